@@ -54,6 +54,21 @@
 		08/01/09 RSB	Adjusted to use NormalizeSourceName().
 		08/06/09 OH		Path and Filename for NormalizeSourcename
 						not FrameName
+		2026-10-17	Rather than a full copy of erasable memory
+				and the i/o channels for each of 100 
+				backtrace points, only the words changed 
+				since the previous point are kept, in a 
+				journal, along with periodic full keyframes.
+				This allows hundreds of thousands of points.
+		2026-10-17	All of that is now kept in a struct
+				Backtrace for each agc_t, rather than in
+				file statics.
+		2026-10-17	Each point also records where the straight
+				run of code leading up to it began.  Added
+				BacktraceStep, BacktraceLength, BacktraceRun,
+				and BacktraceRewind, for the debugger's
+				reverse-step and reverse-continue.
+		2026-10-17	Added BacktraceFree.
 */
 
 #include <stdlib.h>
@@ -63,6 +78,153 @@
 #include "agc_symtab.h"
 #include "agc_debugger.h"
 
+//---------------------------------------------------------------------------
+// The backtrace points are numbered consecutively (their "sequence numbers")
+// as they're added.  What's recorded for each point is an Entry_t, holding the
+// CPU flags and such, plus the changes to erasable memory, the i/o channels,
+// and the interrupt requests since the previous point, which are appended to
+// the Journal[].  These are all compared as 16-bit words at positions within
+// an "image" of those things, laid out as follows.
+#define IMAGE_ERASABLE 0
+#define IMAGE_INPUT (IMAGE_ERASABLE + 8 * 0400)
+#define IMAGE_CHANNEL7 (IMAGE_INPUT + NUM_CHANNELS)
+#define IMAGE_CHANNEL10 (IMAGE_CHANNEL7 + 1)
+#define IMAGE_INTERRUPTS (IMAGE_CHANNEL10 + 16)
+#define IMAGE_WORDS (IMAGE_INTERRUPTS + 1 + NUM_INTERRUPT_TYPES)
+
+// Every KEYFRAME_INTERVAL points (by sequence number), the full image is kept
+// too, so that any point can be rebuilt by applying the changes for at most
+// KEYFRAME_INTERVAL - 1 points to a keyframe.  Points are discarded a
+// keyframe's worth at a time, oldest first, whenever the Entries[] or the
+// Journal[] fill up.  The total memory used is about 15 MB.
+#define BACKTRACE_ENTRIES 0x40000
+#define KEYFRAME_INTERVAL 1024
+#define NUM_KEYFRAMES (BACKTRACE_ENTRIES / KEYFRAME_INTERVAL)
+#define JOURNAL_SIZE 0x200000
+
+typedef struct {
+	uint64_t CycleCounter;
+	uint32_t Journal;		// Position in Journal[] of first change.
+	uint16_t NumChanges;
+	int16_t Z;			// As (pre-incremented Z) - 1.
+	int16_t Start;			// First Z since the previous point.
+	int16_t BB;
+	int16_t IndexValue;
+	uint8_t Flags;
+	int8_t DueToInterrupt;
+} Entry_t;
+#define FLAG_EXTRACODE 1
+#define FLAG_ALLOWINTERRUPT 2
+#define FLAG_INISR 4
+#define FLAG_SUBSTITUTE 8
+#define FLAG_SUPERBANK 16
+
+typedef struct {
+	uint16_t Address;		// Within the image.
+	int16_t Value;
+} Change_t;
+
+// The backtrace of an agc_t, allocated by BacktraceAdd the first time it's
+// needed.  If Entries is NULL, there wasn't enough memory for it.
+struct Backtrace {
+	Entry_t *Entries;
+	Change_t *Journal;
+	int16_t ( *Keyframes )[IMAGE_WORDS];
+	// The image as of the most recent point.
+	int16_t Shadow[IMAGE_WORDS];
+	// Changes for the point being added.
+	Change_t Changes[IMAGE_WORDS];
+	// FirstSeq is always a multiple of KEYFRAME_INTERVAL, and NextSeq - 
+	// FirstSeq is Count.
+	uint64_t FirstSeq, NextSeq;
+	uint32_t JournalHead;
+	int Count;
+	// The first instruction since the most recent point, which 
+	// BacktraceStep fills in if NeedStart is set.
+	int16_t RunStart;
+	int NeedStart;
+};
+
+#define ENTRY(B,Seq) ( &( B )->Entries[( Seq ) % BACKTRACE_ENTRIES] )
+#define KEYFRAME(B,Seq) ( ( B )->Keyframes[( ( Seq ) / KEYFRAME_INTERVAL ) % NUM_KEYFRAMES] )
+
+// Compares Count words against the shadow image at Address, updating it and
+// adding any that have changed to Changes[].  Blocks of 16 words are first
+// compared all at once, since usually little has changed.
+static int DiffWords ( struct Backtrace *B, const int16_t *Words, int Address, int Count, int n )
+{
+	int i, j, Block;
+	for ( i = 0; i < Count; i += Block )
+	{
+		Block = ( Count - i < 16 ) ? Count - i : 16;
+		if ( !memcmp ( &Words[i], &B->Shadow[Address + i], Block * sizeof ( int16_t ) ) )
+			continue;
+		for ( j = i; j < i + Block; j++ )
+			if ( Words[j] != B->Shadow[Address + j] )
+			{
+				B->Shadow[Address + j] = Words[j];
+				B->Changes[n].Address = Address + j;
+				B->Changes[n++].Value = Words[j];
+			}
+	}
+	return n;
+}
+
+// The small stuff at the end of the image.
+static void GetMiscellaneous ( agc_t *State, int16_t *Words )
+{
+	int i;
+	Words[0] = State->OutputChannel7;
+	memcpy ( &Words[1], State->OutputChannel10, sizeof ( State->OutputChannel10 ) );
+	for ( i = 0; i < 1 + NUM_INTERRUPT_TYPES; i++ )
+		Words[17 + i] = State->InterruptRequests[i];
+}
+
+// Builds the image as of point Seq in Image[].
+static void BuildImage ( struct Backtrace *B, uint64_t Seq, int16_t *Image )
+{
+	uint64_t s;
+	uint32_t k;
+	Entry_t *Entry;
+	memcpy ( Image, KEYFRAME ( B, Seq ), sizeof ( B->Shadow ) );
+	for ( s = Seq - Seq % KEYFRAME_INTERVAL + 1; s <= Seq; s++ )
+	{
+		Entry = ENTRY ( B, s );
+		for ( k = 0; k < Entry->NumChanges; k++ )
+		{
+			Change_t *Change = &B->Journal[( Entry->Journal + k ) % JOURNAL_SIZE];
+			Image[Change->Address] = Change->Value;
+		}
+	}
+}
+
+// Removes the newest n points (or all of them, if fewer).
+static void RemovePoints ( struct Backtrace *B, int n )
+{
+	if ( n > B->Count )
+		n = B->Count;
+	if ( n <= 0 )
+		return;
+	B->NextSeq -= n;
+	B->Count -= n;
+	B->JournalHead = ENTRY ( B, B->NextSeq )->Journal;
+	if ( B->Count > 0 )
+		BuildImage ( B, B->NextSeq - 1, B->Shadow );
+}
+
+// Sequence number of point n, where 0 is the most recent.
+#define SEQ(B,n) ( ( B )->NextSeq - 1 - ( n ) )
+
+// The number of points State has, or -1 if there wasn't enough memory.
+static int PointCount ( agc_t *State )
+{
+	if ( State->Backtrace == NULL )
+		return 0;
+	if ( State->Backtrace->Entries == NULL )
+		return -1;
+	return State->Backtrace->Count;
+}
+
 
 #ifdef GDBMI
 //static agc_t *PendingState;
@@ -71,25 +233,20 @@ extern char* SourcePathName;
 extern char* DbgGetFrameNameByAddr(unsigned LinearAddress);
 
 /* Remove Last Added Backtracepoint should be used for TC Q or RETURN */
-void BacktraceRemove()
+void BacktraceRemove ( agc_t *State )
 {
-	if ( BacktraceCount > 0 )
-	{
-		BacktraceNextAdd--;
-		if ( BacktraceNextAdd < 0 )
-			BacktraceNextAdd = MAX_BACKTRACE_POINTS - 1;
-		BacktraceCount--;
-	}
+	if ( PointCount ( State ) > 0 )
+		RemovePoints ( State->Backtrace, 1 );
 	return;
 }
 
-int BacktraceDuplicateCheck ( agc_t *State, BacktracePoint_t* Prev )
+static int BacktraceDuplicateCheck ( agc_t *State, Entry_t* Prev )
 {
 	int isDuplicate = 0;
 
-	int PrevZ = Prev->Erasable[0][RegZ] & 07777;
-	int PrevFB = 037 & ( Prev->Erasable[0][RegBB] >> 10 );
-	int PrevSBB = ( Prev->OutputChannel7 & 0100 ) ? 1 : 0;
+	int PrevZ = Prev->Z & 07777;
+	int PrevFB = 037 & ( Prev->BB >> 10 );
+	int PrevSBB = ( Prev->Flags & FLAG_SUPERBANK ) ? 1 : 0;
 
 	int CurrZ = State->Erasable[0][RegZ] & 07777;
 	int CurrFB = 037 & ( State->Erasable[0][RegBB] >> 10 );
@@ -102,26 +259,22 @@ int BacktraceDuplicateCheck ( agc_t *State, BacktracePoint_t* Prev )
 	return isDuplicate;
 }
 
-SymbolLine_t* FindLastLineMain ( void )
+SymbolLine_t* FindLastLineMain ( agc_t *State )
 {
-	BacktracePoint_t *Bp;
+	struct Backtrace *B = State->Backtrace;
+	Entry_t *Bp;
 	SymbolLine_t *Line = NULL;
 	int CurrentZ,FB,SBB;
-	int BacktraceLocation = BacktraceNextAdd;
-	int Count = BacktraceCount;
+	int Count;
 
-	while ( Count > 0 )
+	for ( Count = 0; Count < PointCount ( State ); Count++ )
 	{
-		BacktraceLocation--;
-		if ( BacktraceLocation < 0 )
-			BacktraceLocation = MAX_BACKTRACE_POINTS - 1;
-		Count--;
-		if ( BacktracePoints[BacktraceLocation].DueToInterrupt )
+		Bp = ENTRY ( B, SEQ ( B, Count ) );
+		if ( Bp->DueToInterrupt )
 		{
-			Bp = &BacktracePoints[BacktraceLocation];
-			CurrentZ = Bp->Erasable[0][RegZ] & 07777;
-			FB = 037 & ( Bp->Erasable[0][RegBB] >> 10 );
-			SBB = ( Bp->OutputChannel7 & 0100 ) ? 1 : 0;
+			CurrentZ = Bp->Z & 07777;
+			FB = 037 & ( Bp->BB >> 10 );
+			SBB = ( Bp->Flags & FLAG_SUPERBANK ) ? 1 : 0;
 			Line = ResolveLineAGC ( CurrentZ, FB, SBB );
 		}
 	}
@@ -141,139 +294,241 @@ SymbolLine_t* FindLastLineMain ( void )
 // code, and all backtrace points to foreground code will be completely lost.
 void BacktraceAdd ( agc_t *State, int Cause )
 {
-	BacktracePoint_t *Bp;
-	if ( SingleStepCounter == -2 || BacktraceInitialized == -1 ) return;
+	struct Backtrace *B = State->Backtrace;
+	Entry_t *Entry;
+	int16_t Miscellaneous[IMAGE_WORDS - IMAGE_CHANNEL7];
+	int i, n;
+	if ( SingleStepCounter == -2 ) return;
 
-	if ( BacktraceInitialized == 0 )
+	if ( B == NULL )
 	{
-		BacktracePoints = ( BacktracePoint_t * )
-		                  malloc ( MAX_BACKTRACE_POINTS * sizeof ( BacktracePoint_t ) );
-		if ( BacktracePoints == NULL )
-		{
-			BacktraceInitialized = -1;
+		B = ( struct Backtrace * ) calloc ( 1, sizeof ( struct Backtrace ) );
+		if ( B == NULL )
 			return;
+		B->Entries = ( Entry_t * ) malloc ( BACKTRACE_ENTRIES * sizeof ( Entry_t ) );
+		B->Journal = ( Change_t * ) malloc ( JOURNAL_SIZE * sizeof ( Change_t ) );
+		B->Keyframes = ( int16_t ( * )[IMAGE_WORDS] )
+			malloc ( NUM_KEYFRAMES * sizeof ( B->Shadow ) );
+		if ( B->Entries == NULL || B->Journal == NULL || B->Keyframes == NULL )
+		{
+			free ( B->Entries );
+			free ( B->Journal );
+			free ( B->Keyframes );
+			B->Entries = NULL;
 		}
-		BacktraceInitialized = 1;
+		B->NeedStart = 1;
+		State->Backtrace = B;
 	}
+	if ( B->Entries == NULL ) return;
 
 #ifdef GDBMI
 	/* Check for Duplicate Consecutive Adds remove simple looping */
-	if ( BacktraceNextAdd > 0 &&
-	        BacktraceDuplicateCheck ( State,&BacktracePoints[BacktraceNextAdd-1] ) )
-	{
-		return;
-	}
-	if ( BacktraceNextAdd == 0 &&
-	        BacktraceDuplicateCheck ( State,&BacktracePoints[MAX_BACKTRACE_POINTS-1] ) )
+	if ( B->Count > 0 &&
+	        BacktraceDuplicateCheck ( State, ENTRY ( B, SEQ ( B, 0 ) ) ) )
 	{
+		B->NeedStart = 1;
 		return;
 	}
 #endif
 
 	if ( Cause == 255 )
 	{
-		while ( BacktraceCount > 0 )
-		{
-			BacktraceNextAdd--;
-			if ( BacktraceNextAdd < 0 )
-				BacktraceNextAdd = MAX_BACKTRACE_POINTS - 1;
-			BacktraceCount--;
-			if ( BacktracePoints[BacktraceNextAdd].DueToInterrupt )
+		for ( i = 0; i < B->Count; i++ )
+			if ( ENTRY ( B, SEQ ( B, i ) )->DueToInterrupt )
 				break;
-		}
+		RemovePoints ( B, i + 1 );
+		B->NeedStart = 1;
 		return;
 	}
 
-	Bp = &BacktracePoints[BacktraceNextAdd++];
-	if ( BacktraceNextAdd >= MAX_BACKTRACE_POINTS )
-		BacktraceNextAdd = 0;
-	if ( BacktraceCount < MAX_BACKTRACE_POINTS )
-		BacktraceCount++;
+	// Find what has changed since the previous point.
+	n = DiffWords ( B, &State->Erasable[0][0], IMAGE_ERASABLE, 8 * 0400, 0 );
+	n = DiffWords ( B, State->InputChannel, IMAGE_INPUT, NUM_CHANNELS, n );
+	GetMiscellaneous ( State, Miscellaneous );
+	n = DiffWords ( B, Miscellaneous, IMAGE_CHANNEL7, IMAGE_WORDS - IMAGE_CHANNEL7, n );
+
+	// Make room, discarding the oldest points a keyframe interval at a time.
+	// If there's no room even then, start over.
+	if ( B->NextSeq % KEYFRAME_INTERVAL == 0 )
+		n = 0;			// The keyframe will have all of it.
+	if ( B->NextSeq - B->FirstSeq >= BACKTRACE_ENTRIES )
+		B->FirstSeq += KEYFRAME_INTERVAL;
+	while ( B->FirstSeq < B->NextSeq &&
+	        B->JournalHead - ENTRY ( B, B->FirstSeq )->Journal + n > JOURNAL_SIZE )
+		B->FirstSeq += KEYFRAME_INTERVAL;
+	if ( B->FirstSeq > B->NextSeq )
+	{
+		B->NextSeq = B->FirstSeq;
+		n = 0;
+	}
+
+	Entry = ENTRY ( B, B->NextSeq );
+	Entry->Journal = B->JournalHead;
+	Entry->NumChanges = n;
+	for ( i = 0; i < n; i++ )
+		B->Journal[B->JournalHead++ % JOURNAL_SIZE] = B->Changes[i];
+	if ( B->NextSeq % KEYFRAME_INTERVAL == 0 )
+		memcpy ( KEYFRAME ( B, B->NextSeq ), B->Shadow, sizeof ( B->Shadow ) );
+	B->NextSeq++;
+	B->Count = B->NextSeq - B->FirstSeq;
+
 	// I just happen to know that State->CycleCounter has been pre-incremented.
-	Bp->CycleCounter = State->CycleCounter - 1;
-	memcpy ( Bp->Erasable, State->Erasable, sizeof ( State->Erasable ) );
-	memcpy ( Bp->InputChannel, State->InputChannel, sizeof ( State->InputChannel ) );
-	memcpy ( Bp->InterruptRequests, State->InterruptRequests,sizeof ( State->InterruptRequests ) );
-	Bp->OutputChannel7 = State->OutputChannel7;
-	memcpy ( Bp->OutputChannel10, State->OutputChannel10, sizeof ( State->OutputChannel10 ) );
-	Bp->IndexValue = State->IndexValue;
-	Bp->ExtraCode = State->ExtraCode;
-	Bp->AllowInterrupt = State->AllowInterrupt;
-	//Bp->RegA16 = State->RegA16;
-	//Bp->RegQ16 = State->RegQ16;
-	Bp->InIsr = State->InIsr;
-	Bp->SubstituteInstruction = State->SubstituteInstruction;
-	Bp->DueToInterrupt = Cause;
-
-//	if (NextZ < 5) Bp->TargetZ = Bp->Erasable[0][NextZ];
-//	else Bp->TargetZ = NextZ;
-
-	// printf("\n*** %d ***\n",Bp->TargetZ);
-
-	Bp->Erasable[0][RegZ]--;	// Recall that Z is pre-incremented.
+	Entry->CycleCounter = State->CycleCounter - 1;
+	// Recall that Z is pre-incremented.
+	Entry->Z = State->Erasable[0][RegZ] - 1;
+	Entry->Start = B->NeedStart ? Entry->Z : B->RunStart;
+	B->NeedStart = 1;
+	Entry->BB = State->Erasable[0][RegBB];
+	Entry->IndexValue = State->IndexValue;
+	Entry->Flags = ( State->ExtraCode ? FLAG_EXTRACODE : 0 )
+	               | ( State->AllowInterrupt ? FLAG_ALLOWINTERRUPT : 0 )
+	               | ( State->InIsr ? FLAG_INISR : 0 )
+	               | ( State->SubstituteInstruction ? FLAG_SUBSTITUTE : 0 )
+	               | ( ( State->OutputChannel7 & 0100 ) ? FLAG_SUPERBANK : 0 );
+	Entry->DueToInterrupt = Cause;
 }
 
-// Restores the state of the system from an entry in the backtrace buffer.
+// Restores the state of the system from an entry in the backtrace buffer,
+// by rebuilding it from the nearest earlier keyframe.
 // Returns 0 on success or non-zero on error.
 
 int
 BacktraceRestore ( agc_t *State, int n )
 {
-	BacktracePoint_t *Bp;
-	int k;
+	struct Backtrace *B = State->Backtrace;
+	Entry_t *Entry;
+	int16_t Image[IMAGE_WORDS];
+	int i;
 	if ( SingleStepCounter == -2 )
 		return ( 1 );
-	if ( BacktraceInitialized == -1 )
+	if ( PointCount ( State ) == -1 )
 		return ( 2 );
 	if ( n < 0 )
 		return ( 3 );
-	if ( n >= BacktraceCount )
+	if ( n >= PointCount ( State ) )
 		return ( 4 );
-	k = BacktraceNextAdd - n - 1;
-	if ( k < 0 )
-		k += BacktraceCount;
-	Bp = &BacktracePoints[k];
-	State->CycleCounter = Bp->CycleCounter;
-	memcpy ( State->Erasable, Bp->Erasable, sizeof ( State->Erasable ) );
-	memcpy ( State->InputChannel, Bp->InputChannel, sizeof ( State->InputChannel ) );
-	memcpy ( State->InterruptRequests, Bp->InterruptRequests,
-	         sizeof ( State->InterruptRequests ) );
-	State->OutputChannel7 = Bp->OutputChannel7;
-	memcpy ( State->OutputChannel10, Bp->OutputChannel10, sizeof ( State->OutputChannel10 ) );
-	State->IndexValue = Bp->IndexValue;
-	State->ExtraCode = Bp->ExtraCode;
-	State->AllowInterrupt = Bp->AllowInterrupt;
-	//State->RegA16 = Bp->RegA16;
-	//State->RegQ16 = Bp->RegQ16;
-	State->InIsr = Bp->InIsr;
-	State->SubstituteInstruction = Bp->SubstituteInstruction;
+	Entry = ENTRY ( B, SEQ ( B, n ) );
+	BuildImage ( B, SEQ ( B, n ), Image );
+	B->RunStart = Entry->Start;
+	B->NeedStart = 0;
+	State->CycleCounter = Entry->CycleCounter;
+	memcpy ( State->Erasable, &Image[IMAGE_ERASABLE], sizeof ( State->Erasable ) );
+	State->Erasable[0][RegZ] = Entry->Z;
+	memcpy ( State->InputChannel, &Image[IMAGE_INPUT], sizeof ( State->InputChannel ) );
+	for ( i = 0; i < 1 + NUM_INTERRUPT_TYPES; i++ )
+		State->InterruptRequests[i] = Image[IMAGE_INTERRUPTS + i];
+	State->OutputChannel7 = Image[IMAGE_CHANNEL7];
+	memcpy ( State->OutputChannel10, &Image[IMAGE_CHANNEL10], sizeof ( State->OutputChannel10 ) );
+	State->IndexValue = Entry->IndexValue;
+	State->ExtraCode = ( 0 != ( Entry->Flags & FLAG_EXTRACODE ) );
+	State->AllowInterrupt = ( 0 != ( Entry->Flags & FLAG_ALLOWINTERRUPT ) );
+	State->InIsr = ( 0 != ( Entry->Flags & FLAG_INISR ) );
+	State->SubstituteInstruction = ( 0 != ( Entry->Flags & FLAG_SUBSTITUTE ) );
 	return ( 0 );
 }
 
+// The debugger calls this before each instruction, so that the first one
+// after each point is known.  Between two points, the CPU only runs straight
+// through the code from there to the next point (barring a CCS, say), so 
+// that the debugger can tell whether it passed a breakpoint on the way.
+
+void
+BacktraceStep ( agc_t *State )
+{
+	struct Backtrace *B = State->Backtrace;
+	if ( B != NULL && B->NeedStart )
+	{
+		B->RunStart = State->Erasable[0][RegZ] & 07777;
+		B->NeedStart = 0;
+	}
+}
+
+// The number of backtrace points State has.
+
+int
+BacktraceLength ( agc_t *State )
+{
+	int Count = PointCount ( State );
+	return ( ( Count < 0 ) ? 0 : Count );
+}
+
+// Gets the run of code that led up to backtrace point n, or for n == -1,
+// the code run since the most recent point.  The run is from 12-bit address
+// *First12 to *Last12, in the banks given by *vRegBB, which is the BB 
+// register with the superbank bit inserted, as in Breakpoint_t.  Returns 0
+// on success or non-zero if there's no such run.
+
+int
+BacktraceRun ( agc_t *State, int n, int *First12, int *Last12, int *vRegBB )
+{
+	struct Backtrace *B = State->Backtrace;
+	Entry_t *Entry;
+	if ( n < -1 || n >= PointCount ( State ) )
+		return ( 1 );
+	if ( n == -1 )
+	{
+		if ( B == NULL || B->NeedStart )
+			return ( 1 );
+		*First12 = B->RunStart;
+		*Last12 = ( State->Erasable[0][RegZ] & 07777 ) - 1;
+		*vRegBB = ( State->Erasable[0][RegBB] & 076007 )
+		          | ( State->InputChannel[7] & 0100 );
+	}
+	else
+	{
+		Entry = ENTRY ( B, SEQ ( B, n ) );
+		*First12 = Entry->Start & 07777;
+		*Last12 = Entry->Z & 07777;
+		*vRegBB = ( Entry->BB & 076007 )
+		          | ( ( Entry->Flags & FLAG_SUPERBANK ) ? 0100 : 0 );
+	}
+	if ( *First12 > *Last12 )
+		return ( 1 );
+	return ( 0 );
+}
+
+// Restores backtrace point n, as BacktraceRestore does, and discards it and
+// all of the points after it.  Since the CPU is then at the instruction that
+// made point n, running forward from there adds the points again, so that
+// the history stays the one the CPU actually followed.  Returns 0 on success
+// or else the error code from BacktraceRestore.
+
+int
+BacktraceRewind ( agc_t *State, int n )
+{
+	int RetVal = BacktraceRestore ( State, n );
+	if ( RetVal == 0 )
+		RemovePoints ( State->Backtrace, n + 1 );
+	return ( RetVal );
+}
+
 // Displays the backtrace buffer.
 
 void BacktraceDisplay ( agc_t *State, int Num )
 {
 #ifndef GDBMI
 	int Bank, Value;
+	static int16_t Image[IMAGE_WORDS];
 #else
 	SymbolLine_t *Line = NULL;
 	char* FrameName;
 	char* PrevFrameName = (char*)1;
 #endif
-	int i, j, k;
-	BacktracePoint_t *Bp;
+	struct Backtrace *B = State->Backtrace;
+	int i, j, Count;
+	Entry_t *Bp;
 	int CurrentZ;
 	int FB;
 	int SBB;
 
-	if ( BacktraceInitialized == -1 )
+	Count = PointCount ( State );
+	if ( Count == -1 )
 	{
 		printf ( "Not enough memory for backtrace buffer.\n" );
 		return;
 	}
 
-	if ( BacktraceCount == 0 )
+	if ( Count == 0 )
 	{
 #ifndef GDBMI
 		printf ( "The backtrace table is empty.\n" );
@@ -285,28 +540,27 @@ void BacktraceDisplay ( agc_t *State, int Num )
 	FB = 037 & ( State->Erasable[0][RegBB] >> 10 );
 	SBB = ( State->OutputChannel7 & 0100 ) ? 1 : 0;
 
-	for ( i = j = 0; i < BacktraceCount; i++ )
+	for ( i = j = 0; i < Count; i++ )
 	{
 		/* Determine location of Current Breakpoint Index */
 		if ( 0 == Num-- ) break;
-		k = BacktraceNextAdd - i - 1;
-		if ( k < 0 ) k += BacktraceCount;
 
 		/* Get Breakpoint Object by Index */
-		Bp = &BacktracePoints[k];
+		Bp = ENTRY ( B, SEQ ( B, i ) );
 
 		/* Find the Line for Current Frame Head */
 //		Line = ResolveLineAGC ( CurrentZ, FB, SBB );
 
 #ifndef GDBMI
 		printf ( "%2d: ", i );
-		CurrentZ = Bp->Erasable[0][RegZ] & 07777;
+		CurrentZ = Bp->Z & 07777;
 		// Print the address.
 		if ( CurrentZ < 01400 )
 		{
 			printf ( "Era%04o", CurrentZ );
 			Bank = CurrentZ / 0400;
-			Value = Bp->Erasable[Bank][CurrentZ & 0377];
+			BuildImage ( B, SEQ ( B, i ), Image );
+			Value = Image[IMAGE_ERASABLE + Bank * 0400 + ( CurrentZ & 0377 )];
 		}
 		else if ( CurrentZ >= 04000 )
 		{
@@ -316,14 +570,15 @@ void BacktraceDisplay ( agc_t *State, int Num )
 		}
 		else if ( CurrentZ < 02000 )
 		{
-			Bank = 7 & Bp->Erasable[0][RegBB];
+			Bank = 7 & Bp->BB;
 			printf ( "E%o,%04o", Bank, 01400 + ( CurrentZ & 0377 ) );
-			Value = Bp->Erasable[Bank][CurrentZ & 0377];
+			BuildImage ( B, SEQ ( B, i ), Image );
+			Value = Image[IMAGE_ERASABLE + Bank * 0400 + ( CurrentZ & 0377 )];
 		}
 		else
 		{
-			Bank = 037 & Bp->Erasable[0][RegBB] >> 10;
-			if ( Bank >= 030 && ( Bp->OutputChannel7 & 0100 ) )
+			Bank = 037 & Bp->BB >> 10;
+			if ( Bank >= 030 && ( Bp->Flags & FLAG_SUPERBANK ) )
 				Bank += 010;
 			printf ( "%02o,%04o", Bank, 02000 + ( CurrentZ & 01777 ) );
 			Value = State->Fixed[Bank][CurrentZ & 01777];
@@ -351,7 +606,7 @@ void BacktraceDisplay ( agc_t *State, int Num )
 			/* Make sure we have a line and only display the head frame
 			 * and not the same frame name twice in a row
 			 */
-			if ( Line && (PrevFrameName != FrameName || BacktraceCount == 1))
+			if ( Line && (PrevFrameName != FrameName || Count == 1))
 			{
 				printf ( "#%d\t0x%04x in %s () at %s:%d\n",i,
 					Addr,FrameName,
@@ -369,9 +624,9 @@ void BacktraceDisplay ( agc_t *State, int Num )
 		/* Only Display the back trace of the current thread */
 		if ( Bp->DueToInterrupt ) break;
 
-		CurrentZ = Bp->Erasable[0][RegZ] & 07777;
-		FB = 037 & ( Bp->Erasable[0][RegBB] >> 10 );
-		SBB = ( Bp->OutputChannel7 & 0100 ) ? 1 : 0;
+		CurrentZ = Bp->Z & 07777;
+		FB = 037 & ( Bp->BB >> 10 );
+		SBB = ( Bp->Flags & FLAG_SUPERBANK ) ? 1 : 0;
 
 		// Next ...
 		j++;
@@ -390,3 +645,16 @@ void BacktraceDisplay ( agc_t *State, int Num )
 }
 
 
+
+// Frees State's backtraces, if any.
+void BacktraceFree ( agc_t *State )
+{
+	struct Backtrace *B = State->Backtrace;
+	if ( B == NULL )
+		return;
+	free ( B->Entries );
+	free ( B->Journal );
+	free ( B->Keyframes );
+	free ( B );
+	State->Backtrace = NULL;
+}
@@ -0,0 +1,158 @@
+/*
+  Copyright 2026 Ronald S. Burkey <info@sandroid.org>
+
+  This file is part of yaAGC.
+
+  yaAGC is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  yaAGC is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with yaAGC; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+  Filename:	ChannelInputTest.c
+  Purpose:	Checks that agc_engine_run calls a ChannelInput other than
+  		SocketAPI.c's in every machine cycle, as NullAPI.c promises,
+		quiet cycles and idle loops included.
+  Compiler:	GNU gcc.
+  Contact:	Ron Burkey <info@sandroid.org>
+  Reference:	http://www.ibiblio.org/apollo/index.html
+  Mods:		2026-10-17	Wrote.
+
+  Like InstructionBenchmark.c, this uses only agc_engine.c and this file
+  (which stands in for NullAPI.c), and is compiled with "make
+  ChannelInputTest", or just:
+
+  	gcc ChannelInputTest.c agc_engine.c
+
+  No core-rope is needed.  The CPU runs an idle loop (CA, TC back) in
+  fixed-fixed memory, with and without IdleSkip, and ChannelInput checks
+  that each call comes exactly one machine cycle after the last.  The exit
+  status is 0 if everything checks out, or 1 if not.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "yaAGC.h"
+#include "agc_engine.h"
+
+extern int DebuggerInterruptMasks[11];
+
+#define TEST_CYCLES 1000000
+
+static agc_t State;
+static int16_t Rope[NUM_FIXED_BANKS][02000];
+static uint64_t Calls, LastCycle;
+static int Misses;
+
+// Sets up State to run the loop.
+static void
+MakeLoop (void)
+{
+  int i, j, Bank;
+
+  State.Fixed = Rope;
+  for (Bank = 0; Bank < NUM_FIXED_BANKS; Bank++)
+    for (j = 0; j < 02000; j++)
+      State.Fixed[Bank][j] = 0;
+  State.Fixed[2][0] = 030100;		// CA 0100
+  State.Fixed[2][1] = 004000;		// TC 04000
+
+  for (i = 0; i < NUM_CHANNELS; i++)
+    State.InputChannel[i] = 0;
+  State.InputChannel[030] = 037777;
+  State.InputChannel[031] = 077777;
+  State.InputChannel[032] = 077777;
+  State.InputChannel[033] = 077777;
+  for (Bank = 0; Bank < 8; Bank++)
+    for (j = 0; j < 0400; j++)
+      State.Erasable[Bank][j] = 0;
+  State.Erasable[0][RegZ] = 04000;
+  State.Erasable[0][0100] = 012345;
+  State.CycleCounter = 0;
+  State.ChannelRoutineCount = 0;
+  State.ExtraCode = 0;
+  State.AllowInterrupt = 0;
+  State.PendFlag = 0;
+  State.PendDelay = 0;
+  State.ExtraDelay = 0;
+  State.IndexValue = 0;
+  State.SubstituteInstruction = 0;
+  State.InIsr = 0;
+}
+
+// Returns 0 if ChannelInput was called once in each cycle run, or 1 if not.
+static int
+Check (int Skip)
+{
+  uint64_t Cycles;
+
+  IdleSkip = Skip;
+  MakeLoop ();
+  Calls = LastCycle = 0;
+  Misses = 0;
+  Cycles = agc_engine_run (&State, TEST_CYCLES);
+  printf ("IdleSkip=%d:  %llu cycles, %llu calls to ChannelInput, %d out "
+	  "of step.\n", Skip, (unsigned long long) Cycles,
+	  (unsigned long long) Calls, Misses);
+  return (Cycles != TEST_CYCLES || Calls != Cycles || Misses != 0);
+}
+
+int
+main (void)
+{
+  int Failed = 0;
+
+  DebuggerInterruptMasks[0] = 0;
+  Failed |= Check (0);
+  Failed |= Check (1);
+  printf ("%s\n", Failed ? "FAILED" : "passed");
+  return (Failed);
+}
+
+//-----------------------------------------------------------------------------
+// The i/o-channel model, as in NullAPI.c, except that ChannelInput keeps
+// count.
+
+int
+ChannelInput (agc_t *State)
+{
+  Calls++;
+  if (State->CycleCounter != LastCycle + 1)
+    Misses++;
+  LastCycle = State->CycleCounter;
+  return (0);
+}
+
+void
+ChannelOutput (agc_t *State, int Channel, int Value)
+{
+}
+
+void
+ChannelRoutine (agc_t *State)
+{
+}
+
+void
+ChannelClose (agc_t *State)
+{
+}
+
+void
+ShiftToDeda (agc_t *State, int Data)
+{
+}
+
+// As in EmbeddedDemo.c, there's no debugger, so no backtrace is needed.
+void
+BacktraceAdd (agc_t *State, int Cause)
+{
+}
@@ -40,6 +40,11 @@
 		02/27/05 RSB	Added the license exception, as required by
 				the GPL, for linking to Orbiter SDK libraries.
 		05/14/05 RSB	Corrected website references
+		2026-10-17	Now uses agc_engine_run().
+		2026-10-17	agc_t now just points to fixed memory.
+		2026-10-17	Build the predecoded instructions.
+		2026-10-17	No longer calls InitDecodedInstructions,
+				which is gone.
 
   This minimalist demo of yaAGC uses only agc_engine.c (as-is, unmodified),
   NullAPI.c (which you would modify to incoporate your own model of how
@@ -70,13 +75,16 @@
   4.  Modification of the template file NullAPI.c so that i/o operations
       affect your actual i/o signals.
   5.  An interrupt service routine that calls agc_engine at 11.7 microsecond
-      intervals.
+      intervals --- or, more economically, one that calls agc_engine_run
+      at some slower rate with the number of AGC cycles elapsed since the
+      previous interrupt.
 */
 
 #include "yaAGC.h"
 #include "agc_engine.h"
 #include "agc_symtab.h"
 agc_t State;
+int16_t Rope[40][02000];
 #define CORE_SIZE (044 * 02000)
 #ifdef __embedded__
 // Stuff that's missing.  Figure it out later.
@@ -105,7 +113,9 @@ main (void)
   // having separate arrays for the various available core-ropes, and
   // selecting whichever one you wanted at power-up by using a DIP switch.
   // Or you could transcode them at compile-time, and eliminate the
-  // transcoding.
+  // transcoding.  (Since agc_t merely points to its fixed memory, the 
+  // transcoded array could itself be const, and placed in ROM.)
+  State.Fixed = Rope;
   Bank = 2;
   for (Bank = 2, j = 0, i = 0; i < CORE_SIZE; i++)
     {
@@ -159,9 +169,10 @@ main (void)
   // while (1);
 
   // ... but lacking the ability to do that hardware-specific thing in this test
-  // program, we just call agc_engine repeatedly, so that it runs flat-out.
+  // program, we just call agc_engine_run repeatedly, so that it runs flat-out.
+  // Each call executes one simulated second's worth of machine cycles.
   for (;;)
-    agc_engine (&State);
+    agc_engine_run (&State, AGC_PER_SECOND);
 }
 
 // This stub-function is here to keep agc_engine from slowing itself down by
@@ -0,0 +1,177 @@
+/*
+  Copyright 2026 Ronald S. Burkey <info@sandroid.org>
+
+  This file is part of yaAGC.
+
+  yaAGC is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  yaAGC is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with yaAGC; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+  Filename:	HostDemo.c
+  Purpose:	This shows somebody wanting to build a DSKY (or a whole
+  		spacecraft) into their own program how to connect it to
+		the CPU in-process, with agc_host.c, rather than through
+		the sockets.
+  Compiler:	GNU gcc.
+  Contact:	Ron Burkey <info@sandroid.org>
+  Reference:	http://www.ibiblio.org/apollo/index.html
+  Mods:		2026-10-17	Began.
+		2026-10-17	Stubbed BacktraceFree as well.
+
+  To build it, "make HostDemo".  To run it,
+
+	HostDemo RomImage [Keys]
+
+  where RomImage is (say) ../Luminary099/MAIN.agc.bin, and Keys are DSKY
+  keystrokes, with V, N, E, C, P, R, K, +, and - standing for VERB, NOUN,
+  ENTR, CLR, PRO, RSET, KEY REL, and the signs.  The default is "V35E",
+  the lamp test.  The CPU is run in real time on a thread of its own, the
+  keystrokes are pushed from the main thread, a quarter-second apart, and
+  whatever the AGC software shows in the PROG, VERB, and NOUN digits is
+  printed as it changes.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "yaAGC.h"
+#include "agc_engine.h"
+#include "agc_runner.h"
+#include "agc_host.h"
+
+// Keycodes for channel 015.
+static const char KeyChars[] = "0123456789VNECR+-K";
+static const int KeyCodes[] = {
+  020, 001, 002, 003, 004, 005, 006, 007, 010, 011,
+  021, 037, 034, 036, 022, 032, 033, 031
+};
+
+// The 5-bit relay codes for the digits 0-9 on channel 010.
+static const int DigitCodes[10] = {
+  025, 003, 031, 033, 017, 036, 034, 023, 035, 037
+};
+
+static int Rows[16];
+
+static char
+Digit (int Code)
+{
+  int i;
+
+  for (i = 0; i < 10; i++)
+    if (DigitCodes[i] == Code)
+      return ('0' + i);
+  return (' ');
+}
+
+// The output callback, for channel 010.  Bits 15-12 of each relay word
+// select a row of the display, and bits 10-6 and 5-1 are the digits in it.
+// Rows 11, 10, and 9 are PROG, VERB, and NOUN.
+static void
+Dsky (agc_t *State, int Channel, int Value, void *Data)
+{
+  int Row = (Value >> 11) & 017;
+
+  if (Row < 9 || Row > 11 || Rows[Row] == Value)
+    return;
+  Rows[Row] = Value;
+  printf ("%8.3f  PROG %c%c  VERB %c%c  NOUN %c%c\n",
+	  State->CycleCounter / (double) AGC_PER_SECOND,
+	  Digit ((Rows[11] >> 5) & 037), Digit (Rows[11] & 037),
+	  Digit ((Rows[10] >> 5) & 037), Digit (Rows[10] & 037),
+	  Digit ((Rows[9] >> 5) & 037), Digit (Rows[9] & 037));
+  fflush (stdout);
+}
+
+static void
+Pause (long Milliseconds)
+{
+  struct timespec req, rem;
+
+  req.tv_sec = Milliseconds / 1000;
+  req.tv_nsec = (Milliseconds % 1000) * 1000000;
+  nanosleep (&req, &rem);
+}
+
+int
+main (int argc, char *argv[])
+{
+  static agc_t State;
+  agc_runner_t Runner;
+  const char *Keys = "V35E", *s;
+  char *Found;
+  uint64_t Cycles;
+
+  if (argc < 2 || argc > 3)
+    {
+      printf ("Use:  HostDemo RomImage [Keys]\n");
+      return (1);
+    }
+  if (argc == 3)
+    Keys = argv[2];
+  if (agc_engine_init (&State, argv[1], NULL, 0))
+    {
+      printf ("Could not load \"%s\".\n", argv[1]);
+      return (1);
+    }
+  if (HostAttach (&State)
+      || HostRegisterOutput (&State, 010, 010, Dsky, NULL))
+    {
+      printf ("Could not attach to the CPU.\n");
+      return (1);
+    }
+  if (agc_runner_start (&Runner, &State, 0, 1))
+    {
+      printf ("Could not start the CPU.\n");
+      return (1);
+    }
+
+  // Give the AGC software time to start up, then type.
+  Pause (2000);
+  for (s = Keys; *s; s++)
+    {
+      // PRO is on channel 032 rather than 015, and is active low.
+      if (*s == 'P')
+	{
+	  HostPushInput (&State, 032, 0, 020000);
+	  Pause (250);
+	  HostPushInput (&State, 032, 020000, 020000);
+	  continue;
+	}
+      Found = strchr (KeyChars, *s);
+      if (Found == NULL)
+	continue;
+      HostPushInput (&State, 015, KeyCodes[Found - KeyChars], 037);
+      Pause (250);
+    }
+  Pause (3000);
+
+  Cycles = agc_runner_stop (&Runner);
+  HostDetach (&State);
+  ChannelClose (&State);
+  printf ("Ran %llu machine cycles.\n", (unsigned long long) Cycles);
+  return (0);
+}
+
+// As in EmbeddedDemo.c, there's no debugger, so no backtrace is needed.
+// (This also keeps the linker from taking Backtrace.o from libyaAGC.a.)
+void
+BacktraceAdd (agc_t *State, int Cause)
+{
+}
+
+void
+BacktraceFree (agc_t *State)
+{
+}
@@ -0,0 +1,179 @@
+/*
+  Copyright 2026 Ronald S. Burkey <info@sandroid.org>
+
+  This file is part of yaAGC.
+
+  yaAGC is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  yaAGC is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with yaAGC; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+  Filename:	InstructionBenchmark.c
+  Purpose:	Measures how fast agc_engine.c executes each kind of
+  		instruction, with and without the fast path for
+		instructions fetched without INDEX (PredecodeInstructions).
+  Compiler:	GNU gcc.
+  Contact:	Ron Burkey <info@sandroid.org>
+  Reference:	http://www.ibiblio.org/apollo/index.html
+  Mods:		2026-10-17	Wrote.
+		2026-10-17	Added a target to the Makefile.
+		2026-10-17	The columns are "plain" and "fast path",
+				since there's no predecoded table now.
+
+  Like EmbeddedDemo.c, this uses only agc_engine.c, NullAPI.c, and this
+  file, and is compiled with "make InstructionBenchmark", or just:
+
+  	gcc -O2 InstructionBenchmark.c NullAPI.c agc_engine.c
+
+  No core-rope is needed.  For each instruction in the table below, a
+  synthetic rope is made consisting of a long run of that instruction
+  (preceded by EXTEND, for extracodes) in fixed-fixed memory, followed by a
+  TC back to the start, and the engine is run for a fixed number of machine
+  cycles over it with interrupts disabled.  The optional command-line
+  argument is the number of machine cycles per measurement, in millions.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "yaAGC.h"
+#include "agc_engine.h"
+
+extern int DebuggerInterruptMasks[11];
+
+#define LOOP_LENGTH 01000
+
+typedef struct {
+  const char *Name;
+  int Extracode;
+  int16_t Instruction;
+} Benchmark_t;
+
+// The operands are all at erasable 0100-0101, or channel 030.
+static const Benchmark_t Benchmarks[] = {
+  { "CA", 0, 030100 },
+  { "CS", 0, 040100 },
+  { "AD", 0, 060100 },
+  { "MASK", 0, 070100 },
+  { "TS", 0, 054100 },
+  { "XCH", 0, 056100 },
+  { "LXCH", 0, 022100 },
+  { "INCR", 0, 024100 },
+  { "ADS", 0, 026100 },
+  { "DAS", 0, 020101 },
+  { "DXCH", 0, 052101 },
+  { "READ", 1, 000030 },
+  { "RAND", 1, 002030 },
+  { "DCA", 1, 030101 },
+  { "DCS", 1, 040101 },
+  { "SU", 1, 060100 },
+  { "MSU", 1, 020100 },
+  { "QXCH", 1, 022100 },
+  { "AUG", 1, 024100 },
+  { "DIM", 1, 026100 },
+  { "MP", 1, 070100 },
+  { "DV", 1, 010100 },
+  { NULL }
+};
+
+static agc_t State;
+static int16_t Rope[NUM_FIXED_BANKS][02000];
+
+// Sets up State to run the loop for one instruction.
+static void
+MakeLoop (const Benchmark_t *Benchmark)
+{
+  int i, j, Bank;
+
+  State.Fixed = Rope;
+  for (Bank = 0; Bank < NUM_FIXED_BANKS; Bank++)
+    for (j = 0; j < 02000; j++)
+      State.Fixed[Bank][j] = 0;
+  for (i = j = 0; i < LOOP_LENGTH; i++)
+    {
+      if (Benchmark->Extracode)
+	State.Fixed[2][j++] = 000006;	// EXTEND
+      State.Fixed[2][j++] = Benchmark->Instruction;
+    }
+  State.Fixed[2][j] = 004000;		// TC 04000
+
+  for (i = 0; i < NUM_CHANNELS; i++)
+    State.InputChannel[i] = 0;
+  State.InputChannel[030] = 037777;
+  State.InputChannel[031] = 077777;
+  State.InputChannel[032] = 077777;
+  State.InputChannel[033] = 077777;
+  for (Bank = 0; Bank < 8; Bank++)
+    for (j = 0; j < 0400; j++)
+      State.Erasable[Bank][j] = 0;
+  State.Erasable[0][RegZ] = 04000;
+  State.Erasable[0][0100] = 012345;
+  State.Erasable[0][0101] = 023456;
+  State.CycleCounter = 0;
+  State.ExtraCode = 0;
+  State.AllowInterrupt = 0;
+  State.PendFlag = 0;
+  State.PendDelay = 0;
+  State.ExtraDelay = 0;
+  State.IndexValue = 0;
+  State.SubstituteInstruction = 0;
+  State.InIsr = 0;
+}
+
+// Returns nanoseconds per machine cycle.
+static double
+Measure (const Benchmark_t *Benchmark, uint64_t Cycles, int Predecode)
+{
+  clock_t Start;
+
+  PredecodeInstructions = Predecode;
+  MakeLoop (Benchmark);
+  Start = clock ();
+  agc_engine_run (&State, Cycles);
+  return (1e9 * (clock () - Start) / CLOCKS_PER_SEC / Cycles);
+}
+
+int
+main (int argc, char *argv[])
+{
+  const Benchmark_t *Benchmark;
+  uint64_t Cycles = 10000000;
+  double Plain, Fast, TotalPlain = 0, TotalFast = 0;
+
+  if (argc > 1)
+    Cycles = 1000000 * (uint64_t) atoi (argv[1]);
+  if (Cycles == 0)
+    {
+      printf ("Usage: %s [MegaCycles]\n", argv[0]);
+      return (1);
+    }
+  DebuggerInterruptMasks[0] = 0;
+  printf ("Instruction   ns/MCT plain   ns/MCT fast path   Speedup\n");
+  for (Benchmark = Benchmarks; Benchmark->Name != NULL; Benchmark++)
+    {
+      Plain = Measure (Benchmark, Cycles, 0);
+      Fast = Measure (Benchmark, Cycles, 1);
+      TotalPlain += Plain;
+      TotalFast += Fast;
+      printf ("%-11s %12.2f %18.2f %9.2f\n", Benchmark->Name, Plain,
+	      Fast, Plain / Fast);
+    }
+  printf ("%-11s %12.2f %18.2f %9.2f\n", "(all)", TotalPlain,
+	  TotalFast, TotalPlain / TotalFast);
+  return (0);
+}
+
+// As in EmbeddedDemo.c, there's no debugger, so no backtrace is needed.
+void
+BacktraceAdd (agc_t *State, int Cause)
+{
+}
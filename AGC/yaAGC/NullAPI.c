@@ -41,6 +41,7 @@
 				the GPL, for linking to Orbiter SDK libraries.
 		05/14/05 RSB	Corrected website references.
 		05/31/05 RSB	Added ShiftToDeda.
+		2026-10-17	Added ChannelClose.
 */
 
 #ifdef WIN32
@@ -173,6 +174,15 @@ ChannelRoutine (agc_t *State)
 
 }
 
+//----------------------------------------------------------------------
+// Releases whatever ChannelSetup set up, when the CPU is done with its
+// peripherals.
+
+void
+ChannelClose (agc_t *State)
+{
+}
+
 //----------------------------------------------------------------------
 // This function is useful only for debugging the socket interface, and
 // so can be left as-is.
@@ -0,0 +1,176 @@
+/*
+  Copyright 2026 Ronald S. Burkey <info@sandroid.org>
+
+  This file is part of yaAGC.
+
+  yaAGC is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  yaAGC is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with yaAGC; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+  Filename:	Pacer.c
+  Purpose:	Real-time pacing for the CPU simulations (yaAGC, yaAGS).
+  Compiler:	GNU gcc.
+  Contact:	Ron Burkey <info@sandroid.org>
+  Reference:	http://www.ibiblio.org/apollo/index.html
+  Mods:		2026-10-17	Began.
+		2026-10-17	Added the latest and worst jitter, and
+				PacerBacklog, for agc_stats.c.
+
+  The simulations used to pace themselves with times(), whose resolution
+  is typically only 10 ms, and so ran the CPU in 10 ms bursts.  Instead, a 
+  Pacer_t wakes up at regular intervals (the "quantum", which can be much 
+  shorter) measured from a monotonic clock, sleeping until an absolute 
+  deadline so that errors don't accumulate.  After each wakeup, the caller
+  runs the CPU until it has caught up with real time.  The Pacer_t also 
+  keeps histograms of how late each wakeup was (jitter), and of how far 
+  behind real time the CPU was after catching up (lag).
+*/
+
+#include <stdio.h>
+#include <time.h>
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <sys/time.h>
+#endif
+#include "yaAGC.h"
+#include "agc_engine.h"
+
+// Returns the time, in nanoseconds, from an arbitrary starting point.
+uint64_t
+PacerNow (void)
+{
+#if defined (WIN32)
+  return (GetTickCount () * (uint64_t) 1000000);
+#elif defined (CLOCK_MONOTONIC)
+  struct timespec ts;
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return (ts.tv_sec * (uint64_t) 1000000000 + ts.tv_nsec);
+#else
+  struct timeval tv;
+  gettimeofday (&tv, NULL);
+  return (tv.tv_sec * (uint64_t) 1000000000 + tv.tv_usec * (uint64_t) 1000);
+#endif
+}
+
+void
+PacerInit (Pacer_t *Pacer, uint64_t Quantum)
+{
+  int i;
+  if (Quantum == 0)
+    Quantum = PACER_DEFAULT_QUANTUM;
+  Pacer->Quantum = Quantum;
+  Pacer->Deadline = PacerNow ();
+  Pacer->Wakeups = 0;
+  Pacer->LastJitter = Pacer->MaxJitter = 0;
+  Pacer->Backlog = Pacer->MaxBacklog = 0;
+  for (i = 0; i < PACER_BUCKETS; i++)
+    Pacer->Jitter[i] = Pacer->Lag[i] = 0;
+}
+
+// Adds a time (in ns) to one of the histograms.  Bucket 0 is for times 
+// under 1 us, and bucket i for 2**(i-1) to 2**i us.
+static void
+PacerAdd (unsigned *Histogram, long long Time)
+{
+  int i;
+  Time /= 1000;
+  for (i = 0; Time > 0 && i < PACER_BUCKETS - 1; i++)
+    Time >>= 1;
+  Histogram[i]++;
+}
+
+// Sleeps until the next quantum boundary, and returns the current time.  If
+// the caller has fallen more than a few quanta behind (for example, because
+// it was stopped in a debugger), the schedule restarts from the present 
+// rather than trying to catch up.
+uint64_t
+PacerWait (Pacer_t *Pacer)
+{
+  uint64_t Now;
+  Pacer->Deadline += Pacer->Quantum;
+  Now = PacerNow ();
+  if (Now > Pacer->Deadline + 8 * Pacer->Quantum)
+    Pacer->Deadline = Now + Pacer->Quantum;
+#if defined (WIN32)
+  if (Pacer->Deadline > Now)
+    Sleep ((Pacer->Deadline - Now + 999999) / 1000000);
+#elif defined (TIMER_ABSTIME) && defined (CLOCK_MONOTONIC)
+  {
+    // An early return due to a signal is fine.
+    struct timespec ts;
+    ts.tv_sec = Pacer->Deadline / 1000000000;
+    ts.tv_nsec = Pacer->Deadline % 1000000000;
+    clock_nanosleep (CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+  }
+#else
+  if (Pacer->Deadline > Now)
+    {
+      struct timespec req, rem;
+      req.tv_sec = (Pacer->Deadline - Now) / 1000000000;
+      req.tv_nsec = (Pacer->Deadline - Now) % 1000000000;
+      nanosleep (&req, &rem);
+    }
+#endif
+  Now = PacerNow ();
+  Pacer->Wakeups++;
+  Pacer->LastJitter = (Now > Pacer->Deadline) ? Now - Pacer->Deadline : 0;
+  if (Pacer->LastJitter > Pacer->MaxJitter)
+    Pacer->MaxJitter = Pacer->LastJitter;
+  PacerAdd (Pacer->Jitter, (long long) (Now - Pacer->Deadline));
+  return (Now);
+}
+
+// Records how far (in ns) the CPU was behind real time after catching up.
+void
+PacerLag (Pacer_t *Pacer, uint64_t Lag)
+{
+  PacerAdd (Pacer->Lag, (long long) Lag);
+}
+
+// Records how many machine cycles the CPU had to run after a wakeup in 
+// order to catch up with real time.
+void
+PacerBacklog (Pacer_t *Pacer, uint64_t Cycles)
+{
+  Pacer->Backlog = Cycles;
+  if (Cycles > Pacer->MaxBacklog)
+    Pacer->MaxBacklog = Cycles;
+}
+
+// Prints the histograms.
+void
+PacerReport (Pacer_t *Pacer)
+{
+  FILE *fp = stdout;
+  int i, Last;
+  fprintf (fp, "Pacing: %u us quantum, " FORMAT_64U " wakeups.\n",
+	   (unsigned) (Pacer->Quantum / 1000), Pacer->Wakeups);
+  if (Pacer->Wakeups == 0)
+    return;
+  for (Last = PACER_BUCKETS - 1; Last > 0; Last--)
+    if (Pacer->Jitter[Last] || Pacer->Lag[Last])
+      break;
+  fprintf (fp, "%18s %12s %12s\n", "Time (us)", "Jitter", "Lag");
+  for (i = 0; i <= Last; i++)
+    {
+      char Range[32];
+      if (i == 0)
+	sprintf (Range, "< 1");
+      else if (i == PACER_BUCKETS - 1)
+	sprintf (Range, ">= %lu", 1UL << (i - 1));
+      else
+	sprintf (Range, "%lu-%lu", 1UL << (i - 1), 1UL << i);
+      fprintf (fp, "%18s %12u %12u\n", Range, Pacer->Jitter[i], Pacer->Lag[i]);
+    }
+}
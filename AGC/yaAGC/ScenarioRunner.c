@@ -0,0 +1,553 @@
+/*
+  Copyright 2026 Ronald S. Burkey <info@sandroid.org>
+
+  This file is part of yaAGC.
+
+  yaAGC is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  yaAGC is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with yaAGC; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+  Filename:	ScenarioRunner.c
+  Purpose:	Runs scripted DSKY sessions (scenarios) without any DSKY,
+  		and without a human to watch it, checking what the AGC
+		software displays.  Many scenarios are run at once, in
+		worker processes, as fast as the CPU can go.
+  Compiler:	GNU gcc.
+  Contact:	Ron Burkey <info@sandroid.org>
+  Reference:	http://www.ibiblio.org/apollo/index.html
+  Mods:		2026-10-17	Began.
+		2026-10-17	Stubbed BacktraceFree as well.
+
+  To build it, "make ScenarioRunner".  To run it,
+
+	ScenarioRunner [Options] Scenario1.txt Scenario2.txt ...
+
+  with the options
+
+	--cm=RopeFile	The rope for scenarios beginning with C.
+	--lm=RopeFile	The rope for scenarios beginning with L.
+	--jobs=N	The number of worker processes.  The default is the
+			number of CPUs.
+	--warmup=S	The seconds of AGC time to run before the script
+			starts.  The default is 2.
+	--timeout=S	The default for #@timeout.
+
+  The result, the AGC time, and the wall-clock time of each scenario are
+  printed, with the reason for each failure.  The exit code is 0 only if
+  all of them pass.
+
+  The scenarios are the same scripts that VirtualAGC sends through the
+  digital uplink (see scenarios/LmQuickStart.txt), and are run the same
+  way:  the first character is C or L, for the CM or LM; everything from
+  a # to the end of the line is a comment; the keys VNECPKR+-0123456789
+  are sent, 0.3 seconds apart, with Z for the uplink-error-clear code;
+  each space is a further 0.6 seconds; and everything else is ignored.
+  (Z is sent as the RSET keycode, which is what the AGC software takes to
+  clear an uplink lockout.  Note too that the AGC software doesn't show
+  anything on the DSKY for keys from the uplink until a key has been
+  pressed on the DSKY itself.)  Lines beginning with #@ (which VirtualAGC
+  takes to be comments) add the following:
+
+	#@dsky		Send the keys to the DSKY (channel 015, or 032 for
+			PRO) from now on, rather than through the uplink
+			(channel 0173).
+	#@uplink	Back to the uplink.
+	#@word Octal	Send a raw word through the uplink.
+	#@wait S	Run S seconds of AGC time.
+	#@timeout S	Give up on each #@expect after S seconds of AGC time
+			from now on.  The default is 5.
+	#@expect Field Value
+			Wait until the DSKY display shows Value in Field,
+			which is PROG, VERB, or NOUN, with a 2-digit Value,
+			or R1, R2, or R3, with a sign and 5 digits.  Use _
+			for a blank sign or digit.  The scenario fails if it
+			hasn't within the timeout.
+	#@expect 011 Octal [Mask]
+			Wait until the bits of channel 011 (the DSKY lamps
+			and so on) in Mask (default 077777) are Octal.
+
+  For example,
+
+	L
+	#@dsky
+	V35E		# Lamp test.
+	#@expect VERB 88
+	#@expect R1 +88888
+	#@expect 011 00174 00174
+	#@uplink
+	#@wait 6
+	V16N36E		# Mission time.
+	#@expect NOUN 36
+	#@expect R1 +00000
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <time.h>
+#ifndef WIN32
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#endif
+#include "yaAGC.h"
+#include "agc_engine.h"
+#include "agc_host.h"
+
+#define MAX_LINE 1024
+#define MAX_MESSAGE 256
+#define KEY_DELAY 0.3
+#define SPACE_DELAY 0.6
+// How often expectations are checked, in seconds of AGC time.
+#define CHECK_INTERVAL 0.01
+
+// The DSKY as last output on channels 010 (one word for each row of
+// relays) and 011.
+typedef struct
+{
+  int Rows[16];
+  int Channel11;
+} Display_t;
+
+#define STATUS_NOT_RUN 0
+#define STATUS_RUNNING 1		// Only left if the worker crashed.
+#define STATUS_PASSED 2
+#define STATUS_FAILED 3
+typedef struct
+{
+  int Status;
+  double AgcSeconds, WallSeconds;
+  char Message[MAX_MESSAGE];
+} Result_t;
+
+static const char *CmRope = NULL, *LmRope = NULL;
+static double Warmup = 2.0, DefaultTimeout = 5.0;
+
+// The 5-bit relay codes for the digits 0-9 on channel 010.
+static const int DigitCodes[10] = {
+  025, 003, 031, 033, 017, 036, 034, 023, 035, 037
+};
+
+static char
+Digit (int Code)
+{
+  int i;
+
+  if (Code == 0)
+    return ('_');
+  for (i = 0; i < 10; i++)
+    if (DigitCodes[i] == Code)
+      return ('0' + i);
+  return ('?');
+}
+
+// The relay rows hold two digits each, in bits 10-6 and 5-1, and some
+// hold a sign bit (bit 11) as well.  Each register's digits are listed by
+// row and by which of the two, 1 for the left.
+typedef struct
+{
+  const char *Name;
+  int PlusRow, MinusRow;	// 0 for no sign.
+  int NumDigits;
+  int Digits[5][2];
+} Field_t;
+
+static const Field_t Fields[] = {
+  { "PROG", 0, 0, 2, { { 11, 1 }, { 11, 0 } } },
+  { "VERB", 0, 0, 2, { { 10, 1 }, { 10, 0 } } },
+  { "NOUN", 0, 0, 2, { { 9, 1 }, { 9, 0 } } },
+  { "R1", 7, 6, 5, { { 8, 0 }, { 7, 1 }, { 7, 0 }, { 6, 1 }, { 6, 0 } } },
+  { "R2", 5, 4, 5, { { 5, 1 }, { 5, 0 }, { 4, 1 }, { 4, 0 }, { 3, 1 } } },
+  { "R3", 2, 1, 5, { { 3, 0 }, { 2, 1 }, { 2, 0 }, { 1, 1 }, { 1, 0 } } }
+};
+#define NUM_FIELDS (sizeof (Fields) / sizeof (Fields[0]))
+
+// Puts what the display shows in a field into s, in the form used by
+// #@expect.
+static void
+ShowField (const Display_t *Display, const Field_t *Field, char *s)
+{
+  int i, Word, Plus, Minus;
+
+  if (Field->PlusRow)
+    {
+      Plus = (Display->Rows[Field->PlusRow] & 02000);
+      Minus = (Display->Rows[Field->MinusRow] & 02000);
+      *s++ = Minus ? '-' : (Plus ? '+' : '_');
+    }
+  for (i = 0; i < Field->NumDigits; i++)
+    {
+      Word = Display->Rows[Field->Digits[i][0]];
+      *s++ = Digit (Field->Digits[i][1] ? ((Word >> 5) & 037) : (Word & 037));
+    }
+  *s = 0;
+}
+
+// The output callback, for channels 010 and 011.
+static void
+Output (agc_t *State, int Channel, int Value, void *Data)
+{
+  Display_t *Display = (Display_t *) Data;
+
+  if (Channel == 011)
+    Display->Channel11 = Value;
+  else
+    Display->Rows[(Value >> 11) & 017] = Value;
+}
+
+// The same keycodes as VirtualAGC's uplink, or -1.
+static int
+Keycode (int c)
+{
+  static const char Keys[] = "VN+-0123456789CKER";
+  static const int Codes[] = {
+    17, 31, 26, 27, 16, 1, 2, 3, 4, 5, 6, 7, 8, 9, 30, 25, 28, 18
+  };
+  const char *s;
+
+  if (c == 0 || NULL == (s = strchr (Keys, c)))
+    return (-1);
+  return (Codes[s - Keys]);
+}
+
+static double
+WallClock (void)
+{
+  struct timespec t;
+
+  clock_gettime (CLOCK_MONOTONIC, &t);
+  return (t.tv_sec + t.tv_nsec / 1e9);
+}
+
+static void
+Run (agc_t *State, double Seconds)
+{
+  agc_engine_run (State, (uint64_t) (Seconds * AGC_PER_SECOND + 0.5));
+}
+
+// Sends a keystroke, with the delay after it.
+static void
+Key (agc_t *State, int Dsky, int c)
+{
+  int Code = Keycode (c);
+
+  if (Dsky)
+    {
+      // PRO is on channel 032 rather than 015, and is active low.
+      if (c == 'P')
+	{
+	  HostPushInput (State, 032, 0, 020000);
+	  Run (State, KEY_DELAY);
+	  HostPushInput (State, 032, 020000, 020000);
+	}
+      else if (Code >= 0)
+	HostPushInput (State, 015, Code, 037);
+      else
+	return;
+    }
+  else
+    {
+      // Through the uplink, each keycode is sent along with its
+      // complement, and PRO can't be sent at all.
+      if (c == 'Z')
+	Code = Keycode ('R');
+      if (Code >= 0)
+	Code |= (Code << 10) | ((Code ^ 037) << 5);
+      else
+	return;
+      HostPushInput (State, 0173, Code, 077777);
+    }
+  Run (State, KEY_DELAY);
+}
+
+// Checks one #@expect.  Returns 1 if the display matches, 0 if not (with
+// what it shows in Shown), or -1 if the #@expect itself is bad.
+static int
+Matches (const Display_t *Display, const char *Field, const char *Value,
+	 const char *Mask, char *Shown)
+{
+  unsigned i;
+  int Expected, Bits;
+
+  if (!strcmp (Field, "011"))
+    {
+      if (1 != sscanf (Value, "%o", &Expected))
+	return (-1);
+      Bits = 077777;
+      if (*Mask && 1 != sscanf (Mask, "%o", &Bits))
+	return (-1);
+      sprintf (Shown, "%05o", Display->Channel11 & Bits);
+      return ((Display->Channel11 & Bits) == (Expected & Bits));
+    }
+  for (i = 0; i < NUM_FIELDS; i++)
+    if (!strcmp (Field, Fields[i].Name))
+      {
+	if (strlen (Value) != Fields[i].NumDigits + (Fields[i].PlusRow != 0))
+	  return (-1);
+	ShowField (Display, &Fields[i], Shown);
+	return (!strcmp (Shown, Value));
+      }
+  return (-1);
+}
+
+// Runs the scenario in Filename, and fills in Result.
+static void
+RunScenario (const char *Filename, Result_t *Result)
+{
+  static agc_t State;
+  Display_t Display;
+  FILE *fp;
+  char Line[MAX_LINE], Directive[32], Arg1[32], Arg2[32], Arg3[32], Shown[32];
+  const char *Rope, *s;
+  double Start, Timeout = DefaultTimeout, Waited;
+  int LineNumber = 0, Dsky = 0, Loaded = 0, Word, n, i;
+
+  Start = WallClock ();
+  Result->Status = STATUS_FAILED;
+  fp = fopen (Filename, "r");
+  if (fp == NULL)
+    {
+      sprintf (Result->Message, "Cannot open the file.");
+      return;
+    }
+  if (NULL == fgets (Line, sizeof (Line), fp))
+    Line[0] = 0;
+  LineNumber++;
+  if (toupper (Line[0]) == 'C')
+    Rope = CmRope;
+  else if (toupper (Line[0]) == 'L')
+    Rope = LmRope;
+  else
+    {
+      sprintf (Result->Message, "Doesn't begin with C or L.");
+      goto Done;
+    }
+  if (Rope == NULL)
+    {
+      sprintf (Result->Message, "No --%cm rope.", tolower (Line[0]));
+      goto Done;
+    }
+  if (agc_engine_init (&State, Rope, NULL, 0))
+    {
+      snprintf (Result->Message, MAX_MESSAGE, "Cannot load %s.", Rope);
+      goto Done;
+    }
+  Loaded = 1;
+  memset (&Display, 0, sizeof (Display));
+  if (HostAttach (&State)
+      || HostRegisterOutput (&State, 010, 011, Output, &Display))
+    {
+      sprintf (Result->Message, "Cannot attach to the CPU.");
+      goto Done;
+    }
+  Run (&State, Warmup);
+
+  // The rest of the first line is handled like any other.
+  memmove (Line, Line + 1, strlen (Line));
+  do
+    {
+      if (Line[0] == '#' && Line[1] == '@')
+	{
+	  Arg1[0] = Arg2[0] = Arg3[0] = 0;
+	  n = sscanf (Line + 2, "%31s %31s %31s %31s", Directive, Arg1, Arg2,
+		      Arg3);
+	  if (n < 1)
+	    goto BadDirective;
+	  if (!strcmp (Directive, "dsky"))
+	    Dsky = 1;
+	  else if (!strcmp (Directive, "uplink"))
+	    Dsky = 0;
+	  else if (!strcmp (Directive, "word") && n == 2
+		   && 1 == sscanf (Arg1, "%o", &Word))
+	    {
+	      HostPushInput (&State, 0173, Word, 077777);
+	      Run (&State, KEY_DELAY);
+	    }
+	  else if (!strcmp (Directive, "wait") && n == 2)
+	    Run (&State, atof (Arg1));
+	  else if (!strcmp (Directive, "timeout") && n == 2)
+	    Timeout = atof (Arg1);
+	  else if (!strcmp (Directive, "expect") && n >= 3)
+	    {
+	      for (Waited = 0; ; Waited += CHECK_INTERVAL)
+		{
+		  i = Matches (&Display, Arg1, Arg2, Arg3, Shown);
+		  if (i < 0)
+		    goto BadDirective;
+		  if (i)
+		    break;
+		  if (Waited >= Timeout)
+		    {
+		      snprintf (Result->Message, MAX_MESSAGE,
+				"Line %d:  expected %s %s, but it's %s.",
+				LineNumber, Arg1, Arg2, Shown);
+		      goto Done;
+		    }
+		  Run (&State, CHECK_INTERVAL);
+		}
+	    }
+	  else
+	    goto BadDirective;
+	  continue;
+	}
+      for (s = Line; *s && *s != '#' && *s != '!'; s++)
+	{
+	  if (*s == ' ')
+	    Run (&State, SPACE_DELAY);
+	  else
+	    Key (&State, Dsky, toupper (*s));
+	}
+    }
+  while (LineNumber++, NULL != fgets (Line, sizeof (Line), fp));
+  Result->Status = STATUS_PASSED;
+  goto Done;
+
+BadDirective:
+  snprintf (Result->Message, MAX_MESSAGE, "Line %d:  bad directive.",
+	    LineNumber);
+Done:
+  fclose (fp);
+  if (Loaded)
+    {
+      Result->AgcSeconds = State.CycleCounter / (double) AGC_PER_SECOND;
+      HostDetach (&State);
+    }
+  Result->WallSeconds = WallClock () - Start;
+}
+
+int
+main (int argc, char *argv[])
+{
+  Result_t *Results;
+  int i, NumScenarios, Jobs = 0, Passed = 0;
+  char **Scenarios;
+  double Start;
+#ifndef WIN32
+  volatile int *Next;
+  pid_t Pid;
+#endif
+
+  for (i = 1; i < argc && !strncmp (argv[i], "--", 2); i++)
+    {
+      if (!strncmp (argv[i], "--cm=", 5))
+	CmRope = &argv[i][5];
+      else if (!strncmp (argv[i], "--lm=", 5))
+	LmRope = &argv[i][5];
+      else if (1 == sscanf (argv[i], "--jobs=%d", &Jobs))
+	;
+      else if (1 == sscanf (argv[i], "--warmup=%lf", &Warmup))
+	;
+      else if (1 == sscanf (argv[i], "--timeout=%lf", &DefaultTimeout))
+	;
+      else
+	break;
+    }
+  if (i >= argc || !strncmp (argv[i], "--", 2))
+    {
+      printf ("Use:  ScenarioRunner [--cm=RopeFile] [--lm=RopeFile] [--jobs=N]\n");
+      printf ("                     [--warmup=S] [--timeout=S] Scenario ...\n");
+      return (1);
+    }
+  Scenarios = &argv[i];
+  NumScenarios = argc - i;
+  IdleSkip = 1;
+  Start = WallClock ();
+
+#ifdef WIN32
+  Results = (Result_t *) calloc (NumScenarios, sizeof (Result_t));
+  for (i = 0; i < NumScenarios; i++)
+    RunScenario (Scenarios[i], &Results[i]);
+#else
+  // The workers take the scenarios one at a time, in order, and put the
+  // results where the parent can see them.
+  Next = (volatile int *) mmap (NULL, sizeof (int)
+				+ NumScenarios * sizeof (Result_t),
+				PROT_READ | PROT_WRITE,
+				MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  if (Next == MAP_FAILED)
+    {
+      printf ("Out of memory.\n");
+      return (1);
+    }
+  Results = (Result_t *) (Next + 1);
+  if (Jobs <= 0)
+    Jobs = sysconf (_SC_NPROCESSORS_ONLN);
+  if (Jobs > NumScenarios)
+    Jobs = NumScenarios;
+  fflush (stdout);
+  for (i = 0; i < Jobs; i++)
+    {
+      Pid = fork ();
+      if (Pid < 0)
+	{
+	  printf ("Cannot start worker %d.\n", i);
+	  break;
+	}
+      if (Pid == 0)
+	{
+	  int n;
+	  while ((n = __atomic_fetch_add (Next, 1, __ATOMIC_RELAXED))
+		 < NumScenarios)
+	    {
+	      Results[n].Status = STATUS_RUNNING;
+	      RunScenario (Scenarios[n], &Results[n]);
+	    }
+	  _exit (0);
+	}
+    }
+  while (wait (NULL) > 0)
+    ;
+#endif
+
+  for (i = 0; i < NumScenarios; i++)
+    {
+      Result_t *Result = &Results[i];
+      switch (Result->Status)
+	{
+	case STATUS_PASSED:
+	  Passed++;
+	  printf ("PASS");
+	  break;
+	case STATUS_FAILED:
+	  printf ("FAIL");
+	  break;
+	case STATUS_RUNNING:
+	  printf ("FAIL");
+	  sprintf (Result->Message, "The worker crashed.");
+	  break;
+	default:
+	  printf ("----");
+	  sprintf (Result->Message, "Not run.");
+	  break;
+	}
+      printf ("  %8.2f s AGC  %7.3f s wall  %s\n", Result->AgcSeconds,
+	      Result->WallSeconds, Scenarios[i]);
+      if (Result->Status != STATUS_PASSED)
+	printf ("\t%s\n", Result->Message);
+    }
+  printf ("%d of %d passed, in %.3f s.\n", Passed, NumScenarios,
+	  WallClock () - Start);
+  return (Passed != NumScenarios);
+}
+
+// As in HostDemo.c, there's no debugger, so no backtrace is needed.
+void
+BacktraceAdd (agc_t *State, int Cause)
+{
+}
+
+void
+BacktraceFree (agc_t *State)
+{
+}
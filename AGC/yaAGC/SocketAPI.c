@@ -65,17 +65,209 @@
 				Added some robustness checking to the
 				data stream on the tcp port.
 		03/19/09 RSB	Added DedaQuiet.
+		2026-10-17	The clients, server sockets, and RHC values
+				are now kept in agc_t, so several CPUs can
+				each have their own peripherals.
+		2026-10-17	Input from clients is now read in bulk
+				into per-client buffers, from those that
+				select() says have sent something, and 
+				all the complete packets are processed at
+				once.
+		2026-10-17	Output to clients is collected in buffers
+				that are sent periodically, and clients can
+				subscribe to just the channels they want.
+		2026-10-17	What's done with the input has moved to
+				AcceptInput, so that it can be recorded
+				and replayed.  While replaying, the
+				sockets aren't used at all.
+		2026-10-17	Nor are they for a Headless agc_t.
+		2026-10-17	Input and output go to in-process
+				peripherals too (see agc_host.c).
+		2026-10-17	With SharedMemory, peripherals on the same
+				computer can connect through shared memory
+				(see agc_shm.c) rather than a socket.
+		2026-10-17	A u-bit packet for a counter asks for a run
+				of increments (see BulkIncrement).
+		2026-10-17	Count each client's packets and bytes, and
+				the ones dropped or malformed, for
+				agc_stats.c.
+		2026-10-17	The channel values and the --debug-deda
+				state are now in agc_t.  Added ChannelClose
+				and ChannelCloseGeneric.
+		2026-10-17	ReadClients uses poll() (WSAPoll on Win32)
+				rather than select(), which can't handle
+				descriptors past FD_SETSIZE.  ChannelRoutine
+				drains the clients too, whatever the
+				SocketInterlace.
+		2026-10-17	The check for missing clients goes through
+				the output buffer and RemoveClient too.
+		2026-10-17	ChannelRoutineGeneric's timeout count is no
+				longer hidden in the function, but kept with
+				the global Clients[] it belongs to.
+		2026-10-17	The --debug-deda packets go through the
+				output buffers, like everything else, and
+				only to connected clients.
+		2026-10-17	ChannelInput sets InputInterlaced.
 */
 
 #include <errno.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #ifdef WIN32
 typedef unsigned short uint16_t;
+#else
+#include <sys/time.h>
+#include <poll.h>
 #endif
 #include "yaAGC.h"
 #define SOCKET_API_C
 #include "agc_engine.h"
+#include "agc_host.h"
+#include "agc_shm.h"
+
+//-----------------------------------------------------------------------------
+// Output to the clients isn't sent immediately, but is collected in each
+// client's output buffer, which is sent with a single send() every 
+// SocketInterlaceReload machine cycles (see ChannelInput) or when it fills.
+// If a client isn't keeping up, so that its buffer stays full, further output
+// to it is discarded.  A client connected through shared memory (SHM_SOCKET)
+// is treated just the same, except that ShmSend and ShmRecv take the place
+// of send and recv.
+
+static void
+RemoveClient (Client_t *Client)
+{
+  extern int DebugMode;
+  if (Client->Socket == SHM_SOCKET)
+    {
+      if (!DebugMode)
+	printf ("Removing shared memory on port %d\n", Client->Shm->Port);
+      ShmRelease (Client->Shm);
+    }
+  else
+    {
+      if (!DebugMode)
+	printf ("Removing socket %d\n", Client->Socket);
+#ifdef unix
+      close (Client->Socket);
+#else
+      closesocket (Client->Socket);
+#endif
+    }
+  Client->Socket = -1;
+  Client->OutputSize = 0;
+}
+
+static void
+FlushClient (Client_t *Client)
+{
+  int j;
+  if (Client->OutputSize == 0)
+    return;
+  if (Client->Socket == SHM_SOCKET)
+    {
+      j = ShmSend (Client->Shm, Client->Output, Client->OutputSize);
+      if (j < 0)
+	{
+	  RemoveClient (Client);
+	  return;
+	}
+    }
+  else
+    {
+      j = send (Client->Socket, (const char *) Client->Output,
+		Client->OutputSize, MSG_NOSIGNAL);
+      if (j == SOCKET_ERROR)
+	{
+	  if (SOCKET_BROKEN)
+	    RemoveClient (Client);
+	  return;
+	}
+    }
+  Client->BytesOut += j;
+  if (j < Client->OutputSize)
+    memmove (Client->Output, &Client->Output[j], Client->OutputSize - j);
+  Client->OutputSize -= j;
+}
+
+static void
+FlushClients (agc_t *State)
+{
+  int i;
+  Client_t *Client;
+  for (i = 0, Client = State->Clients; i < State->NumClients; i++, Client++)
+    if (Client->Socket != -1)
+      FlushClient (Client);
+}
+
+static void
+QueuePacket (Client_t *Client, const unsigned char *Packet)
+{
+  if (Client->OutputSize + 4 > CLIENT_OUTPUT_SIZE)
+    FlushClient (Client);
+  if (Client->Socket != -1 && Client->OutputSize + 4 <= CLIENT_OUTPUT_SIZE)
+    {
+      memcpy (&Client->Output[Client->OutputSize], Packet, 4);
+      Client->OutputSize += 4;
+      Client->PacketsOut++;
+    }
+  else if (Client->Socket != -1)
+    Client->DroppedPackets++;
+}
+
+// Queues the current value of an output channel, if it isn't the default.
+static void
+QueueChannel (agc_t *State, Client_t *Client, int Channel)
+{
+  int i;
+  unsigned char Packet[4];
+  if (Channel == 010)
+    {
+      for (i = 0; i < 16; i++)
+	if (State->OutputChannel10[i] != 0)
+	  {
+	    FormIoPacket (010, State->OutputChannel10[i], Packet);
+	    QueuePacket (Client, Packet);
+	  }
+    }
+  else if (Channel >= 011 && Channel < 0200 && State->InputChannel[Channel] != 0)
+    {
+      FormIoPacket (Channel, State->InputChannel[Channel], Packet);
+      QueuePacket (Client, Packet);
+    }
+}
+
+// A client can ask to be sent only the output channels it's interested in, 
+// by sending u-bit packets for SUBSCRIBE_CHANNEL.  The value is an output
+// channel number, plus 0400 to subscribe to it (0 to unsubscribe), or else
+// 01000 to go back to receiving all channels.  The client's first 
+// subscription unsubscribes it from everything else.  The current value of
+// a newly-subscribed channel is sent right away.
+
+static void
+Subscribe (agc_t *State, Client_t *Client, int Value)
+{
+  int Channel = (Value & 0377);
+  if (Value & 01000)
+    {
+      memset (Client->Subscribed, 0xFF, sizeof (Client->Subscribed));
+      Client->Subscribing = 0;
+      return;
+    }
+  if (!Client->Subscribing)
+    {
+      memset (Client->Subscribed, 0, sizeof (Client->Subscribed));
+      Client->Subscribing = 1;
+    }
+  if (Value & 0400)
+    {
+      Client->Subscribed[Channel >> 3] |= (1 << (Channel & 7));
+      QueueChannel (State, Client, Channel);
+    }
+  else
+    Client->Subscribed[Channel >> 3] &= ~(1 << (Channel & 7));
+}
 
 //-----------------------------------------------------------------------------
 // Function for broadcasting "output channel" data to all connected clients of
@@ -84,11 +276,9 @@ typedef unsigned short uint16_t;
 void
 ChannelOutput (agc_t * State, int Channel, int Value)
 {
-  int i, j;
-  //int n;
+  int i;
   Client_t *Client;
   unsigned char Packet[4];
-  extern int DebugMode;
   // Some output channels have purposes within the CPU, so we have to
   // account for those separately.
   if (Channel == 7)
@@ -99,306 +289,465 @@ ChannelOutput (agc_t * State, int Channel, int Value)
   // Stick data into the RHCCTR registers, if bits 8,9 of channel 013 are set.
   if (Channel == 013 && 0600 == (0600 & Value) && !CmOrLm)
     {
-      State->Erasable[0][042] = LastRhcPitch;
-      State->Erasable[0][043] = LastRhcYaw;
-      State->Erasable[0][044] = LastRhcRoll;
+      State->Erasable[0][042] = State->LastRhcPitch;
+      State->Erasable[0][043] = State->LastRhcYaw;
+      State->Erasable[0][044] = State->LastRhcRoll;
     }
   // Most output channels are simply transmitted to clients representing
-  // hardware simulations.
+  // hardware simulations, or at least the ones subscribed to them, and to
+  // any peripherals within the program.
+  if (State->Host != NULL)
+    HostOutput (State, Channel, Value);
   if (FormIoPacket (Channel, Value, Packet))
     return;
-  for (i = 0, Client = Clients; i < MAX_CLIENTS; i++, Client++)
-    if (Clients[i].Socket != -1)
-      {
-	j = send (Client->Socket, (const char *) Packet, 4, MSG_NOSIGNAL);
-	if (j == SOCKET_ERROR && SOCKET_BROKEN)
-	  {
-	    if (!DebugMode)
-	      printf ("Removing socket %d\n", Clients[i].Socket);
-#ifdef unix
-	    close (Clients[i].Socket);
-#else
-	    closesocket (Clients[i].Socket);
-#endif
-	    Clients[i].Socket = -1;
-	  }
-      }
+  if (State->Clients == NULL)
+    return;
+  for (i = 0, Client = State->Clients; i < State->NumClients; i++, Client++)
+    if (Client->Socket != -1 
+        && 0 != (Client->Subscribed[Channel >> 3] & (1 << (Channel & 7))))
+      QueuePacket (Client, Packet);
 }
 
 //----------------------------------------------------------------------
 // A function for handling reception of "input channel" data from
-// any connected client.  At most one channel of input is handled per
-// call.  The function returns 0 if there is no input, or non-zero if
-// there is input.  If the input causes an interrupt (as, for example,
-// a keystroke from the DSKY), then the function should set the
-// appropriate request in State->InterruptRequests[].
+// any connected client.  The function returns 0 if there is no input, 
+// or non-zero if there is input.  If the input causes an interrupt (as,
+// for example, a keystroke from the DSKY), then the function should set
+// the appropriate request in State->InterruptRequests[].
 //
 // The function also handles unprogrammed counter increments caused
 // by inputs to the CPU.  The function returns 1 if a counter-increment
 // was performed, and returns zero otherwise.
+//
+// Every SocketInterlaceReload calls, a single poll() finds which clients
+// have sent anything, and whatever they've sent is read in bulk into their
+// input buffers.  All of the complete packets buffered are then processed
+// at once, except that a counter increment uses up the machine cycle, so
+// that the remaining packets are processed on the following calls.
 
-static int CurrentChannelValues[256] = { 0 };
 static const unsigned char Signatures[4] = { 0x00, 0x40, 0x80, 0xC0 };
 static const unsigned char SignaturesAgs[4] = { 0x00, 0xC0, 0x80, 0x40 };
 
-int
-ChannelInput (agc_t *State)
+// Reads whatever is waiting on the socket into the client's input buffer.
+static void
+ReadClient (Client_t *Client)
+{
+  unsigned Free, Offset;
+  int n;
+  while (0 != (Free = CLIENT_INPUT_SIZE - (Client->InputTail - Client->InputHead)))
+    {
+      Offset = Client->InputTail & (CLIENT_INPUT_SIZE - 1);
+      if (Free > CLIENT_INPUT_SIZE - Offset)
+        Free = CLIENT_INPUT_SIZE - Offset;
+      if (Client->Socket == SHM_SOCKET)
+	n = ShmRecv (Client->Shm, &Client->Input[Offset], Free);
+      else
+	n = recv (Client->Socket, (char *) &Client->Input[Offset], Free, 0);
+      if (n <= 0)
+        break;
+      Client->InputTail += n;
+      Client->BytesIn += n;
+      if (n < Free)
+        break;
+    }
+}
+
+// Reads from all of the clients that have sent anything.  The sockets are
+// checked with poll(), POLL_CHUNK of them at a time, rather than with 
+// select(), whose fd_set can't hold a descriptor past FD_SETSIZE (which
+// a process with many CPUs, or many files open, can easily reach).  Clients
+// connected through shared memory are simply read.  Returns non-zero if 
+// anything is waiting in the input buffers.
+#ifdef WIN32
+#define poll WSAPoll
+#endif
+#define POLL_CHUNK 16
+
+static int
+ReadClients (agc_t *State)
+{
+  struct pollfd Fds[POLL_CHUNK];
+  Client_t *Polled[POLL_CHUNK], *Client;
+  int i, j, n = 0, Received = 0;
+
+  for (i = 0, Client = State->Clients; i < State->NumClients; i++, Client++)
+    {
+      if (Client->Socket == SHM_SOCKET)
+        ReadClient (Client);
+      else if (Client->Socket >= 0)
+        {
+	  Fds[n].fd = Client->Socket;
+	  Fds[n].events = POLLIN;
+	  Fds[n].revents = 0;
+	  Polled[n++] = Client;
+	}
+      if (n == POLL_CHUNK || (n > 0 && i == State->NumClients - 1))
+        {
+	  if (0 < poll (Fds, n, 0))
+	    for (j = 0; j < n; j++)
+	      if (Fds[j].revents & (POLLIN | POLLHUP | POLLERR))
+	        ReadClient (Polled[j]);
+	  n = 0;
+	}
+    }
+  for (i = 0, Client = State->Clients; i < State->NumClients; i++, Client++)
+    if (Client->InputTail != Client->InputHead)
+      Received = 1;
+  return (Received);
+}
+
+// Moves bytes from the client's input buffer into Client->Packet, until 
+// it holds a complete packet.  Returns non-zero if it does.
+static int
+NextPacket (Client_t *Client)
 {
-  static int SocketInterlace = 0;
-  int i, j, k;
   unsigned char c;
-  Client_t *Client;
-  int Channel, Value;
+  while (Client->Size < 4 && Client->InputHead != Client->InputTail)
+    {
+      c = Client->Input[Client->InputHead++ & (CLIENT_INPUT_SIZE - 1)];
+      // 20090318 RSB.  Added this filter for a little robustness,
+      // but it shouldn't be needed.
+      if (!(
+	    (Signatures[Client->Size] == (c & 0xC0)) ||
+	    (DebugDeda && (SignaturesAgs[Client->Size] == (c & 0xC0)))
+	  )
+	 )
+	{
+	  if (Client->Size != 0 || 0 != (c & 0xC0))
+	    Client->BadPackets++;
+	  Client->Size = 0;
+	  if (0 != (c & 0xC0))
+	    continue;
+	}
+      Client->Packet[Client->Size++] = c;
+    }
+  return (Client->Size >= 4);
+}
 
-  //We use SocketInterlace to slow down the number
-  // of polls of the sockets.
-  if (SocketInterlace > 0)
-    SocketInterlace--;
-  else
+// Acts on the packet in Client->Packet.  Returns 1 if it was a counter
+// increment.
+static int
+ProcessPacket (agc_t *State, Client_t *Client)
+{
+  int Channel, Value, uBit, Type, Data;
+  //printf ("Received from %d: %02X %02X %02X %02X\n",
+  //	i, Client->Packet[0], Client->Packet[1],
+  //      Client->Packet[2], Client->Packet[3]);
+  if (!ParseIoPacket (Client->Packet, &Channel, &Value, &uBit))
     {
-      SocketInterlace = SocketInterlaceReload;
-      for (i = 0, Client = Clients; i < MAX_CLIENTS; i++, Client++)
-	if (Client->Socket != -1)
-	  {
-	    // We arbitrarily adopt the rule that we'll process at most one
-	    // packet per client per instruction cycle.
-	    for (j = Client->Size; j < 4; j++)
-	      {
-		k = recv (Client->Socket, (char *) &c, 1, 0);
-		if (k == 0 || k == -1)
-		  break;
-		// 20090318 RSB.  Added this filter for a little robustness,
-		// but it shouldn't be needed.
-		if (!(
-		      (Signatures[j] == (c & 0xC0)) ||
-		      (DebugDeda && (SignaturesAgs[j] == (c & 0xC0)))
-		    )
-		   )
-		  {
-		    Client->Size = 0;
-		    if (0 != (c & 0xC0))
-		      {
-		        j = -1;
-	                continue;
-		      }
-		    j = 0;
-		  }
-		Client->Packet[Client->Size++] = c;
-	      }
-	    // Process a received packet.
-	    if (Client->Size >= 4)
-	      {
-		int uBit, Type, Data;
-		//printf ("Received from %d: %02X %02X %02X %02X\n",
-		//	i, Client->Packet[0], Client->Packet[1],
-		//	Client->Packet[2], Client->Packet[3]);
-		if (!ParseIoPacket (Client->Packet, &Channel, &Value, &uBit))
-		  {
-		    // Convert to AGC format (upper 15 bits).
-		    Value &= 077777;
-		    if (uBit)
-		      {
-			Client->ChannelMasks[Channel] = Value;
-		      }
-		    else if (Channel & 0x80)
-		      {
-		        // In this case we're dealing with a counter increment.
-			// So increment the counter.
-			//printf ("Channel=%02o Int=%o\n", Channel, Value);
-			UnprogrammedIncrement (State, Channel, Value);
-			Client->Size = 0;
-			return (1);
-		      }
-		    else
-		      {
-			Value &= Client->ChannelMasks[Channel];
-			Value |=
-			  ReadIO (State,
-				  Channel) & ~Client->ChannelMasks[Channel];
-			WriteIO (State, Channel, Value);
-			// If this is a keystroke from the DSKY, generate an interrupt req.
-			if (Channel == 015)
-			  State->InterruptRequests[5] = 1;
-			// If this is on fictitious input channel 0173, then the data
-			// should be placed in the INLINK counter register, and an
-			// UPRUPT interrupt request should be set.
-			else if (Channel == 0173)
-			  {
-			    State->Erasable[0][RegINLINK] = (Value & 077777);
-			    State->InterruptRequests[7] = 1;
-			  }
-			// Fictitious registers for rotational hand controller (RHC).
-			// Note that the RHC angles are not immediately used, but
-			// merely squirreled away for later.  They won't actually
-			// go into the counter registers until the RHC counters are
-			// enabled and the data requested (bits 8,9 of channel 13).
-			else if (Channel == 0166)
-			  {
-			    LastRhcPitch = Value;
-			    ChannelOutput (State, Channel, Value);	// echo
-			  }
-			else if (Channel == 0167)
-			  {
-			    LastRhcYaw = Value;
-			    ChannelOutput (State, Channel, Value);	// echo
-			  }
-			else if (Channel == 0170)
-			  {
-			    LastRhcRoll = Value;
-			    ChannelOutput (State, Channel, Value);	// echo
-			  }
-			else if (Channel == 031)
-			  {
-			    static int LastInDetent = 040000;
-			    int InDetent;
-			    ChannelOutput (State, Channel, Value);
-			    // If the RHC stick has moved out of detent,
-			    // generate a RUPT10 interrupt.
-			    InDetent = (040000 & Value);
-			    if (LastInDetent && !InDetent)
-			      State->InterruptRequests[10] = 1;
-			    LastInDetent = InDetent;
-			  }
-			//---------------------------------------------------------------
-			// For --debug-dsky mode.
-			if (DebugDsky)
-			  {
-			    if (Channel == 032)
-			      {
-				// For DebugDsky purposes only, the PRO key is translated
-				// to appear as the otherwise-fictitious KeyCode 0.
-				if (0 != (Value & 020000))
-				  {
-				    Channel = 015;
-				    Value = 0;
-				  }
-			      }
-			    if (Channel == 015)
-			      {
-				int i, CurrentValue;
-				Value &= 077777;
-				for (i = 0; i < NumDebugRules; i++)
-				  if (Value == DebugRules[i].KeyCode)
-				    {
-				      CurrentValue =
-					CurrentChannelValues[DebugRules[i].
-							     Channel];
-				      switch (DebugRules[i].Logic)
-					{
-					case '=':
-					  CurrentValue = DebugRules[i].Value;
-					  break;
-					case '|':
-					  CurrentValue |= DebugRules[i].Value;
-					  break;
-					case '&':
-					  CurrentValue &= DebugRules[i].Value;
-					  break;
-					case '^':
-					  CurrentValue ^= DebugRules[i].Value;
-					  break;
-					default:
-					  break;
-					}
-				      CurrentChannelValues[DebugRules[i].
-							   Channel] =
-					CurrentValue;
-				      ChannelOutput (State,
-						     DebugRules[i].Channel,
-						     CurrentValue);
-				    }
-			      }
-			    //if (Channel != 032 && Channel != 015)
-			    //  WriteIO (State, Channel, Value);
-			  }
-			//---------------------------------------------------------------
-		      }
-		  }
-		else if (DebugDeda && !ParseIoPacketAGS (Client->Packet, &Type, &Data))
-		  {
-		    // The following code is present only for debugging yaDEDA
-		    // communications, and has no interesting purpose yaAGC-wise.
-		    static unsigned char Buffer[9];
-		    static int NumInBuffer = 0, NumWanted = 0, Collecting = 0;
-		    static unsigned char Packet[4];
-		    if (Type == 05 && (Data == 0777002 || Data == 0777004 ||
-		        Data == 0777010 || Data == 0777020))
-		      printf ("DEDA key release.\n");
-		    else if (Collecting && Type == 07)
-		      {
-		        Buffer[NumInBuffer++] = Data >> 13;
-			if (NumInBuffer < NumWanted)
-			  send (Client->Socket, (const char *) Packet, 4, 0);
-			else
-			  {
-			    int i;
-			    Collecting = 0;
-			    printf ("Received %d DEDA nibbles:", NumWanted);
-			    for (i = 0; i < NumWanted; i++)
-			      printf (" %1X", Buffer[i]);
-			    printf ("\n");
-			    if (NumWanted == 3)
-			      {
-			        if (!DedaQuiet)
-			          DedaMonitor = 1;
-				DedaAddress = Buffer[0] * 0100 + Buffer[1] * 010 + Buffer[2];
-				DedaWhen = State->CycleCounter;
-			      }
-			  }
-		      }
-		    else if (Type == 05 && (Data == 0775002 || Data == 0773004))
+      // Convert to AGC format (upper 15 bits).
+      Value &= 077777;
+      if (uBit)
+	{
+	  if (Channel == SUBSCRIBE_CHANNEL)
+	    Subscribe (State, Client, Value);
+	  else if (Channel & 0x80)
+	    return (AcceptInput (State, Channel, BULK_INCREMENT | Value));
+	  else
+	    Client->ChannelMasks[Channel] = Value;
+	}
+      else if (Channel & 0x80)
+	{
+	  // In this case we're dealing with a counter increment.
+	  // So increment the counter.
+	  //printf ("Channel=%02o Int=%o\n", Channel, Value);
+	  return (AcceptInput (State, Channel, Value));
+	}
+      else
+	{
+	  Value &= Client->ChannelMasks[Channel];
+	  Value |=
+	    ReadIO (State,
+		    Channel) & ~Client->ChannelMasks[Channel];
+	  AcceptInput (State, Channel, Value);
+	  //---------------------------------------------------------------
+	  // For --debug-dsky mode.
+	  if (DebugDsky)
+	    {
+	      if (Channel == 032)
+		{
+		  // For DebugDsky purposes only, the PRO key is translated
+		  // to appear as the otherwise-fictitious KeyCode 0.
+		  if (0 != (Value & 020000))
+		    {
+		      Channel = 015;
+		      Value = 0;
+		    }
+		}
+	      if (Channel == 015)
+		{
+		  int i, CurrentValue;
+		  Value &= 077777;
+		  for (i = 0; i < NumDebugRules; i++)
+		    if (Value == DebugRules[i].KeyCode)
 		      {
-		        NumInBuffer = 0;
-			Collecting = 1;
-			if (Data == 0775002)
-			  {
-		            printf ("Received DEDA READOUT.\n");
-			    NumWanted = 3;
-			  }
-			else
+			CurrentValue =
+			  State->CurrentChannelValues[DebugRules[i].
+						      Channel];
+			switch (DebugRules[i].Logic)
 			  {
-		            printf ("Received DEDA ENTR.\n");
-			    NumWanted = 9;
+			  case '=':
+			    CurrentValue = DebugRules[i].Value;
+			    break;
+			  case '|':
+			    CurrentValue |= DebugRules[i].Value;
+			    break;
+			  case '&':
+			    CurrentValue &= DebugRules[i].Value;
+			    break;
+			  case '^':
+			    CurrentValue ^= DebugRules[i].Value;
+			    break;
+			  default:
+			    break;
 			  }
-			FormIoPacketAGS (040, ~010, Packet);
-			send (Client->Socket, (const char *) Packet, 4, 0);
-		      }
-		    else if (Type == 05 && Data == 0767010)
-		      {
-		        printf ("Received DEDA HOLD.\n");
-			DedaMonitor = 0;
-		      }
-		    else if (Type == 05 && Data == 0757020)
-		      {
-		        printf ("Received DEDA CLR.\n");
-			DedaMonitor = 0;
+			State->CurrentChannelValues[DebugRules[i].
+						    Channel] =
+			  CurrentValue;
+			ChannelOutput (State,
+				       DebugRules[i].Channel,
+				       CurrentValue);
 		      }
-		    else
-		      printf ("Unknown AGS packet %02X %02X %02X %02X\n",
-		              Client->Packet[0], Client->Packet[1],
-			      Client->Packet[2], Client->Packet[3]);
-		  }
-		Client->Size = 0;
-	      }
-	  }
+		}
+	      //if (Channel != 032 && Channel != 015)
+	      //  WriteIO (State, Channel, Value);
+	    }
+	  //---------------------------------------------------------------
+	}
+    }
+  else if (DebugDeda && !ParseIoPacketAGS (Client->Packet, &Type, &Data))
+    {
+      // The following code is present only for debugging yaDEDA
+      // communications, and has no interesting purpose yaAGC-wise.
+      unsigned char *Buffer = State->DedaBuffer, *Packet = State->DedaPacket;
+      if (Type == 05 && (Data == 0777002 || Data == 0777004 ||
+	  Data == 0777010 || Data == 0777020))
+	printf ("DEDA key release.\n");
+      else if (State->DedaCollecting && Type == 07)
+	{
+	  Buffer[State->DedaInBuffer++] = Data >> 13;
+	  if (State->DedaInBuffer < State->DedaWanted)
+	    QueuePacket (Client, Packet);
+	  else
+	    {
+	      int i;
+	      State->DedaCollecting = 0;
+	      printf ("Received %d DEDA nibbles:", State->DedaWanted);
+	      for (i = 0; i < State->DedaWanted; i++)
+		printf (" %1X", Buffer[i]);
+	      printf ("\n");
+	      if (State->DedaWanted == 3)
+		{
+		  if (!DedaQuiet)
+		    State->DedaMonitor = 1;
+		  State->DedaAddress =
+		    Buffer[0] * 0100 + Buffer[1] * 010 + Buffer[2];
+		  State->DedaWhen = State->CycleCounter;
+		}
+	    }
+	}
+      else if (Type == 05 && (Data == 0775002 || Data == 0773004))
+	{
+	  State->DedaInBuffer = 0;
+	  State->DedaCollecting = 1;
+	  if (Data == 0775002)
+	    {
+	      printf ("Received DEDA READOUT.\n");
+	      State->DedaWanted = 3;
+	    }
+	  else
+	    {
+	      printf ("Received DEDA ENTR.\n");
+	      State->DedaWanted = 9;
+	    }
+	  FormIoPacketAGS (040, ~010, Packet);
+	  QueuePacket (Client, Packet);
+	}
+      else if (Type == 05 && Data == 0767010)
+	{
+	  printf ("Received DEDA HOLD.\n");
+	  State->DedaMonitor = 0;
+	}
+      else if (Type == 05 && Data == 0757020)
+	{
+	  printf ("Received DEDA CLR.\n");
+	  State->DedaMonitor = 0;
+	}
+      else
+	printf ("Unknown AGS packet %02X %02X %02X %02X\n",
+		Client->Packet[0], Client->Packet[1],
+		Client->Packet[2], Client->Packet[3]);
+    }
+  else
+    Client->BadPackets++;
+  return (0);
+}
+
+int
+ChannelInput (agc_t *State)
+{
+  int i;
+  Client_t *Client;
+
+  // Tells agc_engine_run that between polls (or replayed inputs) there's
+  // no need to call this.
+  State->InputInterlaced = 1;
+  // A recording being replayed takes the place of the sockets.
+  if (State->InputLog.Replay != NULL)
+    return (ReplayInput (State));
+  if (State->Host != NULL && HostInput (State))
+    return (1);
+  if (State->Headless)
+    return (0);
+
+  //We use SocketInterlace to slow down the number
+  // of polls of the sockets, since a poll() every machine cycle
+  // would cost far more than the cycle itself.  Input that's already
+  // been received isn't held up by it, though, and ChannelRoutine
+  // drains the sockets as well, however long the interlace.  When 
+  // single-stepping in the debugger, output is sent right away.
+  if (DebugMode && State->Clients != NULL)
+    FlushClients (State);
+  if (!State->SocketInputPending)
+    {
+      if (State->SocketInterlace > 0)
+	{
+	  State->SocketInterlace--;
+	  return (0);
+	}
+      if (State->Clients == NULL)
+	return (0);
+      State->SocketInterlace = SocketInterlaceReload;
+      FlushClients (State);
+      if (!ReadClients (State))
+	return (0);
     }
+  State->SocketInputPending = 0;
+  for (i = 0, Client = State->Clients; i < State->NumClients; i++, Client++)
+    while (NextPacket (Client))
+      {
+	Client->Size = 0;
+	Client->PacketsIn++;
+	if (ProcessPacket (State, Client))
+	  {
+	    State->SocketInputPending = 1;
+	    return (1);
+	  }
+      }
   return (0);
 }
 
 //----------------------------------------------------------------------
 // A generic function for handling client connects/disconnects.
 // The input parameters are the CPU-dependent state (may be an agc_t
-// or an aea_t, for example) and a function which will update a
-// newly-connected peripheral with up-to-date CPU output signals.
+// or an aea_t, for example), the set of clients and server sockets,
+// and a function which will update a newly-connected peripheral with 
+// up-to-date CPU output signals.
 
-void
-ChannelRoutineGeneric (void *State, void (*UpdatePeripherals) (void *, Client_t *))
+static void
+AddClient (void *State, Client_t *Client,
+	   void (*UpdatePeripherals) (void *, Client_t *))
+{
+  int ii;
+  Client->Size = 0;
+  Client->InputHead = Client->InputTail = 0;
+  Client->OutputSize = 0;
+  Client->PacketsIn = Client->BytesIn = 0;
+  Client->PacketsOut = Client->BytesOut = 0;
+  Client->BadPackets = Client->DroppedPackets = 0;
+  Client->Subscribing = 0;
+  memset (Client->Subscribed, 0xFF, sizeof (Client->Subscribed));
+  for (ii = 0; ii < 256; ii++)
+    Client->ChannelMasks[ii] = 077777;
+  // Now that a new connection has been made, update the
+  // client with all current output-port values.  Values of
+  // zero are treated as the default, and are not transmitted.
+  (*UpdatePeripherals) (State, Client);
+}
+
+static void
+ServiceClients (void *State, int NumClients, Client_t *Clients,
+		int *ServerSockets, int Port, int *TimeoutCount,
+		void (*UpdatePeripherals) (void *, Client_t *))
 {
-  static int TimeoutCount = 0;
-  int i, j;
+  int i;
   Client_t *Client;
   extern int DebugMode;
 
+  for (i = 0, Client = Clients; i < NumClients; i++, Client++)
+    {
+      if (ServerSockets[i] != -1 && Client->Socket == -1)
+	{
+	  // Get new clients.
+	  Client->Socket = accept (ServerSockets[i], NULL, NULL);
+	  if (Client->Socket != -1)
+	    {
+	      UnblockSocket (Client->Socket);
+	      if (!DebugMode)
+		printf ("Adding socket %d on port %d\n", Client->Socket,
+			Port + i);
+	      AddClient (State, Client, UpdatePeripherals);
+	    }
+	  else if (errno == EMFILE)
+	    printf ("File-descriptor limit reached.\n");
+	}
+      // Or through shared memory.
+      if (Client->Socket == -1 && Client->Shm != NULL
+	  && ShmAccept (Client->Shm))
+	{
+	  Client->Socket = SHM_SOCKET;
+	  if (!DebugMode)
+	    printf ("Adding shared memory on port %d\n", Port + i);
+	  AddClient (State, Client, UpdatePeripherals);
+	}
+    }
+  // Do a sort of timeout check for missing clients.  Sending whatever
+  // output is waiting is check enough, but if there's none, a byte that
+  // the peripheral discards is sent instead.  Either way, it's FlushClient
+  // that finds a broken socket and removes the client.
+  (*TimeoutCount)++;
+  if (0 == (017 & *TimeoutCount))
+    {
+      for (i = 0, Client = Clients; i < NumClients; i++, Client++)
+	if (Client->Socket == SHM_SOCKET)
+	  {
+	    if (!ShmConnected (Client->Shm))
+	      RemoveClient (Client);
+	  }
+	else if (Client->Socket != -1)
+	  {
+	    if (Client->OutputSize == 0)
+	      Client->Output[Client->OutputSize++] = 0377;
+	    FlushClient (Client);
+	  }
+    }
+}
+
+// With --shm, peripherals can connect to each port through shared memory
+// as well as through the socket.
+
+static ShmLink_t *
+OfferSharedMemory (int Port)
+{
+  ShmLink_t *Link;
+  if (!SharedMemory)
+    return (NULL);
+  Link = ShmCreate (Port);
+  if (Link == NULL)
+    printf ("Could not create shared memory for port %d.\n", Port);
+  return (Link);
+}
+
+// This version uses the global Clients[] and ServerSockets[], and so is for
+// programs simulating just one CPU (yaAGS).  GenericTimeoutCount goes with
+// those globals; CPUs in agc_t use ChannelRoutine, which keeps the count in
+// agc_t instead.
+
+static int GenericTimeoutCount = 0;
+
+void
+ChannelRoutineGeneric (void *State, void (*UpdatePeripherals) (void *, Client_t *))
+{
   // Initialize the server sockets, if needed.
   if (NumServers == 0)
     {
@@ -407,84 +756,119 @@ ChannelRoutineGeneric (void *State, void (*UpdatePeripherals) (void *, Client_t
 	  Clients[NumServers].Socket = -1;
 	  ServerSockets[NumServers] =
 	    EstablishSocket (Portnum + NumServers, 3);
+	  Clients[NumServers].Shm = OfferSharedMemory (Portnum + NumServers);
 	}
     }
-  for (i = 0, Client = Clients; i < MAX_CLIENTS; i++, Client++)
-    if (ServerSockets[i] != -1 && Client->Socket == -1)
-      {
-	// Get new clients.
-	Client->Socket = accept (ServerSockets[i], NULL, NULL);
-	if (Client->Socket != -1)
-	  {
-	    int ii;
-	    extern int DebugMode;
-	    UnblockSocket (Client->Socket);
-	    if (!DebugMode)
-	      printf ("Adding socket %d on port %d\n", Client->Socket,
-		      Portnum + i);
-	    Client->Size = 0;
-	    for (ii = 0; ii < 256; ii++)
-	      Client->ChannelMasks[ii] = 077777;
-	    // Now that a new connection has been made, update the
-	    // client with all current output-port values.  Values of
-	    // zero are treated as the default, and are not transmitted.
-	    (*UpdatePeripherals) (State, Client);
-	  }
-	else if (errno == EMFILE)
-	  printf ("File-descriptor limit reached.\n");
-      }
-  // Do a sort of timeout check for missing clients.
-  TimeoutCount++;
-  if (0 == (017 & TimeoutCount))
-    {
-      unsigned char c = 0377;
-      for (i = 0, Client = Clients; i < MAX_CLIENTS; i++, Client++)
-	if (Clients[i].Socket != -1)
-	  {
-	    j = send (Client->Socket, (const char *) &c, 1, MSG_NOSIGNAL);
-	    if (j == SOCKET_ERROR && SOCKET_BROKEN)
-	      {
-	        if (!DebugMode)
-		  printf ("Removing socket %d\n", Clients[i].Socket);
-#ifdef unix
-		close (Clients[i].Socket);
-#else
-		closesocket (Clients[i].Socket);
-#endif
-		Client->Socket = -1;
-	      }
-	  }
-    }
+  ServiceClients (State, MAX_CLIENTS, Clients, ServerSockets, Portnum,
+		  &GenericTimeoutCount, UpdatePeripherals);
 }
 
 static void
 UpdateAgcPeripheralConnect (void *AgcState, Client_t *Client)
 {
-#define State ((agc_t *) AgcState)
   int i;
-  unsigned char Packet[4];
-  for (i = 0; i < 16; i++)
-    if (State->OutputChannel10[i] != 0) {
-      FormIoPacket (010, State->OutputChannel10[i], Packet);
-      send (Client->Socket, (const char *) Packet, 4, MSG_NOSIGNAL);
+  for (i = 010; i < 0200; i++)
+    QueueChannel ((agc_t *) AgcState, Client, i);
+}
+
+void
+ChannelRoutine (agc_t *State)
+{
+  int i;
+
+  // A replay has no use for the sockets, nor of course does a headless CPU.
+  if (State->InputLog.Replay != NULL || State->Headless)
+    return;
+
+  // Initialize this CPU's server sockets, if needed.
+  if (State->Clients == NULL)
+    {
+      if (State->NumClients <= 0)
+        State->NumClients = MAX_CLIENTS;
+      if (State->Portnum == 0)
+        State->Portnum = Portnum;
+      State->Clients = (Client_t *) calloc (State->NumClients,
+					    sizeof (Client_t));
+      State->ServerSockets = (int *) calloc (State->NumClients, sizeof (int));
+      if (State->Clients == NULL || State->ServerSockets == NULL)
+        {
+	  free (State->Clients);
+	  free (State->ServerSockets);
+	  State->Clients = NULL;
+	  State->ServerSockets = NULL;
+	  return;
+	}
+      for (i = 0; i < State->NumClients; i++)
+	{
+	  State->Clients[i].Socket = -1;
+	  State->ServerSockets[i] = EstablishSocket (State->Portnum + i, 3);
+	  State->Clients[i].Shm = OfferSharedMemory (State->Portnum + i);
+	}
     }
-  for (i = 011; i < 0200; i++)
-    if (State->InputChannel[i] != 0) {
-      FormIoPacket (i, State->InputChannel[i], Packet);
-      send (Client->Socket, (const char *) Packet, 4, MSG_NOSIGNAL);
+  FlushClients (State);
+  ServiceClients (State, State->NumClients, State->Clients, 
+  		  State->ServerSockets, State->Portnum, 
+		  &State->SocketTimeoutCount, UpdateAgcPeripheralConnect);
+  // Drain whatever the clients have sent, for ChannelInput to process.
+  if (ReadClients (State))
+    State->SocketInputPending = 1;
+}
+
+//----------------------------------------------------------------------
+// Closes the server sockets and the clients, and removes the shared memory,
+// when the CPU is done with its peripherals.
+
+static void
+CloseClients (int NumClients, Client_t *Clients, int *ServerSockets)
+{
+  int i;
+  Client_t *Client;
+
+  for (i = 0, Client = Clients; i < NumClients; i++, Client++)
+    {
+      if (Client->Socket != -1)
+        RemoveClient (Client);
+      ShmDestroy (Client->Shm);
+      Client->Shm = NULL;
+      if (ServerSockets[i] != -1)
+        {
+#ifdef unix
+	  close (ServerSockets[i]);
+#else
+	  closesocket (ServerSockets[i]);
+#endif
+	  ServerSockets[i] = -1;
+	}
     }
-#undef State
 }
 
 void
-ChannelRoutine (agc_t *State)
+ChannelClose (agc_t *State)
 {
-  ChannelRoutineGeneric (State, UpdateAgcPeripheralConnect);
+  if (State->Clients == NULL)
+    return;
+  CloseClients (State->NumClients, State->Clients, State->ServerSockets);
+  free (State->Clients);
+  free (State->ServerSockets);
+  State->Clients = NULL;
+  State->ServerSockets = NULL;
+}
+
+// This version uses the global Clients[] and ServerSockets[].
+
+void
+ChannelCloseGeneric (void)
+{
+  if (NumServers == 0)
+    return;
+  CloseClients (NumServers, Clients, ServerSockets);
+  NumServers = 0;
 }
 
 //----------------------------------------------------------------------
 // This function is useful for debugging the yaDEDA socket interface.  It
-// forms a packet for the DEDA shift register.
+// forms a packet for the DEDA shift register, and queues it for each 
+// connected client, like any other output.
 
 void
 ShiftToDeda (agc_t *State, int Data)
@@ -493,8 +877,11 @@ ShiftToDeda (agc_t *State, int Data)
   int i;
   Client_t *Client;
   FormIoPacketAGS (027, Data << 13, Packet);
-  for (i = 0, Client = Clients; i < MAX_CLIENTS; i++, Client++)
-    send (Client->Socket, (const char *) Packet, 4, MSG_NOSIGNAL);
+  if (State->Clients == NULL)
+    return;
+  for (i = 0, Client = State->Clients; i < State->NumClients; i++, Client++)
+    if (Client->Socket != -1)
+      QueuePacket (Client, Packet);
 }
 
 
@@ -0,0 +1,293 @@
+/*
+  Copyright 2026 Ronald S. Burkey <info@sandroid.org>
+
+  This file is part of yaAGC.
+
+  yaAGC is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  yaAGC is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with yaAGC; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+  Filename:	agc_benchmark.c
+  Purpose:	Measures how fast the engine runs real AGC software, for
+  		--benchmark.
+  Compiler:	GNU gcc.
+  Contact:	Ron Burkey <info@sandroid.org>
+  Reference:	http://www.ibiblio.org/apollo/index.html
+  Mods:		2026-10-17	Began.
+		2026-10-17	The CycleHook is now BenchmarkState's.
+		2026-10-17	The runs are made with the debugger off,
+				even without --nodebug, since otherwise
+				every TC and TCF is added to the backtraces.
+
+  Where InstructionBenchmark.c times synthetic loops of single
+  instructions, this times the rope itself.  It's run headless --- with no
+  sockets, no input, and no pacing --- for the given number of seconds of
+  AGC time, BENCHMARK_RUNS times over, and the fastest run is taken as the
+  engine's speed.  The runs are all exactly alike, so a checksum of
+  erasable memory at the end is printed too, which shows whether a change
+  meant only to speed up the engine has changed what it does.  (With
+  --idle-skip, the checksum is the same as without it.)  The debugger is
+  off during the runs (SingleStepCounter is -2), whether or not --nodebug
+  was given, since the backtraces it keeps would otherwise be part of 
+  what's timed.
+
+  The run is then made once more with CycleHook set, reading the clock at
+  every machine cycle, to see where the time goes:  to which instructions,
+  and to the CDU FIFOs, the counter-timers, and so on (the CYCLE_xxx
+  classes in agc_engine.h).  That slows the engine down considerably, so
+  the cost of reading the clock is subtracted out, and the remaining times
+  are scaled to add up to the fastest run's.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "yaAGC.h"
+#include "agc_engine.h"
+#include "agc_benchmark.h"
+
+// The number of runs without the timing of each cycle.
+#define BENCHMARK_RUNS 3
+
+typedef struct
+{
+  int First, Last;
+  const char *Name;
+} OpcodeRange_t;
+
+// The instructions, by ExtendedOpcode, as in CpuCycle's switch.
+static const OpcodeRange_t Opcodes[] = {
+  { 000, 007, "TC" }, { 010, 011, "CCS" }, { 012, 017, "TCF" },
+  { 020, 021, "DAS" }, { 022, 023, "LXCH" }, { 024, 025, "INCR" },
+  { 026, 027, "ADS" }, { 030, 037, "CA" }, { 040, 047, "CS" },
+  { 050, 051, "INDEX" }, { 052, 053, "DXCH" }, { 054, 055, "TS" },
+  { 056, 057, "XCH" }, { 060, 067, "AD" }, { 070, 077, "MASK" },
+  { 0100, 0100, "READ" }, { 0101, 0101, "WRITE" }, { 0102, 0102, "RAND" },
+  { 0103, 0103, "WAND" }, { 0104, 0104, "ROR" }, { 0105, 0105, "WOR" },
+  { 0106, 0106, "RXOR" }, { 0107, 0107, "EDRUPT" }, { 0110, 0111, "DV" },
+  { 0112, 0117, "BZF" }, { 0120, 0121, "MSU" }, { 0122, 0123, "QXCH" },
+  { 0124, 0125, "AUG" }, { 0126, 0127, "DIM" }, { 0130, 0137, "DCA" },
+  { 0140, 0147, "DCS" }, { 0150, 0157, "INDEX" }, { 0160, 0161, "SU" },
+  { 0162, 0167, "BZMF" }, { 0170, 0177, "MP" },
+  { 0, -1, NULL }
+};
+
+// The other classes, from CYCLE_DELAY on.
+static const char *ClassNames[NUM_CYCLE_CLASSES - CYCLE_DELAY] = {
+  "(multi-MCT waits)",
+  "(CDU FIFOs)",
+  "(counter-timers)",
+  "(interrupt vectoring)",
+  "(peripheral input)",
+  "(idle loops skipped)",
+  "(cycle and i/o bookkeeping)"
+};
+
+typedef struct
+{
+  const char *Name;
+  uint64_t Count;
+  double Time;
+} BenchmarkRow_t;
+
+static agc_t BenchmarkState;
+static uint64_t ClassCycles[NUM_CYCLE_CLASSES];
+static uint64_t ClassTimes[NUM_CYCLE_CLASSES];
+static uint64_t ClassCalls[NUM_CYCLE_CLASSES];
+static uint64_t LastTime;
+
+// The CycleHook.
+static void
+TimeCycles (agc_t *State, int Class, uint64_t Cycles)
+{
+  uint64_t Now = PacerNow ();
+  ClassTimes[Class] += Now - LastTime;
+  ClassCycles[Class] += Cycles;
+  ClassCalls[Class]++;
+  LastTime = Now;
+}
+
+// Returns the time taken by each reading of the clock, in ns.
+static double
+ClockCost (void)
+{
+  uint64_t Start;
+  int i;
+
+  Start = PacerNow ();
+  for (i = 0; i < 1000000; i++)
+    PacerNow ();
+  return ((PacerNow () - Start) / 1e6);
+}
+
+// Runs Cycles machine cycles from the start, with Hook (if not NULL) as the
+// CycleHook, and returns the time taken in *Time and a checksum of erasable
+// memory in *Checksum.  Returns 0 on success, or else the agc_engine_init 
+// error code.
+static int
+Run (const char *RomImage, const char *CoreDump, uint64_t Cycles,
+     void (*Hook) (agc_t *State, int Class, uint64_t Cycles),
+     uint64_t *Time, unsigned *Checksum)
+{
+  uint64_t Start;
+  int i, RetVal;
+
+  RetVal = agc_engine_init (&BenchmarkState, RomImage, CoreDump, 1);
+  if (RetVal)
+    return (RetVal);
+  BenchmarkState.Headless = 1;
+  BenchmarkState.CycleHook = Hook;
+  Start = LastTime = PacerNow ();
+  while (Cycles > 0)
+    Cycles -= agc_engine_run (&BenchmarkState, Cycles);
+  *Time = PacerNow () - Start;
+
+  // FNV-1a.
+  *Checksum = 2166136261u;
+  for (i = 0; i < 8 * 0400; i++)
+    {
+      *Checksum ^= BenchmarkState.Erasable[i / 0400][i % 0400] & 0177777;
+      *Checksum *= 16777619u;
+    }
+  agc_release_fixed (&BenchmarkState);
+  return (0);
+}
+
+static int
+CompareRows (const void *Raw1, const void *Raw2)
+{
+  const BenchmarkRow_t *Row1 = Raw1, *Row2 = Raw2;
+  if (Row1->Time > Row2->Time)
+    return (-1);
+  if (Row1->Time < Row2->Time)
+    return (1);
+  return (0);
+}
+
+// Runs the benchmark for Seconds of AGC time and prints the results.  If
+// Limit isn't 0, it's the most time per machine cycle (in ns) that's
+// acceptable.  Returns 0 on success, or 1 if the rope can't be run or the
+// limit is exceeded.
+
+int
+Benchmark (const char *RomImage, const char *CoreDump, double Seconds,
+	   double Limit)
+{
+  BenchmarkRow_t Rows[NUM_CYCLE_CLASSES];
+  uint64_t Cycles, Time, Best = 0, Instructions = 0;
+  unsigned Checksum;
+  double Cost, Net, Scale, NsPerCycle;
+  int i, j, NumRows = 0;
+  const OpcodeRange_t *Range;
+  int SavedSingleStepCounter = SingleStepCounter;
+
+  // The debugger has already been set up, unless --nodebug was used, and
+  // it would keep backtraces (see BacktraceAdd) throughout.
+  SingleStepCounter = -2;
+  Cycles = (uint64_t) (Seconds * AGC_PER_SECOND);
+  if (Cycles == 0)
+    Cycles = 1;
+  for (i = 0; i < BENCHMARK_RUNS; i++)
+    {
+      if (Run (RomImage, CoreDump, Cycles, NULL, &Time, &Checksum))
+	{
+	  printf ("Could not load \"%s\" for the benchmark.\n", RomImage);
+	  SingleStepCounter = SavedSingleStepCounter;
+	  return (1);
+	}
+      if (i == 0 || Time < Best)
+	Best = Time;
+    }
+  if (Best == 0)
+    Best = 1;
+
+  // Now once more, timing each machine cycle.
+  memset (ClassCycles, 0, sizeof (ClassCycles));
+  memset (ClassTimes, 0, sizeof (ClassTimes));
+  memset (ClassCalls, 0, sizeof (ClassCalls));
+  Cost = ClockCost ();
+  Run (RomImage, CoreDump, Cycles, TimeCycles, &Time, &Checksum);
+  SingleStepCounter = SavedSingleStepCounter;
+
+  // Gather the instructions under their names, and the other classes.
+  for (Range = Opcodes; Range->Name != NULL; Range++)
+    {
+      for (j = 0; j < NumRows; j++)
+	if (!strcmp (Rows[j].Name, Range->Name))
+	  break;
+      if (j == NumRows)
+	{
+	  Rows[NumRows].Name = Range->Name;
+	  Rows[NumRows].Count = 0;
+	  Rows[NumRows].Time = 0;
+	  NumRows++;
+	}
+      for (i = Range->First; i <= Range->Last; i++)
+	{
+	  Net = ClassTimes[i] - Cost * ClassCalls[i];
+	  Rows[j].Count += ClassCycles[i];
+	  Rows[j].Time += (Net > 0) ? Net : 0;
+	  Instructions += ClassCycles[i];
+	}
+    }
+  for (i = CYCLE_DELAY; i < NUM_CYCLE_CLASSES; i++)
+    {
+      Net = ClassTimes[i] - Cost * ClassCalls[i];
+      Rows[NumRows].Name = ClassNames[i - CYCLE_DELAY];
+      Rows[NumRows].Count = ClassCycles[i];
+      Rows[NumRows].Time = (Net > 0) ? Net : 0;
+      NumRows++;
+    }
+  // The bookkeeping is done every cycle.
+  Rows[NumRows - 1].Count = Cycles;
+  Net = 0;
+  for (j = 0; j < NumRows; j++)
+    Net += Rows[j].Time;
+  Scale = (Net > 0) ? Best / Net : 0;
+  qsort (Rows, NumRows, sizeof (Rows[0]), CompareRows);
+
+  NsPerCycle = (double) Best / Cycles;
+  printf ("Benchmark:  %s, %g seconds of AGC time (%llu machine cycles), "
+	  "debugger off%s.\n", RomImage, Seconds, (unsigned long long) Cycles,
+	  IdleSkip ? ", skipping idle loops" : "");
+  printf ("Fastest of %d runs:           %.3f seconds (%.1f times real time)\n",
+	  BENCHMARK_RUNS, Best / 1e9, Seconds / (Best / 1e9));
+  printf ("Host time per machine cycle:  %.2f ns\n", NsPerCycle);
+  printf ("AGC instructions:             %llu (%.2f million per second)\n",
+	  (unsigned long long) Instructions, Instructions * 1e3 / Best);
+  printf ("Erasable-memory checksum:     %08X\n", Checksum);
+  printf ("\n");
+  printf ("Where the time went, measured by reading the clock (%.1f ns) at\n"
+	  "every machine cycle, less the cost of doing so, and scaled to the\n"
+	  "fastest run.  Instructions are counted when they complete; their\n"
+	  "other machine cycles are under (multi-MCT waits).\n\n", Cost);
+  printf ("%-28s %12s %10s %10s %7s\n", "", "Count", "ns each", "ms",
+	  "%time");
+  for (j = 0; j < NumRows; j++)
+    {
+      if (Rows[j].Count == 0 && Rows[j].Time == 0)
+	continue;
+      printf ("%-28s %12llu %10.2f %10.2f %7.2f\n", Rows[j].Name,
+	      (unsigned long long) Rows[j].Count,
+	      Rows[j].Count ? Rows[j].Time * Scale / Rows[j].Count : 0.0,
+	      Rows[j].Time * Scale / 1e6,
+	      (Net > 0) ? 100.0 * Rows[j].Time / Net : 0.0);
+    }
+
+  if (Limit > 0 && NsPerCycle > Limit)
+    {
+      printf ("\nSlower than the limit of %g ns per machine cycle.\n", Limit);
+      return (1);
+    }
+  return (0);
+}
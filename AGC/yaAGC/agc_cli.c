@@ -40,9 +40,90 @@ static void CliShowUsage(void)
 "--command=FILE    Execute AGC commands from FILE.\n"
 "--directory=DIR   Search for source files in DIR.\n"
 "--port=N          Change the server port number (default=19697).\n"
+"--shm             Let peripherals on the same computer connect to each\n"
+"                  port through shared memory rather than the socket, if\n"
+"                  they're run with --shm too.  The socket still works.\n"
 "--nodebug         Disables debugging and run just the simulation\n"
 "--interlace=N     Read the socket interface every N CPU instructions.\n"
-"--dump-time=N     Create core image every N seconds (default = 10).\n"
+"--idle-skip       Fast-forward through the idle loop of the AGC software\n"
+"                  rather than simulating every instruction of it.  The\n"
+"                  simulation results are the same, but use much less CPU.\n"
+"--speed=N         Run N times faster than the real AGC (default = 1).\n"
+"                  N need not be an integer.\n"
+"--speed=max       Run as fast as possible.  In this mode and the one\n"
+"                  above, the achieved speed is printed on exit.\n"
+"--quantum=N       Catch the CPU up with real time every N microseconds\n"
+"                  (default = 1000).\n"
+"--pacing-report   On exit, print histograms of how late the catch-ups were\n"
+"                  (jitter), and of how far the CPU then trailed real time\n"
+"                  (lag).\n"
+"--stats=FILE      While running, rewrite FILE every second with live\n"
+"                  statistics:  AGC cycles per second, pacing jitter and\n"
+"                  backlog, interrupts taken, CDU FIFO depth, traffic with\n"
+"                  each peripheral, and core-dump times.\n"
+"--stats-interval=N  Rewrite the --stats file every N milliseconds instead.\n"
+"--profile=FILE    Count the instructions executed and machine cycles used\n"
+"                  at every address, and on exit write a profile of them,\n"
+"                  by routine, source file, and line, to FILE.  Flame-graph\n"
+"                  input (folded stacks) is written to FILE.folded.  The\n"
+"                  debugger's PROFILE command also controls profiling.\n"
+"                  Idle loops aren't skipped while profiling.\n"
+"--load-report=FILE Write a time series of the Executive and Waitlist load\n"
+"                  to FILE: duty cycle, time in each interrupt, jobs by\n"
+"                  priority, VAC areas, and Waitlist depth.  Needs the\n"
+"                  symbol table.\n"
+"--load-window=N   Seconds of AGC time per line of the load report\n"
+"                  (default = 1).\n"
+"--rupt-report=FILE On exit, write to FILE histograms of how long each type\n"
+"                  of interrupt waited to be taken, the time spent with\n"
+"                  interrupts inhibited, and the source lines responsible\n"
+"                  for the most of either.  Idle loops aren't skipped.\n"
+"--trace=FILE      Write a binary record of every instruction executed and\n"
+"                  interrupt taken (with the machine cycle, address, and A,\n"
+"                  L, and Q) to FILE, compressed by gzip if FILE ends in\n"
+"                  .gz.  Idle loops aren't skipped.\n"
+"--trace-range=ADDRESS[-ADDRESS]  Trace only the instructions in this range\n"
+"                  of addresses (and any others given the same way).  An\n"
+"                  address is E bank,offset or bank,offset in octal, an\n"
+"                  unswitched octal address, or a label or variable from\n"
+"                  the symbol table.\n"
+"--trace-from=ADDRESS  Start tracing when the instruction at ADDRESS is\n"
+"                  reached.\n"
+"--trace-after=N   Start tracing after N seconds of AGC time.\n"
+"--trace-limit=N   Stop tracing after N records.\n"
+"--decode-trace=FILE  Instead of running, print the trace in FILE with the\n"
+"                  instructions disassembled, and their labels and source\n"
+"                  lines if there's a symbol table.\n"
+"--interp-report=FILE On exit, write to FILE a profile of the interpretive\n"
+"                  instructions:  how many times each was executed, and\n"
+"                  the machine cycles taken, by instruction, routine, and\n"
+"                  source line.  Needs the symbol table.\n"
+"--interp-trace=FILE  Write each interpretive instruction executed, with\n"
+"                  its machine cycle, job, source line, and operands, to\n"
+"                  FILE.  Needs the symbol table.\n"
+"--record=FILE     Record the CPU's starting state, and then every input\n"
+"                  accepted from the peripherals, along with the machine\n"
+"                  cycle it was accepted in, to FILE.\n"
+"--replay=FILE     Start from the state recorded by --record (rather than\n"
+"                  from a core dump or --resume), and feed the recorded\n"
+"                  input back in at exactly the same machine cycles,\n"
+"                  instead of taking it from the sockets, so that the\n"
+"                  recorded run is repeated exactly.\n"
+"                  The replay runs at maximum speed, and the program exits\n"
+"                  when it's finished.\n"
+"--benchmark=N     Instead of running normally, time N seconds of AGC time\n"
+"                  headless (no sockets and no pacing), and print the host\n"
+"                  time per machine cycle, the AGC instructions per\n"
+"                  second, a checksum of the final erasable memory, and a\n"
+"                  breakdown of the time by instruction and by counter,\n"
+"                  CDU-FIFO, and i/o bookkeeping.\n"
+"--benchmark-limit=N  With --benchmark, exit with status 1 if the host time\n"
+"                  per machine cycle is over N nanoseconds.\n"
+"--dump-time=N     Create core image every N seconds (default = 10).  These\n"
+"                  are binary, and are written in the background.  Either\n"
+"                  these or the octal core images made by the debugger\n"
+"                  can be resumed from.\n"
+"                  These are seconds of AGC time, not of real time.\n"
 "--cdu-log         Used only for debugging. Creates the file yaAGC.cdulog\n"
 "                  containing data related to the bandwidth-limiting of\n"
 "                  CDU inputs PCDU and MCDU.\n"
@@ -139,6 +220,7 @@ static void CliInitializeOptions(void)
 	  Options.cfg = (char*)0;
 	  Options.fromfile = (char*)0;
 	  Options.port  = 19697;
+	  Options.shm = 0;
 	  Options.dump_time = 10;
 	  Options.debug_dsky = 0;
 	  Options.debug_deda = 0;
@@ -148,6 +230,28 @@ static void CliInitializeOptions(void)
 	  Options.debug = 1;
 	  Options.resumed = 0;
 	  Options.interlace = 50;
+	  Options.idle_skip = 0;
+	  Options.speed = 1.0;
+	  Options.quantum = 1000;
+	  Options.pacing_report = 0;
+	  Options.stats = (char*)0;
+	  Options.stats_interval = 1000;
+	  Options.profile = (char*)0;
+	  Options.load_report = (char*)0;
+	  Options.load_window = 1.0;
+	  Options.rupt_report = (char*)0;
+	  Options.trace = (char*)0;
+	  Options.num_trace_ranges = 0;
+	  Options.trace_from = (char*)0;
+	  Options.trace_after = 0;
+	  Options.trace_limit = 0;
+	  Options.decode_trace = (char*)0;
+	  Options.interp_report = (char*)0;
+	  Options.interp_trace = (char*)0;
+	  Options.record = (char*)0;
+	  Options.replay = (char*)0;
+	  Options.benchmark = 0;
+	  Options.benchmark_limit = 0;
 	  Options.version = 0;
 }
 /**
@@ -162,6 +266,7 @@ static int CliProcessArgument(char* token)
 {
 	int result = CLI_E_OK;
 	int j;
+	double f;
 
 	/* Transform -- to just - for compatibility */
 	if (!strncmp(token,"--",2)) token++;
@@ -183,6 +288,7 @@ static int CliProcessArgument(char* token)
 	else if (!strncmp (token, "-exec=", 6))Options.core = strdup(&token[6]);
 	else if (!strncmp (token, "-resume=", 8))Options.resume = strdup(&token[8]);
 	else if (1 == sscanf (token, "-port=%d", &j)) Options.port = j;
+	else if (!strcmp (token, "-shm")) Options.shm = 1;
 	else if (1 == sscanf (token, "-dump-time=%d", &j)) Options.dump_time = j;
 	else if (!strcmp (token, "-debug-dsky")) Options.debug_dsky = 1;
 	else if (!strcmp (token, "-debug-deda")) Options.debug_deda = 1;
@@ -199,6 +305,34 @@ static int CliProcessArgument(char* token)
 	else if (!strncmp (token, "-symbols=", 9)) Options.symtab = strdup(&token[9]);
 	else if (!strncmp (token, "-symtab=", 8)) Options.symtab = strdup(&token[8]);
 	else if (1 == sscanf (token,"-interlace=%d", &j)) Options.interlace = j;
+	else if (!strcmp (token, "-idle-skip")) Options.idle_skip = 1;
+	else if (!strcmp (token, "-speed=max")) Options.speed = 0.0;
+	else if (1 == sscanf (token, "-speed=%lf", &f) && f > 0) Options.speed = f;
+	else if (1 == sscanf (token, "-quantum=%d", &j) && j > 0) Options.quantum = j;
+	else if (!strcmp (token, "-pacing-report")) Options.pacing_report = 1;
+	else if (!strncmp (token, "-stats=", 7)) Options.stats = strdup(&token[7]);
+	else if (1 == sscanf (token, "-stats-interval=%d", &j) && j > 0) Options.stats_interval = j;
+	else if (!strncmp (token, "-profile=", 9)) Options.profile = strdup(&token[9]);
+	else if (!strncmp (token, "-load-report=", 13)) Options.load_report = strdup(&token[13]);
+	else if (1 == sscanf (token, "-load-window=%lf", &f) && f > 0) Options.load_window = f;
+	else if (!strncmp (token, "-rupt-report=", 13)) Options.rupt_report = strdup(&token[13]);
+	else if (!strncmp (token, "-trace=", 7)) Options.trace = strdup(&token[7]);
+	else if (!strncmp (token, "-trace-range=", 13))
+	{
+		if (Options.num_trace_ranges < CLI_MAX_TRACE_RANGES)
+			Options.trace_range[Options.num_trace_ranges++] = strdup(&token[13]);
+		else result = CLI_E_UNKOWNTOKEN;
+	}
+	else if (!strncmp (token, "-trace-from=", 12)) Options.trace_from = strdup(&token[12]);
+	else if (1 == sscanf (token, "-trace-after=%lf", &f) && f > 0) Options.trace_after = f;
+	else if (1 == sscanf (token, "-trace-limit=%lf", &f) && f > 0) Options.trace_limit = f;
+	else if (!strncmp (token, "-decode-trace=", 14)) Options.decode_trace = strdup(&token[14]);
+	else if (!strncmp (token, "-interp-report=", 15)) Options.interp_report = strdup(&token[15]);
+	else if (!strncmp (token, "-interp-trace=", 14)) Options.interp_trace = strdup(&token[14]);
+	else if (!strncmp (token, "-record=", 8)) Options.record = strdup(&token[8]);
+	else if (!strncmp (token, "-replay=", 8)) Options.replay = strdup(&token[8]);
+	else if (1 == sscanf (token, "-benchmark=%lf", &f) && f > 0) Options.benchmark = f;
+	else if (1 == sscanf (token, "-benchmark-limit=%lf", &f) && f > 0) Options.benchmark_limit = f;
 	else if (Options.core == (char*)0) Options.core = strdup(token);
 	else if (Options.resume == (char*)0) Options.resume = strdup(token);
 	else result = CLI_E_UNKOWNTOKEN;
@@ -228,7 +362,8 @@ Options_t* CliParseArguments(int argc, char *argv[])
 	 * display the usage message. Otherwise proceed with the automatic
 	 * values based on the core-ropes image name.
 	 */
-	if (argc == 1 || i < argc || (!Options.core && !Options.debug_dsky))
+	if (argc == 1 || i < argc ||
+			(!Options.core && !Options.debug_dsky && !Options.decode_trace))
 	{
 		/* Check if only version info is requested */
 		if (Options.version) result = &Options;
@@ -247,12 +382,16 @@ Options_t* CliParseArguments(int argc, char *argv[])
 		/* Must have .bin extension to find the symbol table based on the
 		 * core basename with the bin extension.
 		 */
-		if (strstr(Options.core,".bin"))
+		if (Options.core && strstr(Options.core,".bin"))
 		{
 			int FullPathLength = strlen(Options.core);
 
-			/* If Debugging without symtab set default symtab */
-			if (Options.debug && !Options.symtab)
+			/* If Debugging, profiling, analyzing the load or tracing
+			 * without symtab set default symtab */
+			if ((Options.debug || Options.profile || Options.load_report
+					|| Options.rupt_report || Options.trace
+					|| Options.decode_trace || Options.interp_report
+					|| Options.interp_trace) && !Options.symtab)
 			{
 				Options.symtab = (char*)calloc(1,FullPathLength + 4);
 				strcpy(Options.symtab,Options.core);
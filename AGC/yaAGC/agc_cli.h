@@ -11,6 +11,9 @@
 #define CLI_E_OK 0
 #define CLI_E_UNKOWNTOKEN 1
 
+/* Most --trace-range options */
+#define CLI_MAX_TRACE_RANGES 16
+
 typedef struct
 {
   char* core;
@@ -22,6 +25,7 @@ typedef struct
   char* cfg;
   char* fromfile;
   int   port;
+  int   shm;		/* Offer shared memory to the peripherals too */
   int   dump_time;
   int   debug_dsky;
   int   debug_deda;
@@ -30,6 +34,29 @@ typedef struct
   int   fullname;
   int   debug;
   int   interlace;
+  int   idle_skip;
+  double speed;		/* AGC time per real time, or 0 for unthrottled */
+  int   quantum;	/* Real-time pacing interval, in microseconds */
+  int   pacing_report;
+  char* stats;		/* File for the live statistics, or NULL */
+  int   stats_interval;	/* Milliseconds between rewrites of it */
+  char* profile;	/* File for the profile, or NULL if not profiling */
+  char* load_report;	/* File for the load analysis, or NULL */
+  double load_window;	/* Seconds of AGC time per load analysis line */
+  char* rupt_report;	/* File for the interrupt latency, or NULL */
+  char* trace;		/* File for the instruction trace, or NULL */
+  char* trace_range[CLI_MAX_TRACE_RANGES];	/* Addresses traced */
+  int   num_trace_ranges;
+  char* trace_from;	/* Address that starts the trace, or NULL */
+  double trace_after;	/* Seconds of AGC time before the trace starts */
+  double trace_limit;	/* Most records traced, or 0 for no limit */
+  char* decode_trace;	/* Trace to print instead of running, or NULL */
+  char* interp_report;	/* File for the interpretive profile, or NULL */
+  char* interp_trace;	/* File for the interpretive trace, or NULL */
+  char* record;		/* File to record the peripheral input to, or NULL */
+  char* replay;		/* File to replay the peripheral input from, or NULL */
+  double benchmark;	/* Seconds of AGC time to benchmark, or 0 */
+  double benchmark_limit;	/* Most ns per machine cycle, or 0 for no limit */
   int	resumed;
   int	version;
 } Options_t;
@@ -27,6 +27,8 @@ typedef struct
   //    2 for a pattern (i.e., the next instruction code matches a pattern).
   //    3 for a watchpoint wherein a given value is written to a given address.
   //    4 for a watchpoint that displays a variable rather than halting.
+  //    5 for a watchpoint wherein a given address is read.
+  //    6 for a watchpoint wherein a given address is read or written.
   int WatchBreak;
 
   // If the "break <line>" is used, then Line will be set. If "break <symbol>"
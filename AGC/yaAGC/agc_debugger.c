@@ -35,6 +35,18 @@
   Reference:	http://virtualagc.googlecode.com
   Mods:		 12/05/08 OH	Began work.
 			 07/01/09 OH	Allow Address request using symbol
+			 2026-10-17	Index the breakpoints by address, so
+					that DbgMonitorBreakpoints needn't scan
+					them all before each instruction.
+			 2026-10-17	Watchpoints are now watch traps in the
+					engine rather than being polled, and
+					read and access watchpoints were added.
+			 2026-10-17	Added reverse-step and reverse-continue.
+			 2026-10-17	Noted that the debugger's state is
+					process-wide.
+			 2026-10-17	Report every watch trap that fired, and
+					don't index read watchpoints on the
+					central registers, which can't fire.
  */
 
 #include <stdio.h>
@@ -56,6 +68,11 @@ extern int SymbolTableSize;
 extern Symbol_t *SymbolTable;
 extern char *SourcePathName;	/* Owned by agc_symtab */
 
+/* There is one debugger per process, attached to the one agc_t that it's
+ * given (the yaAGC CPU); its state, the breakpoints, and the symbol table
+ * (agc_symtab.c) are all process-wide, as are agc_gdbmi.c's.  The engine's
+ * own state, including the watch traps the debugger sets, is in agc_t.
+ */
 static Debugger_t Debugger;
 static Frame_t *Frames;
 
@@ -99,6 +116,22 @@ char s[129], sraw[129], slast[129];
 Breakpoint_t Breakpoints[MAX_BREAKPOINTS];
 int NumBreakpoints = 0;
 
+/* Breakpoint index.  Rather than comparing every breakpoint with the
+ * program counter before each instruction, the enabled code breakpoints
+ * are marked in a bitmap with one bit per memory location (see
+ * DbgBreakKey), and watchpoints are set as watch traps in the engine,
+ * which reports them as the memory is accessed (see DbgWatchHit).  Only
+ * the patterns, and watchpoints on the central registers, which the CPU
+ * writes without any trap being checked, still have to be polled; they
+ * are listed in Polled[].  DbgIndexBreakpoints rebuilds all of this after
+ * Breakpoints[] may have changed.
+ */
+#define BREAK_KEYS (014000 + 050 * 02000)
+static unsigned char BreakMap[BREAK_KEYS / 8];
+static int Polled[MAX_BREAKPOINTS];
+static int NumPolled = 0;
+static char Trapped[MAX_BREAKPOINTS];
+
 /*
  * My substitute for fgets, for use when stdin is unblocked.
  */
@@ -243,6 +276,8 @@ DbgDeleteBreakpoint(int bp)
              }
              break;
        }
+
+    DbgIndexBreakpoints();
 }
 
 void
@@ -576,8 +611,14 @@ DbgInitialize (Options_t * Options, agc_t * State)
   if (Options->directory > 0)
     SourcePathName = Options->directory;
 
-  /* Add the AGC starting point */
+  /* Add the AGC starting point.  BacktraceAdd expects to be called during
+   * an instruction, after Z and the cycle counter have been incremented,
+   * so that restoring the point really does return to the start. */
+  State->Erasable[0][RegZ]++;
+  State->CycleCounter++;
   BacktraceAdd (State, 0);
+  State->Erasable[0][RegZ]--;
+  State->CycleCounter--;
 
   /* Register the SIGINT to be handled by AGC Debugger */
   signal (SIGINT, DbgCatchSignal);
@@ -585,23 +626,286 @@ DbgInitialize (Options_t * Options, agc_t * State)
   return 0;
 }
 
+/*
+ * Maps a 12-bit address, together with a BB register into which the
+ * superbank bit has been inserted (as in Breakpoint_t), to a key for
+ * BreakMap.  Unswitched addresses are their own keys, switched erasable
+ * is 010000-013777, and switched fixed is 014000 on up.  Returns -1 if
+ * the address isn't valid.
+ */
+static int
+DbgBreakKey (int Address12, int vRegBB)
+{
+  int Bank;
+
+  if (Address12 < 0 || Address12 > 07777)
+    return (-1);
+  if (Address12 < 01400 || Address12 >= 04000)
+    return (Address12);
+  if (Address12 < 02000)
+    return (010000 + (vRegBB & 7) * 0400 + (Address12 & 0377));
+  Bank = (vRegBB >> 10) & 037;
+  if (Bank >= 030 && (vRegBB & 0100))
+    Bank += 010;
+  return (014000 + Bank * 02000 + (Address12 & 01777));
+}
+
+/*
+ * Tells whether the CPU passed any breakpoint running straight through the
+ * code from First12 to Last12 (see BacktraceRun).
+ */
+static int
+DbgBreakInRun (int First12, int Last12, int vRegBB)
+{
+  int Address12, Key;
+
+  for (Address12 = First12; Address12 <= Last12; Address12++)
+    {
+      Key = DbgBreakKey (Address12, vRegBB);
+      if (Key >= 0 && (BreakMap[Key / 8] & (1 << (Key % 8))))
+	return (1);
+    }
+  return (0);
+}
+
+/*
+ * Returns the CPU to backtrace point N, discarding it and the points after
+ * it (see BacktraceRewind), for reverse-step and reverse-continue.  The
+ * watchpoints are left comparing against the restored values.  Returns 0
+ * on success.
+ */
+static int
+DbgRewind (int n)
+{
+  int i, j;
+
+  if (0 != (j = BacktraceRewind (Debugger.State, n)))
+    {
+      printf ("Error %d restoring backtrace point #%d.\n", j, n);
+      return (j);
+    }
+  for (i = 0; i < NumBreakpoints; i++)
+    if (Breakpoints[i].WatchBreak == 1 || Breakpoints[i].WatchBreak == 4)
+      Breakpoints[i].WatchValue =
+	DbgGetWatch (Debugger.State, &Breakpoints[i]);
+  Debugger.State->PendFlag = SingleStepCounter = 0;
+  SimSetCycleCount (SIM_CYCLECOUNT_AGC);
+  return (0);
+}
+
+/*
+ * Finds the erasable word watched by a watchpoint, in the same way as
+ * DbgGetWatch.  Returns 0 if it isn't in erasable memory.
+ */
+static int
+DbgWatchWord (Breakpoint_t * bp, int *Bank, int *Offset)
+{
+  int Address12 = (bp->Address12 & 07777);
+
+  if (Address12 <= 01377)
+    *Bank = Address12 / 0400;
+  else if (Address12 <= 01777)
+    *Bank = (bp->vRegBB & 07);
+  else
+    return (0);
+  *Offset = (Address12 & 0377);
+  return (1);
+}
+
+/*
+ * The watch-trap modes needed by each kind of watchpoint.
+ */
+static int
+DbgWatchModes (Breakpoint_t * bp)
+{
+  switch (bp->WatchBreak)
+    {
+    case 1:
+    case 4:
+      return (WATCH_CHANGE);
+    case 3:
+      return (WATCH_WRITE);
+    case 5:
+      return (WATCH_READ);
+    case 6:
+      return (WATCH_READ | WATCH_WRITE);
+    default:
+      return (0);
+    }
+}
+
+/*
+ * Rebuilds the breakpoint index from Breakpoints[].  Breakpoints are only
+ * ever added, deleted, enabled or disabled from the debugger prompt, so
+ * DbgExecute does this each time it leaves the prompt.  This also resets
+ * the values the watch traps compare against to the current ones.
+ */
+void
+DbgIndexBreakpoints (void)
+{
+  int i, Key, Bank, Offset;
+
+  if (Debugger.State == NULL)
+    return;
+  memset (BreakMap, 0, sizeof (BreakMap));
+  NumPolled = 0;
+  ClearWatchTraps (Debugger.State);
+  for (i = 0; i < NumBreakpoints; i++)
+    {
+      Trapped[i] = 0;
+      if (Breakpoints[i].WatchBreak == 0)
+	{
+	  if (DbgCheckBreakpoint (&Breakpoints[i]))
+	    {
+	      Key = DbgBreakKey (Breakpoints[i].Address12,
+				 Breakpoints[i].vRegBB);
+	      if (Key >= 0)
+		BreakMap[Key / 8] |= 1 << (Key % 8);
+	    }
+	}
+      else if (Breakpoints[i].WatchBreak >= 5 &&
+	       DbgWatchWord (&Breakpoints[i], &Bank, &Offset) &&
+	       Bank == 0 && Offset < 020)
+	{
+	  /* Reads of the central registers can't be seen, which is why
+	   * GdbmiHandleAllWatch refuses these; they never fire. */
+	}
+      else if (DbgWatchModes (&Breakpoints[i]) &&
+	       DbgWatchWord (&Breakpoints[i], &Bank, &Offset) &&
+	       (Bank != 0 || Offset >= 020))
+	{
+	  Trapped[i] = 1;
+	  if (DbgCheckBreakpoint (&Breakpoints[i]))
+	    SetWatchTrap (Debugger.State, Bank, Offset,
+			  Debugger.State->WatchModes[Bank][Offset] |
+			  DbgWatchModes (&Breakpoints[i]));
+	}
+      else
+	Polled[NumPolled++] = i;
+    }
+}
+
+/*
+ * Prints where a watch trap fired:  the instruction responsible, or a
+ * counter increment.
+ */
+static void
+DbgPrintWatchCause (WatchHit_t * Hit)
+{
+  int Bank;
+
+  if (Hit->Z < 0)
+    printf (" by a counter increment");
+  else if (Hit->Z >= 01400 && Hit->Z < 02000)
+    printf (" by the instruction at E%o,%05o", Hit->BB & 7, Hit->Z);
+  else if (Hit->Z >= 02000 && Hit->Z < 04000)
+    {
+      Bank = (Hit->BB >> 10) & 037;
+      if (Bank >= 030 && (Hit->BB & 0100))
+	Bank += 010;
+      printf (" by the instruction at %02o,%05o", Bank, Hit->Z);
+    }
+  else
+    printf (" by the instruction at %05o", Hit->Z);
+}
+
+/*
+ * Reports a watch trap that fired during the last instruction, to each of
+ * the watchpoints on the word that asked for it.  Returns 1 if execution
+ * should stop.  DbgMonitorBreakpoints calls this for each word hit.
+ */
+static int
+DbgWatchHit (WatchHit_t * Hit)
+{
+  int i, Bank, Offset, Break = 0;
+  Breakpoint_t *bp;
+
+  for (i = 0; i < NumBreakpoints; i++)
+    {
+      bp = &Breakpoints[i];
+      if (!Trapped[i] || !DbgCheckBreakpoint (bp) ||
+	  !(DbgWatchModes (bp) & Hit->Mode) ||
+	  !DbgWatchWord (bp, &Bank, &Offset) ||
+	  Bank != Hit->Bank || Offset != Hit->Offset)
+	continue;
+      if (bp->WatchBreak == 3 && bp->WatchValue != Hit->New)
+	continue;
+
+      if (bp->WatchBreak == 4)
+	{
+	  if (bp->Symbol != NULL)
+	    printf ("%s=%06o\n", bp->Symbol->Name, Hit->New & 077777);
+	  else
+	    printf ("(E%o,%05o)=%06o\n", Bank, 01400 + Offset,
+		    Hit->New & 077777);
+	  bp->WatchValue = Hit->New;
+	  continue;
+	}
+
+      if (bp->WatchBreak == 5 || !(Hit->Mode & (WATCH_WRITE | WATCH_CHANGE)))
+	printf ("Hit read watchpoint");
+      else
+	printf ("Hit watchpoint");
+      if (bp->Symbol != NULL)
+	printf (" %s", bp->Symbol->Name);
+      printf (" at E%o,%05o, ", Bank, 01400 + Offset);
+      if (bp->WatchBreak == 5 || !(Hit->Mode & (WATCH_WRITE | WATCH_CHANGE)))
+	printf ("%06o", Hit->Old & 077777);
+      else
+	printf ("%06o -> %06o", Hit->Old & 077777, Hit->New & 077777);
+      DbgPrintWatchCause (Hit);
+      printf (".\n");
+      if (bp->WatchBreak == 1)
+	bp->WatchValue = Hit->New;
+      DbgHitBreakpoint (bp);
+      Break = 1;
+    }
+  return (Break);
+}
+
 int
 DbgMonitorBreakpoints (void)
 {
   int Break;
   int CurrentZ;
   int CurrentBB;
-  int i;
+  int i, n, Count, Key, CodeHit;
   int Value;
   SymbolLine_t *Line;
 
-  Value = DbgGetFromZ (Debugger.State);
+  /* Watch traps fired during the last instruction.  All of them are
+   * reported, even if the first already stops execution. */
+  if (Debugger.State->NumWatchHits)
+    {
+      for (Break = i = 0; i < Debugger.State->NumWatchHits; i++)
+	Break |= DbgWatchHit (&Debugger.State->WatchHits[i]);
+      if (Debugger.State->LostWatchHits)
+	printf ("(%d more watched words were hit.)\n",
+		Debugger.State->LostWatchHits);
+      Debugger.State->NumWatchHits = Debugger.State->LostWatchHits = 0;
+      if (Break)
+	return (1);
+    }
+
   CurrentZ = Debugger.State->Erasable[0][RegZ];
   CurrentBB = (Debugger.State->Erasable[0][RegBB] & 076007) |
     (Debugger.State->InputChannel[7] & 0100);
 
-  for (Break = i = 0; i < NumBreakpoints; i++)
+  /* The usual case is no breakpoint here and nothing to poll. */
+  Key = DbgBreakKey (CurrentZ, CurrentBB);
+  CodeHit = (Key >= 0 && (BreakMap[Key / 8] & (1 << (Key % 8))));
+  if (!CodeHit && !NumPolled)
+    return (0);
+
+  /* If there is a breakpoint here, find it among all of them; otherwise
+   * just check the ones that are polled. */
+  Value = DbgGetFromZ (Debugger.State);
+  Count = CodeHit ? NumBreakpoints : NumPolled;
+  for (Break = n = 0; n < Count; n++)
     {
+      i = CodeHit ? n : Polled[n];
+      if (Trapped[i])
+	continue;
       Line = Breakpoints[i].Line;
       if (Breakpoints[i].WatchBreak == 2 &&
 	  DbgCheckBreakpoint (&Breakpoints[i]))
@@ -1054,6 +1358,8 @@ DbgSetValueByAddress (unsigned gdbmi_addr, unsigned short value)
     }
   else				/* Must be fixed memory */
     {
+      /* Don't patch the rope of any other AGC sharing it */
+      agc_unshare_fixed (Debugger.State);
       if (agc_addr.Unbanked == 1)	/* Check for Fixed Fixed */
 	{
 	  /* remember the FB should already be fine (see gdbmiNativeAddr */
@@ -1140,6 +1446,7 @@ DbgExecute ()
   //char FileName[MAX_FILE_LENGTH + 1];
   char SymbolName[129];
 
+  BacktraceStep (Debugger.State);
   Break = DbgHasBreakEvent ();
 
   if (Break && !DebugDsky)
@@ -1385,6 +1692,62 @@ DbgExecute ()
 	    }
 	  else if (!strcmp (s, "BACKTRACES"))
 	    BacktraceDisplay (Debugger.State, MAX_BACKTRACE_POINTS);
+	  else if (!strcmp (s, "REVERSE-STEP") || !strcmp (s, "RS")
+		   || 1 == sscanf (s, "REVERSE-STEP%d", &i)
+		   || 1 == sscanf (s, "RS%d", &i))
+	    {
+	      // Back to the Nth most recent branch, which is point N - 1.
+	      if (!strcmp (s, "REVERSE-STEP") || !strcmp (s, "RS"))
+		i = 1;
+	      if (i < 1)
+		printf ("The step-count must be 1 or greater.\n");
+	      else if (BacktraceLength (Debugger.State) == 0)
+		printf ("There is no execution history to go back through.\n");
+	      else
+		{
+		  if (i > BacktraceLength (Debugger.State))
+		    {
+		      i = BacktraceLength (Debugger.State);
+		      printf ("Only %d branches are in the history.\n", i);
+		    }
+		  if (!DbgRewind (i - 1))
+		    printf ("Went back %d branch%s.\n", i, (i == 1) ? "" : "es");
+		}
+	      DbgIndexBreakpoints ();
+	      return (1);
+	    }
+	  else if (!strcmp (s, "REVERSE-CONTINUE") || !strcmp (s, "RC"))
+	    {
+	      // Find the most recent run of code (-1 being the one since the
+	      // latest branch) that passed a breakpoint, go back to the branch
+	      // that began it, and run forward again to the breakpoint.
+	      int First12, Last12, vRegBB, Count;
+	      DbgIndexBreakpoints ();
+	      Count = BacktraceLength (Debugger.State);
+	      for (i = -1; i < Count; i++)
+		if (!BacktraceRun (Debugger.State, i, &First12, &Last12, &vRegBB)
+		    && DbgBreakInRun (First12, Last12, vRegBB))
+		  break;
+	      if (Count == 0)
+		printf ("There is no execution history to go back through.\n");
+	      else if (i + 1 >= Count)
+		{
+		  if (!DbgRewind (Count - 1))
+		    printf ("Reached the start of the execution history.\n");
+		}
+	      else if (!DbgRewind (i + 1) &&
+		       (Debugger.State->Erasable[0][RegZ] & 07777) != First12)
+		{
+		  // The run began with the branch just restored, which is
+		  // executed before any breakpoint is checked.  (At the start
+		  // point, there's no branch, and the CPU is already there.)
+		  SingleStepCounter = -1;
+		  Debugger.RunState = 1;
+		  break;
+		}
+	      DbgIndexBreakpoints ();
+	      return (1);
+	    }
 	  else if (1 == sscanf (s, "BACKTRACE%d", &i))
 	    {
 	      int j;
@@ -1402,6 +1765,7 @@ DbgExecute ()
 	      Debugger.State->PendFlag = SingleStepCounter = 0;
 	      Break = 1;
 	      SimSetCycleCount (SIM_CYCLECOUNT_AGC);
+	      DbgIndexBreakpoints ();
 
 	      return (1);
 	    }
@@ -1451,6 +1815,7 @@ DbgExecute ()
 	    }
 	}
 
+      DbgIndexBreakpoints ();
       DbgProcessLog ();
     }
 
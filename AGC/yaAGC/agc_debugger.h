@@ -46,6 +46,7 @@ extern int DbgGetFromZ (agc_t * State);
 extern int DbgInitialize(Options_t* Options,agc_t* State);
 extern void DbgDisplayInnerFrame(void);
 extern int DbgMonitorBreakpoints(void);
+extern void DbgIndexBreakpoints(void);
 extern char* DbgNormalizeCmdString(char* s);
 extern int DbgHasBreakEvent(void);
 extern void DbgDisplayPrompt(void);
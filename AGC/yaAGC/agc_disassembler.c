@@ -33,6 +33,8 @@
   Contact:	Onno Hommes
   Reference:	http://www.ibiblio.org/apollo
   Mods:		08/31/08 OH.	Began.
+		2026-10-17	Added DasPrintTracedInstruction, for the trace
+				decoder in agc_trace.c.
 */
 
 #include <stdio.h>
@@ -285,3 +287,16 @@ void DasPrintInstructionAtAddr(unsigned short LinearAddress)
 
 	DasPrintInstruction(ExtraCode,Value);
 }
+
+/**
+Disassemble an instruction recorded in a trace (see agc_trace.c).  Z is the
+12-bit address it was executed at, and Value the instruction as indexed.
+*/
+void DasPrintTracedInstruction(int Z, int ExtraCode, int Value)
+{
+	sCurrentZ = Z;
+	sErasable = (Z < 02000);
+	sFixed = !sErasable;
+
+	DasPrintInstruction(ExtraCode,Value);
+}
@@ -33,6 +33,7 @@
   Contact:	Onno Hommes
   Reference:	http://www.ibiblio.org/apollo
   Mods:		08/31/08 OH.	Began.
+		2026-10-17	Added DasPrintTracedInstruction.
 */
 
 #ifndef AGC_DISASSEMBLE_H_
@@ -40,5 +41,6 @@
 
 extern void Disassemble (agc_t * State);
 extern void DasPrintInstructionAtAddr(unsigned short LinearAddress);
+extern void DasPrintTracedInstruction(int Z, int ExtraCode, int Value);
 
 #endif /*AGC_DISASSEMBLE_H_*/
@@ -242,6 +242,70 @@
 				CpuWriteIO() to agc_t, trying to overcome the
 				lack of resumption of telemetry after an AGC
 				resumption in Windows.
+		2026-10-17	Added agc_engine_run(), which executes many
+				machine cycles per call and does the DOWNRUPT,
+				DEDA, and ChannelRoutine bookkeeping only on
+				the cycles where it can be due.  agc_engine()
+				is now just a 1-cycle agc_engine_run().
+		2026-10-17	Added IdleSkip, for fast-forwarding through
+				idle loops.
+		2026-10-17	Added the predecoded-instruction table.
+		2026-10-17	Moved all of the file-level statics that 
+				hold CPU state into agc_t, so the engine is
+				reentrant.
+		2026-10-17	Idle loops aren't skipped while socket
+				input is waiting to be processed.
+		2026-10-17	Added watch traps, which check accesses to
+				watched words of erasable memory as they
+				happen.
+		2026-10-17	Revived coverage collection (CollectCoverage),
+				now with instruction and machine-cycle counts
+				for profiling.
+		2026-10-17	Added load accounting, which counts the machine
+				cycles used by jobs, by each interrupt, and by
+				idling.
+		2026-10-17	Quiet cycles stop short of the next input of a
+				recording being replayed (see agc_input.c).
+		2026-10-17	Each machine cycle is classed by what it was
+				used for, and can be reported to CycleHook,
+				for --benchmark.
+		2026-10-17	Added BulkIncrement, for runs of unprogrammed
+				counter increments sent in a single packet.
+				PushCduFifo now takes a count.
+		2026-10-17	Count the interrupts taken, by type.
+		2026-10-17	Time the interrupts' latency, and the
+				cycles with interrupts inhibited or held
+				off, while RuptTiming is set (see
+				agc_rupt.c).
+		2026-10-17	Record each instruction executed and
+				each interrupt taken while Trace is set
+				(see agc_trace.c).
+		2026-10-17	Count, time, and record the interpretive
+				instructions dispatched while
+				Interpreter is set (see agc_interp.c).
+		2026-10-17	The coverage counts, CycleHook, and the DEDA
+				monitor are now in agc_t.
+		2026-10-17	The predecoded-instruction table is indexed
+				by the top 6 bits of the instruction, which
+				is all it depends on, and so is static.
+		2026-10-17	agc_engine() no longer goes through
+				agc_engine_run(), and quiet cycles skip
+				ChannelInput() and the hooks as well.
+		2026-10-17	Added StopCoverage.
+		2026-10-17	Every watch trap that fires is recorded, and
+				reads of fixed memory aren't checked for
+				them at all.
+		2026-10-17	The interpretive switch instructions are
+				each counted on their own.
+		2026-10-17	Dropped the predecoded-instruction table,
+				which only duplicated InstructionTiming
+				and ExtracodeTiming.  Unindexed fetches
+				still skip the index arithmetic.
+		2026-10-17	ChannelInput is only skipped in quiet
+				cycles if it's SocketAPI.c's (which sets
+				InputInterlaced); otherwise it's called
+				every cycle, as NullAPI.c promises, and
+				idle loops aren't fast-forwarded.
   
   The technical documentation for the Apollo Guidance & Navigation (G&N) system,
   or more particularly for the Apollo Guidance Computer (AGC) may be found at 
@@ -280,8 +344,9 @@
 
 #define AGC_ENGINE_C
 //#include <errno.h>
-//#include <stdlib.h>
+#include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #ifdef WIN32
 typedef unsigned short uint16_t;
 typedef int int32_t;
@@ -361,20 +426,459 @@ static const int ExtracodeTiming[32] = {
 // everything if 0.  Entries 1-10 disable individual interrupts.
 int DebuggerInterruptMasks[11] = { 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1 };
 
+// For debugging the CDUX,Y,Z inputs.
+FILE *CduLog = NULL;
+
+// State->QuietCycles is the number of upcoming machine cycles in which
+// agc_engine_run() can skip its per-cycle bookkeeping.  Anything that schedules
+// a new event must zero it.
+
 //-----------------------------------------------------------------------------
-// Stuff for doing structural coverage analysis.  Yes, I know it could be done
-// much more cleverly.
+// Watch traps.  The debugger marks words of erasable memory with WATCH_xxx
+// modes (see agc_engine.h), and accesses to them are checked as they happen:
+// reads of operands in FindMemoryWord, and writes in Assign, WriteIO and 
+// wherever counters are incremented.  Each trap that fires is added to 
+// State->WatchHits, and makes agc_engine_run return.  When no traps are set,
+// all of this costs only a test of State->NumWatchTraps.  (The central 
+// registers, which CpuCycle mostly reads and writes directly, aren't 
+// covered, so the debugger polls them for changes instead.)
 
-int CoverageCounts = 0;			// Increment coverage counts is != 0.
-unsigned ErasableReadCounts[8][0400];
-unsigned ErasableWriteCounts[8][0400];
-unsigned ErasableInstructionCounts[8][0400];
-unsigned FixedAccessCounts[40][02000];
-unsigned IoReadCounts[01000];
-unsigned IoWriteCounts[01000];
+void
+SetWatchTrap (agc_t * State, int Bank, int Offset, int Modes)
+{
+  if (Bank < 0 || Bank >= 8 || Offset < 0 || Offset >= 0400)
+    return;
+  if (State->WatchModes[Bank][Offset] == 0 && Modes != 0)
+    State->NumWatchTraps++;
+  else if (State->WatchModes[Bank][Offset] != 0 && Modes == 0)
+    State->NumWatchTraps--;
+  State->WatchModes[Bank][Offset] = Modes;
+  State->WatchValues[Bank][Offset] = State->Erasable[Bank][Offset];
+}
 
-// For debugging the CDUX,Y,Z inputs.
-FILE *CduLog = NULL;
+void
+ClearWatchTraps (agc_t * State)
+{
+  memset (State->WatchModes, 0, sizeof (State->WatchModes));
+  State->NumWatchTraps = 0;
+  State->NumWatchHits = State->LostWatchHits = 0;
+}
+
+// Checks an access to the word of erasable memory at Pointer, which has just
+// been written if Write is non-zero, or is about to be read otherwise.  
+// Counter is non-zero if the write is a counter increment rather than by an
+// instruction.  Pointer must be in State->Erasable; callers that might have
+// a word of fixed memory check first.
+static void
+WatchAccess (agc_t * State, int16_t * Pointer, int Write, int Counter)
+{
+  int Address, Bank, Offset, Modes, Mode = 0, i;
+  int16_t Old, New;
+  WatchHit_t *Hit;
+
+  Address = Pointer - State->Erasable[0];
+  Bank = Address / 0400;
+  Offset = Address & 0377;
+  Modes = State->WatchModes[Bank][Offset];
+  if (Modes == 0)
+    return;
+  Old = State->WatchValues[Bank][Offset];
+  New = *Pointer;
+  if (Write)
+    {
+      State->WatchValues[Bank][Offset] = New;
+      if ((Modes & WATCH_CHANGE) && New != Old)
+        Mode = WATCH_CHANGE;
+      else if (Modes & WATCH_WRITE)
+        Mode = WATCH_WRITE;
+    }
+  else if (Modes & WATCH_READ)
+    Mode = WATCH_READ;
+  if (Mode == 0)
+    return;
+  State->RunStop = 1;
+  // An instruction that reads a word and then writes it hits twice, which
+  // is one hit.
+  for (i = 0, Hit = State->WatchHits; i < State->NumWatchHits; i++, Hit++)
+    if (Hit->Bank == Bank && Hit->Offset == Offset)
+      {
+        Hit->Mode |= Mode;
+	Hit->New = New;
+	return;
+      }
+  if (State->NumWatchHits >= MAX_WATCH_HITS)
+    {
+      State->LostWatchHits++;
+      return;
+    }
+  State->NumWatchHits++;
+  Hit->Mode = Mode;
+  Hit->Bank = Bank;
+  Hit->Offset = Offset;
+  Hit->Old = Old;
+  Hit->New = New;
+  Hit->Z = Counter ? -1 : State->WatchZ;
+  Hit->BB = State->WatchBB;
+}
+
+//-----------------------------------------------------------------------------
+// Stuff for doing structural coverage analysis and profiling.  The counts 
+// themselves are in State->Coverage (see Coverage_t).  Since 
+// LocateMemoryWord has already taken care of the bank selection, the word is
+// identified by where it is in State->Erasable or State->Fixed, rather than
+// by its 12-bit address.
+
+#define COVERAGE_READ 1
+#define COVERAGE_INSTRUCTION 2
+
+static void
+CollectCoverage (agc_t * State, int16_t * Pointer, int What)
+{
+  Coverage_t *Coverage = State->Coverage;
+  int Address;
+
+  Address = Pointer - State->Erasable[0];
+  if (Address >= 0 && Address < 04000)
+    {
+      if (What == COVERAGE_READ)
+        Coverage->ErasableReadCounts[Address / 0400][Address & 0377]++;
+      else
+        Coverage->ErasableInstructionCounts[Address / 0400][Address & 0377]++;
+      return;
+    }
+  Address = Pointer - State->Fixed[0];
+  if (Address >= 0 && Address < NUM_FIXED_BANKS * 02000)
+    {
+      if (What == COVERAGE_READ)
+        Coverage->FixedAccessCounts[Address / 02000][Address & 01777]++;
+      else
+        Coverage->FixedInstructionCounts[Address / 02000][Address & 01777]++;
+    }
+}
+
+// Charges a machine cycle to State->CoverageWord.
+static void
+CollectCycle (agc_t * State)
+{
+  int Address;
+
+  if (State->CoverageWord == NULL)
+    return;
+  Address = State->CoverageWord - State->Erasable[0];
+  if (Address >= 0 && Address < 04000)
+    {
+      State->Coverage->ErasableCycleCounts[Address / 0400][Address & 0377]++;
+      return;
+    }
+  Address = State->CoverageWord - State->Fixed[0];
+  if (Address >= 0 && Address < NUM_FIXED_BANKS * 02000)
+    State->Coverage->FixedCycleCounts[Address / 02000][Address & 01777]++;
+}
+
+// While interrupt timing is on, notes the interrupts requested since the
+// last machine cycle, and charges this one to the word being executed if
+// interrupts were inhibited or a request was kept waiting.
+static void
+RuptCycle (agc_t * State)
+{
+  RuptTiming_t *Rupt = State->RuptTiming;
+  int i, Address, Waiting = 0;
+
+  for (i = 1; i <= NUM_INTERRUPT_TYPES; i++)
+    if (State->InterruptRequests[i])
+      {
+	Waiting = 1;
+	if (Rupt->Requested[i] == 0)
+	  Rupt->Requested[i] = State->CycleCounter;
+      }
+  if (State->AllowInterrupt && !Waiting)
+    return;
+  if (!State->AllowInterrupt)
+    Rupt->InhibitedCycles++;
+  if (Waiting)
+    Rupt->WaitingCycles++;
+  if (State->CoverageWord == NULL)
+    return;
+  Address = State->CoverageWord - State->Erasable[0];
+  if (Address >= 0 && Address < 04000)
+    {
+      if (!State->AllowInterrupt)
+	Rupt->InhibitedErasable[Address / 0400][Address & 0377]++;
+      if (Waiting)
+	Rupt->WaitingErasable[Address / 0400][Address & 0377]++;
+      return;
+    }
+  Address = State->CoverageWord - State->Fixed[0];
+  if (Address >= 0 && Address < NUM_FIXED_BANKS * 02000)
+    {
+      if (!State->AllowInterrupt)
+	Rupt->InhibitedFixed[Address / 02000][Address & 01777]++;
+      if (Waiting)
+	Rupt->WaitingFixed[Address / 02000][Address & 01777]++;
+    }
+}
+
+// Adds the latency of interrupt i, which is being taken, to its histogram.
+// A request made in this same machine cycle hasn't been noted yet, and has
+// no latency.
+static void
+RuptTaken (agc_t * State, int i)
+{
+  RuptTiming_t *Rupt = State->RuptTiming;
+  uint64_t Latency = 0, n;
+  int Bucket;
+
+  if (Rupt->Requested[i] != 0 && Rupt->Requested[i] < State->CycleCounter)
+    Latency = State->CycleCounter - Rupt->Requested[i];
+  Rupt->Requested[i] = 0;
+  for (Bucket = 0, n = Latency; n > 0 && Bucket < RUPT_BUCKETS - 1; Bucket++)
+    n >>= 1;
+  Rupt->Latency[i][Bucket]++;
+  Rupt->Taken[i]++;
+  Rupt->TotalLatency[i] += Latency;
+  if (Latency > Rupt->MaxLatency[i])
+    Rupt->MaxLatency[i] = Latency;
+}
+
+// While tracing, puts a record of the instruction at WhereWord (or of
+// interrupt Cause being taken in its place, if Cause isn't 0) into the
+// trace ring, if the filters allow.
+static void
+TraceInstruction (agc_t * State, int16_t * WhereWord, int Instruction,
+		  int ExtraCode, int Cause)
+{
+  Trace_t *Trace = State->Trace;
+  TraceRecord_t *Record;
+  int Address = -1;
+
+  if (Trace->Limit && Trace->Records >= Trace->Limit)
+    return;
+  if (Trace->Ranged || Trace->StartAddress != -1)
+    {
+      Address = WhereWord - State->Erasable[0];
+      if (Address < 0 || Address >= 04000)
+	{
+	  Address = WhereWord - State->Fixed[0];
+	  if (Address >= 0 && Address < NUM_FIXED_BANKS * 02000)
+	    Address += 04000;
+	  else
+	    Address = -1;
+	}
+    }
+  if (!Trace->Triggered)
+    {
+      if (State->CycleCounter < Trace->StartCycle ||
+	  (Trace->StartAddress != -1 && Address != Trace->StartAddress))
+	return;
+      Trace->Triggered = 1;
+    }
+  if (Trace->Ranged && (Address == -1 || !Trace->InRange[Address]))
+    return;
+
+  // Wait for room, if the writer has fallen behind.
+  if (Trace->Head - __atomic_load_n (&Trace->Tail, __ATOMIC_ACQUIRE)
+      >= TRACE_RING_SIZE)
+    {
+      Trace->Stalls++;
+      while (Trace->Head - __atomic_load_n (&Trace->Tail, __ATOMIC_ACQUIRE)
+	     >= TRACE_RING_SIZE);
+    }
+  Record = &Trace->Ring[Trace->Head & (TRACE_RING_SIZE - 1)];
+  Record->Cycle = State->CycleCounter;
+  Record->Z = c (RegZ) & 07777;
+  Record->BB = c (RegBB);
+  Record->Instruction = Instruction;
+  Record->A = c (RegA);
+  Record->L = c (RegL);
+  Record->Q = c (RegQ);
+  Record->Index = State->IndexValue;
+  Record->Cause = Cause;
+  Record->Flags = 0;
+  if (ExtraCode)
+    Record->Flags |= TRACE_EXTRACODE;
+  if (State->OutputChannel7 & 0100)
+    Record->Flags |= TRACE_SUPERBANK;
+  if (State->InIsr)
+    Record->Flags |= TRACE_ISR;
+  if (!State->AllowInterrupt)
+    Record->Flags |= TRACE_INHINT;
+  if (State->SubstituteInstruction)
+    Record->Flags |= TRACE_SUBSTITUTE;
+  __atomic_store_n (&Trace->Head, Trace->Head + 1, __ATOMIC_RELEASE);
+  Trace->Records++;
+}
+
+// Converts the S-register address of a word of interpretive code, whose
+// bank is in BANKSET, to a trace address.
+static int
+InterpAddress (agc_t * State, int Address)
+{
+  int Bankset = State->Erasable[0][State->Interpreter->Bankset], Bank;
+
+  Address &= 07777;
+  if (Address < 01400)
+    return (Address);
+  if (Address < 02000)
+    return ((Bankset & 7) * 0400 + (Address & 0377));
+  if (Address >= 04000)
+    return (04000 + Address);
+  Bank = (Bankset >> 10) & 037;
+  if (Bank >= 030 && (State->OutputChannel7 & 0100))
+    Bank += 010;
+  return (04000 + Bank * 02000 + (Address & 01777));
+}
+
+static uint16_t
+InterpWord (agc_t * State, int Address)
+{
+  if (Address < 04000)
+    return (State->Erasable[0][Address] & 077777);
+  return (State->Fixed[0][Address - 04000] & 077777);
+}
+
+// Charges the machine cycles since the last dispatch to it.
+static void
+InterpCharge (agc_t * State)
+{
+  Interpreter_t *Interp = State->Interpreter;
+  uint64_t Cycles;
+
+  if (!Interp->Running)
+    return;
+  Cycles = State->CycleCounter - Interp->Started;
+  Interp->Cycles[Interp->Vector][Interp->Code] += Cycles;
+  Interp->UseCycles[Interp->Location] += Cycles;
+  Interp->Running = 0;
+}
+
+// Counts the dispatch of Code, held in the word at trace address Location,
+// and records it if tracing.  A switch instruction is counted by which one
+// it is, from its first operand.  The record's Operands are the two words
+// after LOC, or for a store code (Operand not -1), Operand and the word
+// after LOC.
+static void
+InterpDispatch (agc_t * State, int Code, int Location, int Operand)
+{
+  Interpreter_t *Interp = State->Interpreter;
+  InterpRecord_t *Record;
+  int Loc = State->Erasable[0][Interp->Loc];
+
+  if (Code == INTERP_SWITCH_OP)
+    Code = INTERP_SWITCH
+      + ((InterpWord (State, InterpAddress (State, Loc + 1)) >> 4) & 017);
+  InterpCharge (State);
+  Interp->Vector = (0 != (State->Erasable[0][Interp->Mode] & 040000));
+  Interp->Code = Code;
+  Interp->Location = Location;
+  Interp->Started = State->CycleCounter;
+  Interp->Running = (Code != 0);	// Not after EXIT.
+  Interp->Dispatches++;
+  Interp->Counts[Interp->Vector][Code]++;
+  Interp->Uses[Location]++;
+  if (!Interp->Tracing)
+    return;
+  if (Interp->Buffered >= INTERP_BUFFER_SIZE)
+    {
+      Interp->Lost++;
+      return;
+    }
+  Record = &Interp->Buffer[Interp->Buffered++];
+  Record->Cycle = State->CycleCounter;
+  Record->Location = Location;
+  Record->Code = Code;
+  if (Operand == -1)
+    {
+      Record->Operands[0] = InterpWord (State, InterpAddress (State, Loc + 1));
+      Record->Operands[1] = InterpWord (State, InterpAddress (State, Loc + 2));
+    }
+  else
+    {
+      Record->Operands[0] = Operand;
+      Record->Operands[1] = InterpWord (State, InterpAddress (State, Loc + 1));
+    }
+  Record->Fixloc = State->Erasable[0][Interp->Fixloc] & 077777;
+  Record->Vector = Interp->Vector;
+}
+
+// Called with each instruction executed while Interpreter is set, before
+// it's executed, to watch for the interpreter's dispatches.
+static void
+InterpInstruction (agc_t * State, int16_t * WhereWord)
+{
+  Interpreter_t *Interp = State->Interpreter;
+  int Loc;
+
+  if (WhereWord == Interp->Newops)
+    Interp->Pair = InterpAddress (State, State->Erasable[0][Interp->Loc]);
+  else if (WhereWord == Interp->Opjump)
+    {
+      // The pair is where LOC was at NEWOPS, since LOC has been advanced
+      // past the left-hand op's operands by the time the right-hand op is
+      // dispatched.
+      if (Interp->Pair == -1)
+	Interp->Pair = InterpAddress (State, State->Erasable[0][Interp->Loc]);
+      InterpDispatch (State, c (RegA) & 0177, Interp->Pair, -1);
+    }
+  else if (WhereWord == Interp->Dostore)
+    {
+      Loc = State->Erasable[0][Interp->Loc];
+      InterpDispatch (State, INTERP_STORE + ((c (RegA) >> 11) & 7),
+		      InterpAddress (State, Loc), c (RegA) & 077777);
+    }
+  else if (WhereWord == Interp->Chang2)
+    {
+      InterpCharge (State);
+      Interp->Pair = -1;
+    }
+}
+
+// Starts collecting the coverage counts for State, setting up 
+// State->Coverage if it hasn't been already.  Returns 0 on success, or 1 if
+// out of memory.
+int
+StartCoverage (agc_t * State)
+{
+  if (State->Coverage == NULL)
+    {
+      State->Coverage = (Coverage_t *) calloc (1, sizeof (Coverage_t));
+      if (State->Coverage == NULL)
+        return (1);
+    }
+  State->CoverageCounts = 1;
+  return (0);
+}
+
+void
+ClearCoverage (agc_t * State)
+{
+  if (State->Coverage != NULL)
+    memset (State->Coverage, 0, sizeof (Coverage_t));
+}
+
+// Stops collecting the coverage counts, and frees them.
+void
+StopCoverage (agc_t * State)
+{
+  State->CoverageCounts = 0;
+  free (State->Coverage);
+  State->Coverage = NULL;
+}
+
+//-----------------------------------------------------------------------------
+// Load accounting.  Returns the class of the current machine cycle, for 
+// State->LoadCycles.
+
+static int
+LoadClass (agc_t * State)
+{
+  int Address;
+  if (State->InIsr)
+    return (State->InterruptRequests[0]);
+  Address = State->LoadIdleAddress;
+  if (Address >= 0 && State->Erasable[Address / 0400][Address & 0377] == State->LoadIdleValue)
+    return (LOAD_IDLE);
+  return (LOAD_JOB);
+}
 
 //-----------------------------------------------------------------------------
 // Functions for reading or writing from/to i/o channels.  The reason we have
@@ -387,8 +891,8 @@ ReadIO (agc_t * State, int Address)
 {
   if (Address < 0 || Address > 0777)
     return (0);
-  if (CoverageCounts)
-    IoReadCounts[Address]++;
+  if (State->CoverageCounts)
+    State->Coverage->IoReadCounts[Address]++;
   if (Address == RegL || Address == RegQ)
     return (State->Erasable[0][Address]);
   return (State->InputChannel[Address]);
@@ -401,10 +905,14 @@ WriteIO (agc_t * State, int Address, int Value)
   Value &= 077777;
   if (Address < 0 || Address > 0777)
     return;
-  if (CoverageCounts)
-    IoWriteCounts[Address]++;
+  if (State->CoverageCounts)
+    State->Coverage->IoWriteCounts[Address]++;
   if (Address == RegL || Address == RegQ)
-    State->Erasable[0][Address] = Value;
+    {
+      State->Erasable[0][Address] = Value;
+      if (State->NumWatchTraps)
+        WatchAccess (State, &State->Erasable[0][Address], 1, 0);
+    }
     
   // 2005-07-04 RSB.  The necessity for this was pointed out by Mark 
   // Grant via Markus Joachim.  Although channel 033 is an input channel,
@@ -442,6 +950,7 @@ CpuWriteIO (agc_t * State, int Address, int Value)
       State->DownruptTimeValid = 1;
       State->DownruptTime = State->CycleCounter + (AGC_PER_SECOND / 50);
       State->Downlink = 0;
+      State->QuietCycles = 0;
     }
 }
 
@@ -449,10 +958,12 @@ CpuWriteIO (agc_t * State, int Address, int Value)
 // This function does all of the processing associated with converting a 
 // 12-bit "address" as used within instructions or in the Z register, to a
 // pointer to the actual word in the simulated memory.  In other words, here
-// we take memory bank-selection into account.  
+// we take memory bank-selection into account.  LocateMemoryWord is for 
+// looking without the CPU's involvement (fetching the instruction itself,
+// for example), and FindMemoryWord for the instructions' operands.
 
 static int16_t *
-FindMemoryWord (agc_t * State, int Address12)
+LocateMemoryWord (agc_t * State, int Address12)
 {
   //int PseudoAddress;
   int AdjustmentEB, AdjustmentFB;
@@ -492,72 +1003,18 @@ FindMemoryWord (agc_t * State, int Address12)
     return (&State->Fixed[3][Address12 & 01777]);
 }
 
-// Same thing, basically, but for collecting coverage data.
-#if 0
-static void
-CollectCoverage (agc_t * State, int Address12, int Read, int Write, int Instruction)
+static int16_t *
+FindMemoryWord (agc_t * State, int Address12)
 {
-  int AdjustmentEB, AdjustmentFB;
-
-  if (!CoverageCounts)
-    return;
-
-  // Get rid of the parity bit.
-  Address12 = Address12;
-
-  // Make sure the darn thing really is 12 bits.
-  Address12 &= 07777;
-
-  if (Address12 < 00400)	// Unswitched-erasable.
-    {
-      AdjustmentEB = 0;
-      goto Erasable;  
-    }
-  else if (Address12 < 01000)	// Unswitched-erasable (continued).
-    {
-      AdjustmentEB = 1;
-      goto Erasable;
-    }
-  else if (Address12 < 01400)	// Unswitched-erasable (continued).
-    {
-      AdjustmentEB = 2;
-      goto Erasable;
-    }
-  else if (Address12 < 02000)	// Switched-erasable.
-    {
-      // Recall that the parity bit is accounted for in the shift below.
-      AdjustmentEB = (7 & (c (RegEB) >> 8));
-    Erasable:
-      Address12 &= 00377;
-      if (Read)
-        ErasableReadCounts[AdjustmentEB][Address12]++;
-      if (Write)
-        ErasableWriteCounts[AdjustmentEB][Address12]++;
-      if (Instruction)
-        ErasableInstructionCounts[AdjustmentEB][Address12]++;
-    }
-  else if (Address12 < 04000)	// Fixed-switchable.
-    {
-      AdjustmentFB = (037 & (c (RegFB) >> 10));
-      // Account for the superbank bit. 
-      if (030 == (AdjustmentFB & 030) && (State->OutputChannel7 & 0100) != 0)
-	AdjustmentFB += 010;
-    Fixed:
-      FixedAccessCounts[AdjustmentFB][Address12 & 01777]++;
-    }
-  else if (Address12 < 06000)	// Fixed-fixed.
-    {
-      AdjustmentFB = 2;
-      goto Fixed;
-    }
-  else				// Fixed-fixed (continued).
-    {
-      AdjustmentFB = 3;
-      goto Fixed;
-    }
-  return;
+  int16_t *WhereWord;
+  WhereWord = LocateMemoryWord (State, Address12);
+  if (State->NumWatchTraps && Address12 < 02000)	// Erasable.
+    WatchAccess (State, WhereWord, 0, 0);
+  if (State->CoverageCounts)
+    CollectCoverage (State, WhereWord, COVERAGE_READ);
+  return (WhereWord);
 }
-#endif //0
+
 
 //-----------------------------------------------------------------------------
 // Assign a new value to "erasable" memory, performing editing as necessary
@@ -567,8 +1024,6 @@ CollectCoverage (agc_t * State, int Address12, int Read, int Write, int Instruct
 // and an offset into that bank, while AssignFromPointer simply uses a pointer
 // directly to the simulated memory location.
 
-static int NextZ;
-
 static void
 Assign (agc_t * State, int Bank, int Offset, int Value)
 {
@@ -576,14 +1031,14 @@ Assign (agc_t * State, int Bank, int Offset, int Value)
     return;			// Non-erasable memory.
   if (Offset < 0 || Offset >= 0400)
     return;
-  if (CoverageCounts)
-    ErasableWriteCounts[Bank][Offset]++;
+  if (State->CoverageCounts)
+    State->Coverage->ErasableWriteCounts[Bank][Offset]++;
   if (Bank == 0)
     {
       switch (Offset)
 	{
 	case RegZ:
-	  NextZ = Value & 07777;
+	  State->NextZ = Value & 07777;
 	  break;
 	case RegCYR:
 	  Value &= 077777;
@@ -624,6 +1079,8 @@ Assign (agc_t * State, int Bank, int Offset, int Value)
     }
   else
     State->Erasable[Bank][Offset] = Value & 077777;
+  if (State->NumWatchTraps)
+    WatchAccess (State, &State->Erasable[Bank][Offset], 1, 0);
 }
 
 static void
@@ -924,7 +1381,8 @@ NegateSP (int16_t Value)
 // and return 1 on overflow.
 
 #include <stdio.h>
-static int TrapPIPA = 0;
+// Nothing sets this any longer, so it's constant (and reentrant).
+static const int TrapPIPA = 0;
 
 // 1's-complement increment
 int
@@ -1106,6 +1564,17 @@ CounterSHANC (int16_t * Counter)
   return (Overflow);
 }
 
+// CounterPINC, for one of the TIMEn registers, checking the watch traps.
+static int
+TimerPINC (agc_t * State, int Register)
+{
+  int Overflow;
+  Overflow = CounterPINC (&c (Register));
+  if (State->NumWatchTraps)
+    WatchAccess (State, &c (Register), 1, 1);
+  return (Overflow);
+}
+
 // Pinch hits for the above in setting interrupt requests with INCR,
 // AUG, and DIM instructins.  The docs aren't very forthcoming as to 
 // which counter registers are affected by this ... but still.
@@ -1116,7 +1585,7 @@ InterruptRequests (agc_t * State, int16_t Address10, int Sum)
   if (ValueOverflowed (Sum) == AGC_P0)
     return;
   if (IsReg (Address10, RegTIME1))
-    CounterPINC (&c (RegTIME2));
+    TimerPINC (State, RegTIME2);
   else if (IsReg (Address10, RegTIME6))
     State->InterruptRequests[1] = 1;
   else if (IsReg (Address10, RegTIME5))
@@ -1144,24 +1613,13 @@ InterruptRequests (agc_t * State, int16_t Address10, int Sum)
 // Actually, there are two different fixed rates for PCDU/MCDU:  400 counts
 // per second in "slow mode", and 6400 counts per second in "fast mode".
 //
-// *** FIXME! All of the following junk will need to move to agc_t, and will
-//     somehow have to be made compatible with backtraces. ***
+// The FIFOs themselves (CduFifo_t) are in agc_t, though they still aren't
+// included in backtraces.
 // The way the FIFO works is that it can hold an ordered set of + counts and
 // - counts.  For example, if it held 7,-5,10, it would mean to apply 7 PCDUs,
 // followed by 5 MCDUs, followed by 10 PCDUs.  If there are too many sign-changes
 // buffered, triggers will be transparently dropped.
-#define MAX_CDU_FIFO_ENTRIES 128
-#define NUM_CDU_FIFOS 3			// Increase to 5 to include OPTX, OPTY.
 #define FIRST_CDU 032
-typedef struct {
-  int Ptr;				// Index of next entry being pulled.
-  int Size;				// Number of entries.
-  int IntervalType;			// 0,1,2,0,1,2,...
-  uint64_t NextUpdate;			// Cycle count at which next counter update occurs.
-  int32_t Counts[MAX_CDU_FIFO_ENTRIES];
-} CduFifo_t;
-static CduFifo_t CduFifos[NUM_CDU_FIFOS];// For registers 032, 033, and 034.
-static int CduChecker = 0;		// 0, 1, ..., NUM_CDU_FIFOS-1, 0, 1, ...
 
 // Here's an auxiliary function to add a count to a CDU FIFO.  The only allowed
 // increment types are:
@@ -1175,8 +1633,9 @@ static int CduChecker = 0;		// 0, 1, ..., NUM_CDU_FIFOS-1, 0, 1, ...
 //	021	Upper bits = 10
 //	023	Upper bits = 11
 // The least-significant 30 bits are simply the absolute value of the count.
+// Count triggers of the same type are pushed at once.
 static void
-PushCduFifo (agc_t *State, int Counter, int IncType)
+PushCduFifo (agc_t *State, int Counter, int IncType, int Count)
 {
   CduFifo_t *CduFifo;
   int Next, Interval;
@@ -1205,14 +1664,19 @@ PushCduFifo (agc_t *State, int Counter, int IncType)
       return;
     }
   if (CduLog != NULL)
-    fprintf (CduLog, "< " FORMAT_64U " %o %02o\n", State->CycleCounter, Counter, IncType);
-  CduFifo = &CduFifos[Counter - FIRST_CDU];
+    {
+      if (Count == 1)
+        fprintf (CduLog, "< " FORMAT_64U " %o %02o\n", State->CycleCounter, Counter, IncType);
+      else
+        fprintf (CduLog, "< " FORMAT_64U " %o %02o x%d\n", State->CycleCounter, Counter, IncType, Count);
+    }
+  CduFifo = &State->CduFifos[Counter - FIRST_CDU];
   // It's a little easier if the FIFO is completely empty.
   if (CduFifo->Size == 0)
     {
       CduFifo->Ptr = 0;
       CduFifo->Size = 1;
-      CduFifo->Counts[0] = Base + 1;
+      CduFifo->Counts[0] = Base + Count;
       CduFifo->NextUpdate = State->CycleCounter + Interval;
       CduFifo->IntervalType = 1;
       return;
@@ -1235,14 +1699,14 @@ PushCduFifo (agc_t *State, int Counter, int IncType)
       Next++;
       if (Next >= MAX_CDU_FIFO_ENTRIES)
         Next -= MAX_CDU_FIFO_ENTRIES;
-      CduFifo->Counts[Next] = Base + 1;
+      CduFifo->Counts[Next] = Base + Count;
       return;
     }
   // Okay, add in the new data to the last FIFO entry.  The sign is assured
   // to be compatible.  The size of the FIFO doesn't increase. We also don't
   // bother to check for arithmetic overflow, since only the wildest IMU
   // failure could cause it.
-  CduFifo->Counts[Next]++;
+  CduFifo->Counts[Next] += Count;
 }
 
 // Here's an auxiliary function to perform the next available PCDU or MCDU
@@ -1258,12 +1722,12 @@ ServiceCduFifo (agc_t *State)
   int16_t *Ch;
   // See if there are any pending PCDU or MCDU counts we need to apply.  We only
   // check one of the CDUs, and the CDU to check is indicated by CduChecker.
-  CduFifo = &CduFifos[CduChecker];
+  CduFifo = &State->CduFifos[State->CduChecker];
 
   if (CduFifo->Size > 0 && State->CycleCounter >= CduFifo->NextUpdate)
     {  
       // Update the counter.
-      Ch = &State->Erasable[0][CduChecker + FIRST_CDU];
+      Ch = &State->Erasable[0][State->CduChecker + FIRST_CDU];
       Count = CduFifo->Counts[CduFifo->Ptr];
       HighRate = (Count & 0x80000000);
       DownCount = (Count & 0x40000000);
@@ -1271,14 +1735,16 @@ ServiceCduFifo (agc_t *State)
         {
           CounterMCDU (Ch);
 	  if (CduLog != NULL)
-	    fprintf (CduLog, ">\t\t" FORMAT_64U " %o 03\n", State->CycleCounter, CduChecker + FIRST_CDU);
+	    fprintf (CduLog, ">\t\t" FORMAT_64U " %o 03\n", State->CycleCounter, State->CduChecker + FIRST_CDU);
 	}
       else
         {
           CounterPCDU (Ch);
 	  if (CduLog != NULL)
-	    fprintf (CduLog, ">\t\t" FORMAT_64U " %o 01\n", State->CycleCounter, CduChecker + FIRST_CDU);
+	    fprintf (CduLog, ">\t\t" FORMAT_64U " %o 01\n", State->CycleCounter, State->CduChecker + FIRST_CDU);
 	}
+      if (State->NumWatchTraps)
+        WatchAccess (State, Ch, 1, 1);
       Count--;
       // Update the FIFO.
       if (0 != (Count & ~0xC0000000))
@@ -1319,9 +1785,9 @@ ServiceCduFifo (agc_t *State)
       RetVal = 1;
     }
     
-  CduChecker++;
-  if (CduChecker >= NUM_CDU_FIFOS)
-    CduChecker = 0;  
+  State->CduChecker++;
+  if (State->CduChecker >= NUM_CDU_FIFOS)
+    State->CduChecker = 0;  
     
   return (RetVal);
 }
@@ -1334,11 +1800,11 @@ void
 UnprogrammedIncrement (agc_t *State, int Counter, int IncType)
 {
   int16_t *Ch;
-  int Overflow = 0;
+  int Overflow = 0, Queued = 0;
   Counter &= 0x7f;
   Ch = &State->Erasable[0][Counter];
-  if (CoverageCounts)
-    ErasableWriteCounts[0][Counter]++;
+  if (State->CoverageCounts)
+    State->Coverage->ErasableWriteCounts[0][Counter]++;
   switch (IncType)
     {
     case 0:  
@@ -1349,7 +1815,10 @@ UnprogrammedIncrement (agc_t *State, int Counter, int IncType)
     case 021: 
       // For the CDUX,Y,Z counters, push the command into a FIFO.
       if (Counter >= FIRST_CDU && Counter < FIRST_CDU + NUM_CDU_FIFOS)
-        PushCduFifo (State, Counter, IncType);
+        {
+          PushCduFifo (State, Counter, IncType, 1);
+	  Queued = 1;
+	}
       else
         Overflow = CounterPCDU (Ch);
       break;
@@ -1361,7 +1830,10 @@ UnprogrammedIncrement (agc_t *State, int Counter, int IncType)
     case 023:
       // For the CDUX,Y,Z counters, push the command into a FIFO.
       if (Counter >= FIRST_CDU && Counter < FIRST_CDU + NUM_CDU_FIFOS)
-        PushCduFifo (State, Counter, IncType);
+        {
+          PushCduFifo (State, Counter, IncType, 1);
+	  Queued = 1;
+	}
       else
         Overflow = CounterMCDU (Ch);
       break;
@@ -1375,15 +1847,130 @@ UnprogrammedIncrement (agc_t *State, int Counter, int IncType)
       Overflow = CounterSHANC (Ch);
       break;
     default:
+      Queued = 1;
       break;
     }
+  if (State->NumWatchTraps && !Queued)
+    WatchAccess (State, Ch, 1, 1);
   if (Overflow)
     {
       // On some counters, overflow is supposed to cause
       // an interrupt.  Take care of setting the interrupt request here.
      
     }
-  TrapPIPA = 0;
+}
+
+//----------------------------------------------------------------------------
+// The same, but for a whole run of increments of one counter, which a
+// simulated IMU, say, can send in a single packet (see BULK_INCREMENT in
+// agc_engine.h) rather than a packet for each pulse.  Increments of the
+// CDUX,Y,Z counters go into the CDU FIFOs all at once, and so are still
+// applied at the proper rate.  Others are queued, and applied one per
+// machine cycle by ServiceBulk, just as they would be if they had come in
+// one packet at a time.  With BULK_DIRECT, though, they're all applied
+// right away, for when the timing doesn't matter.
+
+void
+BulkIncrement (agc_t *State, int Counter, int Value)
+{
+  int Count, IncType, Cdu;
+  BulkEntry_t *Entry;
+  Counter &= 0x7f;
+  Count = (Value & BULK_COUNT_MASK);
+  if (Count & 04000)
+    Count -= 010000;
+  if (Count == 0)
+    return;
+  switch (Value & BULK_KIND_MASK)
+    {
+    case BULK_PINC:
+      IncType = (Count > 0) ? 0 : 2;
+      break;
+    case BULK_PCDU:
+      IncType = (Count > 0) ? 1 : 3;
+      break;
+    case BULK_PCDU_FAST:
+      IncType = (Count > 0) ? 021 : 023;
+      break;
+    default:
+      return;
+    }
+  if (Count < 0)
+    Count = -Count;
+  Cdu = ((IncType & 1) && Counter >= FIRST_CDU
+         && Counter < FIRST_CDU + NUM_CDU_FIFOS);
+
+  if (Value & BULK_DIRECT)
+    {
+      int16_t *Ch = &State->Erasable[0][Counter];
+      // UnprogrammedIncrement would put CDU increments into the FIFO.
+      if (!Cdu)
+        while (Count--)
+	  UnprogrammedIncrement (State, Counter, IncType);
+      else
+        {
+	  if (State->CoverageCounts)
+	    State->Coverage->ErasableWriteCounts[0][Counter] += Count;
+	  while (Count--)
+	    {
+	      if (IncType & 2)
+	        CounterMCDU (Ch);
+	      else
+	        CounterPCDU (Ch);
+	    }
+	  if (State->NumWatchTraps)
+	    WatchAccess (State, Ch, 1, 1);
+	}
+      return;
+    }
+  if (Cdu)
+    {
+      PushCduFifo (State, Counter, IncType, Count);
+      return;
+    }
+
+  // Add to the last entry in the queue if it's for the same thing.
+  if (State->BulkSize > 0)
+    {
+      Entry = &State->BulkEntries[(State->BulkPtr + State->BulkSize - 1)
+				  % MAX_BULK_ENTRIES];
+      if (Entry->Counter == Counter && Entry->IncType == IncType)
+        {
+	  Entry->Count += Count;
+	  return;
+	}
+    }
+  if (State->BulkSize >= MAX_BULK_ENTRIES)
+    {
+      // No room, so rather than drop them, apply them right away.
+      while (Count--)
+        UnprogrammedIncrement (State, Counter, IncType);
+      return;
+    }
+  Entry = &State->BulkEntries[(State->BulkPtr + State->BulkSize)
+			      % MAX_BULK_ENTRIES];
+  Entry->Counter = Counter;
+  Entry->IncType = IncType;
+  Entry->Count = Count;
+  State->BulkSize++;
+}
+
+// Applies the next of the queued bulk increments, if any.  Returns non-zero
+// if it did, in which case the machine cycle has been used up.
+static int
+ServiceBulk (agc_t *State)
+{
+  BulkEntry_t *Entry;
+  if (State->BulkSize == 0)
+    return (0);
+  Entry = &State->BulkEntries[State->BulkPtr];
+  UnprogrammedIncrement (State, Entry->Counter, Entry->IncType);
+  if (--Entry->Count == 0)
+    {
+      State->BulkSize--;
+      State->BulkPtr = (State->BulkPtr + 1) % MAX_BULK_ENTRIES;
+    }
+  return (1);
 }
 
 //----------------------------------------------------------------------------
@@ -1393,14 +1980,13 @@ UnprogrammedIncrement (agc_t *State, int Counter, int IncType)
 static int
 BurstOutput (agc_t *State, int DriveBitMask, int CounterRegister, int Channel)
 {
-  static int CountCDUX = 0, CountCDUY = 0, CountCDUZ = 0;  // In target CPU format.
   int DriveCount = 0, DriveBit, Direction = 0, Delta, DriveCountSaved;
   if (CounterRegister == RegCDUXCMD)
-    DriveCountSaved = CountCDUX;
+    DriveCountSaved = State->CountCDUX;
   else if (CounterRegister == RegCDUYCMD)
-    DriveCountSaved = CountCDUY;
+    DriveCountSaved = State->CountCDUY;
   else if (CounterRegister == RegCDUZCMD)
-    DriveCountSaved = CountCDUZ;
+    DriveCountSaved = State->CountCDUZ;
   else
     return (0);
   // Driving this axis?
@@ -1441,59 +2027,292 @@ BurstOutput (agc_t *State, int DriveBitMask, int CounterRegister, int Channel)
   if (Direction)
     DriveCountSaved = -DriveCountSaved;
   if (CounterRegister == RegCDUXCMD)
-    CountCDUX = DriveCountSaved;
+    State->CountCDUX = DriveCountSaved;
   else if (CounterRegister == RegCDUYCMD)
-    CountCDUY = DriveCountSaved;
+    State->CountCDUY = DriveCountSaved;
   else if (CounterRegister == RegCDUZCMD)
-    CountCDUZ = DriveCountSaved;
+    State->CountCDUZ = DriveCountSaved;
   return (DriveCountSaved);
 }      
       
 //-----------------------------------------------------------------------------
-// Execute one machine-cycle of the simulation.  Use agc_engine_init prior to 
-// the first call of agc_engine, to initialize State, and then call agc_engine 
-// thereafter every (simulated) 11.7 microseconds.
+// Note on addressing of bits within words:  The MIT docs refer to bits
+// 1 through 15, with 1 being the least-significant, and 15 the most 
+// significant.  A 16th bit, the (odd) parity bit, would be bit 0 in this
+// scheme.  Now, we're probably not going to use the parity bit in our
+// simulation -- I haven't fully decided this at the time I'm writing
+// this note -- so we have a choice of whether to map the 15 bits that ARE
+// used to D0-14 or to D1-15.  I'm going to choose the latter, even though
+// it requires slightly more processing, in order to conform as obviously
+// as possible to the MIT docs.
+
+#define SCALER_OVERFLOW 160
+#define SCALER_DIVIDER 3
+
+// Fine-alignment.
+// The gyro needs 3200 pulses per second, and therefore counts twice as
+// fast as the regular 1600 pps counters.
+#define GYRO_OVERFLOW 160
+#define GYRO_DIVIDER (2 * 3)
+
+// Coarse-alignment.
+// The IMU CDU drive emits bursts every 600 ms.  Each cycle is 
+// 12/1024000 seconds long.  This happens to mean that a burst is
+// emitted every 51200 CPU cycles, but we multiply it out below
+// to make it look pretty
+#define IMUCDU_BURST_CYCLES ((600 * 1024000) / (1000 * 12 * COARSE_SMOOTH))
+
+//-----------------------------------------------------------------------------
+// Apply one 1/1600 second scaler pulse to SCALER1/2 and the TIME1-TIME6
+// counter-timers, adding the machine cycles this takes to ExtraDelay.  Used
+// by CpuCycle, and by IdleFastForward.
+
+static void
+ScalerTick (agc_t * State)
+{
+  int Overflow;
+  // First, update SCALER1 and SCALER2.
+  State->ScalerCounter -= SCALER_OVERFLOW;
+  if (CounterPINC (&State->InputChannel[ChanSCALER1]))
+    {
+      State->ExtraDelay++;
+      CounterPINC (&State->InputChannel[ChanSCALER2]);
+    }
+  // Check whether there was a pulse into bit 5 of SCALER1.
+  // If so, the 10 ms. timers TIME1 and TIME3 are updated.
+  // Recall that the registers are in AGC integer format,
+  // and therefore are actually shifted left one space.
+  if (0 == (017 & State->InputChannel[ChanSCALER1]))
+    {
+      State->ExtraDelay++;
+      if (TimerPINC (State, RegTIME1))
+	{
+	  State->ExtraDelay++;
+	  TimerPINC (State, RegTIME2);
+	}
+      State->ExtraDelay++;
+      if (TimerPINC (State, RegTIME3))
+	State->InterruptRequests[3] = 1;
+      // I have very little data about what TIME5 is supposed to do.
+      // From the table on p. 1-64 of Savage & Drake, I assume
+      // it works just like TIME3.
+      State->ExtraDelay++;
+      if (TimerPINC (State, RegTIME5))
+	State->InterruptRequests[2] = 1;
+    }
+  // TIME4 is the same as TIME3, but 5 ms. out of phase.
+  if (010 == (017 & State->InputChannel[ChanSCALER1]))
+    {
+      State->ExtraDelay++;
+      if (TimerPINC (State, RegTIME4))
+	State->InterruptRequests[4] = 1;
+    }
+  // I'm not sure if TIME6 is supposed to count when the T6 RUPT
+  // is disabled or not.  For the sake of argument, I'll assume
+  // that it is.  Nor am I sure how many bits this counter has.
+  // I'll assume 14.  Nor if it's out of phase with SCALER1.
+  // Nor ... well, you get the idea.
+  State->ExtraDelay++;
+  Overflow = CounterDINC (State, 0, &c (RegTIME6));
+  if (State->NumWatchTraps)
+    WatchAccess (State, &c (RegTIME6), 1, 1);
+  if (Overflow)
+    if (040000 & State->InputChannel[013])
+      State->InterruptRequests[1] = 1;
+}
+
+//-----------------------------------------------------------------------------
+// Idle-loop fast-forwarding, used only if IdleSkip is set.  When there's 
+// nothing for the flight software to do, it spins in a short loop (for 
+// example, Luminary's CHECKNJ/ADVAN idling with SMODE=0) until an interrupt 
+// makes a job ready.  Simulating every one of those cycles is a waste of 
+// host CPU time.
 //
-// Returns:
-//      0 -- success
-// I'm not sure if there are any circumstances under which this can fail ...
+// A loop is recognized in three steps.  First, a backward branch has to 
+// arrive twice at the same address with the same A, L, Q, and bank 
+// registers.  Second, one complete pass through the loop is checked (by 
+// IdleProbe and IdleBranch):  none of its instructions may touch the counter
+// registers (024-060), or any i/o channel other than L, Q, and the superbank
+// channel 7, and at the end of it the CPU registers and flags, and all of
+// erasable memory outside the counters, have to be exactly what they were at
+// the start.  Such a loop can't change anything, and will go around 
+// identically until an interrupt occurs.  Third, agc_engine_run() calls 
+// IdleFastForward to advance through whole passes of the loop without 
+// decoding any instructions.  Only the counter-timers (using ScalerTick), the 
+// cycle counters, and the handful of other per-cycle states are updated, 
+// following the machine-cycle pattern recorded for the checked pass.  This 
+// stops before any pass in which an interrupt would be requested, or in which 
+// the DOWNRUPT, DEDA, or socket-service bookkeeping would be due, and normal
+// simulation takes over again at the top of the loop.  The result is exactly
+// what full simulation would have produced, except that ChannelInput is not
+// polled during the skipped cycles and the (unchanging) superbank channel 
+// isn't output again.
+
+// The state of all this, in agc_t, is:
+//	IdleCandidates[]	Backward-branch targets seen so far.
+//	IdleHead		Loop whose pass is being checked.
+//	IdleImpure		Pass touched counters or i/o.
+//	IdleInstructions	Instructions in the pass so far.
+//	IdleCycles		Machine cycles in the pass so far.
+//	IdleEligible		... of which aren't PendDelay cycles.
+//	IdlePattern[]		0 for PendDelay cycles, else 1.
+//	IdleErasable[][]	Erasable memory at top of the loop.
+//	IdleFlags		CPU flags at top of the loop.
+//	IdleConfirmed		Loop ready for IdleFastForward.
+
+#define IDLE_FLAGS(State) ((State)->ExtraCode | ((State)->AllowInterrupt << 1) \
+  | ((State)->InIsr << 2) | ((State)->SubstituteInstruction << 3) \
+  | (((State)->IndexValue & 0177777) << 4))
 
-// Note on addressing of bits within words:  The MIT docs refer to bits
-// 1 through 15, with 1 being the least-significant, and 15 the most 
-// significant.  A 16th bit, the (odd) parity bit, would be bit 0 in this
-// scheme.  Now, we're probably not going to use the parity bit in our
-// simulation -- I haven't fully decided this at the time I'm writing
-// this note -- so we have a choice of whether to map the 15 bits that ARE
-// used to D0-14 or to D1-15.  I'm going to choose the latter, even though
-// it requires slightly more processing, in order to conform as obviously
-// as possible to the MIT docs.
+static int
+IdleInterruptRequested (agc_t * State)
+{
+  int i;
+  for (i = 1; i <= NUM_INTERRUPT_TYPES; i++)
+    if (State->InterruptRequests[i])
+      return (1);
+  return (0);
+}
 
-#define SCALER_OVERFLOW 160
-#define SCALER_DIVIDER 3
-static int ScalerCounter = 0;
+// Non-zero if an address refers to one of the counter registers.
+static int
+IdleIsCounter (agc_t * State, int Address12)
+{
+  int16_t *WhereWord;
+  WhereWord = LocateMemoryWord (State, Address12);
+  return (WhereWord >= &State->Erasable[0][RegCOUNTER] &&
+          WhereWord <= &State->Erasable[0][RegALTM]);
+}
 
-// Fine-alignment.
-// The gyro needs 3200 pulses per second, and therefore counts twice as
-// fast as the regular 1600 pps counters.
-#define GYRO_OVERFLOW 160
-#define GYRO_DIVIDER (2 * 3)
-static unsigned GyroCount = 0;
-static unsigned OldChannel14 = 0, GyroTimer = 0;
+// Called by CpuCycle for each instruction executed while a pass through a 
+// candidate idle loop is being checked, to record its timing and to check 
+// that it doesn't access anything that can change behind the program's back.
+static void
+IdleProbe (agc_t * State, int ExtendedOpcode, int Instruction)
+{
+  int i, Address9, Address10, Address12;
+  // Machine cycles used, as for the PendDelay computation in CpuCycle.
+  i = Instruction >> 10;
+  if (State->ExtraCode)
+    i = ExtracodeTiming[i];
+  else
+    i = InstructionTiming[i];
+  if (State->IdleInstructions >= MAX_IDLE_INSTRUCTIONS)
+    {
+      // Too long to be an idle loop.
+      State->IdleHead->Cooldown = 64;
+      State->IdleHead = NULL;
+      return;
+    }
+  State->IdleInstructions++;
+  State->IdlePattern[State->IdleCycles++] = 1;
+  State->IdleEligible++;
+  if (i)
+    {
+      while (i--)
+        State->IdlePattern[State->IdleCycles++] = 0;
+      State->IdlePattern[State->IdleCycles++] = 1;
+      State->IdleEligible++;
+    }
+  // Now the operand.  Double-precision instructions use the preceding
+  // address too, and we can't be bothered to distinguish 10-bit from 12-bit
+  // addresses.
+  Address9 = Instruction & MASK9;
+  Address10 = Instruction & MASK10;
+  Address12 = Instruction & MASK12;
+  if (ExtendedOpcode >= 0100 && ExtendedOpcode <= 0107)
+    {
+      // I/O instructions and EDRUPT.
+      if (ExtendedOpcode == 0107 || 
+          (Address9 != RegL && Address9 != RegQ && Address9 != 7))
+	State->IdleImpure = 1;
+    }
+  else if (((ExtendedOpcode & 0176) == 050 && Address10 == 017) ||
+	   ((ExtendedOpcode & 0170) == 0150 && Address12 == (017 << 1)))
+    State->IdleImpure = 1;			// RESUME.
+  else if (IdleIsCounter (State, Address12) || 
+	   IdleIsCounter (State, Address12 - 1) ||
+	   IdleIsCounter (State, Address10) || 
+	   IdleIsCounter (State, Address10 - 1))
+    State->IdleImpure = 1;
+}
 
-// Coarse-alignment.
-// The IMU CDU drive emits bursts every 600 ms.  Each cycle is 
-// 12/1024000 seconds long.  This happens to mean that a burst is
-// emitted every 51200 CPU cycles, but we multiply it out below
-// to make it look pretty
-#define IMUCDU_BURST_CYCLES ((600 * 1024000) / (1000 * 12 * COARSE_SMOOTH))
-static uint64_t ImuCduCount = 0;
-static unsigned ImuChannel14 = 0;
+// Called by CpuCycle at the end of each instruction (or interrupt vector), 
+// to look for idle loops.  ProgramCounter is the address of the instruction
+// just executed.
+static void
+IdleBranch (agc_t * State, uint16_t ProgramCounter)
+{
+  IdleCandidate_t *Candidate;
+  uint16_t Z;
+  Z = c (RegZ);
+  if (State->IdleHead != NULL)
+    {
+      // A pass through a loop is being checked.  Back at the top yet?
+      if (Z != State->IdleHead->Z || c (RegBB) != State->IdleHead->BB ||
+          State->OutputChannel7 != State->IdleHead->Channel7)
+	return;
+      if (!State->IdleImpure && State->IdleFlags == IDLE_FLAGS (State) &&
+          !IdleInterruptRequested (State) &&
+	  !memcmp (State->IdleErasable[0], State->Erasable[0], 
+	  	   RegCOUNTER * sizeof (int16_t)) &&
+	  !memcmp (&State->IdleErasable[0][RegALTM + 1], 
+	  	   &State->Erasable[0][RegALTM + 1], 
+		   (0400 - RegALTM - 1) * sizeof (int16_t)) &&
+	  !memcmp (State->IdleErasable[1], State->Erasable[1], 
+	  	   7 * 0400 * sizeof (int16_t)))
+	State->IdleConfirmed = 1;
+      else
+        State->IdleHead->Cooldown = 64;
+      State->IdleHead = NULL;
+      return;
+    }
+  // Otherwise, only a backward branch into fixed memory can start a loop.
+  if (Z >= ProgramCounter || Z < 02000 || State->InIsr || 
+      IdleInterruptRequested (State))
+    return;
+  Candidate = &State->IdleCandidates[Z & (IDLE_CANDIDATES - 1)];
+  if (Candidate->Valid && Candidate->Z == Z && Candidate->BB == c (RegBB) &&
+      Candidate->Channel7 == State->OutputChannel7 &&
+      Candidate->A == c (RegA) && Candidate->L == c (RegL) &&
+      Candidate->Q == c (RegQ))
+    {
+      if (Candidate->Cooldown)
+        {
+	  Candidate->Cooldown--;
+	  return;
+	}
+      // Second identical arrival, so check the next pass through the loop.
+      State->IdleHead = Candidate;
+      State->IdleImpure = 0;
+      State->IdleInstructions = State->IdleCycles = State->IdleEligible = 0;
+      State->IdleFlags = IDLE_FLAGS (State);
+      memcpy (State->IdleErasable, State->Erasable, sizeof (State->IdleErasable));
+      return;
+    }
+  Candidate->Valid = 1;
+  Candidate->Cooldown = 0;
+  Candidate->Z = Z;
+  Candidate->BB = c (RegBB);
+  Candidate->Channel7 = State->OutputChannel7;
+  Candidate->A = c (RegA);
+  Candidate->L = c (RegL);
+  Candidate->Q = c (RegQ);
+}
 
-int
-agc_engine (agc_t * State)
+// The socket-servicing ChannelRoutine() is called whenever 
+// State->ChannelRoutineCount wraps to 0, i.e., every 8192 machine cycles.
+
+//-----------------------------------------------------------------------------
+// Everything in a machine cycle that follows the per-cycle bookkeeping done
+// in agc_engine_run():  multi-MCT delays, CDU FIFOs, the counter-timers, and
+// finally the instruction itself.  There is only one call to this function,
+// so the compiler is free to inline it into the loop in agc_engine_run().
+
+static int
+CpuCycle (agc_t * State)
 {
   int i, j;
-  static int Count = 0;
   uint16_t ProgramCounter, Instruction, OpCode, QuarterCode, sExtraCode;
   int16_t *WhereWord;
   uint16_t Address12, Address10, Address9;
@@ -1507,62 +2326,6 @@ agc_engine (agc_t * State)
   
   sExtraCode = 0;
   
-  // For DOWNRUPT
-  if (State->DownruptTimeValid && State->CycleCounter >= State->DownruptTime)
-    {
-      State->InterruptRequests[8] = 1;	// Request DOWNRUPT
-      State->DownruptTimeValid = 0;
-    }
-  
-  State->CycleCounter++;
-  
-  //----------------------------------------------------------------------
-  // The following little thing is useful only for debugging yaDEDA with
-  // the --debug-deda command-line switch.  It just outputs the contents
-  // of the address that was specified by the DEDA at 1/2 second intervals.
-  if (DedaMonitor && State->CycleCounter >= DedaWhen)
-    {
-      int16_t Data;
-      Data = State->Erasable[0][DedaAddress];
-      DedaWhen = State->CycleCounter + 1024000 / 24;	// 1/2 second.
-      ShiftToDeda (State, (DedaAddress >> 6) & 7);
-      ShiftToDeda (State, (DedaAddress >> 3) & 7);
-      ShiftToDeda (State, DedaAddress & 7);
-      ShiftToDeda (State, 0);
-      ShiftToDeda (State, (Data >> 12) & 7);
-      ShiftToDeda (State, (Data >> 9) & 7);
-      ShiftToDeda (State, (Data >> 6) & 7);
-      ShiftToDeda (State, (Data >> 3) & 7);
-      ShiftToDeda (State, Data & 7);
-    }
-
-  //----------------------------------------------------------------------
-  // Update the thingy that determines when 1/1600 second has passed.
-  // 1/1600 is the basic timing used to drive timer registers.  1/1600
-  // second happens to be 160/3 machine cycles.
-
-  ScalerCounter += SCALER_DIVIDER;
-
-  //-------------------------------------------------------------------------
-
-  // Handle server stuff for socket connections used for i/o channel
-  // communications.  Stuff like listening for clients we only do
-  // every once and a while---nominally, every 100 ms.  Actually 
-  // processing input data is done every cycle.
-  if (Count == 0)
-    ChannelRoutine (State);
-  Count = ((Count + 1) & 017777);
-
-  // Get data from input channels.  Return immediately if a unprogrammed 
-  // counter-increment was performed.
-  if (ChannelInput (State))
-    return (0);
-
-  // If in --debug-dsky mode, don't want to take the chance of executing
-  // any AGC code, since there isn't any loaded anyway.
-  if (DebugDsky)
-    return (0);
-
   //----------------------------------------------------------------------  
   // This stuff takes care of extra CPU cycles used by some instructions.
 
@@ -1571,6 +2334,7 @@ agc_engine (agc_t * State)
   if (State->ExtraDelay)
     {
       State->ExtraDelay--;
+      State->CycleClass = CYCLE_DELAY;
       return (0);
     }
 
@@ -1581,6 +2345,7 @@ agc_engine (agc_t * State)
   if (State->PendFlag && State->PendDelay > 0)
     {
       State->PendDelay--;
+      State->CycleClass = CYCLE_DELAY;
       return (0);
     }
 
@@ -1591,6 +2356,14 @@ agc_engine (agc_t * State)
     {
       // A CDU counter was serviced, so a cycle was used up, and we must
       // return.  
+      State->CycleClass = CYCLE_CDU;
+      return (0);
+    }
+
+  // Likewise for bulk counter increments not yet applied.
+  if (ServiceBulk (State))
+    {
+      State->CycleClass = CYCLE_INPUT;
       return (0);
     }
   
@@ -1603,55 +2376,12 @@ agc_engine (agc_t * State)
   // takes 1 machine cycle.
 
   // This can only iterate once, but I use 'while' just in case.
-  while (ScalerCounter >= SCALER_OVERFLOW)
+  while (State->ScalerCounter >= SCALER_OVERFLOW)
     {
-      // First, update SCALER1 and SCALER2.
-      ScalerCounter -= SCALER_OVERFLOW;
-      if (CounterPINC (&State->InputChannel[ChanSCALER1]))
-	{
-	  State->ExtraDelay++;
-	  CounterPINC (&State->InputChannel[ChanSCALER2]);
-	}
-      // Check whether there was a pulse into bit 5 of SCALER1.
-      // If so, the 10 ms. timers TIME1 and TIME3 are updated.
-      // Recall that the registers are in AGC integer format,
-      // and therefore are actually shifted left one space.
-      if (0 == (017 & State->InputChannel[ChanSCALER1]))
-	{
-	  State->ExtraDelay++;
-	  if (CounterPINC (&c (RegTIME1)))
-	    {
-	      State->ExtraDelay++;
-	      CounterPINC (&c (RegTIME2));
-	    }
-	  State->ExtraDelay++;
-	  if (CounterPINC (&c (RegTIME3)))
-	    State->InterruptRequests[3] = 1;
-	  // I have very little data about what TIME5 is supposed to do.
-	  // From the table on p. 1-64 of Savage & Drake, I assume
-	  // it works just like TIME3.
-	  State->ExtraDelay++;
-	  if (CounterPINC (&c (RegTIME5)))
-	    State->InterruptRequests[2] = 1;
-	}
-      // TIME4 is the same as TIME3, but 5 ms. out of phase.
-      if (010 == (017 & State->InputChannel[ChanSCALER1]))
-	{
-	  State->ExtraDelay++;
-	  if (CounterPINC (&c (RegTIME4)))
-	    State->InterruptRequests[4] = 1;
-	}
-      // I'm not sure if TIME6 is supposed to count when the T6 RUPT
-      // is disabled or not.  For the sake of argument, I'll assume
-      // that it is.  Nor am I sure how many bits this counter has.
-      // I'll assume 14.  Nor if it's out of phase with SCALER1.
-      // Nor ... well, you get the idea.
-      State->ExtraDelay++;
-      if (CounterDINC (State, 0, &c (RegTIME6)))
-	if (040000 & State->InputChannel[013])
-	  State->InterruptRequests[1] = 1;
+      ScalerTick (State);
       // Return, so as to account for the time occupied by updating the
       // counters.
+      State->CycleClass = CYCLE_COUNTER;
       return (0);
     }
 
@@ -1662,16 +2392,16 @@ agc_engine (agc_t * State)
 
 #ifdef GYRO_TIMING_SIMULATED
   // Update the 3200 pps gyro pulse counter.
-  GyroTimer += GYRO_DIVIDER;
-  while (GyroTimer >= GYRO_OVERFLOW)
+  State->GyroTimer += GYRO_DIVIDER;
+  while (State->GyroTimer >= GYRO_OVERFLOW)
     {
-      GyroTimer -= GYRO_OVERFLOW;
+      State->GyroTimer -= GYRO_OVERFLOW;
       // We get to this point 3200 times per second.  We increment the 
       // pulse count only if the GYRO ACTIVITY bit in channel 014 is set.
       if (0 != (State->InputChannel[014] & 01000) &&
           State->Erasable[0][RegGYROCTR] > 0)
 	{
-          GyroCount++;
+          State->GyroCount++;
 	  State->Erasable[0][RegGYROCTR]--;
 	  if (State->Erasable[0][RegGYROCTR] == 0)
 	    State->InputChannel[014] &= ~01000;
@@ -1681,11 +2411,11 @@ agc_engine (agc_t * State)
   // If 1/4 second (nominal gyro pulse count of 800 decimal) or the gyro 
   // bits in channel 014 have changed, output to channel 0177.
   i = (State->InputChannel[014] & 01740);  // Pick off the gyro bits.
-  if (i != OldChannel14 || GyroCount >= 800)
+  if (i != State->OldChannel14 || State->GyroCount >= 800)
     {
-      j = ((OldChannel14 & 0740) << 6) | GyroCount;
-      OldChannel14 = i;
-      GyroCount = 0;
+      j = ((State->OldChannel14 & 0740) << 6) | State->GyroCount;
+      State->OldChannel14 = i;
+      State->GyroCount = 0;
       ChannelOutput (State, 0177, j);
     }
 #else // GYRO_TIMING_SIMULATED
@@ -1696,32 +2426,32 @@ agc_engine (agc_t * State)
       {
         // If any torquing is still pending, do it all at once before
 	// setting up a new torque counter.
-        while (GyroCount)
+        while (State->GyroCount)
 	  {
-	    j = GyroCount;
+	    j = State->GyroCount;
 	    if (j > 03777)
 	      j = 03777;
-	    ChannelOutput (State, 0177, OldChannel14 | j);
-	    GyroCount -= j;
+	    ChannelOutput (State, 0177, State->OldChannel14 | j);
+	    State->GyroCount -= j;
 	  }
 	// Set up new torque counter.
-	GyroCount = State->Erasable[0][RegGYROCTR];
+	State->GyroCount = State->Erasable[0][RegGYROCTR];
 	State->Erasable[0][RegGYROCTR] = 0;
-	OldChannel14 = ((State->InputChannel[014] & 0740) << 6);
-	GyroTimer = GYRO_OVERFLOW * GYRO_BURST - GYRO_DIVIDER;
+	State->OldChannel14 = ((State->InputChannel[014] & 0740) << 6);
+	State->GyroTimer = GYRO_OVERFLOW * GYRO_BURST - GYRO_DIVIDER;
       }
   // Update the 3200 pps gyro pulse counter.
-  GyroTimer += GYRO_DIVIDER;
-  while (GyroTimer >= GYRO_BURST * GYRO_OVERFLOW)
+  State->GyroTimer += GYRO_DIVIDER;
+  while (State->GyroTimer >= GYRO_BURST * GYRO_OVERFLOW)
     {
-      GyroTimer -= GYRO_BURST * GYRO_OVERFLOW;
-      if (GyroCount)
+      State->GyroTimer -= GYRO_BURST * GYRO_OVERFLOW;
+      if (State->GyroCount)
         {
-	  j = GyroCount;
+	  j = State->GyroCount;
 	  if (j > GYRO_BURST2)
 	    j = GYRO_BURST2;
-	  ChannelOutput (State, 0177, OldChannel14 | j);
-	  GyroCount -= j;
+	  ChannelOutput (State, 0177, State->OldChannel14 | j);
+	  State->GyroCount -= j;
 	}
     }
 #endif // GYRO_TIMING_SIMULATED
@@ -1732,31 +2462,31 @@ agc_engine (agc_t * State)
   
 #if 0  
   i = (State->InputChannel[014] & 070000);	// Check IMU CDU drive bits.
-  if (ImuChannel14 == 0 && i != 0)		// If suddenly active, start drive.
-    ImuCduCount = IMUCDU_BURST_CYCLES;
-  if (i != 0 && ImuCduCount >= IMUCDU_BURST_CYCLES)	// Time for next burst.
+  if (State->ImuChannel14 == 0 && i != 0)		// If suddenly active, start drive.
+    State->ImuCduCount = IMUCDU_BURST_CYCLES;
+  if (i != 0 && State->ImuCduCount >= IMUCDU_BURST_CYCLES)	// Time for next burst.
     {
       // Adjust the cycle counter.
-      ImuCduCount -= IMUCDU_BURST_CYCLES;
+      State->ImuCduCount -= IMUCDU_BURST_CYCLES;
       // Determine how many pulses are wanted on each axis this burst.
-      ImuChannel14 = BurstOutput (State, 040000, RegCDUXCMD, 0174);
-      ImuChannel14 |= BurstOutput (State, 020000, RegCDUYCMD, 0175);
-      ImuChannel14 |= BurstOutput (State, 010000, RegCDUZCMD, 0176);
+      State->ImuChannel14 = BurstOutput (State, 040000, RegCDUXCMD, 0174);
+      State->ImuChannel14 |= BurstOutput (State, 020000, RegCDUYCMD, 0175);
+      State->ImuChannel14 |= BurstOutput (State, 010000, RegCDUZCMD, 0176);
     }
   else
-    ImuCduCount++;
+    State->ImuCduCount++;
 #else // 0
   i = (State->InputChannel[014] & 070000);	// Check IMU CDU drive bits.
-  if (ImuChannel14 == 0 && i != 0)		// If suddenly active, start drive.
-    ImuCduCount = State->CycleCounter - IMUCDU_BURST_CYCLES;
-  if (i != 0 && (State->CycleCounter - ImuCduCount) >= IMUCDU_BURST_CYCLES) // Time for next burst.
+  if (State->ImuChannel14 == 0 && i != 0)		// If suddenly active, start drive.
+    State->ImuCduCount = State->CycleCounter - IMUCDU_BURST_CYCLES;
+  if (i != 0 && (State->CycleCounter - State->ImuCduCount) >= IMUCDU_BURST_CYCLES) // Time for next burst.
     {
       // Adjust the cycle counter.
-      ImuCduCount += IMUCDU_BURST_CYCLES;
+      State->ImuCduCount += IMUCDU_BURST_CYCLES;
       // Determine how many pulses are wanted on each axis this burst.
-      ImuChannel14 = BurstOutput (State, 040000, RegCDUXCMD, 0174);
-      ImuChannel14 |= BurstOutput (State, 020000, RegCDUYCMD, 0175);
-      ImuChannel14 |= BurstOutput (State, 010000, RegCDUZCMD, 0176);
+      State->ImuChannel14 = BurstOutput (State, 040000, RegCDUXCMD, 0174);
+      State->ImuChannel14 |= BurstOutput (State, 020000, RegCDUYCMD, 0175);
+      State->ImuChannel14 |= BurstOutput (State, 010000, RegCDUZCMD, 0176);
     }
 #endif // 0
 
@@ -1795,7 +2525,14 @@ agc_engine (agc_t * State)
   ProgramCounter = c (RegZ);
   // However, since the Z register contains only 12 bits, the address has to
   // be massaged to get a 16-bit address.
-  WhereWord = FindMemoryWord (State, ProgramCounter);
+  WhereWord = LocateMemoryWord (State, ProgramCounter);
+  if (State->NumWatchTraps)
+    {
+      State->WatchZ = ProgramCounter & 07777;
+      State->WatchBB = (CurrentBB & 076007) | (State->OutputChannel7 & 0100);
+    }
+  if (State->CoverageCounts || State->RuptTiming)
+    State->CoverageWord = WhereWord;
 
   // Fetch the instruction itself.
   //Instruction = *WhereWord;
@@ -1812,11 +2549,19 @@ agc_engine (agc_t * State)
       // do if the result has overflow, I can't say.  I arbitrarily 
       // overflow-correct it.
       sExtraCode = State->ExtraCode;
-      Instruction =
-	OverflowCorrected (AddSP16
-			   (SignExtend (State->IndexValue),
-			    SignExtend (*WhereWord)));
-      Instruction &= 077777;
+      if (State->IndexValue == AGC_P0 && PredecodeInstructions)
+	{
+	  // Adding +0 changes nothing, so skip the arithmetic.
+	  Instruction = (*WhereWord & 077777);
+	}
+      else
+        {
+	  Instruction =
+	    OverflowCorrected (AddSP16
+			       (SignExtend (State->IndexValue),
+				SignExtend (*WhereWord)));
+	  Instruction &= 077777;
+	}
       // Handle interrupts.
       if (DebuggerInterruptMasks[0] &&
 	  !State->InIsr && State->AllowInterrupt && !State->ExtraCode &&
@@ -1850,6 +2595,12 @@ agc_engine (agc_t * State)
 	      if (State->InterruptRequests[i] && DebuggerInterruptMasks[i])
 		{
 		  BacktraceAdd (State, i);
+		  State->InterruptCounts[i]++;
+		  if (State->RuptTiming)
+		    RuptTaken (State, i);
+		  if (State->Trace)
+		    TraceInstruction (State, WhereWord, Instruction,
+				      sExtraCode, i);
 		  // Clear the interrupt request.
 		  State->InterruptRequests[i] = 0;
 		  State->InterruptRequests[0] = i;
@@ -1858,7 +2609,8 @@ agc_engine (agc_t * State)
 		  c (RegBRUPT) = Instruction;
 		  // Vector to the interrupt.
 		  State->InIsr = 1;
-		  NextZ = 04000 + 4 * i;
+		  State->NextZ = 04000 + 4 * i;
+		  State->CycleClass = CYCLE_INTERRUPT;
 		  goto AllDone;
 		}
 	    }
@@ -1889,11 +2641,18 @@ agc_engine (agc_t * State)
 	{
 	  State->PendFlag = 1;
 	  State->PendDelay = i;
+	  State->CycleClass = CYCLE_DELAY;
 	  return (0);
 	}
     }
   else
     State->PendFlag = 0;
+  if (State->CoverageCounts)
+    CollectCoverage (State, WhereWord, COVERAGE_INSTRUCTION);
+  if (State->Trace)
+    TraceInstruction (State, WhereWord, Instruction, sExtraCode, 0);
+  if (State->Interpreter)
+    InterpInstruction (State, WhereWord);
 
   // Now that the index value has been used, get rid of it.
   State->IndexValue = AGC_P0;
@@ -1911,18 +2670,21 @@ agc_engine (agc_t * State)
   // memory.)  As a first cut, therefore, I simply increment the thing without 
   // checking for a problem.  (The increment is by 2, since bit 0 is the
   // parity and the address only starts at bit 1.) 
-  NextZ = 1 + c (RegZ);
+  State->NextZ = 1 + c (RegZ);
   // I THINK that the Z register is updated before the instruction executes,
   // which is important if you have an instruction that directly accesses
   // the value in Z.  (I deduce this from descriptions of the TC register,
   // which imply that the contents of Z is directly transferred into Q.)
-  c (RegZ) = NextZ;
+  c (RegZ) = State->NextZ;
 
   // Parse the instruction.  Refer to p.34 of 1689.pdf for an easy 
   // picture of what follows.
   ExtendedOpcode = Instruction >> 9;	//2;
   if (sExtraCode)
     ExtendedOpcode |= 0100;
+  if (State->IdleHead != NULL)
+    IdleProbe (State, ExtendedOpcode, Instruction);
+  State->CycleClass = ExtendedOpcode;
   switch (ExtendedOpcode)
     {
     case 000:			// TC.  
@@ -1950,8 +2712,8 @@ agc_engine (agc_t * State)
 	{
 	  BacktraceAdd (State, 0);
 	  if (ValueK != RegQ)	// If not a RETURN instruction ...
-	    c (RegQ) = 0177777 & NextZ;
-	  NextZ = Address12;
+	    c (RegQ) = 0177777 & State->NextZ;
+	  State->NextZ = Address12;
 	}
       break;
     case 010:			// CCS. 
@@ -1981,16 +2743,16 @@ agc_engine (agc_t * State)
       // incremented.
       if (Address10 < REG16
 	  && ValueOverflowed (0177777 & c (Address10)) == AGC_P1)
-	NextZ += 0;
+	State->NextZ += 0;
       else if (Address10 < REG16
 	       && ValueOverflowed (0177777 & c (Address10)) == AGC_M1)
-	NextZ += 2;
+	State->NextZ += 2;
       else if (Operand16 == AGC_P0)
-	NextZ += 1;
+	State->NextZ += 1;
       else if (Operand16 == AGC_M0)
-	NextZ += 3;
+	State->NextZ += 3;
       else if (0 != (Operand16 & 040000))
-	NextZ += 2;
+	State->NextZ += 2;
       break;
     case 012:			// TCF. 
     case 013:
@@ -2000,7 +2762,7 @@ agc_engine (agc_t * State)
     case 017:
       BacktraceAdd (State, 0);
       // TCF instruction (1 MCT).
-      NextZ = Address12;
+      State->NextZ = Address12;
       // THAT was easy ... too easy ...
       break;
     case 020:			// DAS.
@@ -2076,7 +2838,7 @@ agc_engine (agc_t * State)
 	  else
 	    c (Address10) = Operand16;
 	  if (Address10 == RegZ)
-	    NextZ = c (RegZ);
+	    State->NextZ = c (RegZ);
 	}
       else
 	{
@@ -2192,7 +2954,7 @@ agc_engine (agc_t * State)
 	    BacktraceAdd (State, 255);
 	  else
 	    BacktraceAdd (State, 0);
-	  NextZ = c (RegZRUPT);
+	  State->NextZ = c (RegZRUPT);
 	  State->InIsr = 0;
 #ifdef ALLOW_BSUB
 	  State->SubstituteInstruction = 1;
@@ -2226,7 +2988,7 @@ agc_engine (agc_t * State)
 	  c (Address10) = c (RegL);
 	  c (RegL) = Operand16;
 	  if (Address10 == RegZ)
-	    NextZ = c (RegZ);
+	    State->NextZ = c (RegZ);
 	}
       else
 	{
@@ -2242,7 +3004,7 @@ agc_engine (agc_t * State)
 	  c (Address10 - 1) = c (RegA);
 	  c (RegA) = Operand16;
 	  if (Address10 == RegZ + 1)
-	    NextZ = c (RegZ);
+	    State->NextZ = c (RegZ);
 	}
       else
 	{
@@ -2257,17 +3019,18 @@ agc_engine (agc_t * State)
       if (IsA (Address10))	// OVSK
 	{
 	  if (Overflow)
-	    NextZ += AGC_P1;
+	    State->NextZ += AGC_P1;
 	}
       else if (IsZ (Address10))	// TCAA
 	{
-	  NextZ = (077777 & Accumulator);
+	  State->NextZ = (077777 & Accumulator);
 	  if (Overflow)
 	    c (RegA) = SignExtend (ValueOverflowed (Accumulator));
 	}
       else			// Not OVSK or TCAA.
 	{
-	  WhereWord = FindMemoryWord (State, Address10);
+	  // TS only writes, so it's no read as far as the watch traps go.
+	  WhereWord = LocateMemoryWord (State, Address10);
 	  if (Address10 < REG16)
 	    c (Address10) = Accumulator;
 	  else
@@ -2276,7 +3039,7 @@ agc_engine (agc_t * State)
 	  if (Overflow)
 	    {
 	      c (RegA) = SignExtend (ValueOverflowed (Accumulator));
-	      NextZ += AGC_P1;
+	      State->NextZ += AGC_P1;
 	    }
 	}
       break;
@@ -2289,7 +3052,7 @@ agc_engine (agc_t * State)
 	  c (RegA) = c (Address10);
 	  c (Address10) = Accumulator;
 	  if (Address10 == RegZ)
-	    NextZ = c (RegZ);
+	    State->NextZ = c (RegZ);
 	  break;
 	}
       WhereWord = FindMemoryWord (State, Address10);
@@ -2417,7 +3180,7 @@ agc_engine (agc_t * State)
 	  printf ("EDRUPT w/o ISR %d\n", ++Count);
 	}
 #endif // 0
-      NextZ = 0;
+      State->NextZ = 0;
       break;
     case 0110:			// DV
     case 0111:
@@ -2510,7 +3273,7 @@ agc_engine (agc_t * State)
       if (Accumulator == 0 || Accumulator == 0177777)
 	{
 	  BacktraceAdd (State, 0);
-	  NextZ = Address12;
+	  State->NextZ = Address12;
 	}
       break;
     case 0120:			// MSU
@@ -2555,7 +3318,7 @@ agc_engine (agc_t * State)
 	  c (RegQ) = c (Address10);
 	  c (Address10) = Operand16;
 	  if (Address10 == RegZ)
-	    NextZ = c (RegZ);
+	    State->NextZ = c (RegZ);
 	}
       else
 	{
@@ -2703,7 +3466,7 @@ agc_engine (agc_t * State)
       if (Accumulator == 0 || 0 != (Accumulator & 0100000))
 	{
 	  BacktraceAdd (State, 0);
-	  NextZ = Address12;
+	  State->NextZ = Address12;
 	}
       break;
     case 0170:			// MP
@@ -2769,7 +3532,7 @@ AllDone:
     {
       c (RegZERO) = AGC_P0;
       State->InputChannel[7] = State->OutputChannel7 &= 0160;
-      c (RegZ) = NextZ;
+      c (RegZ) = State->NextZ;
       if (!KeepExtraCode)
 	State->ExtraCode = 0;
       // Values written to EB and FB are automatically mirrored to BB,
@@ -2784,7 +3547,369 @@ AllDone:
       c (RegEB) &= 03400;
       c (RegFB) &= 076000;
       c (RegBB) &= 076007;
+      if (IdleSkip)
+        IdleBranch (State, ProgramCounter);
     }
   return (0);
 }
 
+
+//-----------------------------------------------------------------------------
+// Fast-forward through whole passes of an idle loop just confirmed by 
+// IdleBranch, without going past Limit machine cycles.  (Refer to the notes
+// preceding IdleProbe.)  CPU execution is at the top of the loop.  Returns 
+// the number of machine cycles skipped.
+
+static uint64_t
+IdleFastForward (agc_t * State, uint64_t Limit)
+{
+#ifdef GYRO_TIMING_SIMULATED
+  return (0);
+#else
+  uint64_t Skipped = 0, SavedCycleCounter;
+  int i, j, SavedScalerCounter, SavedChannelRoutineCount, SavedCduChecker;
+  int SavedExtraDelay;
+  unsigned SavedGyroTimer;
+  int16_t SavedScalers[2], SavedTimers[RegTIME6 - RegTIME2 + 1];
+
+  // Per-cycle activities that would interfere, or watch traps, coverage
+  // counts, interrupt timing, or a trace that would be skipped over.
+  if (State->NumWatchTraps || State->CoverageCounts || State->RuptTiming ||
+      State->Trace ||
+      State->GyroCount || State->CduFifos[0].Size || State->CduFifos[1].Size || State->CduFifos[2].Size ||
+      State->BulkSize ||
+      0 != (State->InputChannel[014] & 070000) ||
+      (0 != (State->InputChannel[014] & 01000) && 
+       0 != State->Erasable[0][RegGYROCTR]) ||
+      (State->Erasable[0][RegOPTX] && 0 != (State->InputChannel[014] & 02000)) ||
+      (State->Erasable[0][RegOPTY] && 0 != (State->InputChannel[014] & 04000)) ||
+      IdleInterruptRequested (State))
+    return (0);
+
+  while (Skipped + State->IdleCycles <= Limit)
+    {
+      if (State->ScalerCounter + SCALER_DIVIDER * State->IdleCycles < SCALER_OVERFLOW)
+        {
+	  // No counter-timer updates fall due during this pass, so all the
+	  // counts can be updated at once.
+	  Skipped += State->IdleCycles;
+	  State->CycleCounter += State->IdleCycles;
+	  State->ScalerCounter += SCALER_DIVIDER * State->IdleCycles;
+	  State->ChannelRoutineCount = ((State->ChannelRoutineCount + State->IdleCycles) & 017777);
+	  State->CduChecker = (State->CduChecker + State->IdleEligible) % NUM_CDU_FIFOS;
+	  State->GyroTimer = (State->GyroTimer + GYRO_DIVIDER * State->IdleEligible) 
+	  	      % (GYRO_BURST * GYRO_OVERFLOW);
+	  continue;
+	}
+      // Otherwise, step through the pass a cycle at a time, exactly as 
+      // agc_engine_run and CpuCycle would, but be ready to back out of it.
+      SavedCycleCounter = State->CycleCounter;
+      SavedScalerCounter = State->ScalerCounter;
+      SavedChannelRoutineCount = State->ChannelRoutineCount;
+      SavedCduChecker = State->CduChecker;
+      SavedGyroTimer = State->GyroTimer;
+      SavedExtraDelay = State->ExtraDelay;
+      SavedScalers[0] = State->InputChannel[ChanSCALER1];
+      SavedScalers[1] = State->InputChannel[ChanSCALER2];
+      memcpy (SavedTimers, &c (RegTIME2), sizeof (SavedTimers));
+      for (i = j = 0; i < State->IdleCycles; j++)
+        {
+	  State->CycleCounter++;
+	  State->ScalerCounter += SCALER_DIVIDER;
+	  State->ChannelRoutineCount = ((State->ChannelRoutineCount + 1) & 017777);
+	  if (State->ExtraDelay)
+	    {
+	      State->ExtraDelay--;
+	      continue;
+	    }
+	  if (!State->IdlePattern[i])
+	    {
+	      i++;			// PendDelay cycle.
+	      continue;
+	    }
+	  if (++State->CduChecker >= NUM_CDU_FIFOS)
+	    State->CduChecker = 0;
+	  if (State->ScalerCounter >= SCALER_OVERFLOW)
+	    {
+	      ScalerTick (State);
+	      continue;
+	    }
+	  State->GyroTimer += GYRO_DIVIDER;
+	  if (State->GyroTimer >= GYRO_BURST * GYRO_OVERFLOW)
+	    State->GyroTimer -= GYRO_BURST * GYRO_OVERFLOW;
+	  i++;
+	}
+      if (Skipped + j > Limit || IdleInterruptRequested (State))
+        {
+	  // Back out.  The pass will be simulated normally.
+	  State->CycleCounter = SavedCycleCounter;
+	  State->ScalerCounter = SavedScalerCounter;
+	  State->ChannelRoutineCount = SavedChannelRoutineCount;
+	  State->CduChecker = SavedCduChecker;
+	  State->GyroTimer = SavedGyroTimer;
+	  State->ExtraDelay = SavedExtraDelay;
+	  State->InputChannel[ChanSCALER1] = SavedScalers[0];
+	  State->InputChannel[ChanSCALER2] = SavedScalers[1];
+	  memcpy (&c (RegTIME2), SavedTimers, sizeof (SavedTimers));
+	  for (i = 1; i <= 4; i++)
+	    State->InterruptRequests[i] = 0;
+	  break;
+	}
+      Skipped += j;
+    }
+  return (Skipped);
+#endif // GYRO_TIMING_SIMULATED
+}
+
+//-----------------------------------------------------------------------------
+// Count how many of the upcoming machine cycles are "quiet", in the sense that
+// none of the bookkeeping done at the top of a cycle by agc_engine_run() --- 
+// DOWNRUPT requests, --debug-deda monitoring, and socket service by 
+// ChannelRoutine() --- can possibly be due during them.  If ChannelInput() is
+// SocketAPI.c's (State->InputInterlaced), it would have nothing to do in
+// them either:  no input from the sockets is already waiting to be 
+// processed, and the sockets aren't due to be polled (every 
+// SocketInterlaceReload cycles).  When replaying, the next replayed input
+// must not be due during them either.  Idle loops are fast-forwarded only
+// through quiet cycles.  The count never exceeds Budget.
+
+static uint64_t
+CountQuietCycles (agc_t * State, uint64_t Budget)
+{
+  uint64_t Cycles;
+  if (Budget == 0 || State->DedaMonitor || State->SocketInputPending)
+    return (0);
+  // Cycles until ChannelRoutineCount is back to 0.
+  Cycles = (020000 - State->ChannelRoutineCount) & 017777;
+  if (State->DownruptTimeValid)
+    {
+      if (State->DownruptTime <= State->CycleCounter)
+        return (0);
+      if (State->DownruptTime - State->CycleCounter < Cycles)
+        Cycles = State->DownruptTime - State->CycleCounter;
+    }
+  if (State->InputLog.Replay != NULL)
+    {
+      if (State->InputLog.NextCycle <= State->CycleCounter + 1)
+        return (0);
+      if (State->InputLog.NextCycle - State->CycleCounter - 1 < Cycles)
+        Cycles = State->InputLog.NextCycle - State->CycleCounter - 1;
+    }
+  else if (!State->Headless && State->Clients != NULL
+	   && (uint64_t) State->SocketInterlace < Cycles)
+    Cycles = State->SocketInterlace;
+  if (Cycles > Budget)
+    Cycles = Budget;
+  return (Cycles);
+}
+
+//-----------------------------------------------------------------------------
+// The bookkeeping at the top of every machine cycle, before input is taken
+// and the CPU proper (CpuCycle) runs.
+
+static inline void
+CycleBookkeeping (agc_t * State)
+{
+  // For DOWNRUPT
+  if (State->DownruptTimeValid && State->CycleCounter >= State->DownruptTime)
+    {
+      State->InterruptRequests[8] = 1;	// Request DOWNRUPT
+      State->DownruptTimeValid = 0;
+    }
+
+  State->CycleCounter++;
+
+  //----------------------------------------------------------------------
+  // The following little thing is useful only for debugging yaDEDA with
+  // the --debug-deda command-line switch.  It just outputs the contents
+  // of the address that was specified by the DEDA at 1/2 second intervals.
+  if (State->DedaMonitor && State->CycleCounter >= State->DedaWhen)
+    {
+      int16_t Data;
+      Data = State->Erasable[0][State->DedaAddress];
+      State->DedaWhen = State->CycleCounter + 1024000 / 24;	// 1/2 second.
+      ShiftToDeda (State, (State->DedaAddress >> 6) & 7);
+      ShiftToDeda (State, (State->DedaAddress >> 3) & 7);
+      ShiftToDeda (State, State->DedaAddress & 7);
+      ShiftToDeda (State, 0);
+      ShiftToDeda (State, (Data >> 12) & 7);
+      ShiftToDeda (State, (Data >> 9) & 7);
+      ShiftToDeda (State, (Data >> 6) & 7);
+      ShiftToDeda (State, (Data >> 3) & 7);
+      ShiftToDeda (State, Data & 7);
+    }
+
+  //----------------------------------------------------------------------
+  // Update the thingy that determines when 1/1600 second has passed.
+  // 1/1600 is the basic timing used to drive timer registers.  1/1600
+  // second happens to be 160/3 machine cycles.
+
+  State->ScalerCounter += SCALER_DIVIDER;
+
+  //-------------------------------------------------------------------------
+
+  // Handle server stuff for socket connections used for i/o channel
+  // communications.  Stuff like listening for clients we only do
+  // every once and a while---nominally, every 100 ms.  Actually 
+  // processing input data is done every cycle.
+  if (State->ChannelRoutineCount == 0)
+    ChannelRoutine (State);
+  State->ChannelRoutineCount = ((State->ChannelRoutineCount + 1) & 017777);
+}
+
+// The profiling and the like that follows a machine cycle, if any of it is
+// turned on.  Hook is State->CycleHook.
+
+static void
+CycleInstruments (agc_t * State,
+		  void (*Hook) (agc_t *State, int Class, uint64_t Cycles))
+{
+  if (Hook != NULL)
+    Hook (State, State->CycleClass, 1);
+  if (State->CoverageCounts)
+    CollectCycle (State);
+  if (State->LoadAccounting)
+    State->LoadCycles[LoadClass (State)]++;
+  if (State->RuptTiming)
+    RuptCycle (State);
+}
+
+//-----------------------------------------------------------------------------
+// Execute up to MaxCycles machine cycles of the simulation in a tight loop.
+// Use agc_engine_init prior to the first call, to initialize State.  This is
+// exactly equivalent to calling agc_engine MaxCycles times, but in quiet 
+// cycles (see CountQuietCycles) the bookkeeping is skipped:  only the cycle
+// counters are updated before ChannelInput() and the CPU proper (CpuCycle)
+// are run.  SocketAPI.c's ChannelInput() is skipped too, since it only polls
+// the sockets every SocketInterlaceReload cycles, unless an in-process host
+// is attached, since its input can be queued at any time (see agc_host.c).
+// Any other ChannelInput(), such as NullAPI.c's, is called every cycle.
+// The CycleHook isn't called with CYCLE_BOOKKEEPING in them either, and the
+// hook and the profiling are only looked at if one of them was turned on
+// when agc_engine_run was called.
+//
+// If IdleSkip is set, passes through idle loops are fast-forwarded (see
+// IdleFastForward) rather than simulated instruction by instruction, with 
+// the same results.  That's only done with SocketAPI.c's ChannelInput(),
+// since no other would be called while fast-forwarding.
+//
+// The loop is also left early if State->RunStop is set during a cycle (for
+// example, by a breakpoint or watchpoint).  RunStop is cleared before 
+// returning.
+//
+// Returns:
+//      The number of machine cycles actually executed.
+
+uint64_t
+agc_engine_run (agc_t * State, uint64_t MaxCycles)
+{
+  uint64_t Cycles;
+  int Input;
+  // Kept locally, so that they needn't be reloaded after every call.
+  void (*Hook) (agc_t *State, int Class, uint64_t Cycles) = State->CycleHook;
+  int Instrumented = (Hook != NULL || State->CoverageCounts
+		      || State->LoadAccounting || State->RuptTiming != NULL);
+
+  State->QuietCycles = 0;
+  for (Cycles = 0; Cycles < MaxCycles; )
+    {
+      Cycles++;
+      if (State->QuietCycles)
+        {
+	  // Nothing can be due, so just keep the counters up to date,
+	  // including the one SocketAPI.c's ChannelInput() would have
+	  // counted down.  An in-process host's queue, or any other 
+	  // ChannelInput(), is still checked every cycle.
+	  State->QuietCycles--;
+	  State->CycleCounter++;
+	  State->ScalerCounter += SCALER_DIVIDER;
+	  State->ChannelRoutineCount = ((State->ChannelRoutineCount + 1) & 017777);
+	  if (State->Host != NULL || !State->InputInterlaced)
+	    Input = ChannelInput (State);
+	  else
+	    {
+	      if (State->SocketInterlace > 0)
+		State->SocketInterlace--;
+	      Input = 0;
+	    }
+	}
+      else
+        {
+	  CycleBookkeeping (State);
+	  if (Hook != NULL)
+	    Hook (State, CYCLE_BOOKKEEPING, 0);
+	  // Get data from input channels.  The rest of the cycle is skipped
+	  // if an unprogrammed counter-increment was performed.
+	  Input = ChannelInput (State);
+	  // ChannelInput() may have left socket input waiting, or turned on
+	  // the DEDA monitor, so this comes after it.
+	  State->QuietCycles = CountQuietCycles (State, MaxCycles - Cycles);
+	}
+
+      // If in --debug-dsky mode, don't want to take the chance of executing
+      // any AGC code, since there isn't any loaded anyway.
+      if (!Input && !DebugDsky)
+	CpuCycle (State);
+      else
+        State->CycleClass = CYCLE_INPUT;
+      if (Instrumented)
+        CycleInstruments (State, Hook);
+
+      // If CpuCycle has just found the CPU at the top of an idle loop, skip
+      // through as much of it as the quiet cycles allow.
+      if (State->IdleConfirmed)
+        {
+	  uint64_t Skipped;
+	  State->IdleConfirmed = 0;
+	  Skipped = 0;
+	  if (State->InputInterlaced)
+	    Skipped = IdleFastForward (State, State->QuietCycles);
+	  State->QuietCycles -= Skipped;
+	  Cycles += Skipped;
+	  if (Hook != NULL && Skipped)
+	    Hook (State, CYCLE_IDLE, Skipped);
+	  if (State->LoadAccounting)
+	    State->LoadCycles[LoadClass (State)] += Skipped;
+	}
+
+      if (State->RunStop)
+        {
+	  State->RunStop = 0;
+	  break;
+	}
+    }
+  State->QuietCycles = 0;
+  return (Cycles);
+}
+
+//-----------------------------------------------------------------------------
+// Execute one machine-cycle of the simulation.  Use agc_engine_init prior to 
+// the first call of agc_engine, to initialize State, and then call agc_engine 
+// thereafter every (simulated) 11.7 microseconds.  (Or call agc_engine_run
+// less often, to execute many cycles at once.)  There are no quiet cycles
+// or idle loops to look for in a single cycle, so this does just what
+// agc_engine_run does in a cycle that isn't quiet.
+//
+// Returns:
+//      0 -- success
+// I'm not sure if there are any circumstances under which this can fail ...
+
+int
+agc_engine (agc_t * State)
+{
+  void (*Hook) (agc_t *State, int Class, uint64_t Cycles) = State->CycleHook;
+
+  CycleBookkeeping (State);
+  if (Hook != NULL)
+    Hook (State, CYCLE_BOOKKEEPING, 0);
+  if (!ChannelInput (State) && !DebugDsky)
+    CpuCycle (State);
+  else
+    State->CycleClass = CYCLE_INPUT;
+  if (Hook != NULL || State->CoverageCounts
+      || State->LoadAccounting || State->RuptTiming != NULL)
+    CycleInstruments (State, Hook);
+  State->IdleConfirmed = 0;
+  State->RunStop = 0;
+  return (0);
+}
@@ -88,6 +88,66 @@
 		03/30/09 RSB	Moved Downlink from CpuWriteIO() local variable
 				to agc_t.
 		04/07/09 RSB	Added ProcessDownlinkList and ProcessDownlinkList_t.
+		2026-10-17	Added agc_engine_run() and agc_t RunStop.
+		2026-10-17	Added IdleSkip.
+		2026-10-17	Added PredecodeInstructions.
+		2026-10-17	Moved the engine's and SocketAPI.c's 
+				per-CPU state into agc_t, so that several
+				agc_t can run in one process.  Fixed is now
+				a pointer, so that CPUs loaded with the same
+				rope can share it.
+		2026-10-17	Added Pacer_t.
+		2026-10-17	Added the binary core-dump (snapshot) functions.
+		2026-10-17	Added input buffers to Client_t.
+		2026-10-17	Added output buffers and subscriptions to
+				Client_t.
+		2026-10-17	Noted that yaAGC's backtraces no longer use
+				BacktracePoint_t.
+		2026-10-17	Added watch traps to agc_t.
+		2026-10-17	Moved the coverage counts here from agc_engine.c,
+				and added instruction and cycle counts for fixed
+				memory.
+		2026-10-17	Added load accounting to agc_t.
+		2026-10-17	Added AcceptInput, and the recording and
+				replay of input (InputLog_t).
+		2026-10-17	Added the machine-cycle classes and CycleHook,
+				and Headless.
+		2026-10-17	Added Host, for in-process peripherals.
+		2026-10-17	Added SharedMemory and Client_t.Shm.
+		2026-10-17	Added bulk counter increments (BULK_*).
+		2026-10-17	Added the counters for agc_stats.c:  the
+				traffic of each Client_t, interrupts taken,
+				the pacer's latest and worst jitter and
+				backlog, and SnapshotStats.
+		2026-10-17	Added RuptTiming_t, for interrupt latency.
+		2026-10-17	Added Trace_t and TraceRecord_t, for the
+				binary instruction trace.
+		2026-10-17	Added Interpreter_t and InterpRecord_t, for
+				counting and tracing interpretive
+				instructions.
+		2026-10-17	Moved the predecoded instructions into agc_t.
+		2026-10-17	Moved the coverage counts (now Coverage_t),
+				CycleHook, the DEDA monitor, the --debug-dsky
+				channel values, and the backtraces into agc_t.
+		2026-10-17	Added BacktraceStep, BacktraceLength,
+				BacktraceRun, and BacktraceRewind.
+		2026-10-17	Added NUM_FIXED_BANKS.
+		2026-10-17	Input recordings begin with a snapshot
+				(agc_restore_snapshot, WriteSnapshotFile).
+		2026-10-17	Added BeginInputRecord and BeginInputReplay,
+				so that opening a recording, with its snapshot,
+				needn't be in agc_input.c.
+		2026-10-17	The predecoded instructions are now one fixed
+				table, shared by every agc_t, rather than
+				being in agc_t.
+		2026-10-17	CycleHook isn't called with CYCLE_BOOKKEEPING
+				in quiet cycles.
+		2026-10-17	Every watch trap that fires is recorded, in
+				WatchHits, rather than just the first.
+		2026-10-17	Removed DecodedInstruction_t.
+		2026-10-17	Each interpretive switch instruction is
+				counted on its own (INTERP_SWITCH).
+		2026-10-17	Added InputInterlaced.
    
   For more insight, I'd highly recommend looking at the documents
   http://hrst.mit.edu/hrs/apollo/public/archive/1689.pdf and
@@ -134,6 +194,7 @@ extern long random (void);
 //#include <sys/types.h>
 #include <stdint.h>
 #endif // WIN32
+#include <stdio.h>
 
 // For socket connections.
 #ifdef WIN32
@@ -228,6 +289,16 @@ extern long random (void);
 
 #define NUM_INTERRUPT_TYPES 10
 
+// The number of fixed-memory banks the AGC can address, including the
+// superbanks 040-047 (see agc_t Fixed).
+#define NUM_FIXED_BANKS 050
+
+// Classes of machine cycles for load accounting (see agc_t LoadCycles):  a 
+// job, interrupts 1 through NUM_INTERRUPT_TYPES, or idling.
+#define LOAD_JOB 0
+#define LOAD_IDLE (NUM_INTERRUPT_TYPES + 1)
+#define LOAD_CLASSES (NUM_INTERRUPT_TYPES + 2)
+
 // Max number of 15-bit words in a downlink-telemetry list.
 #define MAX_DOWNLINK_LIST 260
 
@@ -282,12 +353,247 @@ typedef struct {
 // A type of function for processing downlink lists.
 typedef void ProcessDownlinkList_t (const DownlinkListSpec_t *Spec);
 
+// A connection to a peripheral, such as a DSKY.  Input from it is read
+// into a ring buffer; InputTail - InputHead bytes of it are unprocessed.
+#define CLIENT_INPUT_SIZE 512	// Must be a power of 2.
+#define CLIENT_OUTPUT_SIZE 1024
+#define SUBSCRIBE_CHANNEL 0377	// For u-bit packets; see SocketAPI.c.
+// A u-bit packet for a counter (channel 0x80 plus the counter register)
+// asks for a whole run of unprogrammed increments of it, rather than the
+// one that a normal packet asks for.  The value is BULK_PINC, BULK_PCDU, or
+// BULK_PCDU_FAST, optionally plus BULK_DIRECT, plus a 12-bit two's-
+// complement count which is negative for MINC or MCDU.  AcceptInput tells
+// these from normal increments by BULK_INCREMENT.  See BulkIncrement.
+#define BULK_COUNT_MASK 07777
+#define BULK_PINC 000000
+#define BULK_PCDU 010000
+#define BULK_PCDU_FAST 020000
+#define BULK_KIND_MASK 030000
+#define BULK_DIRECT 040000	// Apply them all at once.
+#define BULK_INCREMENT 0100000
+// Client_t.Socket for a peripheral connected through Shm instead.
+#define SHM_SOCKET (-2)
+typedef struct
+{
+  int Socket;
+  struct ShmLink *Shm;		// With SharedMemory; see agc_shm.c.
+  unsigned char Packet[4];
+  int Size;
+  unsigned char Input[CLIENT_INPUT_SIZE];
+  unsigned InputHead, InputTail;
+  // Output waiting to be sent to it, and the channels it wants.
+  unsigned char Output[CLIENT_OUTPUT_SIZE];
+  int OutputSize;
+  int Subscribing;
+  unsigned char Subscribed[0x200 / 8];
+  int ChannelMasks[256];
+  // Traffic since it connected, for agc_stats.c.  BadPackets counts
+  // packets that were malformed or were cut short by a stray byte, and
+  // DroppedPackets those discarded because it wasn't keeping up.
+  uint64_t PacketsIn, BytesIn, PacketsOut, BytesOut;
+  uint64_t BadPackets, DroppedPackets;
+  //int DedaBufferCount;
+  //int DedaBufferWanted;
+  //int DedaBufferReadout;
+  //int DedaBufferDefault;
+  //int DedaBuffer[9];
+} Client_t;
+
+// The FIFOs in which CDU counter increments await application (see
+// agc_engine.c).
+#define MAX_CDU_FIFO_ENTRIES 128
+#define NUM_CDU_FIFOS 3			// Increase to 5 to include OPTX, OPTY.
+typedef struct {
+  int Ptr;				// Index of next entry being pulled.
+  int Size;				// Number of entries.
+  int IntervalType;			// 0,1,2,0,1,2,...
+  uint64_t NextUpdate;			// Cycle count at which next counter update occurs.
+  int Counts[MAX_CDU_FIFO_ENTRIES];
+} CduFifo_t;
+
+// Bulk counter increments waiting to be applied, one per machine cycle
+// (see BulkIncrement).
+#define MAX_BULK_ENTRIES 32
+typedef struct {
+  int Counter;
+  int IncType;
+  int Count;
+} BulkEntry_t;
+
+// Recording and replay of the input from peripherals (see agc_input.c).
+// While Record is open, every input accepted is written to it.  While
+// Replay is open, the input comes from it instead of from ChannelInput,
+// the next input being due at NextCycle; NextChannel is -1 if the replay
+// ends then instead, after which Replay is closed and Finished is set.
+#define INPUT_LOG_MAGIC "yaAGCi2"
+typedef struct {
+  FILE *Record;
+  FILE *Replay;
+  uint64_t RecordCycle;			// Of the last input written.
+  uint64_t NextCycle;
+  int NextChannel, NextValue;
+  int Finished;
+} InputLog_t;
+
+// Backward-branch targets being considered as idle loops (see agc_engine.c).
+#define IDLE_CANDIDATES 16		// Must be a power of 2.
+#define MAX_IDLE_INSTRUCTIONS 64
+#define MAX_IDLE_CYCLES (MAX_IDLE_INSTRUCTIONS * 7)
+typedef struct {
+  int Valid;
+  int Cooldown;				// Arrivals to ignore after a failed check.
+  uint16_t Z;
+  int16_t BB, Channel7, A, L, Q;
+} IdleCandidate_t;
+
+// Watch traps on words of erasable memory (see agc_engine.c).  The modes
+// can be combined.  WATCH_READ fires when an instruction reads the word,
+// WATCH_WRITE on any write to it, and WATCH_CHANGE on a write that changes
+// its value.
+#define WATCH_READ 1
+#define WATCH_WRITE 2
+#define WATCH_CHANGE 4
+typedef struct {
+  int Mode;				// The WATCH_xxx that fired, or 0 if none.
+  int Bank, Offset;			// The erasable word.
+  int16_t Old, New;			// Its value before and after.
+  int Z, BB;				// The instruction, or Z = -1 for a counter.
+} WatchHit_t;
+// The most words whose traps can fire between two looks at agc_t WatchHits;
+// an instruction touches at most a few, plus any counters incremented.
+#define MAX_WATCH_HITS 8
+
+// Coverage counts, for structural coverage analysis and for profiling (see
+// agc_profile.c), collected while agc_t CoverageCounts is set, into the
+// Coverage_t that StartCoverage has given agc_t Coverage.  Fixed banks
+// 040-047 are the superbanks (030-037 with the superbank bit set).  Every
+// machine cycle is charged to the instruction being executed, or to the one
+// most recently executed if the cycle went to something else, such as a
+// counter increment.
+typedef struct Coverage {
+  unsigned ErasableReadCounts[8][0400];
+  unsigned ErasableWriteCounts[8][0400];
+  unsigned ErasableInstructionCounts[8][0400];
+  unsigned FixedAccessCounts[NUM_FIXED_BANKS][02000];	// Reads of constants.
+  unsigned FixedInstructionCounts[NUM_FIXED_BANKS][02000];
+  uint64_t ErasableCycleCounts[8][0400];
+  uint64_t FixedCycleCounts[NUM_FIXED_BANKS][02000];
+  unsigned IoReadCounts[01000];
+  unsigned IoWriteCounts[01000];
+} Coverage_t;
+
+// Interrupt latency and lockout (see agc_rupt.c), kept while agc_t
+// RuptTiming points to one of these.  Requested is the machine cycle in
+// which each pending interrupt was requested, or 0.  When it's taken, the
+// cycles it waited go into Latency:  bucket 0 for none, bucket i for
+// 2**(i-1) to 2**i - 1 cycles.  Every machine cycle in which interrupts are
+// inhibited (by INHINT), and every one in which a requested interrupt is
+// kept waiting for any reason, is charged to the word being executed
+// (fixed banks 040-047 being the superbanks, as for Coverage_t).
+#define RUPT_BUCKETS 24
+typedef struct RuptTiming {
+  uint64_t Requested[1 + NUM_INTERRUPT_TYPES];
+  uint64_t Taken[1 + NUM_INTERRUPT_TYPES];
+  uint64_t TotalLatency[1 + NUM_INTERRUPT_TYPES];
+  uint64_t MaxLatency[1 + NUM_INTERRUPT_TYPES];
+  unsigned Latency[1 + NUM_INTERRUPT_TYPES][RUPT_BUCKETS];
+  uint64_t StartCycle;
+  uint64_t InhibitedCycles, WaitingCycles;
+  unsigned InhibitedErasable[8][0400], WaitingErasable[8][0400];
+  unsigned InhibitedFixed[NUM_FIXED_BANKS][02000], WaitingFixed[NUM_FIXED_BANKS][02000];
+} RuptTiming_t;
+
+// A binary instruction trace (see agc_trace.c), kept while agc_t Trace
+// points to one of these.  For each instruction executed, and each
+// interrupt taken, the CPU's thread puts a TraceRecord_t into Ring, and a
+// thread in agc_trace.c takes them out and writes them to the file.  Head
+// and Tail count the records put in and taken out; only the CPU's thread
+// changes Head, and only the writer changes Tail, so the ring needs no
+// lock.  If it's full, the CPU waits (and counts a stall) rather than
+// losing records.  Addresses are "trace addresses":  bank * 0400 + offset
+// for erasable memory, and 04000 + bank * 02000 + offset for fixed memory
+// (040-047 being the superbanks, as for Coverage_t).  Only the
+// instructions in the words marked in InRange are recorded, if any are,
+// and nothing is recorded until the trigger:  StartAddress reached (if
+// not -1), at or after StartCycle.  After Limit records (if not 0), the
+// recording stops.
+#define TRACE_RING_SIZE 0400000	// Records; a power of 2.
+#define TRACE_ADDRESSES (04000 + NUM_FIXED_BANKS * 02000)
+// TraceRecord_t Flags.
+#define TRACE_EXTRACODE 0001	// The instruction is an extracode.
+#define TRACE_SUPERBANK 0002	// Channel 7's superbank bit was set.
+#define TRACE_ISR 0004		// In an interrupt-service routine.
+#define TRACE_INHINT 0010	// Interrupts were inhibited.
+#define TRACE_SUBSTITUTE 0020	// The instruction was restored by RESUME.
+typedef struct TraceRecord {
+  uint64_t Cycle;			// The machine cycle.
+  uint16_t Z, BB;			// Where the instruction was.
+  uint16_t Instruction;			// As indexed.
+  uint16_t A, L, Q;			// Before the instruction.
+  uint16_t Index;			// The INDEX in effect, if any.
+  uint8_t Cause;			// The interrupt vectored to, or 0.
+  uint8_t Flags;			// TRACE_xxx.
+} TraceRecord_t;
+typedef struct Trace {
+  TraceRecord_t Ring[TRACE_RING_SIZE];
+  uint64_t Head, Tail;
+  uint64_t Records, Stalls;
+  int Triggered, Ranged;
+  int StartAddress;
+  uint64_t StartCycle;
+  uint64_t Limit;
+  unsigned char InRange[TRACE_ADDRESSES];
+} Trace_t;
+
+// Interpretive instructions (see agc_interp.c), counted while agc_t
+// Interpreter points to one of these.  Four places in the interpreter,
+// found in the symbol table, are watched:  NEWOPS, where an op code pair
+// is picked up (from LOC, in the bank in BANKSET), OPJUMP, where an op
+// code in A is dispatched, DOSTORE, where a store code in A is dispatched,
+// and CHANG2 (if found), where an interpretive job gives way to another
+// job.  Each dispatch is counted in Counts, by code and by whether MODE
+// was vector, and in Uses, by the trace address (see Trace_t) of the word
+// holding the code.  The machine cycles from it to the next dispatch are
+// charged to it in Cycles and UseCycles, except after EXIT or CHANG2.
+// While Tracing, a record of each dispatch is also put into Buffer, for
+// agc_interp.c to take out between runs of the CPU; if it's full, the
+// record is counted in Lost instead.  The switch instructions (BON, SET,
+// and so on), which all have op code 0162, are told apart by bits 5-8 of
+// their first operand, and are counted as codes INTERP_SWITCH and up.
+#define INTERP_CODES 0230		// 0200 op codes, 8 store, 16 switch.
+#define INTERP_STORE 0200
+#define INTERP_SWITCH 0210
+#define INTERP_SWITCH_OP 0162
+#define INTERP_BUFFER_SIZE 010000
+typedef struct InterpRecord {
+  uint64_t Cycle;			// The machine cycle of the dispatch.
+  int Location;				// The trace address of the code.
+  uint16_t Code;			// As for Counts.
+  uint16_t Operands[2];			// From after LOC; see agc_engine.c.
+  uint16_t Fixloc;			// The job's work area.
+  uint8_t Vector;			// MODE was vector.
+} InterpRecord_t;
+typedef struct Interpreter {
+  int16_t *Newops, *Opjump, *Dostore, *Chang2;	// NULL if not found.
+  int Loc, Bankset, Mode, Fixloc;	// Erasable, as bank * 0400 + offset.
+  int Pair;				// Last op code pair, or -1.
+  int Running, Code, Vector, Location;	// The dispatch being timed.
+  uint64_t Started;
+  uint64_t StartCycle, Dispatches;
+  uint64_t Counts[2][INTERP_CODES], Cycles[2][INTERP_CODES];
+  unsigned Uses[TRACE_ADDRESSES];
+  uint64_t UseCycles[TRACE_ADDRESSES];
+  int Tracing, Buffered;
+  uint64_t Lost;
+  InterpRecord_t Buffer[INTERP_BUFFER_SIZE];
+} Interpreter_t;
+
 //--------------------------------------------------------------------------
 // Each instance of the AGC CPU simulation has a data structure of type agc_t
 // that contains the CPU's internal states, the complete memory space, and any
 // other little handy items needed to track execution by the CPU.
 
-typedef struct
+typedef struct agc_s
 {
   // The following variable counts the total number of clock cycles since
   // CPU-startup.  A 64-bit integer is used, because with a 32-bit integer 
@@ -300,8 +606,10 @@ typedef struct
   int16_t Erasable[8][0400];	// Banks 0,1,2 are "unswitched erasable".
   // There are actually only 36 (0-043) fixed banks, but the calculation of bank
   // numbers by the AGC can theoretically go 0-39 (0-047).  Therefore, I
-  // provide some extra.
-  int16_t Fixed[40][02000];	// Banks 2,3 are "fixed-fixed".
+  // provide some extra.  Since fixed memory never changes, it's kept outside
+  // of agc_t, and is shared by all of the CPUs loaded from the same rope
+  // (see agc_load_binfile).  Fixed points to 40 banks.
+  int16_t (*Fixed)[02000];	// Banks 2,3 are "fixed-fixed".
   // There are also "input/output channels".  Output channels are acted upon
   // immediately, but input channels are buffered from asynchronous data.
   int16_t InputChannel[NUM_CHANNELS];
@@ -310,6 +618,7 @@ typedef struct
   // The indexing value.
   int16_t IndexValue;
   int8_t InterruptRequests[1 + NUM_INTERRUPT_TYPES];	// 0-index not used.
+  uint64_t InterruptCounts[1 + NUM_INTERRUPT_TYPES];	// Taken, by type.
   // CPU internal flags.
   unsigned ExtraCode:1;		// Set by the "Extend" instruction.
   unsigned AllowInterrupt:1;
@@ -323,6 +632,105 @@ typedef struct
   unsigned DownruptTimeValid:1;	// Set if the DownruptTime field is valid.
   uint64_t /*unsigned long long */ DownruptTime;	// Time when next DOWNRUPT occurs.
   int Downlink;
+  // Set this to make agc_engine_run() return at the end of the current
+  // machine cycle (for example, when a breakpoint is hit).
+  int RunStop;
+  // The remaining state of the engine proper, which would otherwise be
+  // file-level statics in agc_engine.c.  agc_engine_init clears it all.
+  int NextZ;
+  int ScalerCounter;
+  int ChannelRoutineCount;
+  uint64_t QuietCycles;
+  unsigned GyroCount, OldChannel14, GyroTimer;
+  uint64_t ImuCduCount;
+  unsigned ImuChannel14;
+  int CountCDUX, CountCDUY, CountCDUZ;
+  CduFifo_t CduFifos[NUM_CDU_FIFOS];	// For registers 032, 033, and 034.
+  int CduChecker;
+  BulkEntry_t BulkEntries[MAX_BULK_ENTRIES];
+  int BulkPtr, BulkSize;
+  IdleCandidate_t IdleCandidates[IDLE_CANDIDATES];
+  IdleCandidate_t *IdleHead;
+  int IdleImpure, IdleInstructions, IdleCycles, IdleEligible;
+  char IdlePattern[MAX_IDLE_CYCLES];
+  int16_t IdleErasable[8][0400];
+  int IdleFlags, IdleConfirmed;
+  // Watch traps.  NumWatchTraps is the number of words with nonzero
+  // WatchModes, and WatchValues holds each one's value as last seen.
+  // WatchZ and WatchBB (with the superbank bit inserted) locate the
+  // instruction being executed, and are kept up to date only while traps
+  // are set.  Each trap that fires is recorded in WatchHits, one entry per
+  // word, until NumWatchHits is cleared; past MAX_WATCH_HITS words, the
+  // rest are only counted in LostWatchHits.
+  int NumWatchTraps;
+  uint8_t WatchModes[8][0400];
+  int16_t WatchValues[8][0400];
+  int WatchZ, WatchBB;
+  WatchHit_t WatchHits[MAX_WATCH_HITS];
+  int NumWatchHits, LostWatchHits;
+  // The word that machine cycles are being charged to, while 
+  // CoverageCounts or RuptTiming is set.
+  int16_t *CoverageWord;
+  int CoverageCounts;		// Collect the coverage counts if != 0.
+  Coverage_t *Coverage;		// The coverage counts, or NULL if none yet.
+  // Load accounting (see agc_load.c).  While LoadAccounting is set, each 
+  // machine cycle is counted in LoadCycles:  LOAD_IDLE while the erasable
+  // word LoadIdleAddress (bank*0400 + offset, or -1 for none) is equal to
+  // LoadIdleValue, the interrupt number while an interrupt is serviced, or
+  // otherwise LOAD_JOB.
+  int LoadAccounting;
+  int LoadIdleAddress;
+  int16_t LoadIdleValue;
+  uint64_t LoadCycles[LOAD_CLASSES];
+  struct LoadReport *LoadReport;	// agc_load.c's analysis, or NULL.
+  RuptTiming_t *RuptTiming;	// Interrupt latency, or NULL if not kept.
+  Trace_t *Trace;		// The instruction trace, or NULL if none.
+  Interpreter_t *Interpreter;	// Interpretive counts, or NULL if none.
+  InputLog_t InputLog;
+  // What the machine cycle just run was used for:  CYCLE_xxx, or the
+  // ExtendedOpcode of an instruction that completed in it.
+  int CycleClass;
+  // If not NULL, CycleHook is called by agc_engine_run after each machine
+  // cycle, with Cycles=1 and the cycle's class, or with Cycles>1 and 
+  // CYCLE_IDLE for an idle loop fast-forwarded in one go.  It's also called
+  // with CYCLE_BOOKKEEPING and Cycles=0 just before the CPU proper runs, in
+  // each cycle whose bookkeeping isn't skipped as quiet.  Set it before
+  // calling agc_engine_run, which only looks at it then.
+  // The --benchmark timing (agc_benchmark.c) uses it.
+  void (*CycleHook) (struct agc_s *State, int Class, uint64_t Cycles);
+  // yaAGC's backtraces (see Backtrace.c), or NULL until the first is added.
+  struct Backtrace *Backtrace;
+  // Connections to peripherals, for SocketAPI.c.  NumClients server sockets
+  // are opened, on ports Portnum, Portnum+1, ..., the first time 
+  // ChannelRoutine is called.  If 0, the global MAX_CLIENTS and Portnum are
+  // used instead, which is what agc_engine_init sets up.  When several 
+  // CPUs are run side by side, each needs its own Portnum.  If Headless is
+  // set, no sockets are opened at all.  Host is for peripherals within the
+  // same program instead (see agc_host.c), or else NULL.
+  int Headless;
+  struct HostIo *Host;
+  int Portnum;
+  int NumClients;
+  Client_t *Clients;
+  int *ServerSockets;
+  int SocketInterlace;
+  int SocketInputPending;	// Clients' input buffers may hold packets.
+  // Set by a ChannelInput() that only polls for input every SocketInterlace
+  // cycles (SocketAPI.c's).  Only then does agc_engine_run skip calling it
+  // in quiet cycles; any other ChannelInput() is called every cycle.
+  int InputInterlaced;
+  int SocketTimeoutCount;
+  int LastRhcPitch, LastRhcYaw, LastRhcRoll, LastInDetent;
+  // Channel values set by --debug-dsky's rules.
+  int CurrentChannelValues[256];
+  // With --debug-deda, the nibbles collected from yaDEDA, and the erasable
+  // word (DedaAddress) shown on it every half second while DedaMonitor is
+  // set.
+  unsigned char DedaBuffer[9], DedaPacket[4];
+  int DedaInBuffer, DedaWanted, DedaCollecting;
+  int DedaMonitor;
+  int DedaAddress;
+  uint64_t DedaWhen;
   // The following pointer is present for whatever use the Orbiter
   // integration squad wants.  The Virtual AGC code proper doesn't use it
   // in any way.
@@ -348,7 +756,40 @@ extern int NumDebugRules;
 extern DebugRule_t DebugRules[MAX_DEBUG_RULES];
 #endif
 
-// Stuff for --debug mode.
+// If set, agc_engine_run() fast-forwards through idle loops of the flight
+// software rather than simulating every instruction of them.
+#ifdef AGC_ENGINE_C
+int IdleSkip = 0;
+#else
+extern int IdleSkip;
+#endif
+
+// If set (the default), instructions fetched without INDEX modification
+// skip the index arithmetic.  Clear it to do the arithmetic throughout.
+#ifdef AGC_ENGINE_C
+int PredecodeInstructions = 1;
+#else
+extern int PredecodeInstructions;
+#endif
+
+// Machine-cycle classes (agc_t's CycleClass) other than instructions, which
+// are classed by ExtendedOpcode (0-0177).  CYCLE_BOOKKEEPING is never a
+// cycle's class; it's the per-cycle work of agc_engine_run itself (socket
+// service, DOWNRUPT, and so on) that precedes the rest of the cycle.
+#define CYCLE_DELAY		0200	// Waiting out a multi-MCT instruction.
+#define CYCLE_CDU		0201	// Servicing a CDU FIFO.
+#define CYCLE_COUNTER		0202	// Counter-timer increments.
+#define CYCLE_INTERRUPT		0203	// Vectoring to an interrupt.
+#define CYCLE_INPUT		0204	// Counter increments from peripherals.
+#define CYCLE_IDLE		0205	// Fast-forwarded through an idle loop.
+#define CYCLE_BOOKKEEPING	0206
+#define NUM_CYCLE_CLASSES	0207
+
+// Stuff for --debug mode.  yaAGC's Backtrace.c keeps far more backtrace
+// points than MAX_BACKTRACE_POINTS, in its own format; it's just the number
+// that the BACKTRACES command shows.  Its backtraces are kept in agc_t 
+// Backtrace, so BacktracePoint_t, BacktraceInitialized, BacktracePoints,
+// BacktraceNextAdd, and BacktraceCount are used only by yaAGS.
 #define MAX_BACKTRACE_POINTS 100
 #define BACKTRACES_PER_LINE 5
 typedef struct {
@@ -368,19 +809,6 @@ typedef struct {
   //unsigned RegQ16:1;		// Bit "16" of register Q.
 } BacktracePoint_t;
 
-typedef struct
-{
-  int Socket;
-  unsigned char Packet[4];
-  int Size;
-  int ChannelMasks[256];
-  //int DedaBufferCount;
-  //int DedaBufferWanted;
-  //int DedaBufferReadout;
-  //int DedaBufferDefault;
-  //int DedaBuffer[9];
-} Client_t;
-
 #define DEFAULT_MAX_CLIENTS 10
 
 #ifdef AGC_ENGINE_C
@@ -408,16 +836,12 @@ int *ServerSockets = DefaultSockets;
 int NumServers = 0;
 int SocketInterlaceReload = 50;
 int DebugDeda = 0, DedaQuiet = 0;
-int DedaMonitor = 0;
-int DedaAddress;
-uint64_t /* unsigned long long */ DedaWhen;
 int DownlinkListBuffer[MAX_DOWNLINK_LIST];
 int DownlinkListCount = 0, DownlinkListExpected = 0, DownlinkListZero = -1;
 ProcessDownlinkList_t *ProcessDownlinkList = NULL;
 int CmOrLm = 0;	// Default is 0 (LM); other choice is 1 (CM)
 char Sbuffer[SHEIGHT][SWIDTH + 1];
 int Sheight = DEFAULT_SHEIGHT, Swidth = DEFAULT_SWIDTH;
-int LastRhcPitch = 0, LastRhcYaw = 0, LastRhcRoll = 0;
 #else //AGC_ENGINE_C
 extern int DebugMode;
 extern int SingleStepCounter;
@@ -431,16 +855,12 @@ extern int *ServerSockets;
 extern int NumServers;
 extern int SocketInterlaceReload;
 extern int DebugDeda, DedaQuiet;
-extern int DedaMonitor;
-extern int DedaAddress;
-extern uint64_t /* unsigned long long */ DedaWhen;
 extern int DownlinkListBuffer[MAX_DOWNLINK_LIST];
 extern int DownlinkListCount, DownlinkListExpected, DownlinkListZero;
 extern ProcessDownlinkList_t *ProcessDownlinkList;
 extern int CmOrLm;
 extern char Sbuffer[SHEIGHT][SWIDTH + 1];
 extern int Sheight, Swidth;
-extern int LastRhcPitch, LastRhcYaw, LastRhcRoll;
 #endif //AGC_ENGINE_C
 
 #ifndef DECODE_DIGITAL_DOWNLINK_C
@@ -449,8 +869,10 @@ extern Swrite_t *SwritePtr;
 
 #ifdef SOCKET_API_C
 int Portnum = 19697;
+int SharedMemory = 0;	// Non-zero to offer shared memory as well (--shm).
 #else
 extern int Portnum;
+extern int SharedMemory;
 #endif
 
 
@@ -460,22 +882,62 @@ extern int Portnum;
 char *nbfgets (char *Buffer, int Length);
 void nbfgets_ready (const char *);
 int agc_engine (agc_t * State);
+uint64_t agc_engine_run (agc_t * State, uint64_t MaxCycles);
 int agc_engine_init (agc_t * State, const char *RomImage,
 		     const char *CoreDump, int AllOrErasable);
 int agc_load_binfile(agc_t *Stage, const char *RomImage);
+void agc_unshare_fixed (agc_t *State);
+void agc_release_fixed (agc_t *State);
 int ReadIO (agc_t * State, int Address);
 void WriteIO (agc_t * State, int Address, int Value);
 void CpuWriteIO (agc_t * State, int Address, int Value);
 void MakeCoreDump (agc_t * State, const char *CoreDump);
+// Binary core dumps, which begin with SNAPSHOT_MAGIC.  See agc_snapshot.c.
+#define SNAPSHOT_MAGIC "yaAGCsn"
+#define MAX_SNAPSHOT_NAME 1024
+int agc_load_snapshot (agc_t *State, const char *Filename, int AllOrErasable);
+int agc_restore_snapshot (agc_t *State, FILE *fp);
+int WriteSnapshotFile (agc_t *State, FILE *fp);
+void MakeSnapshot (agc_t *State, const char *Filename);
+void MakeSnapshotAsync (agc_t *State, const char *Filename);
+void FlushSnapshots (void);
+// How long MakeSnapshotAsync held up the CPU copying the state, and how
+// long the writer thread took to write it, in ns (for agc_stats.c).
+typedef struct {
+  uint64_t Count;
+  uint64_t LastCopy, MaxCopy;
+  uint64_t LastWrite, MaxWrite;
+} SnapshotStats_t;
+extern SnapshotStats_t SnapshotStats;
 void UnblockSocket (int SocketNum);
 //FILE *rfopen (const char *Filename, const char *mode);
 void BacktraceAdd (agc_t *State, int Cause);
 int BacktraceRestore (agc_t *State, int n);
+int BacktraceLength (agc_t *State);
+int BacktraceRun (agc_t *State, int n, int *First12, int *Last12, int *vRegBB);
+void BacktraceStep (agc_t *State);
+int BacktraceRewind (agc_t *State, int n);
 void BacktraceDisplay (agc_t *State,int Num);
+void BacktraceFree (agc_t *State);
 int16_t OverflowCorrected (int Value);
 int SignExtend (int16_t Word);
 int AddSP16 (int Addend1, int Addend2);
 void UnprogrammedIncrement (agc_t *State, int Counter, int IncType);
+void BulkIncrement (agc_t *State, int Counter, int Value);
+int AcceptInput (agc_t *State, int Channel, int Value);
+int StartInputRecord (agc_t *State, const char *Filename);
+void BeginInputRecord (agc_t *State, FILE *fp);
+void RecordInput (agc_t *State, int Channel, int Value);
+void StopInputRecord (agc_t *State);
+int StartInputReplay (agc_t *State, const char *Filename);
+void BeginInputReplay (agc_t *State, FILE *fp);
+int ReplayInput (agc_t *State);
+void StopInputReplay (agc_t *State);
+void SetWatchTrap (agc_t *State, int Bank, int Offset, int Modes);
+void ClearWatchTraps (agc_t *State);
+int StartCoverage (agc_t *State);
+void ClearCoverage (agc_t *State);
+void StopCoverage (agc_t *State);
 
 void DecodeDigitalDownlink (int Channel, int Value, int CmOrLm);
 ProcessDownlinkList_t PrintDownlinkList;
@@ -491,8 +953,32 @@ void ChannelOutput (agc_t * State, int Channel, int Value);
 int ChannelInput (agc_t * State);
 void ChannelRoutine (agc_t *State);
 void ChannelRoutineGeneric (void *State, void (*UpdatePeripherals) (void *, Client_t *));
+void ChannelClose (agc_t *State);
+void ChannelCloseGeneric (void);
 void ShiftToDeda (agc_t *State, int Data);
 
+// Real-time pacing (see Pacer.c).  Times are in nanoseconds.
+#define PACER_DEFAULT_QUANTUM 1000000
+#define PACER_BUCKETS 24
+typedef struct
+{
+  uint64_t Quantum;			// Time between wakeups.
+  uint64_t Deadline;			// Time of the latest wakeup.
+  uint64_t Wakeups;
+  unsigned Jitter[PACER_BUCKETS];	// Wakeup lateness, by powers of 2 us.
+  unsigned Lag[PACER_BUCKETS];		// CPU behind real time, likewise.
+  uint64_t LastJitter, MaxJitter;
+  // Cycles the CPU had to run to catch up, at the latest wakeup and at 
+  // worst (see PacerBacklog).
+  uint64_t Backlog, MaxBacklog;
+} Pacer_t;
+uint64_t PacerNow (void);
+void PacerInit (Pacer_t *Pacer, uint64_t Quantum);
+uint64_t PacerWait (Pacer_t *Pacer);
+void PacerLag (Pacer_t *Pacer, uint64_t Lag);
+void PacerBacklog (Pacer_t *Pacer, uint64_t Cycles);
+void PacerReport (Pacer_t *Pacer);
+
 #endif // AGC_ENGINE_H
 
 #ifdef __cplusplus
@@ -73,16 +73,135 @@
 				in the agc_t structure which aren't being 
 				saved or restored, so I'm adding all of these.
 		03/30/09 RSB	Added the Downlink variable to the core dumps.
+		2026-10-17	Ropes are now loaded into memory shared by
+				all agc_t loaded with identical ropes, and
+				agc_engine_init clears the new agc_t fields.
+		2026-10-17	Core-dump files may now also be binary
+				snapshots (see agc_snapshot.c).
+		2026-10-17	Clear the watch traps.
+		2026-10-17	Clear the word that's charged with machine
+				cycles for profiling.
+		2026-10-17	Clear the load accounting.
+		2026-10-17	Clear the input recording and replay.
+		2026-10-17	Fail at once if the rope can't be loaded,
+				since there's no fixed memory then.
+		2026-10-17	Clear CycleClass and Headless.
+		2026-10-17	Clear Host.
+		2026-10-17	Clear the bulk counter increments.
+		2026-10-17	Clear InterruptCounts and RuptTiming.
+		2026-10-17	Clear Trace.
+		2026-10-17	Clear Interpreter.
+		2026-10-17	Clear the coverage counts, CycleHook, the
+				backtraces, and the DEDA and --debug-dsky
+				state, which are now in agc_t.
+		2026-10-17	A failed agc_load_binfile leaves Fixed NULL.
+		2026-10-17	The predecoded instructions are a fixed table
+				now, so there's nothing to build for them.
+		2026-10-17	The rope list is locked.  agc_unshare_fixed's
+				copies are kept in it, so they're freed by
+				agc_release_fixed.  Initializing an agc_t
+				again frees what it held before.
+		2026-10-17	Clear InputInterlaced.
 */
 
 // For Orbiter.
 #ifndef AGC_SOCKET_ENABLED
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
 #include "yaAGC.h"
 #include "agc_engine.h"
 FILE *rfopen (const char *Filename, const char *mode);
 
+//---------------------------------------------------------------------------
+// Fixed memory never changes, so all of the agc_t loaded with identical 
+// ropes point to a single copy of it.  The copies in use are kept in a list,
+// with a count of the agc_t using each.  The private copies made by
+// agc_unshare_fixed are in the list too, so that they can be freed, but are
+// never matched by agc_load_binfile.  RopesMutex guards the list, so agc_t
+// can be initialized (or unshared) in different threads.
+
+typedef struct Rope_s {
+  struct Rope_s *Next;
+  int Users;
+  int Private;
+  int16_t Fixed[NUM_FIXED_BANKS][02000];
+} Rope_t;
+static Rope_t *Ropes = NULL;
+static pthread_mutex_t RopesMutex = PTHREAD_MUTEX_INITIALIZER;
+
+static Rope_t *
+FindRope (int16_t (*Fixed)[02000], Rope_t ***Link)
+{
+  Rope_t **Rope;
+  for (Rope = &Ropes; *Rope != NULL; Rope = &(*Rope)->Next)
+    if ((*Rope)->Fixed == Fixed)
+      {
+        if (Link != NULL)
+	  *Link = Rope;
+	return (*Rope);
+      }
+  return (NULL);
+}
+
+// ReleaseRope and AddRope are called with RopesMutex held.
+static void
+ReleaseRope (agc_t *State)
+{
+  Rope_t *Rope, **Link;
+  Rope = FindRope (State->Fixed, &Link);
+  if (Rope == NULL)
+    return;
+  State->Fixed = NULL;
+  if (--Rope->Users > 0)
+    return;
+  *Link = Rope->Next;
+  free (Rope);
+}
+
+static void
+AddRope (agc_t *State, Rope_t *Rope)
+{
+  Rope->Next = Ropes;
+  Ropes = Rope;
+  Rope->Users = 1;
+  State->Fixed = Rope->Fixed;
+}
+
+// Stops using a shared rope, or frees a private one.  Fixed memory not
+// obtained from agc_load_binfile or agc_unshare_fixed is left alone.
+void
+agc_release_fixed (agc_t *State)
+{
+  pthread_mutex_lock (&RopesMutex);
+  ReleaseRope (State);
+  pthread_mutex_unlock (&RopesMutex);
+}
+
+// Gives State a private copy of fixed memory, which can then be modified
+// (by the debugger, say) without affecting any other agc_t.
+void
+agc_unshare_fixed (agc_t *State)
+{
+  Rope_t *Rope, *Copy;
+  pthread_mutex_lock (&RopesMutex);
+  Rope = FindRope (State->Fixed, NULL);
+  if (Rope != NULL && !Rope->Private)
+    {
+      Copy = malloc (sizeof (Rope_t));
+      if (Copy != NULL)
+        {
+	  memcpy (Copy->Fixed, Rope->Fixed, sizeof (Rope->Fixed));
+	  Copy->Private = 1;
+	  ReleaseRope (State);
+	  AddRope (State, Copy);
+	}
+    }
+  pthread_mutex_unlock (&RopesMutex);
+}
+
 //---------------------------------------------------------------------------
 // Returns:
 //      0 -- success.
@@ -92,12 +211,19 @@ FILE *rfopen (const char *Filename, const char *mode);
 //      4 -- agc_t structure not allocated.
 //      5 -- File-read error.
 //      6 -- Core-dump file not found.
+//      7 -- Core-dump file is a corrupt snapshot, or of an unknown version.
 // Normally, on input the CoreDump filename is NULL, in which case all of the 
 // i/o channels, erasable memory, etc., are cleared to their reset values.
 // When the CoreDump is loaded instead, it allows execution to continue precisely
 // from the point at which the CoreDump was created, if AllOrErasable != 0.
 // If AllOrErasable == 0, then only the erasable memory is initialized from the
 // core-dump file.
+// The agc_t must be all zeroes (static, or from calloc) before it's first
+// initialized.  It can then be initialized again, which frees what it holds
+// from before:  the coverage counts, the backtraces, the connections to
+// peripherals, and any input recording or replay.  The instruments started
+// from yaAGC (TraceStart, InterpStart, LoadStart, and so on) should be
+// stopped beforehand, since they're forgotten.
 
 int
 agc_load_binfile(agc_t *State, const char *RomImage)
@@ -106,6 +232,7 @@ agc_load_binfile(agc_t *State, const char *RomImage)
   FILE *fp = NULL;
   int Bank;
   int m, n, i, j;
+  Rope_t *Rope = NULL, *Match;
 
   // The following sequence of steps loads the ROM image into the simulated
   // core memory, in what I think is a pretty obvious way.
@@ -132,6 +259,9 @@ agc_load_binfile(agc_t *State, const char *RomImage)
     goto Done;
 
   RetVal = 5;
+  Rope = calloc (1, sizeof (Rope_t));
+  if (Rope == NULL)
+    goto Done;
   Bank = 2;
   for (Bank = 2, j = 0, i = 0; i < n; i++)
     {
@@ -147,7 +277,7 @@ agc_load_binfile(agc_t *State, const char *RomImage)
 	  RetVal = 2;
 	  goto Done;
 	}
-      State->Fixed[Bank][j++] = (In[0] * 256 + In[1]) >> 1;
+      Rope->Fixed[Bank][j++] = (In[0] * 256 + In[1]) >> 1;
       if (j == 02000)
 	{
 	  j = 0;
@@ -165,7 +295,36 @@ agc_load_binfile(agc_t *State, const char *RomImage)
 	}
     }
 
+  // Use an identical rope that's already loaded, if there is one.
+  RetVal = 0;
+  pthread_mutex_lock (&RopesMutex);
+  ReleaseRope (State);
+  for (Match = Ropes; Match != NULL; Match = Match->Next)
+    if (!Match->Private
+	&& !memcmp (Match->Fixed, Rope->Fixed, sizeof (Rope->Fixed)))
+      break;
+  if (Match == NULL)
+    {
+      AddRope (State, Rope);
+      Rope = NULL;
+    }
+  else
+    {
+      Match->Users++;
+      State->Fixed = Match->Fixed;
+    }
+  pthread_mutex_unlock (&RopesMutex);
+
 Done:
+  // A failed load leaves State without fixed memory, rather than with a
+  // pointer that a later agc_release_fixed would trip over.
+  if (RetVal != 0 && State != NULL)
+    {
+      agc_release_fixed (State);
+      State->Fixed = NULL;
+    }
+  if (Rope != NULL)
+    free (Rope);
   if (fp != NULL)
     fclose (fp);
   return (RetVal);
@@ -189,8 +348,20 @@ agc_engine_init (agc_t * State, const char *RomImage, const char *CoreDump,
   UnblockSocket (fileno (stdin));
 #endif
 
+  // Without fixed memory there's nothing to run.
   if (RomImage)
-	  RetVal = agc_load_binfile(State, RomImage);
+    {
+      RetVal = agc_load_binfile(State, RomImage);
+      if (RetVal)
+        return (RetVal);
+    }
+
+  // Free whatever an earlier initialization left.
+  StopCoverage (State);
+  BacktraceFree (State);
+  ChannelClose (State);
+  StopInputRecord (State);
+  StopInputReplay (State);
  
   // Clear i/o channels.
   for (i = 0; i < NUM_CHANNELS; i++)
@@ -224,15 +395,64 @@ agc_engine_init (agc_t * State, const char *RomImage, const char *CoreDump,
     State->OutputChannel10[j] = 0;
   State->IndexValue = 0;
   for (j = 0; j < 1 + NUM_INTERRUPT_TYPES; j++)
-    State->InterruptRequests[j] = 0;
+    State->InterruptRequests[j] = State->InterruptCounts[j] = 0;
   State->InIsr = 0;
   State->SubstituteInstruction = 0;
   State->DownruptTimeValid = 1;
   State->DownruptTime = 0;
   State->Downlink = 0;
+  State->RunStop = 0;
+
+  // The rest of the engine's state.
+  State->NextZ = 0;
+  State->ScalerCounter = 0;
+  State->ChannelRoutineCount = 0;
+  State->QuietCycles = 0;
+  State->GyroCount = State->OldChannel14 = State->GyroTimer = 0;
+  State->ImuCduCount = 0;
+  State->ImuChannel14 = 0;
+  State->CountCDUX = State->CountCDUY = State->CountCDUZ = 0;
+  memset (State->CduFifos, 0, sizeof (State->CduFifos));
+  State->CduChecker = 0;
+  State->BulkPtr = State->BulkSize = 0;
+  memset (State->IdleCandidates, 0, sizeof (State->IdleCandidates));
+  State->IdleHead = NULL;
+  State->IdleConfirmed = 0;
+  ClearWatchTraps (State);
+  State->CoverageWord = NULL;
+  State->CoverageCounts = 0;
+  State->CycleHook = NULL;
+  State->LoadAccounting = 0;
+  State->LoadIdleAddress = -1;
+  State->LoadIdleValue = 0;
+  memset (State->LoadCycles, 0, sizeof (State->LoadCycles));
+  State->LoadReport = NULL;
+  State->RuptTiming = NULL;
+  State->Trace = NULL;
+  State->Interpreter = NULL;
+  memset (&State->InputLog, 0, sizeof (State->InputLog));
+  State->CycleClass = 0;
+
+  // Peripheral connections, which ChannelRoutine() opens.
+  State->Headless = 0;
+  State->Host = NULL;
+  State->Portnum = 0;
+  State->NumClients = 0;
+  State->SocketInterlace = 0;
+  State->SocketInputPending = 0;
+  State->InputInterlaced = 0;
+  State->SocketTimeoutCount = 0;
+  State->LastRhcPitch = State->LastRhcYaw = State->LastRhcRoll = 0;
+  State->LastInDetent = 040000;
+  memset (State->CurrentChannelValues, 0, sizeof (State->CurrentChannelValues));
+  State->DedaInBuffer = State->DedaWanted = State->DedaCollecting = 0;
+  State->DedaMonitor = 0;
+  State->DedaAddress = 0;
+  State->DedaWhen = 0;
 
   if (CoreDump != NULL)
     {
+      char Magic[sizeof (SNAPSHOT_MAGIC)];
       cd = fopen (CoreDump, "r");
       if (cd == NULL)
         {
@@ -241,8 +461,17 @@ agc_engine_init (agc_t * State, const char *RomImage, const char *CoreDump,
 	  else
 	    RetVal = 0;
 	}
+      else if (1 == fread (Magic, sizeof (Magic), 1, cd) 
+	       && !memcmp (Magic, SNAPSHOT_MAGIC, sizeof (Magic)))
+	{
+	  // A binary snapshot rather than an octal core dump.
+	  fclose (cd);
+	  cd = NULL;
+	  RetVal = agc_load_snapshot (State, CoreDump, AllOrErasable);
+	}
       else
 	{
+	  rewind (cd);
 	  RetVal = 5;
 
 	  // Load up the i/o channels.
@@ -41,6 +41,11 @@
 		07/01/09 OH	Convert to command tables to prepare for machine
 				independence and change to GNU formating
 		08/01/09 RSB	Adjusted to use NormalizeSourceName().
+		2026-10-17	Added rwatch and awatch.
+		2026-10-17	Added profile.
+		2026-10-17	The profile is the agc_t's.
+		2026-10-17	Refuse rwatch and awatch on the central
+				registers, whose reads can't be seen.
 */
 
 #include <stdlib.h>
@@ -53,6 +58,7 @@
 #include "agc_debugger.h"
 #include "agc_disassembler.h"
 #include "agc_gdbmi.h"
+#include "agc_profile.h"
 #include <string.h>
 #include <unistd.h>
 #ifdef WIN32
@@ -81,7 +87,7 @@ extern Symbol_t *SymbolTable;
 
 extern char SourceFiles[MAX_NUM_FILES][MAX_FILE_LENGTH];
 extern int NumberFiles;
-extern SymbolLine_t* FindLastLineMain(void);
+extern SymbolLine_t* FindLastLineMain(agc_t *State);
 
 extern void CheckDec (char *s);
 extern char* DbgGetFrameNameByAddr(unsigned LinearAddress);
@@ -305,16 +311,22 @@ GdbmiHandleNormBrk(int i)
 	return (GdbmiHandleAllBreak(i,BP_KEEP));
 }
 
+/* Handle the watch, rwatch and awatch commands, which set watchpoints of
+ * WatchBreak type 1, 5 and 6 respectively */
 static GdbmiResult
-GdbmiHandleWatch (int j)
+GdbmiHandleAllWatch (int j, int WatchType)
 {
-   int k, i, vRegBB, WatchType, WatchValue = 0777777;
+   int k, i, vRegBB, WatchValue = 0777777;
    Symbol_t *Symbol = NULL;
    unsigned gdbmi_address;
    Address_t agc_addr;
 
    /* Adjust the CmdPtr to point to the next token */
    GdbmiAdjustCmdPtr(j);
+   if (*sraw == ' ')
+   {
+      s++;sraw++; /* Skip space */
+   }
 
    if (strlen(sraw))
       Symbol = ResolveSymbol(sraw, SYMBOL_VARIABLE | SYMBOL_REGISTER | SYMBOL_CONSTANT);
@@ -328,10 +340,23 @@ GdbmiHandleWatch (int j)
       /* Watch Type 3 = for value, Watch type 1 for any change */
       agc_addr = DbgNativeAddr(gdbmi_address);
 
-      WatchType = 1;
       vRegBB = agc_addr.EB;
       k = agc_addr.SReg;
-      WatchValue = State->Erasable[vRegBB][k];
+      WatchValue = State->Erasable[vRegBB][k & 0377];
+
+      /* The CPU reads the central registers directly, so only changes to
+       * them can be watched (by polling). */
+      if (WatchType >= 5 && vRegBB == 0 && (k & 0377) < 020)
+      {
+         printf ("Can't watch reads of the central register %s; use "
+                 "\"watch\" for changes.\n", Symbol->Name);
+         return(GdbmiCmdDone);
+      }
+   }
+   else
+   {
+      printf ("No symbol \"%s\" in current context.\n", sraw);
+      return(GdbmiCmdDone);
    }
 
    for (i = 0; i < NumBreakpoints; i++)
@@ -359,7 +384,12 @@ GdbmiHandleWatch (int j)
       else
          Breakpoints[NumBreakpoints].WatchValue = WatchValue;
       NumBreakpoints++;
-      if (Symbol)
+      if (WatchType == 5)
+         printf ("Hardware read watchpoint %d: %s\n",gdbmi_break_id,Symbol->Name);
+      else if (WatchType == 6)
+         printf ("Hardware access (read/write) watchpoint %d: %s\n",
+                 gdbmi_break_id,Symbol->Name);
+      else
          printf ("Hardware watchpoint %d: %s\n",gdbmi_break_id,Symbol->Name);
    }
    else
@@ -368,6 +398,53 @@ GdbmiHandleWatch (int j)
    return(GdbmiCmdDone);
 }
 
+static GdbmiResult
+GdbmiHandleWatch (int j)
+{
+   return (GdbmiHandleAllWatch(j,1));
+}
+
+static GdbmiResult
+GdbmiHandleReadWatch (int j)
+{
+   return (GdbmiHandleAllWatch(j,5));
+}
+
+static GdbmiResult
+GdbmiHandleAccessWatch (int j)
+{
+   return (GdbmiHandleAllWatch(j,6));
+}
+
+/**
+ * PROFILE ON|OFF starts or stops collecting the coverage counts, PROFILE
+ * CLEAR zeroes them, and PROFILE FILE writes the profile of them to FILE.
+ */
+static GdbmiResult
+GdbmiHandleProfile(int i)
+{
+   /* Adjust the CmdPtr to point to the next token */
+   GdbmiAdjustCmdPtr(i);
+   while (*s == ' ') {s++;sraw++;}
+
+   if (!strcmp(s,"ON"))
+   {
+      if (StartCoverage(State)) printf("Out of memory for the profile.\n");
+   }
+   else if (!strcmp(s,"OFF")) State->CoverageCounts = 0;
+   else if (!strcmp(s,"CLEAR")) ClearCoverage(State);
+   else if (*s)
+   {
+      if (WriteProfile(State,sraw))
+         printf("Could not write the profile \"%s\".\n",sraw);
+      else printf("Profile written to \"%s\" and \"%s%s\".\n",
+                  sraw,sraw,PROFILE_FOLDED_SUFFIX);
+      return(GdbmiCmdDone);
+   }
+   printf("Profiling is %s.\n",State->CoverageCounts ? "on" : "off");
+   return(GdbmiCmdDone);
+}
+
 void
 GdbmiHandleShowVersion(void)
 {
@@ -507,8 +584,12 @@ GdbmiHandleInfoBreakpoints(int j)
          {
             if (Breakpoints[i].Symbol != NULL)
             {
-                 printf ("%d\thw watchpoint\t%s\t%c\t        %s",
+                 const char *Type = "hw watchpoint";
+                 if (Breakpoints[i].WatchBreak == 5) Type = "read watchpoint";
+                 else if (Breakpoints[i].WatchBreak == 6) Type = "acc watchpoint";
+                 printf ("%d\t%s\t%s\t%c\t        %s",
                        Breakpoints[i].Id,
+                       Type,
                        disposition,
                        Breakpoints[i].Enable,
                        Breakpoints[i].Symbol->Name);
@@ -828,7 +909,7 @@ GdbmiHandleInfoThreads(int i)
          printf("    at %s:%d\n",Line->FileName,Line->LineNumber);
       }
 
-      Line = FindLastLineMain();
+      Line = FindLastLineMain(State);
       if (Line)
       {
          LinearAddress = DbgLinearAddr(&Line->CodeAddress);
@@ -1793,7 +1874,7 @@ GdbmiHandleQuit(int i)
 /**
  * GDB/MI Root Table of Commands and associated handlers.
  */
-GdbmiCommands_t GdbmiConsoleRootCommands[33] =
+GdbmiCommands_t GdbmiConsoleRootCommands[36] =
 {
    {"INFO ", GdbmiHandleInfo},
    {"SET ", GdbmiHandleSet},
@@ -1802,9 +1883,12 @@ GdbmiCommands_t GdbmiConsoleRootCommands[33] =
    {"BREAK", GdbmiHandleNormBrk},
    {"TBREAK", GdbmiHandleTmpBrk},
    {"PRINT", GdbmiHandlePrint},
+   {"PROFILE", GdbmiHandleProfile},
    {"WHERE", GdbmiHandleBacktrace},
    {"BT", GdbmiHandleBacktrace},
    {"WATCH", GdbmiHandleWatch},
+   {"RWATCH", GdbmiHandleReadWatch},
+   {"AWATCH", GdbmiHandleAccessWatch},
    {"DISASSEMBLE", GdbmiHandleDisassemble},
    {"DISAS", GdbmiHandleDisassemble},
    {"DEFINE", GdbmiHandleDefine},
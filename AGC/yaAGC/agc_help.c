@@ -1,6 +1,7 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include "agc_help.h"
 #include <unistd.h>
 #ifdef WIN32
 #include <windows.h>
@@ -54,6 +55,8 @@ static void gdbmiPrintHelpBreakpoints()
 	printf("disable -- Disable some breakpoints\n");
 	printf("enable -- Enable some breakpoints\n");
 	printf("watch -- Set a watchpoint\n");
+	printf("rwatch -- Set a read watchpoint\n");
+	printf("awatch -- Set a read/write watchpoint\n");
 }
 
 static void gdbmiPrintHelpData()
@@ -70,6 +73,8 @@ static void gdbmiPrintHelpRunning()
 	printf("step -- Step program until it reaches a different source line\n");
 	printf("next -- Step program\n");
 	printf("cont -- Continue program being debugged\n");
+	printf("reverse-step -- Go back to the last branch taken\n");
+	printf("reverse-continue -- Go back to the last breakpoint passed\n");
 	printf("run -- Start debugged program\n");
 	printf("quit -- Exit agc\n");
 }
@@ -89,6 +94,7 @@ static void gdbmiPrintHelpObscure()
 {
 		printf("log -- Log instructions to a log file\n");
 		printf("getoct -- Converts EXP into octal value\n");
+		printf("profile -- Count where the CPU spends its cycles\n");
 		printf("inton -- Set interrupt request\n");
 		printf("intoff -- Clear interrupt request\n");
 }
@@ -238,7 +244,8 @@ int GdbmiHelp(char* s)
 {
 	gdbmi_status = 0;
 
-	if (!strncmp(s,"HELP",4)) gdbmiHandleHelp(s+4);
+	/* The commands documented by legacyHelp get their full documentation */
+	if (!strncmp(s,"HELP",4) && !legacyHelp(s)) gdbmiHandleHelp(s+4);
 	return gdbmi_status;
 }
 
@@ -263,7 +270,14 @@ int legacyHelp(char* s)
 	{
 	  printf ("\n"
 		  "backtraces\n"
-		  "\tDisplays the most recent backtrace points.\n" "\n");
+		  "\tDisplays the most recent backtrace points.  Many more\n"
+		  "\tthan are shown are kept, and can be returned to with\n"
+		  "\t\'backtrace N\', \'reverse-step\', or \'reverse-continue\'.\n"
+		  "\tA point is kept for each branch taken, up to 262,144 of\n"
+		  "\tthem (fewer if a great deal of erasable memory changes\n"
+		  "\tbetween them), with the oldest discarded 1024 at a time.\n"
+		  "\tThe points within an interrupt service routine are\n"
+		  "\tdiscarded when it RESUMEs.\n" "\n");
 	  gdbmi_status++;
 	}
 	else if (!strcmp (s, "HELP BREAK"))
@@ -498,6 +512,23 @@ int legacyHelp(char* s)
 		  "\tPrints out the value of the symbol S\n");
 	  gdbmi_status++;
 	}
+	else if (!strcmp (s, "HELP PROFILE"))
+	{
+	  printf ("\n"
+		  "profile on (or off)\n"
+		  "\tStart (or stop) counting the instructions executed and the\n"
+		  "\tmachine cycles used at each address, and the reads and writes\n"
+		  "\tof erasable memory and i/o channels.\n");
+	  printf ("Or:\n"
+		  "profile clear\n"
+		  "\tZero the counts.\n");
+	  printf ("Or:\n"
+		  "profile FILE\n"
+		  "\tWrite the profile of the counts so far, by routine, source\n"
+		  "\tfile, and source line, to FILE, and the same thing as folded\n"
+		  "\tstacks for a flame graph to FILE.folded.\n" "\n");
+	  gdbmi_status++;
+	}
 	else if (!strcmp (s, "HELP QUIT"))
 	{
 	  printf ("\n"
@@ -505,6 +536,29 @@ int legacyHelp(char* s)
 		  "\tEnd the program.\n" "\n");
 	  gdbmi_status++;
 	}
+	else if (!strcmp (s, "HELP REVERSE-STEP") || !strcmp (s, "HELP RS"))
+	{
+	  printf ("\n"
+		  "reverse-step [N] (or rs [N])\n"
+		  "\tGo back to the Nth most recent branch taken, just before\n"
+		  "\tit was taken.  If omitted, N defaults to 1.  As with\n"
+		  "\t\'backtrace N\', erasable memory, the i/o channels, and the\n"
+		  "\tinterrupt requests are restored, but peripherals are not.\n"
+		  "\tThe history after that branch is discarded, and is made\n"
+		  "\tagain by running forward.\n" "\n");
+	  gdbmi_status++;
+	}
+	else if (!strcmp (s, "HELP REVERSE-CONTINUE") || !strcmp (s, "HELP RC"))
+	{
+	  printf ("\n"
+		  "reverse-continue (or rc)\n"
+		  "\tGo back to the most recent time execution passed a\n"
+		  "\tbreakpoint, by going back to the branch before it and\n"
+		  "\trunning forward again.  Watchpoints aren\'t checked.  If\n"
+		  "\tno breakpoint was passed, the CPU goes back to the start\n"
+		  "\tof the history (see \'backtraces\').\n" "\n");
+	  gdbmi_status++;
+	}
 	else if (!strcmp (s, "HELP STEP"))
 	{
 	  printf ("\n"
@@ -543,12 +597,30 @@ int legacyHelp(char* s)
 		  "\tare displayed after execution stops.  The address\n"
 		  "\tobviously has to be in erasable memory or i/o-channel memory.\n"
 		  "\tNote that the value stored at the address has to CHANGE to\n"
-		  "\ttrigger the break.\n");
+		  "\ttrigger the break.  The address of the instruction that\n"
+		  "\tchanged it (or the fact that a counter did) is displayed too.\n");
 	  printf ("Or:\n"
 		  "watch A V\n"
 		  "\tSame as above, but waits for the SPECIFIC value V to be written.\n" "\n");
 	  gdbmi_status++;
 	}
+	else if (!strcmp (s, "HELP RWATCH"))
+	{
+	  printf ("\n"
+		  "rwatch A\n"
+		  "\tHalt execution after an instruction reads the value at\n"
+		  "\taddress A.  The address of the instruction is displayed.\n" "\n");
+	  gdbmi_status++;
+	}
+	else if (!strcmp (s, "HELP AWATCH"))
+	{
+	  printf ("\n"
+		  "awatch A\n"
+		  "\tHalt execution after an instruction or counter reads or\n"
+		  "\twrites the value at address A, even if the value doesn't\n"
+		  "\tchange.  The address of the instruction is displayed.\n" "\n");
+	  gdbmi_status++;
+	}
 	else if (!strcmp (s, "HELP VIEW"))
 	{
 	  printf ("\n"
@@ -0,0 +1,205 @@
+/*
+  Copyright 2026 Ronald S. Burkey <info@sandroid.org>
+
+  This file is part of yaAGC.
+
+  yaAGC is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  yaAGC is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with yaAGC; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+  Filename:	agc_host.c
+  Purpose:	Connects peripherals simulated within the same program
+  		(a flight simulator, say) directly to the CPU, with
+		callbacks for output and a lock-free queue for input,
+		rather than through the sockets.
+  Compiler:	GNU gcc.
+  Contact:	Ron Burkey <info@sandroid.org>
+  Reference:	http://www.ibiblio.org/apollo/index.html
+  Mods:		2026-10-17	Began.
+		2026-10-17	Added HostPushIncrements.
+
+  See agc_host.h for how it's used.  ChannelOutput (in SocketAPI.c) calls
+  HostOutput, and ChannelInput calls HostInput, whenever State->Host is
+  set.  Since the input goes through AcceptInput, it can be recorded and
+  replayed (see agc_input.c) just like input from the sockets.
+
+  The input queue is a bounded ring of cells, each with a sequence number
+  that says whether it's ready to be filled (the sequence number equals
+  the position it's to be filled at) or to be emptied (one more than
+  that).  Producers claim positions at Tail with an atomic
+  compare-and-swap, so any number of threads can push at once; only the
+  CPU's own thread ever takes from Head.  The GCC __atomic builtins are
+  used.
+*/
+
+#include <stdlib.h>
+#include "yaAGC.h"
+#include "agc_engine.h"
+#include "agc_host.h"
+
+#define HOST_QUEUE_MASK (HOST_QUEUE_SIZE - 1)
+
+// Sets up State for in-process peripherals.  No sockets are opened
+// (clear State->Headless afterward to have socket peripherals as well).
+// Returns 0 on success, or 1 if out of memory.
+int
+HostAttach (agc_t *State)
+{
+  HostIo_t *Host;
+  unsigned i;
+
+  if (State->Host != NULL)
+    return (0);
+  Host = (HostIo_t *) calloc (1, sizeof (HostIo_t));
+  if (Host == NULL)
+    return (1);
+  for (i = 0; i < HOST_QUEUE_SIZE; i++)
+    Host->Cells[i].Sequence = i;
+  State->Host = Host;
+  State->Headless = 1;
+  return (0);
+}
+
+// Only once the CPU has been stopped.
+void
+HostDetach (agc_t *State)
+{
+  free (State->Host);
+  State->Host = NULL;
+}
+
+// Has Callback called for each output to channels First through Last.
+// Several callbacks may cover the same channel.  Returns 0 on success, or
+// 1 if there are already MAX_HOST_OUTPUTS or HostAttach wasn't called.
+int
+HostRegisterOutput (agc_t *State, int First, int Last, HostOutput_t Callback,
+		    void *Data)
+{
+  HostIo_t *Host = State->Host;
+  HostOutputRange_t *Output;
+
+  if (Host == NULL || Host->NumOutputs >= MAX_HOST_OUTPUTS)
+    return (1);
+  Output = &Host->Outputs[Host->NumOutputs++];
+  Output->First = First;
+  Output->Last = Last;
+  Output->Callback = Callback;
+  Output->Data = Data;
+  return (0);
+}
+
+static int
+Push (agc_t *State, int Channel, int Value, int Mask)
+{
+  HostIo_t *Host = State->Host;
+  HostCell_t *Cell;
+  unsigned Position, Sequence;
+
+  if (Host == NULL)
+    return (1);
+  Position = __atomic_load_n (&Host->Tail, __ATOMIC_RELAXED);
+  for (;;)
+    {
+      Cell = &Host->Cells[Position & HOST_QUEUE_MASK];
+      Sequence = __atomic_load_n (&Cell->Sequence, __ATOMIC_ACQUIRE);
+      if (Sequence == Position)
+	{
+	  if (__atomic_compare_exchange_n (&Host->Tail, &Position,
+					   Position + 1, 1, __ATOMIC_RELAXED,
+					   __ATOMIC_RELAXED))
+	    break;
+	}
+      else if ((int) (Sequence - Position) < 0)
+	return (1);		// Full.
+      else
+	Position = __atomic_load_n (&Host->Tail, __ATOMIC_RELAXED);
+    }
+  Cell->Channel = Channel;
+  Cell->Value = Value;
+  Cell->Mask = Mask;
+  __atomic_store_n (&Cell->Sequence, Position + 1, __ATOMIC_RELEASE);
+  return (0);
+}
+
+// Queues a value for input channel Channel (0-0177).  Only the bits in
+// Mask are changed; the others keep whatever value they have when the
+// input is taken up.  Returns 0 on success, or 1 if the queue is full.
+int
+HostPushInput (agc_t *State, int Channel, int Value, int Mask)
+{
+  return (Push (State, Channel & 0177, Value & 077777, Mask & 077777));
+}
+
+// Queues an unprogrammed increment of counter register Counter (032 for
+// CDUX, say), of the same Type as in the socket protocol:  0 for PINC, 1
+// for PCDU, 2 for MINC, 3 for MCDU, and so on.  Each takes a machine
+// cycle.  Returns 0 on success, or 1 if the queue is full.
+int
+HostPushIncrement (agc_t *State, int Counter, int Type)
+{
+  return (Push (State, 0x80 | (Counter & 0x7F), Type, 0));
+}
+
+// Queues a whole run of unprogrammed increments of Counter, with Value as
+// in a bulk packet:  BULK_PCDU plus (-25 & BULK_COUNT_MASK) for 25 MCDUs,
+// say.  Returns 0 on success, or 1 if the queue is full.
+int
+HostPushIncrements (agc_t *State, int Counter, int Value)
+{
+  return (Push (State, 0x80 | (Counter & 0x7F),
+		BULK_INCREMENT | (Value & 077777), 0));
+}
+
+//-------------------------------------------------------------------------
+// The CPU's side.
+
+// Takes up the queued input, as far as the first counter increment.
+// Returns 1 if there was a counter increment, which uses up the machine
+// cycle, or 0 if not.
+int
+HostInput (agc_t *State)
+{
+  HostIo_t *Host = State->Host;
+  HostCell_t *Cell;
+  int Channel, Value;
+
+  for (;;)
+    {
+      Cell = &Host->Cells[Host->Head & HOST_QUEUE_MASK];
+      if (__atomic_load_n (&Cell->Sequence, __ATOMIC_ACQUIRE)
+	  != Host->Head + 1)
+	return (0);
+      Channel = Cell->Channel;
+      Value = Cell->Value;
+      if (!(Channel & 0x80))
+	Value = (Value & Cell->Mask)
+	  | (ReadIO (State, Channel) & ~Cell->Mask);
+      __atomic_store_n (&Cell->Sequence, Host->Head + HOST_QUEUE_SIZE,
+			__ATOMIC_RELEASE);
+      Host->Head++;
+      if (AcceptInput (State, Channel, Value))
+	return (1);
+    }
+}
+
+void
+HostOutput (agc_t *State, int Channel, int Value)
+{
+  HostIo_t *Host = State->Host;
+  HostOutputRange_t *Output;
+  int i;
+
+  for (i = 0, Output = Host->Outputs; i < Host->NumOutputs; i++, Output++)
+    if (Channel >= Output->First && Channel <= Output->Last)
+      (*Output->Callback) (State, Channel, Value, Output->Data);
+}
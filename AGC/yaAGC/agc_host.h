@@ -0,0 +1,115 @@
+/*
+  Copyright 2026 Ronald S. Burkey <info@sandroid.org>
+
+  This file is part of yaAGC.
+
+  yaAGC is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  yaAGC is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with yaAGC; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+  Filename:	agc_host.h
+  Purpose:	Header for agc_host.c, which connects peripherals simulated
+  		within the same program directly to the CPU, in place of
+		the sockets.
+  Compiler:	GNU gcc.
+  Contact:	Ron Burkey <info@sandroid.org>
+  Reference:	http://www.ibiblio.org/apollo/index.html
+  Mods:		2026-10-17	Began.
+		2026-10-17	Added HostPushIncrements.
+		2026-10-17	The example's agc_t is static.
+
+  Typical use, by a program linked with libyaAGC.a (see HostDemo.c):
+
+	static void Dsky (agc_t *State, int Channel, int Value, void *Data)
+	{
+	  ... update the display ...
+	}
+
+	static agc_t Lm;		// agc_engine_init wants it zeroed.
+	agc_runner_t Runner;
+	agc_engine_init (&Lm, "Luminary099.bin", NULL, 0);
+	HostAttach (&Lm);
+	HostRegisterOutput (&Lm, 010, 011, Dsky, NULL);
+	agc_runner_start (&Runner, &Lm, 0, 1);
+	...
+	HostPushInput (&Lm, 015, Keycode, 037);	// From any thread.
+	...
+	agc_runner_stop (&Runner);
+	HostDetach (&Lm);
+
+  The callbacks are called by whichever thread runs the CPU, as soon as
+  the AGC software outputs to the channel, and should be quick about it.
+  The outputs have to be registered before the CPU is started.  Input and
+  counter increments, on the other hand, can be pushed by any thread at
+  any time.  They're queued without locking, and the CPU takes them up in
+  the very next machine cycle, much as it would input from the sockets.
+*/
+
+#ifndef AGC_HOST_H
+#define AGC_HOST_H
+
+#include "agc_engine.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Must be a power of 2.
+#define HOST_QUEUE_SIZE 4096
+#define MAX_HOST_OUTPUTS 32
+
+typedef void (*HostOutput_t) (agc_t *State, int Channel, int Value,
+			      void *Data);
+
+typedef struct
+{
+  int First, Last;		// Range of channels.
+  HostOutput_t Callback;
+  void *Data;
+} HostOutputRange_t;
+
+// A queued input.  Sequence tells whether the cell is free or filled (see
+// agc_host.c).
+typedef struct
+{
+  unsigned Sequence;
+  int16_t Channel;		// Plus 0x80 for a counter increment.
+  uint16_t Value;
+  uint16_t Mask;
+} HostCell_t;
+
+typedef struct HostIo
+{
+  HostOutputRange_t Outputs[MAX_HOST_OUTPUTS];
+  int NumOutputs;
+  unsigned Head, Tail;
+  HostCell_t Cells[HOST_QUEUE_SIZE];
+} HostIo_t;
+
+int HostAttach (agc_t *State);
+void HostDetach (agc_t *State);
+int HostRegisterOutput (agc_t *State, int First, int Last,
+			HostOutput_t Callback, void *Data);
+int HostPushInput (agc_t *State, int Channel, int Value, int Mask);
+int HostPushIncrement (agc_t *State, int Counter, int Type);
+int HostPushIncrements (agc_t *State, int Counter, int Value);
+
+// For SocketAPI.c.
+int HostInput (agc_t *State);
+void HostOutput (agc_t *State, int Channel, int Value);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // AGC_HOST_H
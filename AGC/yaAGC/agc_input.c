@@ -0,0 +1,290 @@
+/*
+  Copyright 2026 Ronald S. Burkey <info@sandroid.org>
+
+  This file is part of yaAGC.
+
+  yaAGC is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  yaAGC is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with yaAGC; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+  Filename:	agc_input.c
+  Purpose:	Acts on input from the peripherals, and records it to a
+  		file or replays it from one.
+  Compiler:	GNU gcc.
+  Contact:	Ron Burkey <info@sandroid.org>
+  Reference:	http://www.ibiblio.org/apollo/index.html
+  Mods:		2026-10-17	Began.
+		2026-10-17	Bulk counter increments.
+		2026-10-17	The recording begins with a snapshot of the
+				CPU's state, which the replay starts from.
+		2026-10-17	Opening the recording, and its snapshot, moved
+				to agc_snapshot.c, so that the peripherals
+				that use AcceptInput needn't link it.
+
+  Everything the peripherals send to the CPU --- DSKY keystrokes on
+  channel 015, uplink on 0173, the RHC on 0166-0170, and all of the other
+  input channels, plus unprogrammed counter increments such as for the
+  CDUs and PIPAs --- goes through AcceptInput.  While State->InputLog.Record
+  is open, each such input is also written to it, along with the machine
+  cycle it was accepted in.
+
+  The replay starts by restoring the CPU's state from when the recording
+  began, in place of whatever core dump the CPU was loaded from.  Opening
+  the file and reading or writing that state is done by StartInputReplay
+  and StartInputRecord in agc_snapshot.c, which only yaAGC itself links;
+  they then hand the file to BeginInputReplay or BeginInputRecord here.  While
+  State->InputLog.Replay is open, ChannelInput (in SocketAPI.c) leaves the
+  sockets alone and just calls ReplayInput, which hands each recorded input
+  back to AcceptInput in exactly the machine cycle it was recorded in.
+  Since nothing else from outside affects the CPU, the replay then follows
+  the recorded run exactly, however fast it is run, and whether or not
+  idle loops are skipped.  The replay ends (setting State->RunStop) at the
+  cycle where the recording was stopped.
+
+  The file begins with the 8-byte INPUT_LOG_MAGIC, the 8-byte
+  little-endian CycleCounter at which recording began, and a binary
+  snapshot of the CPU's state then (see agc_snapshot.c), which has to
+  have been made on a machine of the same byte order.  Each input follows
+  as the number of cycles since the one before (or since the beginning),
+  doubled, as a little-endian base-128 varint; then a byte for the channel
+  (with 0x80 added for a counter increment, as in the socket protocol) and
+  two little-endian bytes for the value.  The end of the recording is the
+  same, except that the doubled count has 1 added and nothing follows it.
+  So a few bytes per input are all that's needed.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "yaAGC.h"
+#include "agc_engine.h"
+
+//-------------------------------------------------------------------------
+// Acts on one input from a peripheral:  a value for an input channel, or
+// an unprogrammed increment of counter Channel & 0x7F if Channel & 0x80,
+// with Value as the type of increment (or, with BULK_INCREMENT, a whole
+// run of them, as for BulkIncrement).  Channel values are as they are
+// to be written, so any masking has already been done.  Returns 1 if it
+// was a counter increment, which uses up the machine cycle.
+
+int
+AcceptInput (agc_t *State, int Channel, int Value)
+{
+  if (State->InputLog.Record != NULL)
+    RecordInput (State, Channel, Value);
+
+  if (Channel & 0x80)
+    {
+      if (Value & BULK_INCREMENT)
+	BulkIncrement (State, Channel, Value);
+      else
+	UnprogrammedIncrement (State, Channel, Value);
+      return (1);
+    }
+
+  WriteIO (State, Channel, Value);
+  // If this is a keystroke from the DSKY, generate an interrupt req.
+  if (Channel == 015)
+    State->InterruptRequests[5] = 1;
+  // If this is on fictitious input channel 0173, then the data
+  // should be placed in the INLINK counter register, and an
+  // UPRUPT interrupt request should be set.
+  else if (Channel == 0173)
+    {
+      State->Erasable[0][RegINLINK] = (Value & 077777);
+      State->InterruptRequests[7] = 1;
+    }
+  // Fictitious registers for rotational hand controller (RHC).
+  // Note that the RHC angles are not immediately used, but
+  // merely squirreled away for later.  They won't actually
+  // go into the counter registers until the RHC counters are
+  // enabled and the data requested (bits 8,9 of channel 13).
+  else if (Channel == 0166)
+    {
+      State->LastRhcPitch = Value;
+      ChannelOutput (State, Channel, Value);      // echo
+    }
+  else if (Channel == 0167)
+    {
+      State->LastRhcYaw = Value;
+      ChannelOutput (State, Channel, Value);      // echo
+    }
+  else if (Channel == 0170)
+    {
+      State->LastRhcRoll = Value;
+      ChannelOutput (State, Channel, Value);      // echo
+    }
+  else if (Channel == 031)
+    {
+      int InDetent;
+      ChannelOutput (State, Channel, Value);
+      // If the RHC stick has moved out of detent,
+      // generate a RUPT10 interrupt.
+      InDetent = (040000 & Value);
+      if (State->LastInDetent && !InDetent)
+	State->InterruptRequests[10] = 1;
+      State->LastInDetent = InDetent;
+    }
+  return (0);
+}
+
+//-------------------------------------------------------------------------
+// Recording.
+
+static void
+WriteVarint (FILE *fp, uint64_t Value)
+{
+  while (Value >= 0x80)
+    {
+      putc (0x80 | (Value & 0x7F), fp);
+      Value >>= 7;
+    }
+  putc ((int) Value, fp);
+}
+
+// Starts recording the input to fp, which StartInputRecord (in
+// agc_snapshot.c) has already begun with the header and the snapshot of
+// the CPU's state.
+
+void
+BeginInputRecord (agc_t *State, FILE *fp)
+{
+  State->InputLog.Record = fp;
+  State->InputLog.RecordCycle = State->CycleCounter;
+}
+
+void
+RecordInput (agc_t *State, int Channel, int Value)
+{
+  FILE *fp = State->InputLog.Record;
+
+  WriteVarint (fp, 2 * (State->CycleCounter - State->InputLog.RecordCycle));
+  State->InputLog.RecordCycle = State->CycleCounter;
+  putc (Channel & 0xFF, fp);
+  putc (Value & 0xFF, fp);
+  putc ((Value >> 8) & 0xFF, fp);
+}
+
+// Marks the end of the recording, and closes it.
+
+void
+StopInputRecord (agc_t *State)
+{
+  FILE *fp = State->InputLog.Record;
+
+  if (fp == NULL)
+    return;
+  WriteVarint (fp, 2 * (State->CycleCounter - State->InputLog.RecordCycle) + 1);
+  fclose (fp);
+  State->InputLog.Record = NULL;
+}
+
+//-------------------------------------------------------------------------
+// Replay.
+
+// Reads the next input from the replay into State->InputLog.  If there's
+// none, because the end was reached or the file is truncated, NextChannel
+// is set to -1.  A truncated recording (cut short by a crash, say) just
+// ends with its last input.
+
+static void
+ReadNextInput (agc_t *State)
+{
+  InputLog_t *Log = &State->InputLog;
+  uint64_t Count = 0;
+  int c, Shift = 0, Channel, Lo, Hi;
+
+  do
+    {
+      c = getc (Log->Replay);
+      if (c == EOF || Shift > 63)
+	goto Truncated;
+      Count |= (uint64_t) (c & 0x7F) << Shift;
+      Shift += 7;
+    }
+  while (c & 0x80);
+  if (Count & 1)
+    {
+      Log->NextCycle += Count / 2;
+      Log->NextChannel = -1;
+      return;
+    }
+  Channel = getc (Log->Replay);
+  Lo = getc (Log->Replay);
+  Hi = getc (Log->Replay);
+  if (Channel == EOF || Lo == EOF || Hi == EOF)
+    goto Truncated;
+  Log->NextCycle += Count / 2;
+  Log->NextChannel = Channel;
+  Log->NextValue = Lo | (Hi << 8);
+  return;
+
+Truncated:
+  Log->NextChannel = -1;
+}
+
+// Starts replaying the input from fp, which StartInputReplay (in
+// agc_snapshot.c) has already read up to the first input, restoring the
+// CPU's state from when the recording began.
+
+void
+BeginInputReplay (agc_t *State, FILE *fp)
+{
+  State->InputLog.Replay = fp;
+  State->InputLog.NextCycle = State->CycleCounter;
+  State->InputLog.Finished = 0;
+  ReadNextInput (State);
+}
+
+// Used by ChannelInput in place of the sockets while replaying, and so
+// returns the same:  1 if a counter increment was performed, and 0
+// otherwise.
+
+int
+ReplayInput (agc_t *State)
+{
+  InputLog_t *Log = &State->InputLog;
+
+  while (State->CycleCounter >= Log->NextCycle)
+    {
+      // Have agc_engine_run count the quiet cycles again, with the next
+      // input in view, so that it doesn't fast-forward past it.
+      State->QuietCycles = 0;
+      if (Log->NextChannel < 0)
+	{
+	  StopInputReplay (State);
+	  Log->Finished = 1;
+	  State->RunStop = 1;
+	  return (0);
+	}
+      // A counter increment uses up the cycle, so if there are more
+      // inputs in this cycle (which can only happen if the recording was
+      // made some other way), they're left for the next.
+      if (AcceptInput (State, Log->NextChannel, Log->NextValue))
+	{
+	  ReadNextInput (State);
+	  return (1);
+	}
+      ReadNextInput (State);
+    }
+  return (0);
+}
+
+void
+StopInputReplay (agc_t *State)
+{
+  if (State->InputLog.Replay == NULL)
+    return;
+  fclose (State->InputLog.Replay);
+  State->InputLog.Replay = NULL;
+}
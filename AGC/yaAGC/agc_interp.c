@@ -0,0 +1,892 @@
+/*
+  Copyright 2026 Ronald S. Burkey <info@sandroid.org>
+
+  This file is part of yaAGC.
+
+  yaAGC is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  yaAGC is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with yaAGC; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+  Filename:	agc_interp.c
+  Purpose:	A profile and a trace of the AGC's interpretive
+  		instructions (--interp-report and --interp-trace).
+  Compiler:	GNU gcc.
+  Contact:	Ron Burkey <info@sandroid.org>
+  Reference:	http://www.ibiblio.org/apollo/index.html
+  Mods:		2026-10-17	Began.
+		2026-10-17	The trace file and its symbol names are kept
+				with each agc_t's counts, rather than in
+				statics shared by all CPUs.
+		2026-10-17	Each switch instruction is counted on its
+				own, and its switch is named.
+
+  Most of the navigation and guidance is written in the interpretive
+  language, so an instruction profile (--profile) or trace (--trace) of
+  it shows mostly the interpreter itself.  While State->Interpreter is
+  set, agc_engine.c watches the interpreter's dispatcher instead, at the
+  labels NEWOPS, OPJUMP, and DOSTORE from the symbol table (the same
+  places the original ITRACE comments in INTERPRETER.agc refer to), and
+  counts each op code and store code dispatched, and the machine cycles
+  from it to the next dispatch, by code and by the word of interpretive
+  code holding it.  Those cycles include the time spent in interrupts;
+  the clock is stopped by EXIT, and by CHANG2 when an interpretive job
+  gives way to another job.  The report lists the instructions, the
+  routines (resolved with ResolveLineAGC and ResolveLastLabel, as in
+  agc_profile.c), and the source lines that took the most cycles.
+
+  For the trace, agc_engine.c also records each dispatch, with LOC's next
+  two words, and this file prints them between runs of the CPU, decoded
+  with a copy of yaYUL's table of op codes, one line per instruction:
+
+	#      Cycle Location Job  Label      Source               ...
+	      943018 11,3456  0401 MINIRECT   ORBITAL_INTEGRATION.agc:640 ...
+		... STOVL   VCV ZEROVEC
+
+  Op codes whose meaning depends on whether the result so far is a
+  vector or a scalar (VSL2 and SL1, for example) are named according to
+  MODE.  Operands are named with the symbol table where possible, and
+  addresses below 45 decimal in the job's work area are shown as nnD, as
+  they are in the source.  The switches that BON, SET, and the rest test
+  and change are named by the constants equated to their numbers after
+  FLAGWRD0 in the erasable assignments (AVEGFLAG = 115D, for example).  Idle loops can still be skipped (--idle-skip),
+  since no interpretive instruction is ever running during them.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "yaAGC.h"
+#include "agc_engine.h"
+#include "agc_symtab.h"
+#include "agc_trace.h"
+#include "agc_interp.h"
+
+extern Symbol_t *SymbolTable;	// Owned by agc_symtab.
+extern int SymbolTableSize;
+
+// How many entries of the longer lists are shown.
+#define INTERP_TOP_ROUTINES 50
+#define INTERP_TOP_WORDS 25
+
+// The interpretive op codes, from InterpreterOpcodesBlock2 in yaYUL.h
+// (which can't simply be included, since it's full of yaYUL's parser
+// tables), but in the order of their codes, and with only the name more
+// often used in Luminary where yaYUL accepts two (ACOS and ARCCOS, for
+// example).  Mode is INTERP_SCALAR or INTERP_VECTOR for the codes that
+// mean one thing when MODE is scalar and another when it's vector.
+#define INTERP_SCALAR 1
+#define INTERP_VECTOR 2
+typedef struct {
+  char Name[1 + MAX_LABEL_LENGTH];
+  unsigned char Code;
+  unsigned char NumOperands;
+  unsigned char SwitchInstruction;	// 0 normally, 1 switch, 2 shifts.
+  int nnnn0000;
+  unsigned char ArgTypes[2];
+  unsigned char Mode;
+} InterpOpcode_t;
+static const InterpOpcode_t InterpOpcodes[] = {
+  { "EXIT",   0000, 0, 0, 000000, { 0, 0 }, 0 },
+  { "VLOAD",  0001, 1, 0, 000000, { 1, 0 }, 0 },
+  { "AXT,2",  0002, 1, 0, 000000, { 0, 0 }, 0 },
+  { "VLOAD*", 0003, 1, 0, 000000, { 1, 0 }, 0 },
+  { "SL1R",   0004, 0, 0, 000000, { 1, 0 }, INTERP_SCALAR },
+  { "VSL1",   0004, 0, 0, 000000, { 1, 0 }, INTERP_VECTOR },
+  { "TAD",    0005, 1, 0, 000000, { 1, 0 }, 0 },
+  { "AXT,1",  0006, 1, 0, 000000, { 0, 0 }, 0 },
+  { "TAD*",   0007, 1, 0, 000000, { 1, 0 }, 0 },
+  { "SQRT",   0010, 0, 0, 000000, { 0, 0 }, 0 },
+  { "SIGN",   0011, 1, 0, 000000, { 1, 0 }, 0 },
+  { "AXC,2",  0012, 1, 0, 000000, { 0, 0 }, 0 },
+  { "SIGN*",  0013, 1, 0, 000000, { 1, 0 }, 0 },
+  { "SR1R",   0014, 0, 0, 000000, { 1, 0 }, INTERP_SCALAR },
+  { "VSR1",   0014, 0, 0, 000000, { 1, 0 }, INTERP_VECTOR },
+  { "VXSC",   0015, 1, 0, 000000, { 1, 0 }, 0 },
+  { "AXC,1",  0016, 1, 0, 000000, { 0, 0 }, 0 },
+  { "VXSC*",  0017, 1, 0, 000000, { 1, 0 }, 0 },
+  { "SIN",    0020, 0, 0, 000000, { 0, 0 }, 0 },
+  { "CGOTO",  0021, 2, 0, 000000, { 1, 0 }, 0 },
+  { "LXA,2",  0022, 1, 0, 000000, { 0, 0 }, 0 },
+  { "CGOTO*", 0023, 2, 0, 000000, { 1, 0 }, 0 },
+  { "SL1",    0024, 0, 0, 000000, { 1, 0 }, INTERP_SCALAR },
+  { "VSL2",   0024, 0, 0, 000000, { 1, 0 }, INTERP_VECTOR },
+  { "TLOAD",  0025, 1, 0, 000000, { 1, 0 }, 0 },
+  { "LXA,1",  0026, 1, 0, 000000, { 0, 0 }, 0 },
+  { "TLOAD*", 0027, 1, 0, 000000, { 1, 0 }, 0 },
+  { "COS",    0030, 0, 0, 000000, { 0, 0 }, 0 },
+  { "DLOAD",  0031, 1, 0, 000000, { 1, 0 }, 0 },
+  { "LXC,2",  0032, 1, 0, 000000, { 0, 0 }, 0 },
+  { "DLOAD*", 0033, 1, 0, 000000, { 1, 0 }, 0 },
+  { "SR1",    0034, 0, 0, 000000, { 1, 0 }, INTERP_SCALAR },
+  { "VSR2",   0034, 0, 0, 000000, { 1, 0 }, INTERP_VECTOR },
+  { "V/SC",   0035, 1, 0, 000000, { 1, 0 }, 0 },
+  { "LXC,1",  0036, 1, 0, 000000, { 0, 0 }, 0 },
+  { "V/SC*",  0037, 1, 0, 000000, { 1, 0 }, 0 },
+  { "ASIN",   0040, 0, 0, 000000, { 0, 0 }, 0 },
+  { "SLOAD",  0041, 1, 0, 000000, { 1, 0 }, 0 },
+  { "SXA,2",  0042, 1, 0, 000000, { 0, 0 }, 0 },
+  { "SLOAD*", 0043, 1, 0, 000000, { 1, 0 }, 0 },
+  { "SL2R",   0044, 0, 0, 000000, { 1, 0 }, INTERP_SCALAR },
+  { "VSL3",   0044, 0, 0, 000000, { 1, 0 }, INTERP_VECTOR },
+  { "SSP",    0045, 2, 0, 000000, { 1, 0 }, 0 },
+  { "SXA,1",  0046, 1, 0, 000000, { 0, 0 }, 0 },
+  { "SSP*",   0047, 1, 0, 000000, { 1, 0 }, 0 },
+  { "ACOS",   0050, 0, 0, 000000, { 0, 0 }, 0 },
+  { "PDDL",   0051, 1, 0, 000000, { 1, 0 }, 0 },
+  { "XCHX,2", 0052, 1, 0, 000000, { 0, 0 }, 0 },
+  { "PDDL*",  0053, 1, 0, 000000, { 1, 0 }, 0 },
+  { "SR2R",   0054, 0, 0, 000000, { 1, 0 }, INTERP_SCALAR },
+  { "VSR3",   0054, 0, 0, 000000, { 1, 0 }, INTERP_VECTOR },
+  { "MXV",    0055, 1, 0, 000000, { 1, 0 }, 0 },
+  { "XCHX,1", 0056, 1, 0, 000000, { 0, 0 }, 0 },
+  { "MXV*",   0057, 1, 0, 000000, { 1, 0 }, 0 },
+  { "DSQ",    0060, 0, 0, 000000, { 0, 0 }, 0 },
+  { "PDVL",   0061, 1, 0, 000000, { 1, 0 }, 0 },
+  { "INCR,2", 0062, 1, 0, 000000, { 0, 0 }, 0 },
+  { "PDVL*",  0063, 1, 0, 000000, { 1, 0 }, 0 },
+  { "SL2",    0064, 0, 0, 000000, { 1, 0 }, INTERP_SCALAR },
+  { "VSL4",   0064, 0, 0, 000000, { 1, 0 }, INTERP_VECTOR },
+  { "CCALL",  0065, 2, 0, 000000, { 1, 0 }, 0 },
+  { "INCR,1", 0066, 1, 0, 000000, { 0, 0 }, 0 },
+  { "CCALL*", 0067, 2, 0, 000000, { 1, 0 }, 0 },
+  { "ROUND",  0070, 0, 0, 000000, { 0, 0 }, 0 },
+  { "VXM",    0071, 1, 0, 000000, { 1, 0 }, 0 },
+  { "TIX,2",  0072, 1, 0, 000000, { 0, 0 }, 0 },
+  { "VXM*",   0073, 1, 0, 000000, { 1, 0 }, 0 },
+  { "SR2",    0074, 0, 0, 000000, { 1, 0 }, INTERP_SCALAR },
+  { "VSR4",   0074, 0, 0, 000000, { 1, 0 }, INTERP_VECTOR },
+  { "NORM",   0075, 1, 0, 000000, { 1, 0 }, 0 },
+  { "TIX,1",  0076, 1, 0, 000000, { 0, 0 }, 0 },
+  { "NORM*",  0077, 1, 0, 000000, { 1, 0 }, 0 },
+  { "DCOMP",  0100, 0, 0, 000000, { 0, 0 }, INTERP_SCALAR },
+  { "VCOMP",  0100, 0, 0, 000000, { 0, 0 }, INTERP_VECTOR },
+  { "DMPR",   0101, 1, 0, 000000, { 1, 0 }, 0 },
+  { "XAD,2",  0102, 1, 0, 000000, { 0, 0 }, 0 },
+  { "DMPR*",  0103, 1, 0, 000000, { 1, 0 }, 0 },
+  { "SL3R",   0104, 0, 0, 000000, { 1, 0 }, INTERP_SCALAR },
+  { "VSL5",   0104, 0, 0, 000000, { 1, 0 }, INTERP_VECTOR },
+  { "DDV",    0105, 1, 0, 000000, { 1, 0 }, 0 },
+  { "XAD,1",  0106, 1, 0, 000000, { 0, 0 }, 0 },
+  { "DDV*",   0107, 1, 0, 000000, { 1, 0 }, 0 },
+  { "VDEF",   0110, 0, 0, 000000, { 0, 0 }, 0 },
+  { "BDDV",   0111, 1, 0, 000000, { 1, 0 }, 0 },
+  { "XSU,2",  0112, 1, 0, 000000, { 0, 0 }, 0 },
+  { "BDDV*",  0113, 1, 0, 000000, { 1, 0 }, 0 },
+  { "SR3R",   0114, 0, 0, 000000, { 1, 0 }, INTERP_SCALAR },
+  { "VSR5",   0114, 0, 0, 000000, { 1, 0 }, INTERP_VECTOR },
+  { "SL",     0115, 1, 2, 020202, { 1, 0 }, INTERP_SCALAR },
+  { "SLR",    0115, 1, 2, 021202, { 1, 0 }, INTERP_SCALAR },
+  { "SR",     0115, 1, 2, 020602, { 1, 0 }, INTERP_SCALAR },
+  { "SRR",    0115, 1, 2, 021602, { 1, 0 }, INTERP_SCALAR },
+  { "VSL",    0115, 1, 2, 020202, { 1, 0 }, INTERP_VECTOR },
+  { "VSR",    0115, 1, 2, 020602, { 1, 0 }, INTERP_VECTOR },
+  { "XSU,1",  0116, 1, 0, 000000, { 0, 0 }, 0 },
+  { "SL*",    0117, 1, 2, 020202, { 1, 0 }, INTERP_SCALAR },
+  { "SLR*",   0117, 1, 2, 021202, { 1, 0 }, INTERP_SCALAR },
+  { "SR*",    0117, 1, 2, 020602, { 1, 0 }, INTERP_SCALAR },
+  { "SRR*",   0117, 1, 2, 021602, { 1, 0 }, INTERP_SCALAR },
+  { "VSL*",   0117, 1, 2, 020202, { 1, 0 }, INTERP_VECTOR },
+  { "VSR*",   0117, 1, 2, 020602, { 1, 0 }, INTERP_VECTOR },
+  { "UNIT",   0120, 0, 0, 000000, { 0, 0 }, 0 },
+  { "VAD",    0121, 1, 0, 000000, { 1, 0 }, 0 },
+  { "BZE",    0122, 1, 0, 000000, { 0, 0 }, 0 },
+  { "VAD*",   0123, 1, 0, 000000, { 1, 0 }, 0 },
+  { "SL3",    0124, 0, 0, 000000, { 1, 0 }, INTERP_SCALAR },
+  { "VSL6",   0124, 0, 0, 000000, { 1, 0 }, INTERP_VECTOR },
+  { "VSU",    0125, 1, 0, 000000, { 1, 0 }, 0 },
+  { "GOTO",   0126, 1, 0, 000000, { 0, 0 }, 0 },
+  { "VSU*",   0127, 1, 0, 000000, { 1, 0 }, 0 },
+  { "ABS",    0130, 0, 0, 000000, { 0, 0 }, INTERP_SCALAR },
+  { "ABVAL",  0130, 0, 0, 000000, { 0, 0 }, INTERP_VECTOR },
+  { "BVSU",   0131, 1, 0, 000000, { 1, 0 }, 0 },
+  { "BPL",    0132, 1, 0, 000000, { 0, 0 }, 0 },
+  { "BVSU*",  0133, 1, 0, 000000, { 1, 0 }, 0 },
+  { "SR3",    0134, 0, 0, 000000, { 1, 0 }, INTERP_SCALAR },
+  { "VSR6",   0134, 0, 0, 000000, { 1, 0 }, INTERP_VECTOR },
+  { "DOT",    0135, 1, 0, 000000, { 1, 0 }, 0 },
+  { "BMN",    0136, 1, 0, 000000, { 0, 0 }, 0 },
+  { "DOT*",   0137, 1, 0, 000000, { 1, 0 }, 0 },
+  { "VSQ",    0140, 0, 0, 000000, { 0, 0 }, 0 },
+  { "VXV",    0141, 1, 0, 000000, { 1, 0 }, 0 },
+  { "RTB",    0142, 1, 0, 000000, { 0, 0 }, 0 },
+  { "VXV*",   0143, 1, 0, 000000, { 1, 0 }, 0 },
+  { "SL4R",   0144, 0, 0, 000000, { 1, 0 }, INTERP_SCALAR },
+  { "VSL7",   0144, 0, 0, 000000, { 1, 0 }, INTERP_VECTOR },
+  { "VPROJ",  0145, 1, 0, 000000, { 1, 0 }, 0 },
+  { "BHIZ",   0146, 1, 0, 000000, { 0, 0 }, 0 },
+  { "VPROJ*", 0147, 1, 0, 000000, { 1, 0 }, 0 },
+  { "STADR",  0150, 0, 0, 000000, { 0, 0 }, 0 },
+  { "DSU",    0151, 1, 0, 000000, { 1, 0 }, 0 },
+  { "CALL",   0152, 1, 0, 000000, { 0, 0 }, 0 },
+  { "DSU*",   0153, 1, 0, 000000, { 1, 0 }, 0 },
+  { "SR4R",   0154, 0, 0, 000000, { 1, 0 }, INTERP_SCALAR },
+  { "VSR7",   0154, 0, 0, 000000, { 1, 0 }, INTERP_VECTOR },
+  { "BDSU",   0155, 1, 0, 000000, { 1, 0 }, 0 },
+  { "STQ",    0156, 1, 0, 000000, { 0, 0 }, 0 },
+  { "BDSU*",  0157, 1, 0, 000000, { 1, 0 }, 0 },
+  { "RVQ",    0160, 0, 0, 000000, { 0, 0 }, 0 },
+  { "DAD",    0161, 1, 0, 000000, { 1, 0 }, 0 },
+  { "BON",    0162, 2, 1, 000301, { 0, 0 }, 0 },
+  { "BOFF",   0162, 2, 1, 000341, { 0, 0 }, 0 },
+  { "SET",    0162, 1, 1, 000061, { 0, 0 }, 0 },
+  { "CLEAR",  0162, 1, 1, 000261, { 0, 0 }, 0 },
+  { "INVERT", 0162, 1, 1, 000161, { 0, 0 }, 0 },
+  { "SETGO",  0162, 2, 1, 000021, { 0, 0 }, 0 },
+  { "CLRGO",  0162, 2, 1, 000221, { 0, 0 }, 0 },
+  { "INVGO",  0162, 2, 1, 000121, { 0, 0 }, 0 },
+  { "BONSET", 0162, 2, 1, 000001, { 0, 0 }, 0 },
+  { "BONCLR", 0162, 2, 1, 000201, { 0, 0 }, 0 },
+  { "BONINV", 0162, 2, 1, 000101, { 0, 0 }, 0 },
+  { "BOFSET", 0162, 2, 1, 000041, { 0, 0 }, 0 },
+  { "BOFCLR", 0162, 2, 1, 000241, { 0, 0 }, 0 },
+  { "BOFINV", 0162, 2, 1, 000141, { 0, 0 }, 0 },
+  { "DAD*",   0163, 1, 0, 000000, { 1, 0 }, 0 },
+  { "SL4",    0164, 0, 0, 000000, { 1, 0 }, INTERP_SCALAR },
+  { "VSL8",   0164, 0, 0, 000000, { 1, 0 }, INTERP_VECTOR },
+  { "PUSH",   0170, 0, 0, 000000, { 0, 0 }, 0 },
+  { "DMP",    0171, 1, 0, 000000, { 1, 0 }, 0 },
+  { "BOVB",   0172, 1, 0, 000000, { 0, 0 }, 0 },
+  { "DMP*",   0173, 1, 0, 000000, { 1, 0 }, 0 },
+  { "SR4",    0174, 0, 0, 000000, { 1, 0 }, INTERP_SCALAR },
+  { "VSR8",   0174, 0, 0, 000000, { 1, 0 }, INTERP_VECTOR },
+  { "SETPD",  0175, 1, 0, 000000, { 1, 0 }, 0 },
+  { "BOV",    0176, 1, 0, 000000, { 0, 0 }, 0 }
+};
+#define NUM_INTERP_OPCODES (sizeof (InterpOpcodes) / sizeof (InterpOpcodes[0]))
+
+// The store codes, which take the place of an op code pair.
+static const char *StoreNames[8] = {
+  "STORE", "STORE,1", "STORE,2", "STODL", "STODL*", "STOVL", "STOVL*", "STCALL"
+};
+
+// The switch numbers there can be, 15 to each of the 64 flag words that
+// the first operand of a switch instruction can pick.
+#define INTERP_SWITCHES (0100 * 15)
+
+// What InterpStart allocates for each agc_t:  the counts (State->Interpreter
+// points to them), and the trace being written from them, if any.
+typedef struct
+{
+  Interpreter_t Interp;
+  FILE *File;				// The trace, or NULL.
+  int Error;
+  const char **Names;			// Symbols, by trace address.
+  const char *Switches[INTERP_SWITCHES];	// Symbols, by switch number.
+} InterpTracer_t;
+
+typedef struct
+{
+  Symbol_t *Label;
+  SymbolLine_t *Line;
+  int Location;
+  unsigned Count;
+  uint64_t Cycles;
+} InterpWord_t;
+
+// Returns the source line for the word at a trace address, or NULL.
+static SymbolLine_t *
+InterpLine (int Address)
+{
+  int Bank;
+
+  if (Address < 04000)
+    return (NULL);
+  Address -= 04000;
+  Bank = Address / 02000;
+  if (Bank == 2 || Bank == 3)
+    return (ResolveLineAGC (Address, Bank, 0));
+  return (ResolveLineAGC (02000 + (Address & 01777),
+			  (Bank < 040) ? Bank : Bank - 010, Bank >= 040));
+}
+
+// Formats a trace address the way agc_trace.c does.
+static void
+InterpWhere (char *Where, int Address)
+{
+  if (Address < 01400)
+    sprintf (Where, "%04o", Address);
+  else if (Address < 04000)
+    sprintf (Where, "E%o,%04o", Address / 0400, 01400 + (Address & 0377));
+  else if (Address < 04000 + 04000 || Address >= 04000 + 04 * 02000)
+    sprintf (Where, "%02o,%04o", (Address - 04000) / 02000,
+	     02000 + (Address & 01777));
+  else
+    sprintf (Where, "%04o", Address - 04000);
+}
+
+// Finds the op code, given whether MODE was vector and, for the switch and
+// shift instructions, which are told apart by their operands, the first
+// word after it (or -1 if not known).
+static const InterpOpcode_t *
+InterpOpcode (int Code, int Vector, int Word)
+{
+  const InterpOpcode_t *Op, *Found = NULL;
+  int Mode = Vector ? INTERP_VECTOR : INTERP_SCALAR, Shift = -1;
+
+  // The shift count was incremented, and complemented if ,2.
+  if (Word != -1)
+    Shift = ((Word & 040000) ? (~Word & 037777) : Word) - 1;
+  for (Op = InterpOpcodes; Op < &InterpOpcodes[NUM_INTERP_OPCODES]; Op++)
+    {
+      if (Op->Code != Code)
+	continue;
+      if (Word != -1 && Op->SwitchInstruction == 1
+	  && (Word & 0360) != (Op->nnnn0000 & 0360))
+	continue;
+      if (Word != -1 && Op->SwitchInstruction == 2
+	  && (Shift & 01600) != (Op->nnnn0000 & 01600))
+	continue;
+      if (Op->Mode == 0 || Op->Mode == Mode)
+	return (Op);
+      if (Found == NULL)
+	Found = Op;
+    }
+  // A negative shift count (VSL* 0 -7,2, for example) garbles the bits
+  // that tell the shifts apart.
+  if (Found == NULL && Word != -1)
+    return (InterpOpcode (Code, Vector, -1));
+  return (Found);
+}
+
+// Names the instruction, for the report.  The shift instructions can only
+// be named as a group.
+static void
+InterpCodeName (char *Name, int Code, int Vector)
+{
+  const InterpOpcode_t *Op;
+
+  if (Code >= INTERP_SWITCH)
+    {
+      Op = InterpOpcode (INTERP_SWITCH_OP, Vector, (Code - INTERP_SWITCH) << 4);
+      if (Op != NULL && ((Op->nnnn0000 >> 4) & 017) == Code - INTERP_SWITCH)
+	strcpy (Name, Op->Name);
+      else
+	sprintf (Name, "%03o,%02o", INTERP_SWITCH_OP, Code - INTERP_SWITCH);
+      return;
+    }
+  if (Code >= INTERP_STORE)
+    {
+      strcpy (Name, StoreNames[Code - INTERP_STORE]);
+      return;
+    }
+  Op = InterpOpcode (Code, Vector, -1);
+  if (Op == NULL)
+    sprintf (Name, "%03o", Code);
+  else if (Op->SwitchInstruction)
+    sprintf (Name, "%s etc.", Op->Name);
+  else
+    strcpy (Name, Op->Name);
+}
+
+// Names the address in an interpretive operand, encoded as yaYUL does (see
+// ParseInterpretiveOperand.c):  bank * 0400 + offset below 04000 for
+// erasable memory, and bank * 02000 + offset above it for fixed memory, in
+// the same half of fixed memory as the code at Location.  Addresses below
+// 45 decimal are in the job's work area instead (X1, for example, is 38D),
+// and are shown that way.
+static void
+InterpAddressName (const char **Names, char *Name, int Value, int Location)
+{
+  int Address, Bank;
+
+  if (Value < 45)
+    {
+      sprintf (Name, "%dD", Value);
+      return;
+    }
+  if (Value < 04000)
+    Address = Value;
+  else
+    {
+      Bank = Value / 02000;
+      if (Bank >= 030 && Location >= 04000 + 040 * 02000)
+	Bank += 010;
+      Address = 04000 + Bank * 02000 + (Value & 01777);
+    }
+  if (Names != NULL && Names[Address] != NULL)
+    strcpy (Name, Names[Address]);
+  else
+    InterpWhere (Name, Address);
+}
+
+// Decodes operand n (0 or 1) of Op, the word Word, into Operand.  Those
+// with ArgTypes 1 are addresses incremented by yaYUL, and complemented for
+// index register 2; for the op codes that aren't indexed, a negative word
+// is the next op code pair instead, and the operand comes from the
+// push-down list.  A switch is named from Switches, or shown as nnD.
+static void
+InterpOperand (const char **Names, const char **Switches, char *Operand,
+	       const InterpOpcode_t *Op, int n, int Word, int Location)
+{
+  int Indexed = ((Op->Code & 3) == 3), Index = 1, Switch;
+
+  Operand[0] = 0;
+  if (n == 0 && Op->SwitchInstruction == 1)
+    {
+      Switch = ((Word >> 8) & 077) * 15 + (Word & 017);
+      if (Switches != NULL && Switch < INTERP_SWITCHES
+	  && Switches[Switch] != NULL)
+	strcpy (Operand, Switches[Switch]);
+      else
+	sprintf (Operand, "%dD", Switch);
+      return;
+    }
+  if (Op->ArgTypes[n] != 1)
+    {
+      // Index register constants, and SSP's constant unless it's an
+      // address in fixed memory.
+      if (!strncmp (Op->Name, "AX", 2) || !strncmp (Op->Name, "INCR", 4)
+	  || (n == 1 && !strcmp (Op->Name, "SSP") && Word < 04000))
+	sprintf (Operand, "%dD", (Word & 040000) ? Word - 077777 : Word);
+      else
+	InterpAddressName (Names, Operand, Word, Location);
+      return;
+    }
+  if (Word & 040000)
+    {
+      if (!Indexed)
+	return;
+      Word = ~Word & 037777;
+      Index = 2;
+    }
+  Word--;
+  if (Op->SwitchInstruction == 2)
+    sprintf (Operand, "%d", Word & 0177);
+  else
+    InterpAddressName (Names, Operand, Word, Location);
+  if (Indexed)
+    sprintf (&Operand[strlen (Operand)], ",%d", Index);
+}
+
+// Decodes the instruction in a trace record.
+static void
+InterpDescribe (const char **Names, const char **Switches, char *Text,
+		const InterpRecord_t *Record)
+{
+  const InterpOpcode_t *Op;
+  char Operands[2][64];
+  int Code = Record->Code, Count = 0;
+
+  Operands[0][0] = Operands[1][0] = 0;
+  if (Code >= INTERP_SWITCH)
+    Code = INTERP_SWITCH_OP;
+  else if (Code >= INTERP_STORE)
+    {
+      // The store address (with the store code itself in bits 12-14), and
+      // for STODL and STOVL the load address, or for STCALL the address
+      // called.
+      Code -= INTERP_STORE;
+      InterpAddressName (Names, Operands[0], Record->Operands[0] & 03777,
+			 Record->Location);
+      if (Code == 1 || Code == 2)
+	sprintf (&Operands[0][strlen (Operands[0])], ",%d", Code);
+      Count = 1;
+      if (Code >= 3 && Code <= 6)
+	{
+	  // As for DLOAD, DLOAD*, VLOAD, or VLOAD*.
+	  Op = InterpOpcode (((Code <= 4) ? 0031 : 0001)
+			     + ((Code == 4 || Code == 6) ? 2 : 0), 0, -1);
+	  InterpOperand (Names, Switches, Operands[1], Op, 0,
+			 Record->Operands[1], Record->Location);
+	  Count = 2;
+	}
+      else if (Code == 7)
+	{
+	  InterpAddressName (Names, Operands[1], Record->Operands[1],
+			     Record->Location);
+	  Count = 2;
+	}
+      sprintf (Text, "%-7s %s", (Code <= 2) ? "STORE" : StoreNames[Code],
+	       Operands[0]);
+      if (Count == 2 && Operands[1][0])
+	sprintf (&Text[strlen (Text)], " %s", Operands[1]);
+      return;
+    }
+  Op = InterpOpcode (Code, Record->Vector, Record->Operands[0]);
+  if (Op == NULL)
+    {
+      sprintf (Text, "%03o", Code);
+      return;
+    }
+  if (Op->NumOperands > 0)
+    InterpOperand (Names, Switches, Operands[0], Op, 0, Record->Operands[0],
+		   Record->Location);
+  if (Op->NumOperands > 1)
+    InterpOperand (Names, Switches, Operands[1], Op, 1, Record->Operands[1],
+		   Record->Location);
+  sprintf (Text, "%-7s %s", Op->Name, Operands[0]);
+  if (Operands[1][0])
+    sprintf (&Text[strlen (Text)], " %s", Operands[1]);
+}
+
+// Returns the trace address of a label or variable in the interpreter, or
+// -1 if it isn't in the symbol table or isn't in the right kind of memory.
+static int
+InterpSymbol (const char *Name, int Fixed)
+{
+  int Address = TraceAddress (Name);
+
+  if (Address == -1 || (Address >= 04000) != Fixed)
+    return (-1);
+  return (Address);
+}
+
+// Names the switches, from the constants equated to switch numbers after
+// FLAGWRD0 in the same file.  Where several constants have the same value,
+// the first is used, since the switches come right after FLAGWRD0.
+static void
+InterpSwitchNames (const char **Switches)
+{
+  static char Flagwrd0[] = "FLAGWRD0";
+  Symbol_t *Symbol, *Start;
+  unsigned Lines[INTERP_SWITCHES];
+  int i, n;
+
+  Start = ResolveSymbol (Flagwrd0, SYMBOL_VARIABLE | SYMBOL_CONSTANT);
+  if (Start == NULL)
+    return;
+  for (i = 0; i < SymbolTableSize; i++)
+    {
+      Symbol = &SymbolTable[i];
+      n = Symbol->Value.Value;
+      if (Symbol->Type != SYMBOL_CONSTANT || !Symbol->Value.Constant
+	  || n < 0 || n >= INTERP_SWITCHES
+	  || Symbol->LineNumber <= Start->LineNumber
+	  || strcmp (Symbol->FileName, Start->FileName))
+	continue;
+      if (Switches[n] == NULL || Symbol->LineNumber < Lines[n])
+	{
+	  Switches[n] = Symbol->Name;
+	  Lines[n] = Symbol->LineNumber;
+	}
+    }
+}
+
+// Starts counting State's interpretive instructions, and tracing them to
+// TraceFilename if it isn't NULL.  Returns 0 on success, or 1 if the
+// symbol table doesn't have the interpreter's labels and variables, or the
+// trace can't be written, or if out of memory.
+int
+InterpStart (agc_t *State, const char *TraceFilename)
+{
+  InterpTracer_t *Tracer;
+  Interpreter_t *Interp;
+  Symbol_t *Symbol;
+  int Newops, Opjump, Dostore, Chang2, Address, Pass, i;
+
+  Newops = InterpSymbol ("NEWOPS", 1);
+  Opjump = InterpSymbol ("OPJUMP", 1);
+  Dostore = InterpSymbol ("DOSTORE", 1);
+  Chang2 = InterpSymbol ("CHANG2", 1);
+  if (Newops == -1 || Opjump == -1 || Dostore == -1)
+    return (1);
+  if (State->Interpreter != NULL)
+    return (1);
+  Tracer = (InterpTracer_t *) calloc (1, sizeof (InterpTracer_t));
+  if (Tracer == NULL)
+    return (1);
+  Interp = &Tracer->Interp;
+  Interp->Loc = InterpSymbol ("LOC", 0);
+  Interp->Bankset = InterpSymbol ("BANKSET", 0);
+  Interp->Mode = InterpSymbol ("MODE", 0);
+  Interp->Fixloc = InterpSymbol ("FIXLOC", 0);
+  if (Interp->Loc == -1 || Interp->Bankset == -1 || Interp->Mode == -1
+      || Interp->Fixloc == -1)
+    goto Fail;
+  Interp->Newops = &State->Fixed[0][Newops - 04000];
+  Interp->Opjump = &State->Fixed[0][Opjump - 04000];
+  Interp->Dostore = &State->Fixed[0][Dostore - 04000];
+  if (Chang2 != -1)
+    Interp->Chang2 = &State->Fixed[0][Chang2 - 04000];
+  Interp->Pair = -1;
+  Interp->StartCycle = State->CycleCounter;
+
+  if (TraceFilename != NULL)
+    {
+      Tracer->Names = (const char **) calloc (TRACE_ADDRESSES,
+					      sizeof (char *));
+      if (Tracer->Names == NULL)
+	goto Fail;
+      // Labels and variables first, then the many names given to them
+      // with EQUALS.
+      for (Pass = 0; Pass < 2; Pass++)
+	for (i = 0; i < SymbolTableSize; i++)
+	  {
+	    Symbol = &SymbolTable[i];
+	    if (Pass == 0
+		&& !(Symbol->Type & (SYMBOL_LABEL | SYMBOL_VARIABLE)))
+	      continue;
+	    if (Pass == 1 && (Symbol->Type != SYMBOL_CONSTANT
+			      || Symbol->Value.Constant))
+	      continue;
+	    Address = TraceSymbolAddress (&Symbol->Value);
+	    if (Address >= 0 && Address < TRACE_ADDRESSES
+		&& Tracer->Names[Address] == NULL)
+	      Tracer->Names[Address] = Symbol->Name;
+	  }
+      InterpSwitchNames (Tracer->Switches);
+      Tracer->File = fopen (TraceFilename, "w");
+      if (Tracer->File == NULL)
+	goto Fail;
+      fprintf (Tracer->File, "# Each interpretive instruction dispatched:  the "
+	       "machine cycle, where its op code\n# pair or store code is, "
+	       "the job's work area (FIXLOC), and the instruction.\n");
+      fprintf (Tracer->File, "#%11s %-8s %-4s %-10s %-30s %s\n", "Cycle",
+	       "Location", "Job", "Label", "Source", "Instruction");
+      Interp->Tracing = 1;
+    }
+  State->Interpreter = Interp;
+  return (0);
+Fail:
+  free (Tracer->Names);
+  free (Tracer);
+  return (1);
+}
+
+// Writes the instructions recorded since the last time to the trace.
+void
+InterpFlush (agc_t *State)
+{
+  Interpreter_t *Interp = State->Interpreter;
+  InterpTracer_t *Tracer = (InterpTracer_t *) Interp;	// Its first member.
+  const InterpRecord_t *Record;
+  SymbolLine_t *Line;
+  Symbol_t *Label;
+  char Where[16], Source[MAX_FILE_LENGTH + 16], Text[160];
+  int i;
+
+  if (Interp == NULL || Tracer->File == NULL)
+    return;
+  for (i = 0, Record = Interp->Buffer; i < Interp->Buffered; i++, Record++)
+    {
+      InterpWhere (Where, Record->Location);
+      Line = InterpLine (Record->Location);
+      Label = NULL;
+      Source[0] = 0;
+      if (Line != NULL)
+	{
+	  Label = ResolveLastLabel (Line);
+	  snprintf (Source, sizeof (Source), "%s:%d", Line->FileName,
+		    Line->LineNumber);
+	}
+      InterpDescribe (Tracer->Names, Tracer->Switches, Text, Record);
+      if (0 > fprintf (Tracer->File, "%12llu %-8s %04o %-10s %-30s %s\n",
+		       (unsigned long long) Record->Cycle, Where,
+		       Record->Fixloc, (Label != NULL) ? Label->Name : "",
+		       Source, Text))
+	Tracer->Error = 1;
+    }
+  Interp->Buffered = 0;
+}
+
+// Writes the last of the trace, if any, and stops counting.  Returns 0 on
+// success, or 1 if the trace couldn't all be written.
+int
+InterpStop (agc_t *State)
+{
+  Interpreter_t *Interp = State->Interpreter;
+  InterpTracer_t *Tracer = (InterpTracer_t *) Interp;
+  int Error = 0;
+
+  if (Interp == NULL)
+    return (1);
+  if (Tracer->File != NULL)
+    {
+      InterpFlush (State);
+      if (Interp->Lost)
+	fprintf (Tracer->File, "# %llu instructions weren't recorded.\n",
+		 (unsigned long long) Interp->Lost);
+      if (fclose (Tracer->File) || Tracer->Error)
+	Error = 1;
+    }
+  free (Tracer->Names);
+  free (Tracer);
+  State->Interpreter = NULL;
+  return (Error);
+}
+
+//---------------------------------------------------------------------------
+// The report.
+
+static int
+CompareCycles (const void *Raw1, const void *Raw2)
+{
+  const InterpWord_t *Word1 = Raw1, *Word2 = Raw2;
+  if (Word1->Cycles != Word2->Cycles)
+    return (Word1->Cycles < Word2->Cycles) ? 1 : -1;
+  if (Word1->Count != Word2->Count)
+    return (Word1->Count < Word2->Count) ? 1 : -1;
+  return (Word1->Location - Word2->Location);
+}
+
+static int
+CompareLabels (const void *Raw1, const void *Raw2)
+{
+  const InterpWord_t *Word1 = Raw1, *Word2 = Raw2;
+  if (Word1->Label != Word2->Label)
+    return (Word1->Label < Word2->Label) ? -1 : 1;
+  return (Word1->Location - Word2->Location);
+}
+
+// Lists the instructions, by name.
+static void
+PrintCodes (FILE *fp, Interpreter_t *Interp, uint64_t Total)
+{
+  char Names[2 * INTERP_CODES][16];
+  InterpWord_t Rows[2 * INTERP_CODES];
+  int NumRows = 0, Code, Vector, i;
+
+  for (Code = 0; Code < INTERP_CODES; Code++)
+    for (Vector = 0; Vector < 2; Vector++)
+      {
+	if (Interp->Counts[Vector][Code] == 0)
+	  continue;
+	InterpCodeName (Names[NumRows], Code, Vector);
+	for (i = 0; i < NumRows; i++)
+	  if (!strcmp (Names[i], Names[NumRows]))
+	    break;
+	if (i == NumRows)
+	  {
+	    memset (&Rows[i], 0, sizeof (Rows[i]));
+	    Rows[i].Location = i;	// Keeps the name with the row.
+	    NumRows++;
+	  }
+	Rows[i].Count += Interp->Counts[Vector][Code];
+	Rows[i].Cycles += Interp->Cycles[Vector][Code];
+      }
+  qsort (Rows, NumRows, sizeof (InterpWord_t), CompareCycles);
+
+  fprintf (fp, "\nBy instruction:\n\n");
+  fprintf (fp, "%12s %12s %6s %8s  %s\n", "Count", "Cycles", "%", "Mean",
+	   "Instruction");
+  for (i = 0; i < NumRows; i++)
+    fprintf (fp, "%12u %12llu %6.2f %8.1f  %s\n", Rows[i].Count,
+	     (unsigned long long) Rows[i].Cycles,
+	     Total ? 100.0 * Rows[i].Cycles / Total : 0.0,
+	     (double) Rows[i].Cycles / Rows[i].Count,
+	     Names[Rows[i].Location]);
+}
+
+// Lists the routines, and then the words of interpretive code, with the
+// most cycles.
+static void
+PrintWords (FILE *fp, Interpreter_t *Interp, uint64_t Total)
+{
+  InterpWord_t *Words, *Routines;
+  int Count = 0, NumRoutines = 0, Address, i;
+  char Where[16];
+
+  Words = (InterpWord_t *) malloc (TRACE_ADDRESSES * sizeof (InterpWord_t));
+  Routines = (InterpWord_t *) malloc (TRACE_ADDRESSES * sizeof (InterpWord_t));
+  if (Words == NULL || Routines == NULL)
+    goto Done;
+  for (Address = 0; Address < TRACE_ADDRESSES; Address++)
+    if (Interp->Uses[Address])
+      {
+	Words[Count].Location = Address;
+	Words[Count].Count = Interp->Uses[Address];
+	Words[Count].Cycles = Interp->UseCycles[Address];
+	Words[Count].Line = InterpLine (Address);
+	Words[Count].Label = (Words[Count].Line != NULL) ?
+	  ResolveLastLabel (Words[Count].Line) : NULL;
+	Count++;
+      }
+
+  // Routines run from one label to the next, as in agc_profile.c.
+  qsort (Words, Count, sizeof (InterpWord_t), CompareLabels);
+  for (i = 0; i < Count; i++)
+    {
+      if (NumRoutines == 0
+	  || Routines[NumRoutines - 1].Label != Words[i].Label)
+	{
+	  Routines[NumRoutines] = Words[i];
+	  NumRoutines++;
+	  continue;
+	}
+      Routines[NumRoutines - 1].Count += Words[i].Count;
+      Routines[NumRoutines - 1].Cycles += Words[i].Cycles;
+    }
+  qsort (Routines, NumRoutines, sizeof (InterpWord_t), CompareCycles);
+  if (NumRoutines > INTERP_TOP_ROUTINES)
+    NumRoutines = INTERP_TOP_ROUTINES;
+  fprintf (fp, "\nBy routine:\n\n");
+  fprintf (fp, "%12s %12s %6s  %-10s %s\n", "Count", "Cycles", "%",
+	   "Routine", "File");
+  for (i = 0; i < NumRoutines; i++)
+    fprintf (fp, "%12u %12llu %6.2f  %-10s %s\n", Routines[i].Count,
+	     (unsigned long long) Routines[i].Cycles,
+	     Total ? 100.0 * Routines[i].Cycles / Total : 0.0,
+	     (Routines[i].Label != NULL) ? Routines[i].Label->Name : "?",
+	     (Routines[i].Line != NULL) ? Routines[i].Line->FileName : "");
+
+  qsort (Words, Count, sizeof (InterpWord_t), CompareCycles);
+  if (Count > INTERP_TOP_WORDS)
+    Count = INTERP_TOP_WORDS;
+  fprintf (fp, "\nBy source line:\n\n");
+  fprintf (fp, "%12s %12s %6s  %-9s %s\n", "Count", "Cycles", "%",
+	   "Address", "Where");
+  for (i = 0; i < Count; i++)
+    {
+      InterpWhere (Where, Words[i].Location);
+      fprintf (fp, "%12u %12llu %6.2f  %-9s ", Words[i].Count,
+	       (unsigned long long) Words[i].Cycles,
+	       Total ? 100.0 * Words[i].Cycles / Total : 0.0, Where);
+      if (Words[i].Line == NULL)
+	fprintf (fp, "unknown source\n");
+      else if (Words[i].Label != NULL)
+	fprintf (fp, "%s:%d (%s)\n", Words[i].Line->FileName,
+		 Words[i].Line->LineNumber, Words[i].Label->Name);
+      else
+	fprintf (fp, "%s:%d\n", Words[i].Line->FileName,
+		 Words[i].Line->LineNumber);
+    }
+Done:
+  free (Words);
+  free (Routines);
+}
+
+// Writes the report.  Returns 0 on success, or 1 if the file can't be
+// written or the instructions aren't being counted.
+int
+InterpReport (agc_t *State, const char *Filename)
+{
+  Interpreter_t *Interp = State->Interpreter;
+  uint64_t Cycles, Total = 0;
+  FILE *fp;
+  int i;
+
+  if (Interp == NULL)
+    return (1);
+  fp = fopen (Filename, "w");
+  if (fp == NULL)
+    return (1);
+  Cycles = State->CycleCounter - Interp->StartCycle;
+  for (i = 0; i < INTERP_CODES; i++)
+    Total += Interp->Cycles[0][i] + Interp->Cycles[1][i];
+  fprintf (fp, "Interpretive instructions over %llu machine cycles "
+	   "(%.3f AGC seconds).\n", (unsigned long long) Cycles,
+	   (double) Cycles / AGC_PER_SECOND);
+  fprintf (fp, "%llu instructions dispatched, taking %llu cycles (%.2f%%).\n",
+	   (unsigned long long) Interp->Dispatches, (unsigned long long) Total,
+	   Cycles ? 100.0 * Total / Cycles : 0.0);
+  fprintf (fp, "The cycles of an instruction run from its dispatch to the "
+	   "next, and include\nthose of any interrupts in between.\n");
+  if (Interp->Dispatches)
+    {
+      PrintCodes (fp, Interp, Total);
+      PrintWords (fp, Interp, Total);
+    }
+  if (fclose (fp))
+    return (1);
+  return (0);
+}
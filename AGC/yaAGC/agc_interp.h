@@ -0,0 +1,38 @@
+/*
+  Copyright 2026 Ronald S. Burkey <info@sandroid.org>
+
+  This file is part of yaAGC.
+
+  yaAGC is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  yaAGC is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with yaAGC; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+  Filename:	agc_interp.h
+  Purpose:	Header for agc_interp.c, the interpretive profile and trace.
+  Compiler:	GNU gcc.
+  Contact:	Ron Burkey <info@sandroid.org>
+  Reference:	http://www.ibiblio.org/apollo/index.html
+  Mods:		2026-10-17	Began.
+*/
+
+#ifndef AGC_INTERP_H
+#define AGC_INTERP_H
+
+#include "agc_engine.h"
+
+int InterpStart (agc_t *State, const char *TraceFilename);
+void InterpFlush (agc_t *State);
+int InterpReport (agc_t *State, const char *Filename);
+int InterpStop (agc_t *State);
+
+#endif // AGC_INTERP_H
@@ -0,0 +1,359 @@
+/*
+  Copyright 2026 Ronald S. Burkey <info@sandroid.org>
+
+  This file is part of yaAGC.
+
+  yaAGC is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  yaAGC is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with yaAGC; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+  Filename:	agc_load.c
+  Purpose:	Analyzes how heavily loaded the AGC software's Executive
+  		and Waitlist are, writing a line of statistics to a file
+		for each window of AGC time.
+  Compiler:	GNU gcc.
+  Contact:	Ron Burkey <info@sandroid.org>
+  Reference:	http://www.ibiblio.org/apollo/index.html
+  Mods:		2026-10-17	Began.
+		2026-10-17	The analysis is now kept in agc_t (as
+				LoadReport), rather than in statics shared
+				by all CPUs.
+		2026-10-17	Added LoadCyclesToSample.
+
+  Two kinds of information go into each line.  The first comes from the
+  engine's load accounting (agc_t LoadCycles), which counts every machine
+  cycle as used by a job, by one of the interrupts, or by idling.  The
+  Executive idles (in DUMMYJOB, running the self-check) with NEWJOB set to
+  -0, so the duty cycle is just the fraction of cycles in which it isn't.
+
+  The second comes from sampling erasable memory whenever LoadSample is
+  called, but no more often than LOAD_SAMPLE_CYCLES:
+
+	PRIORITY	Each core set's priority is +0 or -0 if the core
+			set is free, positive for a job that's awake, or
+			negative for one that's asleep.  Priorities are
+			in the upper 5 bits.
+	VACnUSE		Zero while VAC area n is in use.
+	LST2		The Waitlist's task 2CADRs, with unused entries
+			holding the complement of ENDTASK.
+	NEWJOB		Positive while a job is waiting for a change of
+			jobs.
+
+  All of these are found through the symbol table, so it must have been
+  loaded with ReadSymbolTable before LoadStart.  Anything that can't be
+  found is left out, showing up as "-" in the file.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "yaAGC.h"
+#include "agc_engine.h"
+#include "agc_symtab.h"
+#include "agc_load.h"
+
+extern Symbol_t *SymbolTable;	// Owned by agc_symtab.
+extern int SymbolTableSize;
+
+// Erasable memory is sampled no more often than this (1 ms).
+#define LOAD_SAMPLE_CYCLES (AGC_PER_SECOND / 1000)
+
+#define CORE_SET_SIZE 12
+#define MAX_CORE_SETS 8
+#define NUM_VAC_AREAS 5
+#define LST2_ENTRIES 9
+#define NUM_PRIORITIES 040
+
+static const char *InterruptNames[1 + NUM_INTERRUPT_TYPES] = {
+  "", "T6", "T5", "T3", "T4", "KEY1", "KEY2", "UP", "DOWN", "RADAR", "HAND"
+};
+
+// The state of the analysis, which LoadStart allocates as State->LoadReport.
+struct LoadReport
+{
+  FILE *fp;
+  uint64_t WindowCycles, WindowStart, NextSample;
+  uint64_t StartCycles[LOAD_CLASSES];
+  // Words sampled, as bank * 0400 + offset, or -1 if unknown.
+  int NewJob, Priority, NumCoreSets, VacUse[NUM_VAC_AREAS], Lst2;
+  int16_t EndTask;		// An unused LST2 entry, or -1 if unknown.
+  // Sums and maxima of the samples in this window.
+  unsigned Samples;
+  uint64_t Jobs, Sleeping, Vacs, Waiting, NewJobs;
+  uint64_t Priorities[NUM_PRIORITIES];
+  int MaxJobs, MaxVacs, MaxWaiting;
+};
+
+// Returns the erasable word named Name, as bank * 0400 + offset, or -1.
+static int
+ErasableSymbol (const char *Name)
+{
+  Symbol_t *Symbol;
+  Symbol = ResolveSymbol ((char *) Name, SYMBOL_VARIABLE | SYMBOL_REGISTER);
+  if (Symbol == NULL)
+    return (-1);
+  return (ErasableAddressAGC (&Symbol->Value));
+}
+
+static int16_t
+Word (agc_t *State, int Address)
+{
+  return (State->Erasable[Address / 0400][Address & 0377] & 077777);
+}
+
+// Core sets run from PRIORITY up to the next variable that isn't in them.
+// Luminary has 8 of them, and Colossus 7.
+static int
+CountCoreSets (int Priority)
+{
+  int i, Address, Next = Priority + MAX_CORE_SETS * CORE_SET_SIZE;
+  for (i = 0; i < SymbolTableSize; i++)
+    {
+      if (SymbolTable[i].Type != SYMBOL_VARIABLE)
+	continue;
+      Address = ErasableAddressAGC (&SymbolTable[i].Value);
+      if (Address > Priority && Address < Next)
+	Next = Address;
+    }
+  return ((Next - Priority - 1) / CORE_SET_SIZE + 1);
+}
+
+static void
+ClearWindow (agc_t *State)
+{
+  struct LoadReport *Load = State->LoadReport;
+  Load->WindowStart = State->CycleCounter;
+  memcpy (Load->StartCycles, State->LoadCycles, sizeof (Load->StartCycles));
+  Load->Samples = 0;
+  Load->Jobs = Load->Sleeping = Load->Vacs = Load->Waiting = Load->NewJobs = 0;
+  memset (Load->Priorities, 0, sizeof (Load->Priorities));
+  Load->MaxJobs = Load->MaxVacs = Load->MaxWaiting = 0;
+}
+
+static void
+TakeSample (agc_t *State)
+{
+  struct LoadReport *Load = State->LoadReport;
+  int i, Priority, Jobs = 0, Vacs = 0, Waiting = 0;
+
+  Load->Samples++;
+  if (Load->Priority >= 0)
+    {
+      for (i = 0; i < Load->NumCoreSets; i++)
+	{
+	  Priority = Word (State, Load->Priority + i * CORE_SET_SIZE);
+	  if (Priority == 0 || Priority == 077777)
+	    continue;
+	  Jobs++;
+	  if (Priority & 040000)
+	    Load->Sleeping++;
+	  else
+	    Load->Priorities[(Priority >> 9) & 037]++;
+	}
+      Load->Jobs += Jobs;
+      if (Jobs > Load->MaxJobs)
+	Load->MaxJobs = Jobs;
+    }
+  for (i = 0; i < NUM_VAC_AREAS; i++)
+    if (Load->VacUse[i] >= 0 && Word (State, Load->VacUse[i]) == 0)
+      Vacs++;
+  Load->Vacs += Vacs;
+  if (Vacs > Load->MaxVacs)
+    Load->MaxVacs = Vacs;
+  if (Load->Lst2 >= 0 && Load->EndTask >= 0)
+    {
+      for (i = 0; i < LST2_ENTRIES; i++)
+	if (Word (State, Load->Lst2 + 2 * i) != Load->EndTask)
+	  Waiting++;
+      Load->Waiting += Waiting;
+      if (Waiting > Load->MaxWaiting)
+	Load->MaxWaiting = Waiting;
+    }
+  if (Load->NewJob >= 0)
+    {
+      i = Word (State, Load->NewJob);
+      if (i != 0 && 0 == (i & 040000))
+	Load->NewJobs++;
+    }
+}
+
+static void
+WriteWindow (agc_t *State)
+{
+  struct LoadReport *Load = State->LoadReport;
+  uint64_t Cycles[LOAD_CLASSES], Total = 0;
+  double n = Load->Samples;
+  int i, Any = 0;
+
+  for (i = 0; i < LOAD_CLASSES; i++)
+    {
+      Cycles[i] = State->LoadCycles[i] - Load->StartCycles[i];
+      Total += Cycles[i];
+    }
+  if (Total == 0 || Load->Samples == 0)
+    return;
+  fprintf (Load->fp, "%10.3f", (double) State->CycleCounter / AGC_PER_SECOND);
+  fprintf (Load->fp, " %6.2f", 100.0 * (Total - Cycles[LOAD_IDLE]) / Total);
+  fprintf (Load->fp, " %6.2f", 100.0 * Cycles[LOAD_JOB] / Total);
+  for (i = 1; i <= NUM_INTERRUPT_TYPES; i++)
+    fprintf (Load->fp, " %6.2f", 100.0 * Cycles[i] / Total);
+  if (Load->Priority >= 0)
+    fprintf (Load->fp, " %5.2f %2d %5.2f", Load->Jobs / n, Load->MaxJobs,
+	     Load->Sleeping / n);
+  else
+    fprintf (Load->fp, " %5s %2s %5s", "-", "-", "-");
+  fprintf (Load->fp, " %5.2f %2d", Load->Vacs / n, Load->MaxVacs);
+  if (Load->Lst2 >= 0 && Load->EndTask >= 0)
+    fprintf (Load->fp, " %5.2f %2d", Load->Waiting / n, Load->MaxWaiting);
+  else
+    fprintf (Load->fp, " %5s %2s", "-", "-");
+  if (Load->NewJob >= 0)
+    fprintf (Load->fp, " %6.2f", 100.0 * Load->NewJobs / n);
+  else
+    fprintf (Load->fp, " %6s", "-");
+  fprintf (Load->fp, " ");
+  for (i = NUM_PRIORITIES - 1; i >= 0; i--)
+    if (Load->Priorities[i])
+      {
+	fprintf (Load->fp, "%s%o:%.2f", Any ? "," : "", i,
+		 Load->Priorities[i] / n);
+	Any = 1;
+      }
+  fprintf (Load->fp, "%s\n", Any ? "" : "-");
+  fflush (Load->fp);
+}
+
+//---------------------------------------------------------------------------
+// Starts the analysis of State, in windows of Window seconds of AGC time,
+// writing it to Filename.  Each agc_t has its own analysis, so several CPUs
+// can be analyzed at once.  Returns 0 on success, or 1 if the file can't be
+// created.
+
+int
+LoadStart (agc_t *State, const char *Filename, double Window)
+{
+  struct LoadReport *Load;
+  Symbol_t *Symbol;
+  char Name[16];
+  int i, Address;
+
+  LoadStop (State);
+  Load = calloc (1, sizeof (struct LoadReport));
+  if (Load == NULL)
+    return (1);
+  Load->fp = fopen (Filename, "w");
+  if (Load->fp == NULL)
+    {
+      free (Load);
+      return (1);
+    }
+  State->LoadReport = Load;
+  Load->WindowCycles = Window * AGC_PER_SECOND;
+  if (Load->WindowCycles == 0)
+    Load->WindowCycles = 1;
+
+  Load->NewJob = ErasableSymbol ("NEWJOB");
+  Load->Priority = ErasableSymbol ("PRIORITY");
+  Load->NumCoreSets = (Load->Priority >= 0) ? CountCoreSets (Load->Priority) : 0;
+  for (i = 0; i < NUM_VAC_AREAS; i++)
+    {
+      sprintf (Name, "VAC%dUSE", i + 1);
+      Load->VacUse[i] = ErasableSymbol (Name);
+    }
+  Load->Lst2 = ErasableSymbol ("LST2");
+  Load->EndTask = -1;
+  Symbol = ResolveSymbol ("ENDTASK", SYMBOL_LABEL | SYMBOL_VARIABLE);
+  if (Symbol != NULL && Symbol->Value.Fixed && Symbol->Value.SReg >= 04000)
+    {
+      Address = Symbol->Value.SReg;
+      Load->EndTask = 077777 & ~State->Fixed[Address / 02000][Address & 01777];
+    }
+
+  fprintf (Load->fp, "# Executive/Waitlist load, in windows of %g seconds "
+	   "of AGC time.\n", Window);
+  if (Load->NewJob < 0)
+    fprintf (Load->fp, "# NEWJOB is unknown, so idling can't be told from "
+	     "jobs.\n");
+  fprintf (Load->fp, "# Time is AGC seconds at the end of the window.  "
+	   "Duty, Job, and the interrupts are\n"
+	   "# %% of machine cycles.  Jobs (awake or asleep) are in %d core "
+	   "sets, VACs are VAC\n"
+	   "# areas in use, Wait is Waitlist tasks, and NewJob is %% of "
+	   "samples with a change\n"
+	   "# of jobs pending.  Those are averages of samples, with maxima "
+	   "in Max columns.\n"
+	   "# Prio is the average number of awake jobs of each (octal) "
+	   "priority.\n", Load->NumCoreSets);
+  fprintf (Load->fp, "#%9s %6s %6s", "Time", "Duty", "Job");
+  for (i = 1; i <= NUM_INTERRUPT_TYPES; i++)
+    fprintf (Load->fp, " %6s", InterruptNames[i]);
+  fprintf (Load->fp, " %5s %2s %5s %5s %2s %5s %2s %6s %s\n", "Jobs", "Mx",
+	   "Sleep", "VACs", "Mx", "Wait", "Mx", "NewJob", "Prio");
+
+  State->LoadIdleAddress = Load->NewJob;
+  State->LoadIdleValue = 077777;
+  State->LoadAccounting = 1;
+  Load->NextSample = State->CycleCounter;
+  ClearWindow (State);
+  return (0);
+}
+
+// Samples erasable memory, and writes out the window if it has ended.  Call
+// it between calls to agc_engine_run, each of which should run no more than
+// LoadCyclesToSample cycles, or the samples will be further apart.
+
+void
+LoadSample (agc_t *State)
+{
+  struct LoadReport *Load = State->LoadReport;
+  if (Load == NULL || State->CycleCounter < Load->NextSample)
+    return;
+  TakeSample (State);
+  Load->NextSample = State->CycleCounter + LOAD_SAMPLE_CYCLES;
+  if (State->CycleCounter - Load->WindowStart >= Load->WindowCycles)
+    {
+      WriteWindow (State);
+      ClearWindow (State);
+    }
+}
+
+// The number of machine cycles (at least 1) that can be run before
+// LoadSample is next due, so that batches of agc_engine_run can be cut
+// short to keep the sampling at LOAD_SAMPLE_CYCLES.  Without an analysis,
+// there's no limit, which is returned as ~0.
+
+uint64_t
+LoadCyclesToSample (agc_t *State)
+{
+  struct LoadReport *Load = State->LoadReport;
+  if (Load == NULL)
+    return (~(uint64_t) 0);
+  if (State->CycleCounter >= Load->NextSample)
+    return (1);
+  return (Load->NextSample - State->CycleCounter);
+}
+
+// Writes out what there is of the last window, and ends the analysis.
+
+void
+LoadStop (agc_t *State)
+{
+  struct LoadReport *Load = State->LoadReport;
+  if (Load == NULL)
+    return;
+  WriteWindow (State);
+  fclose (Load->fp);
+  free (Load);
+  State->LoadReport = NULL;
+  State->LoadAccounting = 0;
+}
@@ -0,0 +1,39 @@
+/*
+  Copyright 2026 Ronald S. Burkey <info@sandroid.org>
+
+  This file is part of yaAGC.
+
+  yaAGC is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  yaAGC is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with yaAGC; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+  Filename:	agc_load.h
+  Purpose:	Header for agc_load.c, the Executive/Waitlist load analyzer.
+  Compiler:	GNU gcc.
+  Contact:	Ron Burkey <info@sandroid.org>
+  Reference:	http://www.ibiblio.org/apollo/index.html
+  Mods:		2026-10-17	Began.
+		2026-10-17	Added LoadCyclesToSample.
+*/
+
+#ifndef AGC_LOAD_H
+#define AGC_LOAD_H
+
+#include "agc_engine.h"
+
+int LoadStart (agc_t *State, const char *Filename, double Window);
+void LoadSample (agc_t *State);
+uint64_t LoadCyclesToSample (agc_t *State);
+void LoadStop (agc_t *State);
+
+#endif // AGC_LOAD_H
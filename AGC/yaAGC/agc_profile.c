@@ -0,0 +1,415 @@
+/*
+  Copyright 2026 Ronald S. Burkey <info@sandroid.org>
+
+  This file is part of yaAGC.
+
+  yaAGC is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  yaAGC is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with yaAGC; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+  Filename:	agc_profile.c
+  Purpose:	Writes the coverage counts collected by agc_engine.c (while
+  		an agc_t's CoverageCounts is set) as a profile:  where the
+		AGC software spent its machine cycles, by routine, by source
+		file, and by source line, plus the most-used words of
+		erasable memory and i/o channels.
+  Compiler:	GNU gcc.
+  Contact:	Ron Burkey <info@sandroid.org>
+  Reference:	http://www.ibiblio.org/apollo/index.html
+  Mods:		2026-10-17	Began.
+		2026-10-17	The counts are now those of an agc_t.
+		2026-10-17	Routines and files are looked up through a
+				hash rather than a linear search.
+
+  Addresses are resolved to source lines with ResolveLineAGC, and source
+  lines to routines with ResolveLastLabel, so a "routine" is everything from
+  one program label to the next.  Without a symbol table, the code is
+  listed by bank instead.
+
+  Alongside the profile, a file of "folded stacks" is written, which can be
+  fed straight to flamegraph.pl.  The AGC has no call stack to speak of, so
+  each stack is just source file, routine, and line, and the flame graph
+  shows how the cycles divide up among them.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "yaAGC.h"
+#include "agc_engine.h"
+#include "agc_symtab.h"
+#include "agc_profile.h"
+
+// How many entries of the longer lists are shown.
+#define PROFILE_TOP_LINES 50
+#define PROFILE_TOP_WORDS 50
+
+typedef struct
+{
+  char Routine[1 + MAX_LABEL_LENGTH + 8];
+  char File[1 + MAX_FILE_LENGTH];
+  int LineNumber;		// 0 except in the list of lines.
+  uint64_t Instructions;
+  uint64_t Cycles;
+} ProfileEntry_t;
+
+// Hash holds 1 plus the index of each entry, or 0, and has twice as many
+// slots as Entries, so it's never more than half full.  It's only kept for
+// lists which are searched.
+typedef struct
+{
+  ProfileEntry_t *Entries;
+  int Count, Size;
+  int *Hash;
+} ProfileList_t;
+
+// The hash of an entry's routine, file, and line number (FNV-1a).
+static unsigned
+EntryHash (const char *Routine, const char *File, int LineNumber)
+{
+  unsigned Hash = 2166136261u;
+
+  while (*Routine)
+    Hash = (Hash ^ (unsigned char) *Routine++) * 16777619u;
+  Hash = (Hash ^ '/') * 16777619u;
+  while (*File)
+    Hash = (Hash ^ (unsigned char) *File++) * 16777619u;
+  return ((Hash ^ (unsigned) LineNumber) * 16777619u);
+}
+
+// Adds the counts to the entry for Routine, File, and LineNumber, creating
+// it if necessary.  If Search is 1, the entry is looked up in the list's
+// hash; if 0, only the last entry is checked, which is enough for lists
+// whose words are added in address order.  A list must always be searched
+// or never.  Returns 1 if out of memory.
+static int
+AddEntry (ProfileList_t *List, const char *Routine, const char *File,
+	  int LineNumber, int Search, uint64_t Instructions, uint64_t Cycles)
+{
+  ProfileEntry_t *Entry = NULL;
+  unsigned Mask = 2 * List->Size - 1, Slot = 0;
+  int i, j;
+
+  if (!Search)
+    {
+      if (List->Count > 0)
+	{
+	  Entry = &List->Entries[List->Count - 1];
+	  if (Entry->LineNumber != LineNumber || strcmp (Entry->Routine, Routine)
+	      || strcmp (Entry->File, File))
+	    Entry = NULL;
+	}
+    }
+  else if (List->Hash != NULL)
+    {
+      for (Slot = EntryHash (Routine, File, LineNumber) & Mask;
+	   (i = List->Hash[Slot]) != 0; Slot = (Slot + 1) & Mask)
+	{
+	  Entry = &List->Entries[i - 1];
+	  if (Entry->LineNumber == LineNumber && !strcmp (Entry->Routine, Routine)
+	      && !strcmp (Entry->File, File))
+	    break;
+	  Entry = NULL;
+	}
+    }
+  if (Entry == NULL)
+    {
+      if (List->Count >= List->Size)
+	{
+	  int Size = List->Size ? 2 * List->Size : 256;
+	  Entry = realloc (List->Entries, Size * sizeof (ProfileEntry_t));
+	  if (Entry == NULL)
+	    return (1);
+	  List->Entries = Entry;
+	  if (Search)
+	    {
+	      // Rehash the entries into a bigger table.
+	      int *Hash = calloc (2 * Size, sizeof (int));
+	      if (Hash == NULL)
+		return (1);
+	      free (List->Hash);
+	      List->Hash = Hash;
+	      Mask = 2 * Size - 1;
+	      for (j = 0; j < List->Count; j++)
+		{
+		  Entry = &List->Entries[j];
+		  for (Slot = EntryHash (Entry->Routine, Entry->File,
+					 Entry->LineNumber) & Mask;
+		       Hash[Slot] != 0; Slot = (Slot + 1) & Mask);
+		  Hash[Slot] = j + 1;
+		}
+	      for (Slot = EntryHash (Routine, File, LineNumber) & Mask;
+		   Hash[Slot] != 0; Slot = (Slot + 1) & Mask);
+	    }
+	  List->Size = Size;
+	}
+      if (Search)
+	List->Hash[Slot] = List->Count + 1;
+      Entry = &List->Entries[List->Count++];
+      strncpy (Entry->Routine, Routine, sizeof (Entry->Routine) - 1);
+      Entry->Routine[sizeof (Entry->Routine) - 1] = 0;
+      strncpy (Entry->File, File, sizeof (Entry->File) - 1);
+      Entry->File[sizeof (Entry->File) - 1] = 0;
+      Entry->LineNumber = LineNumber;
+      Entry->Instructions = 0;
+      Entry->Cycles = 0;
+    }
+  Entry->Instructions += Instructions;
+  Entry->Cycles += Cycles;
+  return (0);
+}
+
+static int
+CompareCycles (const void *Raw1, const void *Raw2)
+{
+  const ProfileEntry_t *Entry1 = Raw1, *Entry2 = Raw2;
+  if (Entry1->Cycles != Entry2->Cycles)
+    return (Entry1->Cycles < Entry2->Cycles) ? 1 : -1;
+  if (Entry1->Instructions != Entry2->Instructions)
+    return (Entry1->Instructions < Entry2->Instructions) ? 1 : -1;
+  return (0);
+}
+
+// Lists up to Max entries (all of them, if 0) in order of machine cycles.
+static void
+PrintList (FILE *fp, ProfileList_t *List, uint64_t TotalCycles, int Max,
+	   const char *Heading)
+{
+  ProfileEntry_t *Entry;
+  uint64_t Cumulative = 0;
+  int i;
+
+  qsort (List->Entries, List->Count, sizeof (ProfileEntry_t), CompareCycles);
+  if (Max == 0 || Max > List->Count)
+    Max = List->Count;
+  fprintf (fp, "\n%s:\n\n", Heading);
+  fprintf (fp, "%14s %6s %6s %12s  %s\n", "Cycles", "%", "Cum.%",
+	   "Instructions", "Where");
+  for (i = 0; i < Max; i++)
+    {
+      Entry = &List->Entries[i];
+      Cumulative += Entry->Cycles;
+      fprintf (fp, "%14llu %6.2f %6.2f %12llu  ",
+	       (unsigned long long) Entry->Cycles,
+	       100.0 * Entry->Cycles / TotalCycles,
+	       100.0 * Cumulative / TotalCycles,
+	       (unsigned long long) Entry->Instructions);
+      if (Entry->LineNumber)
+	fprintf (fp, "%s:%d (%s)\n", Entry->File, Entry->LineNumber,
+		 Entry->Routine);
+      else if (Entry->Routine[0])
+	fprintf (fp, "%s (%s)\n", Entry->Routine, Entry->File);
+      else
+	fprintf (fp, "%s\n", Entry->File);
+    }
+}
+
+// Lists the Max most-accessed of the Count words with the given read and
+// write counts, which are either erasable memory or the i/o channels.
+static void
+PrintAccesses (FILE *fp, unsigned *Reads, unsigned *Writes, int Count,
+	       int Max, int Erasable)
+{
+  int i, j, n, *Top;
+  uint64_t Accesses;
+  Symbol_t *Symbol;
+  char Address[16];
+
+  Top = malloc (Max * sizeof (int));
+  if (Top == NULL)
+    return;
+  // A simple insertion into the sorted top-Max list is plenty fast.
+  for (i = n = 0; i < Count; i++)
+    {
+      Accesses = (uint64_t) Reads[i] + Writes[i];
+      if (Accesses == 0)
+	continue;
+      for (j = n; j > 0; j--)
+	{
+	  if ((uint64_t) Reads[Top[j - 1]] + Writes[Top[j - 1]] >= Accesses)
+	    break;
+	  if (j < Max)
+	    Top[j] = Top[j - 1];
+	}
+      if (j < Max)
+	{
+	  Top[j] = i;
+	  if (n < Max)
+	    n++;
+	}
+    }
+  fprintf (fp, "\n%s:\n\n", Erasable ? "Erasable memory" : "I/O channels");
+  fprintf (fp, "%-10s %12s %12s  %s\n", "Address", "Reads", "Writes",
+	   Erasable ? "Name" : "");
+  for (i = 0; i < n; i++)
+    {
+      Symbol = NULL;
+      if (Erasable)
+	{
+	  sprintf (Address, "E%o,%04o", Top[i] / 0400, Top[i] % 0400);
+	  Symbol = ResolveErasableAGC (Top[i] / 0400, Top[i] % 0400);
+	}
+      else
+	sprintf (Address, "%03o", Top[i]);
+      fprintf (fp, "%-10s %12u %12u  %s\n", Address, Reads[Top[i]],
+	       Writes[Top[i]], (Symbol != NULL) ? Symbol->Name : "");
+    }
+  free (Top);
+}
+
+//---------------------------------------------------------------------------
+// Writes State's profile to Filename, and the folded stacks to Filename with
+// PROFILE_FOLDED_SUFFIX appended.  Returns 0 on success, or 1 on error.  If 
+// State has never collected any counts, the profile is simply empty.
+
+int
+WriteProfile (agc_t *State, const char *Filename)
+{
+  Coverage_t *Coverage = State->Coverage;
+  ProfileList_t Routines = { NULL, 0, 0, NULL };
+  ProfileList_t Files = { NULL, 0, 0, NULL };
+  ProfileList_t Lines = { NULL, 0, 0, NULL };
+  uint64_t TotalCycles = 0, TotalInstructions = 0;
+  char Routine[1 + MAX_LABEL_LENGTH + 8], *FoldedName;
+  const char *File;
+  FILE *fp, *Folded;
+  SymbolLine_t *Line;
+  Symbol_t *Label;
+  int Bank, Offset, Address12, LineNumber, Error = 0;
+  uint64_t Instructions, Cycles;
+
+  if (Coverage == NULL)
+    Coverage = (Coverage_t *) calloc (1, sizeof (Coverage_t));
+  FoldedName = malloc (strlen (Filename) + sizeof (PROFILE_FOLDED_SUFFIX));
+  if (Coverage == NULL || FoldedName == NULL)
+    {
+      if (Coverage != State->Coverage)
+	free (Coverage);
+      free (FoldedName);
+      return (1);
+    }
+  sprintf (FoldedName, "%s%s", Filename, PROFILE_FOLDED_SUFFIX);
+  fp = fopen (Filename, "w");
+  Folded = fopen (FoldedName, "w");
+  free (FoldedName);
+  if (fp == NULL || Folded == NULL)
+    {
+      if (fp != NULL)
+	fclose (fp);
+      if (Folded != NULL)
+	fclose (Folded);
+      if (Coverage != State->Coverage)
+	free (Coverage);
+      return (1);
+    }
+
+  // Instructions executed from erasable memory (TC L, for instance, puts
+  // them in the central registers) have no source.
+  for (Bank = 0; Bank < 8; Bank++)
+    for (Offset = 0; Offset < 0400; Offset++)
+      {
+	Instructions = Coverage->ErasableInstructionCounts[Bank][Offset];
+	Cycles = Coverage->ErasableCycleCounts[Bank][Offset];
+	if (Instructions == 0 && Cycles == 0)
+	  continue;
+	TotalInstructions += Instructions;
+	TotalCycles += Cycles;
+	sprintf (Routine, "E%o", Bank);
+	Error |= AddEntry (&Routines, Routine, "erasable memory", 0, 1,
+			   Instructions, Cycles);
+	Error |= AddEntry (&Files, "", "erasable memory", 0, 1,
+			   Instructions, Cycles);
+	if (Cycles)
+	  fprintf (Folded, "erasable memory;%s;E%o,%04o %llu\n", Routine, Bank,
+		   Offset, (unsigned long long) Cycles);
+      }
+
+  // Fixed banks 040-047 are superbanks, which the symbol table has as
+  // banks 030-037 with the superbank bit set.
+  for (Bank = 0; Bank < NUM_FIXED_BANKS; Bank++)
+    for (Offset = 0; Offset < 02000; Offset++)
+      {
+	Instructions = Coverage->FixedInstructionCounts[Bank][Offset];
+	Cycles = Coverage->FixedCycleCounts[Bank][Offset];
+	if (Instructions == 0 && Cycles == 0)
+	  continue;
+	TotalInstructions += Instructions;
+	TotalCycles += Cycles;
+	if (Bank == 2 || Bank == 3)
+	  Address12 = Bank * 02000 + Offset;
+	else
+	  Address12 = 02000 + Offset;
+	Line = ResolveLineAGC (Address12, (Bank < 040) ? Bank : Bank - 010,
+			       Bank >= 040);
+	Label = (Line != NULL) ? ResolveLastLabel (Line) : NULL;
+	if (Line == NULL)
+	  {
+	    File = "unknown source";
+	    LineNumber = 0;
+	  }
+	else
+	  {
+	    File = Line->FileName;
+	    LineNumber = Line->LineNumber;
+	  }
+	if (Label != NULL)
+	  strcpy (Routine, Label->Name);
+	else
+	  sprintf (Routine, "bank %02o", Bank);
+	Error |= AddEntry (&Routines, Routine, File, 0, 1, Instructions,
+			   Cycles);
+	Error |= AddEntry (&Files, "", File, 0, 1, Instructions, Cycles);
+	if (LineNumber)
+	  {
+	    Error |= AddEntry (&Lines, Routine, File, LineNumber, 0,
+			       Instructions, Cycles);
+	    if (Cycles)
+	      fprintf (Folded, "%s;%s;%s:%d %llu\n", File, Routine, File,
+		       LineNumber, (unsigned long long) Cycles);
+	  }
+	else if (Cycles)
+	  fprintf (Folded, "%s;%s;%02o,%04o %llu\n", File, Routine, Bank,
+		   Address12, (unsigned long long) Cycles);
+      }
+
+  fprintf (fp, "%llu machine cycles (%.3f AGC seconds), %llu instructions.\n",
+	   (unsigned long long) TotalCycles, (double) TotalCycles / AGC_PER_SECOND,
+	   (unsigned long long) TotalInstructions);
+  fprintf (fp, "Each cycle is charged to the instruction then executing, or "
+	   "if none, to the\none last executed.\n");
+  if (TotalCycles != 0)
+    {
+      PrintList (fp, &Routines, TotalCycles, 0, "Routines");
+      PrintList (fp, &Files, TotalCycles, 0, "Source files");
+      PrintList (fp, &Lines, TotalCycles, PROFILE_TOP_LINES, "Source lines");
+    }
+  PrintAccesses (fp, &Coverage->ErasableReadCounts[0][0],
+		 &Coverage->ErasableWriteCounts[0][0], 04000, PROFILE_TOP_WORDS,
+		 1);
+  PrintAccesses (fp, Coverage->IoReadCounts, Coverage->IoWriteCounts, 01000,
+		 PROFILE_TOP_WORDS, 0);
+  if (Error)
+    fprintf (fp, "\nOut of memory; some of the above is missing.\n");
+
+  free (Routines.Entries);
+  free (Files.Entries);
+  free (Lines.Entries);
+  free (Routines.Hash);
+  free (Files.Hash);
+  if (Coverage != State->Coverage)
+    free (Coverage);
+  Error = ferror (fp) || ferror (Folded);
+  Error = fclose (Folded) || Error;
+  Error = fclose (fp) || Error;
+  return (Error);
+}
@@ -0,0 +1,130 @@
+/*
+  Copyright 2026 Ronald S. Burkey <info@sandroid.org>
+
+  This file is part of yaAGC.
+
+  yaAGC is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  yaAGC is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with yaAGC; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+  Filename:	agc_runner.c
+  Purpose:	Runs each of several AGC CPUs in a thread of its own.  Since
+  		the engine's state is in agc_t, any number of them can be
+		run at once, for example a CM and an LM, or a batch of
+		regression runs.  (What's still per process, such as the
+		debugger, is listed in agc_runner.h.)  See agc_runner.h
+		for an example.
+  Compiler:	GNU gcc.
+  Contact:	Ron Burkey <info@sandroid.org>
+  Reference:	http://www.ibiblio.org/apollo/index.html
+  Mods:		2026-10-17	Began.
+		2026-10-17	Paced by the monotonic clock (see Pacer.c)
+				rather than by gettimeofday(), and Stop and
+				Cycles are now accessed atomically.
+		2026-10-17	Said what isn't per CPU.
+*/
+
+#include "yaAGC.h"
+#include "agc_runner.h"
+
+// The thread runs the CPU in slices of at most this many machine cycles, 
+// checking for a stop request between slices.
+#define RUNNER_SLICE (AGC_PER_SECOND / 100)
+
+// With RealTime, the thread wakes up every quantum (see Pacer.c), and runs
+// the CPU until it has caught up with real time.  If it has fallen further
+// behind than this (because the computer is too slow, or the process was 
+// stopped), the missed time is skipped rather than made up.
+#define RUNNER_MAX_BACKLOG (AGC_PER_SECOND / 10)
+
+static void *
+RunnerThread (void *Arg)
+{
+  agc_runner_t *Runner = (agc_runner_t *) Arg;
+  uint64_t Start, Now, Cycles = 0, Due, Slice;
+
+  PacerInit (&Runner->Pacer, PACER_DEFAULT_QUANTUM);
+  Start = PacerNow ();
+  while (!__atomic_load_n (&Runner->Stop, __ATOMIC_ACQUIRE))
+    {
+      if (Runner->MaxCycles != 0 && Cycles >= Runner->MaxCycles)
+	break;
+      if (Runner->RealTime)
+	{
+	  Now = PacerWait (&Runner->Pacer);
+	  Due = (Now - Start) / 1000 * AGC_PER_SECOND / 1000000;
+	  if (Due <= Cycles)
+	    continue;
+	  if (Due - Cycles > RUNNER_MAX_BACKLOG)
+	    {
+	      Start += (Due - Cycles - RUNNER_MAX_BACKLOG) * 1000000 
+	      	       / AGC_PER_SECOND * 1000;
+	      Due = Cycles + RUNNER_MAX_BACKLOG;
+	    }
+	  PacerBacklog (&Runner->Pacer, Due - Cycles);
+	}
+      else
+	Due = Cycles + RUNNER_SLICE;
+      while (Cycles < Due 
+      	     && !__atomic_load_n (&Runner->Stop, __ATOMIC_ACQUIRE))
+	{
+	  Slice = Due - Cycles;
+	  if (Slice > RUNNER_SLICE)
+	    Slice = RUNNER_SLICE;
+	  if (Runner->MaxCycles != 0 && Slice > Runner->MaxCycles - Cycles)
+	    Slice = Runner->MaxCycles - Cycles;
+	  if (Slice == 0)
+	    break;
+	  Cycles += agc_engine_run (Runner->State, Slice);
+	  __atomic_store_n (&Runner->Cycles, Cycles, __ATOMIC_RELEASE);
+	}
+    }
+  return (NULL);
+}
+
+//----------------------------------------------------------------------------
+// Starts a thread running State, which has already been set up with 
+// agc_engine_init.  The thread runs until MaxCycles machine cycles have been
+// executed (forever, if 0), or until agc_runner_stop.  Returns 0 on success.
+
+int
+agc_runner_start (agc_runner_t *Runner, agc_t *State, uint64_t MaxCycles,
+		  int RealTime)
+{
+  Runner->State = State;
+  Runner->MaxCycles = MaxCycles;
+  Runner->RealTime = RealTime;
+  Runner->Stop = 0;
+  Runner->Cycles = 0;
+  return (pthread_create (&Runner->Thread, NULL, RunnerThread, Runner));
+}
+
+// Waits for the thread to finish, and returns the number of machine cycles
+// it executed.
+
+uint64_t
+agc_runner_wait (agc_runner_t *Runner)
+{
+  pthread_join (Runner->Thread, NULL);
+  return (__atomic_load_n (&Runner->Cycles, __ATOMIC_ACQUIRE));
+}
+
+// Makes the thread stop at the end of its current slice, and then waits 
+// for it as agc_runner_wait does.
+
+uint64_t
+agc_runner_stop (agc_runner_t *Runner)
+{
+  __atomic_store_n (&Runner->Stop, 1, __ATOMIC_RELEASE);
+  return (agc_runner_wait (Runner));
+}
@@ -0,0 +1,77 @@
+/*
+  Copyright 2026 Ronald S. Burkey <info@sandroid.org>
+
+  This file is part of yaAGC.
+
+  yaAGC is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  yaAGC is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with yaAGC; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+  Filename:	agc_runner.h
+  Purpose:	Header for agc_runner.c, which runs each of several AGC
+  		CPUs in a thread of its own.
+  Compiler:	GNU gcc.
+  Contact:	Ron Burkey <info@sandroid.org>
+  Reference:	http://www.ibiblio.org/apollo/index.html
+  Mods:		2026-10-17	Began.
+		2026-10-17	Paced by a Pacer_t, and Stop and Cycles are
+				accessed with the __atomic builtins.
+		2026-10-17	The example's agc_t are static.
+
+  Typical use, for (say) a CM and an LM in one process:
+
+	static agc_t Cm, Lm;		// agc_engine_init wants them zeroed.
+	agc_runner_t CmRunner, LmRunner;
+	agc_engine_init (&Cm, "Colossus249.bin", NULL, 0);
+	agc_engine_init (&Lm, "Luminary131.bin", NULL, 0);
+	Lm.Portnum = 19797;		// Cm gets the default, 19697.
+	agc_runner_start (&CmRunner, &Cm, 0, 1);
+	agc_runner_start (&LmRunner, &Lm, 0, 1);
+	...
+	agc_runner_stop (&CmRunner);
+	agc_runner_stop (&LmRunner);
+	ChannelClose (&Cm);
+	ChannelClose (&Lm);
+
+  All of the agc_t must be initialized before any of the threads are 
+  started, and nothing else should touch an agc_t while its thread runs.
+  Only one of them can be debugged (--debug), since the debugger and
+  symbol table are per process, and likewise there's one --stats file;
+  the other instruments (traces, load reports, and so on) are per agc_t.
+  Stop and Cycles are shared with the thread, and so are only to be 
+  accessed with the __atomic builtins (or after agc_runner_wait).
+*/
+
+#ifndef AGC_RUNNER_H
+#define AGC_RUNNER_H
+
+#include <pthread.h>
+#include "agc_engine.h"
+
+typedef struct
+{
+  agc_t *State;
+  uint64_t MaxCycles;		// Machine cycles to run, or 0 for no limit.
+  int RealTime;			// Non-zero to run at the real AGC speed.
+  int Stop;			// Set to make the thread exit.
+  uint64_t Cycles;		// Machine cycles run so far.
+  Pacer_t Pacer;		// For RealTime.
+  pthread_t Thread;
+} agc_runner_t;
+
+int agc_runner_start (agc_runner_t *Runner, agc_t *State, uint64_t MaxCycles,
+		      int RealTime);
+uint64_t agc_runner_wait (agc_runner_t *Runner);
+uint64_t agc_runner_stop (agc_runner_t *Runner);
+
+#endif // AGC_RUNNER_H
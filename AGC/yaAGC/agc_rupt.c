@@ -0,0 +1,251 @@
+/*
+  Copyright 2026 Ronald S. Burkey <info@sandroid.org>
+
+  This file is part of yaAGC.
+
+  yaAGC is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  yaAGC is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with yaAGC; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+  Filename:	agc_rupt.c
+  Purpose:	Interrupt latency:  how long each type of interrupt waits
+  		between being requested and being taken, how long
+		interrupts are inhibited, and which code is responsible.
+  Compiler:	GNU gcc.
+  Contact:	Ron Burkey <info@sandroid.org>
+  Reference:	http://www.ibiblio.org/apollo/index.html
+  Mods:		2026-10-17	Began.
+
+  While State->RuptTiming is set, agc_engine.c notes the machine cycle in
+  which each interrupt is requested (TIME3 overflowing, a DSKY keystroke,
+  DOWNRUPT coming due, and so on) and the one in which it's taken, and
+  puts the difference in a histogram for the type of interrupt.  An
+  interrupt can be held off by INHINT, by another interrupt being
+  serviced, by an EXTEND or INDEX in progress, or by overflow in A, L, or
+  Q; each machine cycle in which one is kept waiting is charged to the word
+  then being executed, and so is each cycle with interrupts inhibited.  The
+  report lists the words with the most of either, resolved to source lines
+  and routines with ResolveLineAGC and ResolveLastLabel as agc_profile.c
+  does.  Latencies are in machine cycles (11.7 us), and are exact to the
+  cycle, except that one requested and taken in the same cycle counts as
+  none.
+
+  Idle loops aren't skipped (--idle-skip) while the timing is on.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "yaAGC.h"
+#include "agc_engine.h"
+#include "agc_symtab.h"
+#include "agc_rupt.h"
+
+// How many of the worst words are listed.
+#define RUPT_TOP_WORDS 25
+
+static const char *InterruptNames[1 + NUM_INTERRUPT_TYPES] = {
+  "", "T6RUPT", "T5RUPT", "T3RUPT", "T4RUPT", "KEYRUPT1", "KEYRUPT2",
+  "UPRUPT", "DOWNRUPT", "RADARUPT", "HANDRUPT"
+};
+
+typedef struct
+{
+  int Bank, Offset, Erasable;
+  unsigned Cycles;
+} RuptWord_t;
+
+// Starts timing State's interrupts.  Returns 0 on success, or 1 if out of
+// memory.
+int
+RuptStart (agc_t *State)
+{
+  if (State->RuptTiming == NULL)
+    {
+      State->RuptTiming = (RuptTiming_t *) calloc (1, sizeof (RuptTiming_t));
+      if (State->RuptTiming == NULL)
+	return (1);
+    }
+  State->RuptTiming->StartCycle = State->CycleCounter;
+  return (0);
+}
+
+void
+RuptStop (agc_t *State)
+{
+  free (State->RuptTiming);
+  State->RuptTiming = NULL;
+}
+
+static int
+CompareWords (const void *Raw1, const void *Raw2)
+{
+  const RuptWord_t *Word1 = Raw1, *Word2 = Raw2;
+  if (Word1->Cycles != Word2->Cycles)
+    return (Word1->Cycles < Word2->Cycles) ? 1 : -1;
+  return (0);
+}
+
+// Lists the words with the most cycles in Erasable and Fixed.
+static void
+PrintWords (FILE *fp, unsigned Erasable[8][0400], unsigned Fixed[NUM_FIXED_BANKS][02000],
+	    uint64_t Total, const char *Heading)
+{
+  RuptWord_t *Words;
+  SymbolLine_t *Line;
+  Symbol_t *Label;
+  int Bank, Offset, Address12, Count = 0, i;
+
+  if (Total == 0)
+    return;
+  Words = (RuptWord_t *) malloc ((8 * 0400 + NUM_FIXED_BANKS * 02000) * sizeof (RuptWord_t));
+  if (Words == NULL)
+    return;
+  for (Bank = 0; Bank < 8; Bank++)
+    for (Offset = 0; Offset < 0400; Offset++)
+      if (Erasable[Bank][Offset])
+	{
+	  Words[Count].Bank = Bank;
+	  Words[Count].Offset = Offset;
+	  Words[Count].Erasable = 1;
+	  Words[Count++].Cycles = Erasable[Bank][Offset];
+	}
+  for (Bank = 0; Bank < NUM_FIXED_BANKS; Bank++)
+    for (Offset = 0; Offset < 02000; Offset++)
+      if (Fixed[Bank][Offset])
+	{
+	  Words[Count].Bank = Bank;
+	  Words[Count].Offset = Offset;
+	  Words[Count].Erasable = 0;
+	  Words[Count++].Cycles = Fixed[Bank][Offset];
+	}
+  qsort (Words, Count, sizeof (RuptWord_t), CompareWords);
+  if (Count > RUPT_TOP_WORDS)
+    Count = RUPT_TOP_WORDS;
+
+  fprintf (fp, "\n%s:\n\n", Heading);
+  fprintf (fp, "%12s %6s  %-9s %s\n", "Cycles", "%", "Address", "Where");
+  for (i = 0; i < Count; i++)
+    {
+      Bank = Words[i].Bank;
+      Offset = Words[i].Offset;
+      fprintf (fp, "%12u %6.2f  ", Words[i].Cycles,
+	       100.0 * Words[i].Cycles / Total);
+      if (Words[i].Erasable)
+	{
+	  fprintf (fp, "E%o,%04o   erasable memory\n", Bank, Offset);
+	  continue;
+	}
+      // As in agc_profile.c, superbanks are 030-037 with the superbank bit.
+      if (Bank == 2 || Bank == 3)
+	Address12 = Bank * 02000 + Offset;
+      else
+	Address12 = 02000 + Offset;
+      fprintf (fp, "%02o,%04o   ", Bank, Address12);
+      Line = ResolveLineAGC (Address12, (Bank < 040) ? Bank : Bank - 010,
+			     Bank >= 040);
+      Label = (Line != NULL) ? ResolveLastLabel (Line) : NULL;
+      if (Line == NULL)
+	fprintf (fp, "unknown source\n");
+      else if (Label != NULL)
+	fprintf (fp, "%s:%d (%s)\n", Line->FileName, Line->LineNumber,
+		 Label->Name);
+      else
+	fprintf (fp, "%s:%d\n", Line->FileName, Line->LineNumber);
+    }
+  free (Words);
+}
+
+// Writes the report.  Returns 0 on success, or 1 if the file can't be
+// written or the timing isn't on.
+int
+RuptReport (agc_t *State, const char *Filename)
+{
+  RuptTiming_t *Rupt = State->RuptTiming;
+  uint64_t Cycles;
+  FILE *fp;
+  int i, Bucket, Last = 0, Types[NUM_INTERRUPT_TYPES], NumTypes = 0;
+
+  if (Rupt == NULL)
+    return (1);
+  fp = fopen (Filename, "w");
+  if (fp == NULL)
+    return (1);
+  Cycles = State->CycleCounter - Rupt->StartCycle;
+  fprintf (fp, "Interrupt timing over %llu machine cycles (%.3f AGC seconds).\n",
+	   (unsigned long long) Cycles, (double) Cycles / AGC_PER_SECOND);
+  if (Cycles == 0)
+    {
+      fclose (fp);
+      return (0);
+    }
+  fprintf (fp, "Interrupts inhibited for %llu cycles (%.2f%%).\n",
+	   (unsigned long long) Rupt->InhibitedCycles,
+	   100.0 * Rupt->InhibitedCycles / Cycles);
+  fprintf (fp, "Interrupt requests waiting for %llu cycles (%.2f%%).\n",
+	   (unsigned long long) Rupt->WaitingCycles,
+	   100.0 * Rupt->WaitingCycles / Cycles);
+
+  // Summary by type.
+  fprintf (fp, "\nLatency, in machine cycles:\n\n");
+  fprintf (fp, "%-10s %12s %10s %10s %10s\n", "Interrupt", "Taken", "Mean",
+	   "Max", "Max (ms)");
+  for (i = 1; i <= NUM_INTERRUPT_TYPES; i++)
+    {
+      if (Rupt->Taken[i] == 0)
+	continue;
+      Types[NumTypes++] = i;
+      fprintf (fp, "%-10s %12llu %10.1f %10llu %10.3f\n", InterruptNames[i],
+	       (unsigned long long) Rupt->Taken[i],
+	       (double) Rupt->TotalLatency[i] / Rupt->Taken[i],
+	       (unsigned long long) Rupt->MaxLatency[i],
+	       1000.0 * Rupt->MaxLatency[i] / AGC_PER_SECOND);
+      for (Bucket = 0; Bucket < RUPT_BUCKETS; Bucket++)
+	if (Rupt->Latency[i][Bucket] && Bucket > Last)
+	  Last = Bucket;
+    }
+
+  // The histograms, a column per type.
+  if (NumTypes)
+    {
+      fprintf (fp, "\nLatency histograms:\n\n%14s", "Cycles");
+      for (i = 0; i < NumTypes; i++)
+	fprintf (fp, " %9s", InterruptNames[Types[i]]);
+      fprintf (fp, "\n");
+      for (Bucket = 0; Bucket <= Last; Bucket++)
+	{
+	  char Range[32];
+	  if (Bucket == 0)
+	    sprintf (Range, "0");
+	  else if (Bucket == 1)
+	    sprintf (Range, "1");
+	  else if (Bucket == RUPT_BUCKETS - 1)
+	    sprintf (Range, ">= %lu", 1UL << (Bucket - 1));
+	  else
+	    sprintf (Range, "%lu-%lu", 1UL << (Bucket - 1),
+		     (1UL << Bucket) - 1);
+	  fprintf (fp, "%14s", Range);
+	  for (i = 0; i < NumTypes; i++)
+	    fprintf (fp, " %9u", Rupt->Latency[Types[i]][Bucket]);
+	  fprintf (fp, "\n");
+	}
+    }
+
+  PrintWords (fp, Rupt->WaitingErasable, Rupt->WaitingFixed,
+	      Rupt->WaitingCycles, "Where interrupt requests waited");
+  PrintWords (fp, Rupt->InhibitedErasable, Rupt->InhibitedFixed,
+	      Rupt->InhibitedCycles, "Where interrupts were inhibited");
+  if (fclose (fp))
+    return (1);
+  return (0);
+}
@@ -0,0 +1,439 @@
+/*
+  Copyright 2026 Ronald S. Burkey <info@sandroid.org>
+
+  This file is part of yaAGC.
+
+  yaAGC is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  yaAGC is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with yaAGC; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+  Filename:	agc_shm.c
+  Purpose:	Connects peripherals running on the same computer as the
+  		CPU through shared memory rather than sockets.
+  Compiler:	GNU gcc.
+  Contact:	Ron Burkey <info@sandroid.org>
+  Reference:	http://www.ibiblio.org/apollo/index.html
+  Mods:		2026-10-17	Began.
+		2026-10-17	The regions are removed by ShmDestroy, for
+				each agc_t by ChannelClose, rather than from
+				a list kept for the whole process.
+
+  With --shm, yaAGC (or yaAGS) creates a shared-memory region with
+  shm_open for each of the ports it would otherwise only listen on, named
+  for the port (SHM_NAME_FORMAT).  A peripheral started with --shm opens
+  the region for its --port instead of calling CallSocket.  The region
+  holds a pair of rings, one each way, which carry exactly the same bytes
+  as the socket would, so the 4-byte packets are formed and parsed just
+  as before.  Sending a packet or receiving one is then only a matter of
+  copying it in or out of the ring, with no system call at all.
+
+  Each ring has one producer and one consumer, so it needs no locking,
+  only the GCC __atomic builtins to order the data before the index that
+  publishes it.  A peripheral that would rather sleep than poll can call
+  ShmWait, which on Linux waits on a futex on the ring's Tail.  The
+  producer only makes the system call to wake it when Waiting says that
+  somebody is actually asleep.
+
+  A peripheral claims the region by changing its State from SHM_FREE, and
+  the CPU notices it the next time it checks for new connections.  Either
+  side notices that the other has gone by the State, or by its process
+  no longer existing.  The CPU removes its regions with ShmDestroy (which
+  SocketAPI.c's ChannelClose does for each of an agc_t's ports, and yaAGC
+  does on exit), and any left over from before (after a crash, say) are
+  replaced.
+
+  None of this exists on Win32, where ShmCreate and ShmConnect just fail.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "agc_shm.h"
+
+#ifndef WIN32
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
+// How many times ShmRecv finds nothing before checking that the other
+// side still exists.
+#define SHM_CHECK_POLLS 1024
+
+static int
+Alive (int32_t Pid)
+{
+  return (Pid > 0 && (kill (Pid, 0) == 0 || errno == EPERM));
+}
+
+static ShmLink_t *
+NewLink (ShmRegion_t *Region, int Port, int Server)
+{
+  ShmLink_t *Link;
+
+  Link = (ShmLink_t *) calloc (1, sizeof (ShmLink_t));
+  if (Link == NULL)
+    {
+      munmap (Region, sizeof (ShmRegion_t));
+      return (NULL);
+    }
+  Link->Region = Region;
+  Link->Port = Port;
+  Link->Server = Server;
+  return (Link);
+}
+
+static ShmRegion_t *
+Map (int Fd)
+{
+  void *Region;
+
+  Region = mmap (NULL, sizeof (ShmRegion_t), PROT_READ | PROT_WRITE,
+		 MAP_SHARED, Fd, 0);
+  close (Fd);
+  if (Region == MAP_FAILED)
+    return (NULL);
+  return ((ShmRegion_t *) Region);
+}
+
+//-------------------------------------------------------------------------
+// The CPU's side.
+
+// Creates the region for Port.  Returns NULL on failure.
+ShmLink_t *
+ShmCreate (int Port)
+{
+  char Name[32];
+  ShmRegion_t *Region;
+  int Fd;
+
+  sprintf (Name, SHM_NAME_FORMAT, Port);
+  shm_unlink (Name);
+  Fd = shm_open (Name, O_RDWR | O_CREAT | O_EXCL, 0600);
+  if (Fd == -1)
+    return (NULL);
+  if (ftruncate (Fd, sizeof (ShmRegion_t)))
+    {
+      close (Fd);
+      shm_unlink (Name);
+      return (NULL);
+    }
+  Region = Map (Fd);
+  if (Region == NULL)
+    {
+      shm_unlink (Name);
+      return (NULL);
+    }
+  memcpy (Region->Magic, SHM_MAGIC, 8);
+  Region->ServerPid = getpid ();
+  Region->State = SHM_FREE;
+  // A peripheral looks at the version first, so it's set last.
+  __atomic_store_n (&Region->Version, SHM_VERSION, __ATOMIC_RELEASE);
+  return (NewLink (Region, Port, 1));
+}
+
+// Returns 1 if a peripheral has just connected, and otherwise 0.
+int
+ShmAccept (ShmLink_t *Link)
+{
+  ShmRegion_t *Region = Link->Region;
+  uint32_t State;
+
+  State = __atomic_load_n (&Region->State, __ATOMIC_ACQUIRE);
+  if (State == SHM_CONNECTING)
+    {
+      __atomic_store_n (&Region->State, SHM_CONNECTED, __ATOMIC_RELEASE);
+      Link->Polls = 0;
+      return (1);
+    }
+  // One that left before it was even noticed.
+  if (State == SHM_CLOSED)
+    __atomic_store_n (&Region->State, SHM_FREE, __ATOMIC_RELEASE);
+  return (0);
+}
+
+// Frees the region for another peripheral, once the CPU is done with the
+// one that was connected.
+void
+ShmRelease (ShmLink_t *Link)
+{
+  __atomic_store_n (&Link->Region->State, SHM_FREE, __ATOMIC_RELEASE);
+}
+
+// Removes the region, once the CPU is done with the port altogether.  A
+// peripheral still connected sees it as closed.
+void
+ShmDestroy (ShmLink_t *Link)
+{
+  char Name[32];
+
+  if (Link == NULL)
+    return;
+  __atomic_store_n (&Link->Region->State, SHM_CLOSED, __ATOMIC_RELEASE);
+  sprintf (Name, SHM_NAME_FORMAT, Link->Port);
+  shm_unlink (Name);
+  munmap (Link->Region, sizeof (ShmRegion_t));
+  free (Link);
+}
+
+//-------------------------------------------------------------------------
+// The peripheral's side.
+
+// Connects to the CPU's region for Port.  Returns NULL if there's no such
+// region, if the CPU that created it has gone, or if another peripheral
+// has it.
+ShmLink_t *
+ShmConnect (int Port)
+{
+  char Name[32];
+  ShmRegion_t *Region;
+  struct stat Stat;
+  uint32_t Free = SHM_FREE;
+  int Fd;
+
+  sprintf (Name, SHM_NAME_FORMAT, Port);
+  Fd = shm_open (Name, O_RDWR, 0);
+  if (Fd == -1)
+    return (NULL);
+  if (fstat (Fd, &Stat) || Stat.st_size < (off_t) sizeof (ShmRegion_t))
+    {
+      close (Fd);
+      return (NULL);
+    }
+  Region = Map (Fd);
+  if (Region == NULL)
+    return (NULL);
+  if (__atomic_load_n (&Region->Version, __ATOMIC_ACQUIRE) != SHM_VERSION
+      || memcmp (Region->Magic, SHM_MAGIC, 8) || !Alive (Region->ServerPid)
+      || !__atomic_compare_exchange_n (&Region->State, &Free, SHM_CLAIMED, 0,
+				       __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+    {
+      munmap (Region, sizeof (ShmRegion_t));
+      return (NULL);
+    }
+  Region->ToCpu.Head = Region->ToCpu.Tail = Region->ToCpu.Waiting = 0;
+  Region->FromCpu.Head = Region->FromCpu.Tail = Region->FromCpu.Waiting = 0;
+  Region->ClientPid = getpid ();
+  __atomic_store_n (&Region->State, SHM_CONNECTING, __ATOMIC_RELEASE);
+  return (NewLink (Region, Port, 0));
+}
+
+void
+ShmDisconnect (ShmLink_t *Link)
+{
+  if (Link == NULL)
+    return;
+  __atomic_store_n (&Link->Region->State, SHM_CLOSED, __ATOMIC_RELEASE);
+  munmap (Link->Region, sizeof (ShmRegion_t));
+  free (Link);
+}
+
+//-------------------------------------------------------------------------
+// Both sides.
+
+// Returns non-zero if the other side is (still) there.
+int
+ShmConnected (ShmLink_t *Link)
+{
+  ShmRegion_t *Region = Link->Region;
+  uint32_t State;
+
+  State = __atomic_load_n (&Region->State, __ATOMIC_ACQUIRE);
+  if (Link->Server)
+    return (State == SHM_CONNECTED && Alive (Region->ClientPid));
+  return ((State == SHM_CONNECTING || State == SHM_CONNECTED)
+	  && Alive (Region->ServerPid));
+}
+
+// Just the State part of ShmConnected, which is cheap enough to check
+// every time.
+static int
+Open (ShmLink_t *Link)
+{
+  uint32_t State;
+
+  State = __atomic_load_n (&Link->Region->State, __ATOMIC_RELAXED);
+  if (Link->Server)
+    return (State == SHM_CONNECTED);
+  return (State == SHM_CONNECTING || State == SHM_CONNECTED);
+}
+
+// Like send(), copies up to Size bytes into the ring to the other side.
+// Returns the number copied, which is less than Size if the ring is full,
+// or -1 if the connection has been closed.
+int
+ShmSend (ShmLink_t *Link, const void *Data, int Size)
+{
+  ShmRing_t *Ring;
+  uint32_t Head, Tail, Offset, n, First;
+
+  if (!Open (Link))
+    return (-1);
+  Ring = Link->Server ? &Link->Region->FromCpu : &Link->Region->ToCpu;
+  Head = __atomic_load_n (&Ring->Head, __ATOMIC_ACQUIRE);
+  Tail = Ring->Tail;
+  n = SHM_RING_SIZE - (Tail - Head);
+  if (n > (uint32_t) Size)
+    n = Size;
+  if (n == 0)
+    return (0);
+  Offset = Tail & (SHM_RING_SIZE - 1);
+  First = SHM_RING_SIZE - Offset;
+  if (First > n)
+    First = n;
+  memcpy (&Ring->Data[Offset], Data, First);
+  memcpy (Ring->Data, (const unsigned char *) Data + First, n - First);
+  __atomic_store_n (&Ring->Tail, Tail + n, __ATOMIC_SEQ_CST);
+#ifdef __linux__
+  if (__atomic_load_n (&Ring->Waiting, __ATOMIC_SEQ_CST))
+    syscall (SYS_futex, &Ring->Tail, FUTEX_WAKE, 1, NULL, NULL, 0);
+#endif
+  return (n);
+}
+
+// Like a non-blocking recv(), copies up to Size bytes from the ring from
+// the other side.  Returns the number copied, 0 if there was nothing, or
+// -1 if the connection has been closed (but only once the ring is empty).
+int
+ShmRecv (ShmLink_t *Link, void *Data, int Size)
+{
+  ShmRing_t *Ring;
+  uint32_t Head, Tail, Offset, n, First;
+
+  Ring = Link->Server ? &Link->Region->ToCpu : &Link->Region->FromCpu;
+  Tail = __atomic_load_n (&Ring->Tail, __ATOMIC_ACQUIRE);
+  Head = Ring->Head;
+  n = Tail - Head;
+  if (n == 0)
+    {
+      if (!Open (Link))
+	return (-1);
+      if (++Link->Polls >= SHM_CHECK_POLLS)
+	{
+	  Link->Polls = 0;
+	  if (!ShmConnected (Link))
+	    return (-1);
+	}
+      return (0);
+    }
+  if (n > (uint32_t) Size)
+    n = Size;
+  Offset = Head & (SHM_RING_SIZE - 1);
+  First = SHM_RING_SIZE - Offset;
+  if (First > n)
+    First = n;
+  memcpy (Data, &Ring->Data[Offset], First);
+  memcpy ((unsigned char *) Data + First, Ring->Data, n - First);
+  __atomic_store_n (&Ring->Head, Head + n, __ATOMIC_RELEASE);
+  return (n);
+}
+
+// Sleeps until the other side may have sent something, or for at most
+// Milliseconds (if not negative).  Without futexes, it just sleeps for a
+// millisecond.
+void
+ShmWait (ShmLink_t *Link, int Milliseconds)
+{
+  ShmRing_t *Ring;
+  uint32_t Tail;
+  struct timespec Timeout;
+
+  Ring = Link->Server ? &Link->Region->ToCpu : &Link->Region->FromCpu;
+#ifdef __linux__
+  Tail = __atomic_load_n (&Ring->Tail, __ATOMIC_SEQ_CST);
+  if (Tail != Ring->Head)
+    return;
+  __atomic_store_n (&Ring->Waiting, 1, __ATOMIC_SEQ_CST);
+  Timeout.tv_sec = Milliseconds / 1000;
+  Timeout.tv_nsec = (Milliseconds % 1000) * 1000000L;
+  // Returns at once if Tail has already moved on.
+  syscall (SYS_futex, &Ring->Tail, FUTEX_WAIT, Tail,
+	   (Milliseconds < 0) ? NULL : &Timeout, NULL, 0);
+  __atomic_store_n (&Ring->Waiting, 0, __ATOMIC_SEQ_CST);
+#else
+  Tail = __atomic_load_n (&Ring->Tail, __ATOMIC_ACQUIRE);
+  if (Tail != Ring->Head || Milliseconds == 0)
+    return;
+  Timeout.tv_sec = 0;
+  Timeout.tv_nsec = 1000000L;
+  nanosleep (&Timeout, NULL);
+#endif
+}
+
+#else // WIN32
+
+ShmLink_t *
+ShmCreate (int Port)
+{
+  return (NULL);
+}
+
+int
+ShmAccept (ShmLink_t *Link)
+{
+  return (0);
+}
+
+void
+ShmRelease (ShmLink_t *Link)
+{
+}
+
+void
+ShmDestroy (ShmLink_t *Link)
+{
+}
+
+ShmLink_t *
+ShmConnect (int Port)
+{
+  return (NULL);
+}
+
+void
+ShmDisconnect (ShmLink_t *Link)
+{
+}
+
+int
+ShmConnected (ShmLink_t *Link)
+{
+  return (0);
+}
+
+int
+ShmSend (ShmLink_t *Link, const void *Data, int Size)
+{
+  return (-1);
+}
+
+int
+ShmRecv (ShmLink_t *Link, void *Data, int Size)
+{
+  return (-1);
+}
+
+void
+ShmWait (ShmLink_t *Link, int Milliseconds)
+{
+}
+
+#endif // WIN32
@@ -0,0 +1,118 @@
+/*
+  Copyright 2026 Ronald S. Burkey <info@sandroid.org>
+
+  This file is part of yaAGC.
+
+  yaAGC is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  yaAGC is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with yaAGC; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+  Filename:	agc_shm.h
+  Purpose:	Header for agc_shm.c, the shared-memory alternative to the
+  		sockets for peripherals on the same computer as the CPU.
+  Compiler:	GNU gcc.
+  Contact:	Ron Burkey <info@sandroid.org>
+  Reference:	http://www.ibiblio.org/apollo/index.html
+  Mods:		2026-10-17	Began.
+		2026-10-17	Added ShmDestroy.
+
+  Typical use by a peripheral, in place of CallSocket, recv, and send:
+
+	ShmLink_t *Link = ShmConnect (19697);
+	...
+	n = ShmRecv (Link, Buffer, sizeof (Buffer));	// -1 if yaAGC is gone.
+	...
+	ShmSend (Link, Packet, 4);
+	...
+	ShmDisconnect (Link);
+
+  The CPU's side is handled by SocketAPI.c, when SharedMemory is set.
+*/
+
+#ifndef AGC_SHM_H
+#define AGC_SHM_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// The region for port N is named SHM_NAME_FORMAT with N filled in.
+#define SHM_NAME_FORMAT "/yaAGC-%d"
+#define SHM_MAGIC "yaAGCshm"
+#define SHM_VERSION 1
+// Bytes in each ring.  Must be a power of 2.
+#define SHM_RING_SIZE 4096
+
+// ShmRegion_t.State.
+#define SHM_FREE 0		// No peripheral.
+#define SHM_CLAIMED 1		// A peripheral is setting up the rings.
+#define SHM_CONNECTING 2	// ... and is waiting for the CPU to see it.
+#define SHM_CONNECTED 3
+#define SHM_CLOSED 4		// The peripheral has gone.
+
+// A ring of bytes, with a single producer and a single consumer.  Head
+// and Tail are free-running, and are kept on separate cache lines so that
+// the two sides don't fight over them.  Waiting is set by a consumer that
+// is sleeping (see ShmWait).
+typedef struct
+{
+  uint32_t Head;
+  char Pad1[60];
+  uint32_t Tail;
+  uint32_t Waiting;
+  char Pad2[56];
+  unsigned char Data[SHM_RING_SIZE];
+} ShmRing_t;
+
+// The shared-memory region, one per port.
+typedef struct
+{
+  char Magic[8];
+  uint32_t Version;
+  uint32_t State;
+  int32_t ServerPid, ClientPid;
+  ShmRing_t ToCpu, FromCpu;
+} ShmRegion_t;
+
+// Each side's handle on the region.
+typedef struct ShmLink
+{
+  ShmRegion_t *Region;
+  int Port;
+  int Server;			// Non-zero for the CPU's side.
+  unsigned Polls;		// Empty reads since the other side was checked.
+} ShmLink_t;
+
+// For the CPU.
+ShmLink_t *ShmCreate (int Port);
+int ShmAccept (ShmLink_t *Link);
+void ShmRelease (ShmLink_t *Link);
+void ShmDestroy (ShmLink_t *Link);
+
+// For the peripherals.
+ShmLink_t *ShmConnect (int Port);
+void ShmDisconnect (ShmLink_t *Link);
+
+// For both.
+int ShmConnected (ShmLink_t *Link);
+int ShmSend (ShmLink_t *Link, const void *Data, int Size);
+int ShmRecv (ShmLink_t *Link, void *Data, int Size);
+void ShmWait (ShmLink_t *Link, int Milliseconds);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // AGC_SHM_H
@@ -9,6 +9,7 @@
 #include <string.h>
 #include <unistd.h>
 #include <stdlib.h>
+#include <signal.h>
 
 #include "yaAGC.h"
 #include "agc_cli.h"
@@ -17,10 +18,23 @@
 #include "agc_debug.h"
 #include "agc_debugger.h"
 #include "agc_simulator.h"
+#include "agc_profile.h"
+#include "agc_load.h"
+#include "agc_rupt.h"
+#include "agc_trace.h"
+#include "agc_interp.h"
+#include "agc_benchmark.h"
+#include "agc_stats.h"
 
 /** Declare the singleton Simulator object instance */
 static Simulator_t Simulator;
 
+/** Set by a signal to make SimExecute return */
+static volatile sig_atomic_t SimStop = 0;
+
+/** Number of cycles run per agc_engine_run call with --speed=max */
+#define SIM_MAX_BATCH (AGC_PER_SECOND / 100)
+
 static int SimInitializeEngine(void)
 {
 	int result = 0;
@@ -28,7 +42,14 @@ static int SimInitializeEngine(void)
 	/* Initialize the simulation */
 	if (!Simulator.Options->debug_dsky)
 	{
-		if (Simulator.Options->resume == NULL)
+		/* A replay starts from the state in the recording instead of
+		 * from a core dump */
+		if (Simulator.Options->replay != NULL)
+		{
+			result = agc_engine_init (&Simulator.State,
+					Simulator.Options->core, NULL, 0);
+		}
+		else if (Simulator.Options->resume == NULL)
 	    {
 			if (Simulator.Options->cfg)
 	    	{
@@ -72,24 +93,188 @@ static int SimInitializeEngine(void)
 			case 5:
 			  printf ("Core-rope image file read error.\n");
 			  break;
+			case 7:
+			  printf ("Core-dump file is corrupt or of an unknown version.\n");
+			  break;
 			default:
 			  printf ("Initialization implementation error.\n");
 			  break;
 		}
+
+		/* Replay the input from the start, as fast as possible.  A replay
+		 * that can't start from the recorded state isn't run at all. */
+		if (result == 0 && Simulator.Options->replay != NULL)
+		{
+			switch (StartInputReplay (&Simulator.State,
+					Simulator.Options->replay))
+			{
+				case 0:
+				  Simulator.Options->speed = 0;
+				  break;
+				case 1:
+				  printf ("Could not replay \"%s\".\n",
+						  Simulator.Options->replay);
+				  result = 8;
+				  break;
+				case 2:
+				  printf ("The starting state in \"%s\" is corrupt or of "
+						  "an unknown version.\n", Simulator.Options->replay);
+				  result = 8;
+				  break;
+				default:
+				  printf ("The starting state in \"%s\" isn't from the "
+						  "cycle the recording began in.\n",
+						  Simulator.Options->replay);
+				  result = 8;
+				  break;
+			}
+		}
 	}
 
 	return (result);
 }
 
 /**
-This function executes one cycle of the AGC engine. This is
+This function executes cycles of the AGC engine. This is
 a wrapper function to eliminate showing the passing of the
-current engine state. */
-static void SimExecuteEngine()
+current engine state. Up to Cycles machine cycles are run in a
+single batch, and the number actually executed is returned.  With
+--load-report, the batch ends when the next load sample is due, so the
+samples stay 1 ms apart however large the batch asked for. */
+static uint64_t SimExecuteEngine(uint64_t Cycles)
+{
+	uint64_t Ran, Limit;
+
+	if (Simulator.Options->load_report)
+	{
+		Limit = LoadCyclesToSample (&Simulator.State);
+		if (Cycles > Limit) Cycles = Limit;
+	}
+	Ran = agc_engine_run (&Simulator.State, Cycles);
+	if (Simulator.Options->load_report)
+		LoadSample (&Simulator.State);
+	if (Simulator.Options->interp_trace)
+		InterpFlush (&Simulator.State);
+
+	/* The end of a --replay ends the run, except in the debugger, where
+	 * the input just comes from the sockets from then on */
+	if (Simulator.State.InputLog.Finished)
+	{
+		Simulator.State.InputLog.Finished = 0;
+		printf ("\nReplay finished at cycle %llu.\n",
+				(unsigned long long) Simulator.State.CycleCounter);
+		if (!Simulator.Options->debug) SimStop = 1;
+	}
+	return (Ran);
+}
+
+
+/**
+Write the profile requested by --profile.  This is called on exit, which
+is how the debugger's QUIT command leaves as well.
+*/
+static void SimWriteProfile(void)
 {
-	agc_engine (&Simulator.State);
+	if (WriteProfile(&Simulator.State, Simulator.Options->profile))
+		printf ("Could not write the profile \"%s\".\n",
+				Simulator.Options->profile);
 }
 
+/**
+Close the peripherals' sockets and remove the --shm regions, on exit.
+*/
+static void SimClose(void)
+{
+	ChannelClose (&Simulator.State);
+}
+
+/**
+Finish the load report requested by --load-report, on exit.
+*/
+static void SimStopLoad(void)
+{
+	LoadStop (&Simulator.State);
+}
+
+/**
+Write the interrupt latency report requested by --rupt-report, on exit.
+*/
+static void SimWriteRupt(void)
+{
+	if (RuptReport (&Simulator.State, Simulator.Options->rupt_report))
+		printf ("Could not write the interrupt report \"%s\".\n",
+				Simulator.Options->rupt_report);
+	RuptStop (&Simulator.State);
+}
+
+/**
+Write the last of the trace requested by --trace, on exit.
+*/
+static void SimStopTrace(void)
+{
+	if (TraceStop (&Simulator.State))
+		printf ("Could not write all of the trace \"%s\".\n",
+				Simulator.Options->trace);
+}
+
+/**
+Write the interpretive report requested by --interp-report, and the last
+of the trace requested by --interp-trace, on exit.
+*/
+static void SimStopInterp(void)
+{
+	Options_t *Options = Simulator.Options;
+
+	if (Options->interp_report &&
+			InterpReport (&Simulator.State, Options->interp_report))
+		printf ("Could not write the interpretive report \"%s\".\n",
+				Options->interp_report);
+	if (InterpStop (&Simulator.State) && Options->interp_trace)
+		printf ("Could not write all of the interpretive trace \"%s\".\n",
+				Options->interp_trace);
+}
+
+/**
+Finish the recording requested by --record, on exit.
+*/
+static void SimStopRecord(void)
+{
+	StopInputRecord (&Simulator.State);
+}
+
+/**
+Write yaAGC's part of the --stats file.  This is called by the thread in
+agc_stats.c while the AGC runs, so it only reads counters that the AGC
+keeps up to date anyway.
+*/
+static void SimWriteStats(FILE *fp, double Seconds, void *Data)
+{
+	static uint64_t LastCycles = 0;
+	agc_t *State = &Simulator.State;
+	uint64_t Cycles = State->CycleCounter;
+
+	if (LastCycles == 0) LastCycles = Simulator.StartCycle;
+	if (Seconds > 0)
+		fprintf (fp, "agc_speed %.3f\n",
+				(Cycles - LastCycles) / Seconds / AGC_PER_SECOND);
+	StatsRate (fp, "agc_cycles", Cycles, &LastCycles, Seconds);
+	StatsPacer (fp, &Simulator.Pacer);
+	StatsAgc (fp, State);
+	StatsClients (fp, State->Clients, State->NumClients, State->Portnum);
+	fprintf (fp, "coredumps " FORMAT_64U "\n", SnapshotStats.Count);
+	fprintf (fp, "coredump_copy_us %.1f\n", SnapshotStats.LastCopy / 1e3);
+	fprintf (fp, "coredump_copy_us_max %.1f\n", SnapshotStats.MaxCopy / 1e3);
+	fprintf (fp, "coredump_write_us %.1f\n", SnapshotStats.LastWrite / 1e3);
+	fprintf (fp, "coredump_write_us_max %.1f\n", SnapshotStats.MaxWrite / 1e3);
+}
+
+/**
+Stop rewriting the --stats file, on exit, leaving the final figures in it.
+*/
+static void SimStopStats(void)
+{
+	StatsStop ();
+}
 
 /**
 Initialize the AGC Simulator; this means setting up the debugger, AGC
@@ -102,29 +287,124 @@ int SimInitialize(Options_t* Options)
 	/* Without Options we can't Run */
 	if (!Options) return(6);
 
+	/* Decoding a trace takes the place of the normal run */
+	if (Options->decode_trace)
+	{
+		if (Options->symtab)
+		{
+			ResetSymbolTable ();
+			ReadSymbolTable (Options->symtab);
+		}
+		exit (TraceDecode (Options->decode_trace));
+	}
+
 	/* Set the basic simulator variables */
 	Simulator.Options = Options;
 	Simulator.DebugRules = DebugRules;
-	Simulator.DumpInterval = Options->dump_time * sysconf (_SC_CLK_TCK);
+	Simulator.DumpInterval = Options->dump_time * (uint64_t) AGC_PER_SECOND;
 
 	/* Set legacy Option variables */
 	Portnum = Options->port;
+	SharedMemory = Options->shm;
 	DebugDsky = Options->debug_dsky;
 	DebugDeda = Options->debug_deda;
 	DedaQuiet = Options->deda_quiet;
 
-	Simulator.DumpInterval = Simulator.DumpInterval;
 	SocketInterlaceReload = Options->interlace;
+	IdleSkip = Options->idle_skip;
 
 	/* If we are not in quiet mode display the version info */
 	if (!Options->quiet) DbgDisplayVersion();
 
 	/* Initialize the AGC Engine */
 	result = SimInitializeEngine();
+	atexit (SimClose);
 
 	/* Initialize the Debugger if running with debug mode */
 	if(Options->debug) DbgInitialize(Options,&(Simulator.State));
 
+	/* The debugger has the symbols already, but otherwise they have to
+	 * be loaded for the profile and the reports */
+	if ((Options->profile || Options->load_report || Options->rupt_report
+			|| Options->trace || Options->interp_report
+			|| Options->interp_trace) && !Options->debug && Options->symtab)
+	{
+		ResetSymbolTable ();
+		ReadSymbolTable (Options->symtab);
+	}
+
+	/* Profile from the start if asked to */
+	if (Options->profile)
+	{
+		if (StartCoverage (&Simulator.State))
+			printf ("Out of memory for the profile.\n");
+		else
+			atexit (SimWriteProfile);
+	}
+
+	/* Analyze the load from the start if asked to */
+	if (Options->load_report)
+	{
+		if (LoadStart (&Simulator.State, Options->load_report,
+				Options->load_window))
+			printf ("Could not create the load report \"%s\".\n",
+					Options->load_report);
+		else
+			atexit (SimStopLoad);
+	}
+
+	/* Time the interrupts from the start */
+	if (Options->rupt_report)
+	{
+		if (RuptStart (&Simulator.State))
+			printf ("Out of memory for the interrupt timing.\n");
+		else
+			atexit (SimWriteRupt);
+	}
+
+	/* Trace from the start, or from the trigger */
+	if (Options->trace)
+	{
+		int i;
+
+		if (TraceStart (&Simulator.State, Options->trace))
+			printf ("Could not create the trace \"%s\".\n", Options->trace);
+		else
+		{
+			for (i = 0; i < Options->num_trace_ranges; i++)
+				if (TraceRange (&Simulator.State, Options->trace_range[i]))
+					printf ("Unknown trace range \"%s\".\n",
+							Options->trace_range[i]);
+			if (TraceTrigger (&Simulator.State, Options->trace_from,
+					Simulator.State.CycleCounter +
+					Options->trace_after * AGC_PER_SECOND,
+					Options->trace_limit))
+				printf ("Unknown trace address \"%s\".\n",
+						Options->trace_from);
+			atexit (SimStopTrace);
+		}
+	}
+
+	/* Count or trace the interpretive instructions from the start */
+	if (Options->interp_report || Options->interp_trace)
+	{
+		if (InterpStart (&Simulator.State, Options->interp_trace))
+			printf ("Could not start on the interpretive instructions "
+					"(no NEWOPS, OPJUMP, and DOSTORE in the symbol table?).\n");
+		else
+			atexit (SimStopInterp);
+	}
+
+	/* Record the input from the start */
+	if (Options->record)
+	{
+		if (StartInputRecord (&Simulator.State, Options->record))
+			printf ("Could not create the recording \"%s\".\n",
+					Options->record);
+		else
+			atexit (SimStopRecord);
+	}
+
 //	if (Options->cdu_log)
 //	{
 //	  extern FILE *CduLog;
@@ -132,11 +412,24 @@ int SimInitialize(Options_t* Options)
 //	}
 
 	/* Initialize realtime and cycle counters */
-	Simulator.RealTimeOffset = times (&Simulator.DummyTime);	// The starting time of the program.
-	Simulator.NextCoreDump = Simulator.RealTimeOffset + Simulator.DumpInterval;
+	PacerInit (&Simulator.Pacer, Options->quantum * (uint64_t) 1000);
+	Simulator.RealTime = PacerNow ();	// The starting time of the program.
+	Simulator.StartRealTime = Simulator.RealTimeOffset = Simulator.RealTime;
+	Simulator.StartCycle = Simulator.State.CycleCounter;
+	Simulator.NextCoreDump = Simulator.State.CycleCounter + Simulator.DumpInterval;
 	SimSetCycleCount(SIM_CYCLECOUNT_AGC); // Num. of AGC cycles so far.
-	Simulator.RealTimeOffset -= (Simulator.CycleCount + AGC_PER_SECOND / 2) / AGC_PER_SECOND;
-	Simulator.LastRealTime = ~0UL;
+	Simulator.CycleCountOffset = Simulator.CycleCount;
+
+	/* Keep the live statistics from the start */
+	if (Options->stats)
+	{
+		if (StatsStart (Options->stats, Options->stats_interval,
+				SimWriteStats, NULL))
+			printf ("Could not create the statistics file \"%s\".\n",
+					Options->stats);
+		else
+			atexit (SimStopStats);
+	}
 
 	return (result | Options->version);
 }
@@ -151,95 +444,122 @@ void SimSetCycleCount(int Mode)
 	switch(Mode)
 	{
 		case SIM_CYCLECOUNT_AGC:
-			Simulator.CycleCount = sysconf (_SC_CLK_TCK) * Simulator.State.CycleCounter;
+			Simulator.CycleCount = Simulator.State.CycleCounter;
 			break;
 		case SIM_CYCLECOUNT_INC:
-			Simulator.CycleCount += sysconf (_SC_CLK_TCK);
+			Simulator.CycleCount++;
 			break;
 	}
 }
 
-/**
-This function puts the simulator in a sleep state to reduce
-CPU usage on the PC.
-*/
-static void SimSleep(void)
-{
-#ifdef WIN32
-	Sleep (10);
-#else
-	struct timespec req, rem;
-	req.tv_sec = 0;
-	req.tv_nsec = 10000000;
-	nanosleep (&req, &rem);
-#endif
-}
-
 /**
 This function manages the AGC periodic core dumping of the
-AGC state machine.
+AGC state machine.  The interval is measured in AGC time, so
+that it's the same at any --speed.  The dumps are binary snapshots,
+which are written by a background thread so as not to stall the AGC.
 */
 static void SimManageCoreDump(void)
 {
 	/* Check to see if the next core dump should be made */
-	if (Simulator.RealTime >= Simulator.NextCoreDump)
+	if (Simulator.State.CycleCounter >= Simulator.NextCoreDump)
 	{
 		/* Use either specific core dump name (from cfg) or generic */
 		if (Simulator.Options->cfg)
 		{
-			if (CmOrLm) MakeCoreDump (&Simulator.State, "CM.core");
-			else MakeCoreDump (&Simulator.State, "LM.core");
+			if (CmOrLm) MakeSnapshotAsync (&Simulator.State, "CM.core");
+			else MakeSnapshotAsync (&Simulator.State, "LM.core");
 		}
-		else MakeCoreDump (&Simulator.State, "core");
+		else MakeSnapshotAsync (&Simulator.State, "core");
 
 		/* Set the next CoreDump Time based on DumpInterval time */
-		Simulator.NextCoreDump = Simulator.RealTime + Simulator.DumpInterval;
+		Simulator.NextCoreDump = Simulator.State.CycleCounter + Simulator.DumpInterval;
 	}
 }
 
 /**
- * This function is a helper to allow the debugger to update the realtime
+ * This function is a helper to allow the debugger to update the realtime.
+ * The time since the simulation last ran doesn't count.
  */
 void SimUpdateTime(void)
 {
-	Simulator.RealTimeOffset +=
-		((Simulator.RealTime = times (&Simulator.DummyTime)) - Simulator.LastRealTime);
-	Simulator.LastRealTime = Simulator.RealTime;
+	uint64_t Now = PacerNow ();
+
+	Simulator.RealTimeOffset += Now - Simulator.RealTime;
+	Simulator.RealTime = Now;
 }
 
 /**
 This function manages the Simulator time to achieve the
-average 11.7 microsecond per opcode execution
+average 11.7 microsecond per opcode execution.  It sleeps until
+the next pacing quantum, and then computes how many AGC cycles
+should have been executed by now.
 */
 static void SimManageTime(void)
 {
-	Simulator.RealTime = times (&Simulator.DummyTime);
-	if (Simulator.RealTime != Simulator.LastRealTime)
+	/* Make a routine core dump */
+	SimManageCoreDump();
+
+	Simulator.RealTime = PacerWait (&Simulator.Pacer);
+	Simulator.DesiredCycles = Simulator.CycleCountOffset + (uint64_t)
+		((Simulator.RealTime - Simulator.RealTimeOffset) *
+		 (AGC_PER_SECOND / 1e9) * Simulator.Options->speed);
+	PacerBacklog (&Simulator.Pacer,
+		(Simulator.DesiredCycles > Simulator.CycleCount) ?
+		Simulator.DesiredCycles - Simulator.CycleCount : 0);
+}
+
+/**
+This function records how far the AGC trails real time, after
+it has been caught up.
+*/
+static void SimManageLag(void)
+{
+	uint64_t AgcTime, Now;
+
+	AgcTime = Simulator.RealTimeOffset + (uint64_t)
+		((Simulator.State.CycleCounter - Simulator.CycleCountOffset) *
+		 (1e9 / AGC_PER_SECOND) / Simulator.Options->speed);
+	Now = PacerNow ();
+	PacerLag (&Simulator.Pacer, (Now > AgcTime) ? Now - AgcTime : 0);
+}
+
+/**
+Signal handler which makes SimExecute return.
+*/
+static void SimCatchSignal(int sig)
+{
+	SimStop = 1;
+}
+
+/**
+Execute the simulated CPU as fast as the host allows (--speed=max).
+Socket service is already driven by AGC cycles within agc_engine_run,
+and core dumps are on AGC time, so neither depends on the real time.
+*/
+static void SimExecuteUnthrottled(void)
+{
+	if (Simulator.Options->debug)
 	{
-		/* Make a routine core dump */
-		SimManageCoreDump();
-
-		// Need to recalculate the number of AGC cycles we're supposed to
-		// have executed.  Notice the trick of multiplying both CycleCount
-		// and DesiredCycles by CLK_TCK, to avoid a long long division by CLK_TCK.
-		// This not only reduces overhead, but actually makes the calculation
-		// more exact.  A bit tricky to understand at first glance, though.
-		Simulator.LastRealTime = Simulator.RealTime;
-
-		//DesiredCycles = ((RealTime - RealTimeOffset) * AGC_PER_SECOND) / CLK_TCK;
-		//DesiredCycles = (RealTime - RealTimeOffset) * AGC_PER_SECOND;
-		// The calculation is done in the following funky way because if done as in
-		// the line above, the right-hand side will be done in 32-bit arithmetic
-		// on a 32-bit CPU, while the left-hand side is 64-bit, and so the calculation
-		// will overflow and fail after 4 minutes of operation.  Done the following
-		// way, the calculation will always be 64-bit.  Making AGC_PER_SECOND a ULL
-		// constant in agc_engine.h would fix it, but the Orbiter folk wouldn't
-		// be able to compile it.
-		Simulator.DesiredCycles = Simulator.RealTime;
-		Simulator.DesiredCycles -= Simulator.RealTimeOffset;
-		Simulator.DesiredCycles *= AGC_PER_SECOND;
+		/* If debugging is enabled run the debugger */
+		if (!DbgExecute()) SimExecuteEngine(1);
 	}
-	else SimSleep();
+	else SimExecuteEngine(SIM_MAX_BATCH);
+
+	SimManageCoreDump();
+}
+
+/**
+Print the AGC time executed per unit of real time.
+*/
+static void SimReportSpeed(void)
+{
+	double AgcSeconds, RealSeconds;
+
+	AgcSeconds = (double) (Simulator.State.CycleCounter - Simulator.StartCycle) / AGC_PER_SECOND;
+	RealSeconds = (PacerNow () - Simulator.StartRealTime) / 1e9;
+	printf ("\n%.1f AGC seconds in %.1f real seconds", AgcSeconds, RealSeconds);
+	if (RealSeconds > 0) printf (" (%.2f AGC seconds per second)", AgcSeconds / RealSeconds);
+	printf (".\n");
 }
 
 /**
@@ -249,31 +569,63 @@ Execute the simulated CPU.  Expecting to ACCURATELY cycle the simulation every
 user's standpoint.)  So I do a trick:  I just execute the simulation
 often enough to keep up with real-time on the average.  AGC time is
 measured as the number of machine cycles divided by AGC_PER_SECOND,
-while real-time is measured using the times() function.  What this mains
-is that AGC_PER_SECOND AGC cycles are executed every CLK_TCK clock ticks.
-The timing is thus rather rough-and-ready (i.e., I'm sure it can be improved
-a lot).  It's good enough for me, for NOW, but I'd be happy to take suggestions
-for how to improve it in a reasonably portable way.*/
+while real-time is measured by a monotonic clock (see Pacer.c).  Every
+--quantum microseconds (1 ms by default), the simulation is caught up
+with real time.*/
 void SimExecute(void)
 {
-	while(1)
+	/* A benchmark takes the place of the normal run */
+	if (Simulator.Options->benchmark > 0)
+		exit (Benchmark (Simulator.Options->core, Simulator.Options->resume,
+				Simulator.Options->benchmark,
+				Simulator.Options->benchmark_limit));
+
+	/* Without the debugger, ^C ends the run gracefully */
+	if (!Simulator.Options->debug)
+	{
+		signal (SIGINT, SimCatchSignal);
+		signal (SIGTERM, SimCatchSignal);
+	}
+
+	while(!SimStop)
 	{
+		/* With --speed=max, there's no time to manage */
+		if (Simulator.Options->speed == 0)
+		{
+			SimExecuteUnthrottled();
+			continue;
+		}
+
 		/* Manage the Simulated Time */
 		SimManageTime();
 
 		while (Simulator.CycleCount < Simulator.DesiredCycles)
 		{
-			/* If debugging is enabled run the debugger */
-			if (Simulator.Options->debug && DbgExecute()) continue;
+			if (Simulator.Options->debug)
+			{
+				/* If debugging is enabled run the debugger */
+				if (DbgExecute()) continue;
 
-			/* Execute a cyle of the AGC  engine */
-			SimExecuteEngine();
+				/* Execute a cyle of the AGC  engine */
+				SimExecuteEngine(1);
 
-			/* Adjust the CycleCount */
-			SimSetCycleCount(SIM_CYCLECOUNT_INC);
-		}
-	}
-}
+				/* Adjust the CycleCount */
+				SimSetCycleCount(SIM_CYCLECOUNT_INC);
+			}
+			else
+			{
+				/* Execute all the cycles we're behind by in one batch */
+				SimExecuteEngine(Simulator.DesiredCycles - Simulator.CycleCount);
 
+				/* Resync the CycleCount with the AGC */
+				SimSetCycleCount(SIM_CYCLECOUNT_AGC);
+			}
+		}
 
+		SimManageLag();
+	}
 
+	if (Simulator.Options->speed != 1.0) SimReportSpeed();
+	if (Simulator.Options->pacing_report) PacerReport (&Simulator.Pacer);
+	FlushSnapshots ();
+}
@@ -46,14 +46,16 @@ typedef struct
 {
 	Options_t* Options;
 	DebugRule_t* DebugRules;
-	clock_t DumpInterval;
-	clock_t RealTimeOffset;
-	clock_t RealTime;
-	clock_t LastRealTime;
-	clock_t NextCoreDump;
+	uint64_t DumpInterval;	/* In AGC cycles */
+	uint64_t RealTime;	/* In ns, from PacerNow() */
+	uint64_t RealTimeOffset;	/* Real time at which ... */
+	uint64_t CycleCountOffset;	/* ... the AGC was at this cycle */
+	uint64_t NextCoreDump;	/* AGC cycle count of the next core dump */
+	uint64_t StartRealTime;
+	uint64_t StartCycle;
 	uint64_t DesiredCycles;
 	uint64_t CycleCount;
-	struct tms DummyTime;
+	Pacer_t Pacer;
 	agc_t State;
 } Simulator_t;
 
@@ -0,0 +1,540 @@
+/*
+  Copyright 2026 Ronald S. Burkey <info@sandroid.org>
+
+  This file is part of yaAGC.
+
+  yaAGC is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  yaAGC is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with yaAGC; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+  Filename:	agc_snapshot.c
+  Purpose:	Binary core-dump files ("snapshots"), and a background
+  		thread for writing them, so that the periodic core dumps
+		don't stall the simulation.
+  Compiler:	GNU gcc.
+  Contact:	Ron Burkey <info@sandroid.org>
+  Reference:	http://www.ibiblio.org/apollo/index.html
+  Mods:		2026-10-17	Began.
+		2026-10-17	Added SnapshotStats.
+		2026-10-17	Added WriteSnapshotFile and
+				agc_restore_snapshot, for the recordings
+				made by --record.
+		2026-10-17	StartInputRecord and StartInputReplay moved
+				here from agc_input.c, since they're what
+				need the snapshots.
+		2026-10-17	A pending snapshot for another file is no
+				longer replaced, and SnapshotStats is
+				updated under the writer's lock.
+		2026-10-17	Version 2 adds the scaler, the channel
+				routine count, the gyro and IMU CDU drive
+				timers, the CDU FIFOs, and the bulk
+				increments.
+
+  A snapshot holds the same things as the octal core-dump files made by
+  MakeCoreDump --- i/o channels, erasable memory, and the CPU state that
+  isn't in memory --- plus the timers and queues behind the counters, so
+  that a run restored from one carries on exactly as the original did.
+  It's a single fixed-size Snapshot_t, which is written with one fwrite
+  and read back with one fread.  It's in the byte order of the machine
+  that wrote it; a snapshot from a machine of the other byte order, or
+  from an older version of yaAGC, is rejected as being of an unknown
+  version.
+  agc_engine_init recognizes either kind of file, so the octal format is
+  still there for importing and exporting (the debugger's COREDUMP command
+  makes one).
+*/
+
+// For Orbiter.
+#ifndef AGC_SOCKET_ENABLED
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include <pthread.h>
+#include "yaAGC.h"
+#include "agc_engine.h"
+
+#define SNAPSHOT_VERSION 2
+
+typedef struct {
+  char Magic[8];		// SNAPSHOT_MAGIC.
+  uint32_t Version;		// SNAPSHOT_VERSION.
+  uint32_t Size;		// sizeof (Snapshot_t).
+  uint32_t Checksum;		// Of everything after this field.
+  uint32_t Spare;
+  uint64_t CycleCounter;
+  uint64_t DownruptTime;
+  int32_t Downlink;
+  int16_t InputChannel[NUM_CHANNELS];
+  int16_t Erasable[8][0400];
+  int16_t OutputChannel7;
+  int16_t OutputChannel10[16];
+  int16_t IndexValue;
+  int8_t InterruptRequests[1 + NUM_INTERRUPT_TYPES];
+  uint8_t ExtraCode, AllowInterrupt, InIsr, SubstituteInstruction;
+  uint8_t PendFlag, PendDelay, ExtraDelay, DownruptTimeValid;
+  // Since version 2, the timers and queues of the counters and channels.
+  int32_t ScalerCounter, ChannelRoutineCount;
+  uint32_t GyroCount, OldChannel14, GyroTimer, ImuChannel14;
+  uint64_t ImuCduCount;
+  int32_t CountCDUX, CountCDUY, CountCDUZ;
+  struct {
+    uint64_t NextUpdate;
+    int32_t Ptr, Size, IntervalType;
+    int32_t Counts[MAX_CDU_FIFO_ENTRIES];
+  } CduFifos[NUM_CDU_FIFOS];
+  int32_t CduChecker;
+  struct {
+    int32_t Counter, IncType, Count;
+  } BulkEntries[MAX_BULK_ENTRIES];
+  int32_t BulkPtr, BulkSize;
+} Snapshot_t;
+
+#define CHECKSUM_START offsetof (Snapshot_t, Spare)
+
+// 32-bit FNV-1a.
+static uint32_t
+SnapshotChecksum (const Snapshot_t *Snapshot)
+{
+  const unsigned char *p = (const unsigned char *) Snapshot;
+  uint32_t Sum = 2166136261U;
+  size_t i;
+  for (i = CHECKSUM_START; i < sizeof (Snapshot_t); i++)
+    Sum = (Sum ^ p[i]) * 16777619U;
+  return (Sum);
+}
+
+static void
+FillSnapshot (Snapshot_t *Snapshot, const agc_t *State)
+{
+  int i, j;
+
+  // Clear the padding too, so that it's covered by the checksum.
+  memset (Snapshot, 0, sizeof (Snapshot_t));
+  memcpy (Snapshot->Magic, SNAPSHOT_MAGIC, sizeof (Snapshot->Magic));
+  Snapshot->Version = SNAPSHOT_VERSION;
+  Snapshot->Size = sizeof (Snapshot_t);
+  Snapshot->CycleCounter = State->CycleCounter;
+  Snapshot->DownruptTime = State->DownruptTime;
+  Snapshot->Downlink = State->Downlink;
+  memcpy (Snapshot->InputChannel, State->InputChannel,
+	  sizeof (Snapshot->InputChannel));
+  memcpy (Snapshot->Erasable, State->Erasable, sizeof (Snapshot->Erasable));
+  Snapshot->OutputChannel7 = State->OutputChannel7;
+  memcpy (Snapshot->OutputChannel10, State->OutputChannel10,
+	  sizeof (Snapshot->OutputChannel10));
+  Snapshot->IndexValue = State->IndexValue;
+  for (i = 0; i < 1 + NUM_INTERRUPT_TYPES; i++)
+    Snapshot->InterruptRequests[i] = State->InterruptRequests[i];
+  Snapshot->ExtraCode = State->ExtraCode;
+  Snapshot->AllowInterrupt = State->AllowInterrupt;
+  Snapshot->InIsr = State->InIsr;
+  Snapshot->SubstituteInstruction = State->SubstituteInstruction;
+  Snapshot->PendFlag = State->PendFlag;
+  Snapshot->PendDelay = State->PendDelay;
+  Snapshot->ExtraDelay = State->ExtraDelay;
+  Snapshot->DownruptTimeValid = State->DownruptTimeValid;
+  Snapshot->ScalerCounter = State->ScalerCounter;
+  Snapshot->ChannelRoutineCount = State->ChannelRoutineCount;
+  Snapshot->GyroCount = State->GyroCount;
+  Snapshot->OldChannel14 = State->OldChannel14;
+  Snapshot->GyroTimer = State->GyroTimer;
+  Snapshot->ImuChannel14 = State->ImuChannel14;
+  Snapshot->ImuCduCount = State->ImuCduCount;
+  Snapshot->CountCDUX = State->CountCDUX;
+  Snapshot->CountCDUY = State->CountCDUY;
+  Snapshot->CountCDUZ = State->CountCDUZ;
+  for (i = 0; i < NUM_CDU_FIFOS; i++)
+    {
+      Snapshot->CduFifos[i].NextUpdate = State->CduFifos[i].NextUpdate;
+      Snapshot->CduFifos[i].Ptr = State->CduFifos[i].Ptr;
+      Snapshot->CduFifos[i].Size = State->CduFifos[i].Size;
+      Snapshot->CduFifos[i].IntervalType = State->CduFifos[i].IntervalType;
+      for (j = 0; j < MAX_CDU_FIFO_ENTRIES; j++)
+	Snapshot->CduFifos[i].Counts[j] = State->CduFifos[i].Counts[j];
+    }
+  Snapshot->CduChecker = State->CduChecker;
+  for (i = 0; i < MAX_BULK_ENTRIES; i++)
+    {
+      Snapshot->BulkEntries[i].Counter = State->BulkEntries[i].Counter;
+      Snapshot->BulkEntries[i].IncType = State->BulkEntries[i].IncType;
+      Snapshot->BulkEntries[i].Count = State->BulkEntries[i].Count;
+    }
+  Snapshot->BulkPtr = State->BulkPtr;
+  Snapshot->BulkSize = State->BulkSize;
+  Snapshot->Checksum = SnapshotChecksum (Snapshot);
+}
+
+// Writes the snapshot to a temporary file, and then renames it, so that
+// there's never a half-written file under the real name.
+static int
+WriteSnapshot (const Snapshot_t *Snapshot, const char *Filename)
+{
+  char Temporary[MAX_SNAPSHOT_NAME + 5];
+  FILE *fp;
+  int Ok;
+
+  sprintf (Temporary, "%s.tmp", Filename);
+  fp = fopen (Temporary, "wb");
+  if (fp == NULL)
+    return (1);
+  Ok = (1 == fwrite (Snapshot, sizeof (Snapshot_t), 1, fp));
+  Ok = (0 == fclose (fp)) && Ok;
+#ifdef WIN32
+  if (Ok)
+    remove (Filename);
+#endif
+  if (Ok)
+    Ok = (0 == rename (Temporary, Filename));
+  if (!Ok)
+    remove (Temporary);
+  return (!Ok);
+}
+
+// Reads a snapshot from fp, returning 0 on success, 5 on a read error, or 7
+// if it isn't a snapshot this version of yaAGC can use.
+static int
+ReadSnapshot (Snapshot_t *Snapshot, FILE *fp)
+{
+  int i;
+
+  if (1 != fread (Snapshot, sizeof (Snapshot_t), 1, fp))
+    return (5);
+  if (memcmp (Snapshot->Magic, SNAPSHOT_MAGIC, sizeof (Snapshot->Magic))
+      || Snapshot->Version != SNAPSHOT_VERSION
+      || Snapshot->Size != sizeof (Snapshot_t)
+      || Snapshot->Checksum != SnapshotChecksum (Snapshot))
+    return (7);
+  // The engine indexes its queues with these without checking them.
+  for (i = 0; i < NUM_CDU_FIFOS; i++)
+    if (Snapshot->CduFifos[i].Ptr < 0
+	|| Snapshot->CduFifos[i].Ptr >= MAX_CDU_FIFO_ENTRIES
+	|| Snapshot->CduFifos[i].Size < 0
+	|| Snapshot->CduFifos[i].Size > MAX_CDU_FIFO_ENTRIES)
+      return (7);
+  if (Snapshot->CduChecker < 0 || Snapshot->CduChecker >= NUM_CDU_FIFOS
+      || Snapshot->BulkPtr < 0 || Snapshot->BulkPtr >= MAX_BULK_ENTRIES
+      || Snapshot->BulkSize < 0 || Snapshot->BulkSize > MAX_BULK_ENTRIES)
+    return (7);
+  return (0);
+}
+
+static void
+ApplySnapshot (agc_t *State, const Snapshot_t *Snapshot)
+{
+  int i, j;
+
+  memcpy (State->Erasable, Snapshot->Erasable, sizeof (State->Erasable));
+  memcpy (State->InputChannel, Snapshot->InputChannel,
+	  sizeof (State->InputChannel));
+  State->CycleCounter = Snapshot->CycleCounter;
+  State->DownruptTime = Snapshot->DownruptTime;
+  State->Downlink = Snapshot->Downlink;
+  State->OutputChannel7 = Snapshot->OutputChannel7;
+  memcpy (State->OutputChannel10, Snapshot->OutputChannel10,
+	  sizeof (State->OutputChannel10));
+  State->IndexValue = Snapshot->IndexValue;
+  for (i = 0; i < 1 + NUM_INTERRUPT_TYPES; i++)
+    State->InterruptRequests[i] = Snapshot->InterruptRequests[i];
+  State->ExtraCode = Snapshot->ExtraCode;
+  State->AllowInterrupt = Snapshot->AllowInterrupt;
+  State->InIsr = Snapshot->InIsr;
+  State->SubstituteInstruction = Snapshot->SubstituteInstruction;
+  State->PendFlag = Snapshot->PendFlag;
+  State->PendDelay = Snapshot->PendDelay;
+  State->ExtraDelay = Snapshot->ExtraDelay;
+  State->DownruptTimeValid = Snapshot->DownruptTimeValid;
+  State->ScalerCounter = Snapshot->ScalerCounter;
+  State->ChannelRoutineCount = Snapshot->ChannelRoutineCount;
+  State->GyroCount = Snapshot->GyroCount;
+  State->OldChannel14 = Snapshot->OldChannel14;
+  State->GyroTimer = Snapshot->GyroTimer;
+  State->ImuChannel14 = Snapshot->ImuChannel14;
+  State->ImuCduCount = Snapshot->ImuCduCount;
+  State->CountCDUX = Snapshot->CountCDUX;
+  State->CountCDUY = Snapshot->CountCDUY;
+  State->CountCDUZ = Snapshot->CountCDUZ;
+  for (i = 0; i < NUM_CDU_FIFOS; i++)
+    {
+      State->CduFifos[i].NextUpdate = Snapshot->CduFifos[i].NextUpdate;
+      State->CduFifos[i].Ptr = Snapshot->CduFifos[i].Ptr;
+      State->CduFifos[i].Size = Snapshot->CduFifos[i].Size;
+      State->CduFifos[i].IntervalType = Snapshot->CduFifos[i].IntervalType;
+      for (j = 0; j < MAX_CDU_FIFO_ENTRIES; j++)
+	State->CduFifos[i].Counts[j] = Snapshot->CduFifos[i].Counts[j];
+    }
+  State->CduChecker = Snapshot->CduChecker;
+  for (i = 0; i < MAX_BULK_ENTRIES; i++)
+    {
+      State->BulkEntries[i].Counter = Snapshot->BulkEntries[i].Counter;
+      State->BulkEntries[i].IncType = Snapshot->BulkEntries[i].IncType;
+      State->BulkEntries[i].Count = Snapshot->BulkEntries[i].Count;
+    }
+  State->BulkPtr = Snapshot->BulkPtr;
+  State->BulkSize = Snapshot->BulkSize;
+}
+
+//---------------------------------------------------------------------------
+// Returns 0 on success, 5 on a read error, 6 if the file isn't found, or 7
+// if it isn't a snapshot this version of yaAGC can use.  As with the octal 
+// core dumps, if AllOrErasable is 0 only erasable memory from 010 on up is
+// loaded.
+
+int
+agc_load_snapshot (agc_t *State, const char *Filename, int AllOrErasable)
+{
+  Snapshot_t Snapshot;
+  FILE *fp;
+  int n;
+
+  fp = fopen (Filename, "rb");
+  if (fp == NULL)
+    return (6);
+  n = ReadSnapshot (&Snapshot, fp);
+  fclose (fp);
+  if (n)
+    return (n);
+
+  if (!AllOrErasable)
+    {
+      memcpy (&State->Erasable[0][010], &Snapshot.Erasable[0][010],
+	      sizeof (State->Erasable) - 010 * sizeof (int16_t));
+      return (0);
+    }
+  ApplySnapshot (State, &Snapshot);
+  // Make DOWNRUPT always enabled at start, as for the octal core dumps.
+  State->InterruptRequests[8] = 1;
+  return (0);
+}
+
+// Restores exactly the state in a snapshot read from fp (as embedded in a
+// file by WriteSnapshotFile), returning the same as ReadSnapshot.
+
+int
+agc_restore_snapshot (agc_t *State, FILE *fp)
+{
+  Snapshot_t Snapshot;
+  int n;
+
+  n = ReadSnapshot (&Snapshot, fp);
+  if (n == 0)
+    ApplySnapshot (State, &Snapshot);
+  return (n);
+}
+
+// Writes a snapshot into the open file fp.  Returns 0 on success or 1 on a
+// write error.
+
+int
+WriteSnapshotFile (agc_t *State, FILE *fp)
+{
+  Snapshot_t Snapshot;
+
+  FillSnapshot (&Snapshot, State);
+  return (1 != fwrite (&Snapshot, sizeof (Snapshot), 1, fp));
+}
+
+//---------------------------------------------------------------------------
+// Recordings of the input (see agc_input.c) begin with INPUT_LOG_MAGIC, the
+// cycle at which recording began, and a snapshot of the CPU's state then.
+
+// Starts recording the input to Filename.  Returns 0 on success, or 1 if
+// the file can't be created.  The CPU's state should be the one it was
+// started in, since that's where the replay will start.
+
+int
+StartInputRecord (agc_t *State, const char *Filename)
+{
+  FILE *fp;
+  int i;
+
+  fp = fopen (Filename, "wb");
+  if (fp == NULL)
+    return (1);
+  fwrite (INPUT_LOG_MAGIC, 1, 8, fp);
+  for (i = 0; i < 8; i++)
+    putc ((int) (State->CycleCounter >> (8 * i)) & 0xFF, fp);
+  if (WriteSnapshotFile (State, fp))
+    {
+      fclose (fp);
+      return (1);
+    }
+  BeginInputRecord (State, fp);
+  return (0);
+}
+
+// Starts replaying the input from Filename, first restoring the CPU's state
+// from when the recording began.  Returns 0 on success, 1 if the file can't
+// be read or isn't a recording, 2 if the state in it is corrupt or can't
+// be used by this version of yaAGC, or 3 if the state isn't from the
+// cycle the recording began in.  The CPU's state is changed in all but
+// the first case, so it shouldn't be run if this fails.
+
+int
+StartInputReplay (agc_t *State, const char *Filename)
+{
+  unsigned char Header[16];
+  uint64_t Start = 0;
+  FILE *fp;
+  int i;
+
+  fp = fopen (Filename, "rb");
+  if (fp == NULL)
+    return (1);
+  if (1 != fread (Header, sizeof (Header), 1, fp)
+      || memcmp (Header, INPUT_LOG_MAGIC, 8))
+    {
+      fclose (fp);
+      return (1);
+    }
+  for (i = 7; i >= 0; i--)
+    Start = (Start << 8) | Header[8 + i];
+  if (agc_restore_snapshot (State, fp))
+    {
+      fclose (fp);
+      return (2);
+    }
+  if (Start != State->CycleCounter)
+    {
+      fclose (fp);
+      return (3);
+    }
+  BeginInputReplay (State, fp);
+  return (0);
+}
+
+//---------------------------------------------------------------------------
+
+// Writes a snapshot immediately.
+void
+MakeSnapshot (agc_t *State, const char *Filename)
+{
+  Snapshot_t Snapshot;
+  extern int DebugMode;
+
+  if (strlen (Filename) > MAX_SNAPSHOT_NAME)
+    {
+      printf ("Core-dump filename too long.\n");
+      return;
+    }
+  FillSnapshot (&Snapshot, State);
+  if (WriteSnapshot (&Snapshot, Filename))
+    printf ("Could not create the core-dump file.\n");
+  else if (!DebugMode)
+    printf ("Core-dump file \"%s\" created.\n", Filename);
+}
+
+//---------------------------------------------------------------------------
+// The background writer.  MakeSnapshotAsync just copies the state into
+// Pending and wakes up the writer thread; if the writer hasn't gotten around
+// to the previous snapshot yet, that one is simply replaced by the newer
+// one, provided it's for the same file.  A snapshot for another file (from
+// another CPU, say) is waited for instead, since it wouldn't be superseded.
+// There's one writer for the whole process, and SnapshotStats is updated
+// with SnapshotMutex held.
+
+static pthread_mutex_t SnapshotMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t SnapshotCond = PTHREAD_COND_INITIALIZER;
+static int WriterStarted = 0;
+static int Pending = 0, Writing = 0;
+static Snapshot_t PendingSnapshot;
+static char PendingFilename[MAX_SNAPSHOT_NAME + 1];
+SnapshotStats_t SnapshotStats;
+
+static void *
+SnapshotWriter (void *Arg)
+{
+  Snapshot_t Snapshot;
+  char Filename[MAX_SNAPSHOT_NAME + 1];
+  uint64_t Start;
+  extern int DebugMode;
+
+  pthread_mutex_lock (&SnapshotMutex);
+  while (1)
+    {
+      while (!Pending)
+	pthread_cond_wait (&SnapshotCond, &SnapshotMutex);
+      Snapshot = PendingSnapshot;
+      strcpy (Filename, PendingFilename);
+      Pending = 0;
+      Writing = 1;
+      pthread_mutex_unlock (&SnapshotMutex);
+
+      Start = PacerNow ();
+      if (WriteSnapshot (&Snapshot, Filename))
+	printf ("Could not create the core-dump file.\n");
+      else if (!DebugMode)
+	printf ("Core-dump file \"%s\" created.\n", Filename);
+      Start = PacerNow () - Start;
+
+      pthread_mutex_lock (&SnapshotMutex);
+      SnapshotStats.LastWrite = Start;
+      if (SnapshotStats.LastWrite > SnapshotStats.MaxWrite)
+	SnapshotStats.MaxWrite = SnapshotStats.LastWrite;
+      Writing = 0;
+      pthread_cond_broadcast (&SnapshotCond);
+    }
+  return (NULL);
+}
+
+// Hands a snapshot of State to the writer thread, which is started the first
+// time this is called.  If the thread can't be started, the snapshot is
+// written immediately instead.
+void
+MakeSnapshotAsync (agc_t *State, const char *Filename)
+{
+  pthread_t Thread;
+  uint64_t Start = PacerNow ();
+
+  if (strlen (Filename) > MAX_SNAPSHOT_NAME)
+    {
+      printf ("Core-dump filename too long.\n");
+      return;
+    }
+  pthread_mutex_lock (&SnapshotMutex);
+  if (!WriterStarted)
+    {
+      if (pthread_create (&Thread, NULL, SnapshotWriter, NULL))
+	{
+	  pthread_mutex_unlock (&SnapshotMutex);
+	  MakeSnapshot (State, Filename);
+	  return;
+	}
+      pthread_detach (Thread);
+      WriterStarted = 1;
+    }
+  while (Pending && strcmp (PendingFilename, Filename))
+    pthread_cond_wait (&SnapshotCond, &SnapshotMutex);
+  FillSnapshot (&PendingSnapshot, State);
+  strcpy (PendingFilename, Filename);
+  Pending = 1;
+  pthread_cond_broadcast (&SnapshotCond);
+  SnapshotStats.Count++;
+  SnapshotStats.LastCopy = PacerNow () - Start;
+  if (SnapshotStats.LastCopy > SnapshotStats.MaxCopy)
+    SnapshotStats.MaxCopy = SnapshotStats.LastCopy;
+  pthread_mutex_unlock (&SnapshotMutex);
+}
+
+// Waits for the writer thread to finish any snapshots it has been handed.
+void
+FlushSnapshots (void)
+{
+  pthread_mutex_lock (&SnapshotMutex);
+  while (Pending || Writing)
+    pthread_cond_wait (&SnapshotCond, &SnapshotMutex);
+  pthread_mutex_unlock (&SnapshotMutex);
+}
+
+#endif // AGC_SOCKET_ENABLED
@@ -0,0 +1,302 @@
+/*
+  Copyright 2026 Ronald S. Burkey <info@sandroid.org>
+
+  This file is part of yaAGC.
+
+  yaAGC is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  yaAGC is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with yaAGC; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+  Filename:	agc_stats.c
+  Purpose:	Live runtime statistics for yaAGC and yaAGS (--stats),
+  		written periodically to a file by a background thread.
+  Compiler:	GNU gcc.
+  Contact:	Ron Burkey <info@sandroid.org>
+  Reference:	http://www.ibiblio.org/apollo/index.html
+  Mods:		2026-10-17	Began.
+		2026-10-17	Added the interrupt latencies, when they're
+				being timed (see agc_rupt.c).
+		2026-10-17	Added the records and stalls of the
+				instruction trace (see agc_trace.c).
+		2026-10-17	StatsStart and StatsStop are serialized.
+		2026-10-17	The final write leaves out the rates.
+
+  The simulation itself only bumps plain counters that it keeps anyway
+  (Client_t's traffic, agc_t's InterruptCounts, the Pacer_t, and
+  SnapshotStats), without any locking.  Every so often the thread started
+  by StatsStart reads them and rewrites the statistics file, so the cost
+  to the CPU's thread is a few increments.  Since the counters are read
+  while they're being changed, one line may be a cycle or two out of
+  step with another, which doesn't matter for watching a run.
+
+  The file is written under a temporary name and then renamed, so a reader
+  (watch cat, a script, a dashboard) never sees half of it.  Each line is
+  a name and a value, for example:
+
+	uptime_s 12.001
+	agc_cycles 1024532
+	agc_cycles_per_s 85332.7
+	agc_speed 1.000
+	pacer_wakeups 12001
+	pacer_jitter_us 61
+	pacer_jitter_us_max 1187
+	pacer_backlog_cycles 86
+	pacer_backlog_cycles_max 1021
+	pacer_jitter_hist_32us 11211
+	...
+	interrupts_T3RUPT 1200
+	...
+	cdu_fifo_depth_x 0
+	...
+	client0_port 19697
+	client0_transport socket
+	client0_packets_in 14
+	...
+
+  Histogram lines are given only for the buckets that aren't empty, and
+  client lines only for clients that are connected or have been.  The
+  rates (_per_s, and agc_speed) are over the last interval, and so are
+  left out of the final file written on exit; the averages over the whole
+  run follow from the counts and uptime_s.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "yaAGC.h"
+#include "agc_engine.h"
+#include "agc_stats.h"
+
+static const char *InterruptNames[1 + NUM_INTERRUPT_TYPES] = {
+  "", "T6RUPT", "T5RUPT", "T3RUPT", "T4RUPT", "KEYRUPT1", "KEYRUPT2",
+  "UPRUPT", "DOWNRUPT", "RADARUPT", "HANDRUPT"
+};
+
+// There's one statistics file per process, whatever the number of CPUs
+// (the writer can report on all of them), so this is all process-wide.
+// StatsMutex keeps StatsStart and StatsStop, which may be called from
+// different threads (yaAGS calls StatsStop at exit), from overlapping.
+static pthread_mutex_t StatsMutex = PTHREAD_MUTEX_INITIALIZER;
+static char *StatsFilename = NULL, *StatsTemporary = NULL;
+static uint64_t StatsInterval, StatsStarted, StatsLast;
+static StatsWriter_t *StatsWriter;
+static void *StatsData;
+static pthread_t StatsThread;
+static volatile int StatsStopping = 0;
+
+// Rewrites the file.  The Final write, made by StatsStop, may come only
+// moments after the one before, so the rates over that sliver of time would
+// be meaningless; the writer is given Seconds = 0 instead, which leaves them
+// out.
+static void
+StatsWrite (int Final)
+{
+  FILE *fp;
+  uint64_t Now = PacerNow ();
+  double Seconds = Final ? 0 : (Now - StatsLast) / 1e9;
+
+  StatsLast = Now;
+  fp = fopen (StatsTemporary, "w");
+  if (fp == NULL)
+    return;
+  fprintf (fp, "uptime_s %.3f\n", (Now - StatsStarted) / 1e9);
+  (*StatsWriter) (fp, Seconds, StatsData);
+  if (fclose (fp))
+    return;
+#ifdef WIN32
+  remove (StatsFilename);
+#endif
+  rename (StatsTemporary, StatsFilename);
+}
+
+static void *
+StatsLoop (void *Arg)
+{
+  Pacer_t Pacer;
+
+  PacerInit (&Pacer, StatsInterval);
+  while (!StatsStopping)
+    {
+      PacerWait (&Pacer);
+      if (!StatsStopping)
+	StatsWrite (0);
+    }
+  return (NULL);
+}
+
+// Starts rewriting Filename every Milliseconds (STATS_DEFAULT_INTERVAL if
+// 0), with Writer supplying the contents.  Only one statistics file can be
+// kept per process.  Returns 0 on success, or 1 if the file can't be
+// written or the thread can't be started.
+int
+StatsStart (const char *Filename, int Milliseconds, StatsWriter_t *Writer,
+	    void *Data)
+{
+  FILE *fp;
+
+  pthread_mutex_lock (&StatsMutex);
+  if (StatsFilename != NULL)
+    {
+      pthread_mutex_unlock (&StatsMutex);
+      return (1);
+    }
+  if (Milliseconds <= 0)
+    Milliseconds = STATS_DEFAULT_INTERVAL;
+  StatsFilename = strdup (Filename);
+  StatsTemporary = (char *) malloc (strlen (Filename) + 5);
+  if (StatsFilename == NULL || StatsTemporary == NULL)
+    goto Fail;
+  sprintf (StatsTemporary, "%s.tmp", Filename);
+  fp = fopen (StatsTemporary, "w");
+  if (fp == NULL)
+    goto Fail;
+  fclose (fp);
+  remove (StatsTemporary);
+  StatsInterval = Milliseconds * (uint64_t) 1000000;
+  StatsWriter = Writer;
+  StatsData = Data;
+  StatsStarted = StatsLast = PacerNow ();
+  StatsStopping = 0;
+  if (pthread_create (&StatsThread, NULL, StatsLoop, NULL))
+    goto Fail;
+  pthread_mutex_unlock (&StatsMutex);
+  return (0);
+Fail:
+  free (StatsFilename);
+  free (StatsTemporary);
+  StatsFilename = StatsTemporary = NULL;
+  pthread_mutex_unlock (&StatsMutex);
+  return (1);
+}
+
+// Stops the thread, and writes the file one last time.
+void
+StatsStop (void)
+{
+  pthread_mutex_lock (&StatsMutex);
+  if (StatsFilename == NULL)
+    {
+      pthread_mutex_unlock (&StatsMutex);
+      return;
+    }
+  StatsStopping = 1;
+  pthread_join (StatsThread, NULL);
+  StatsWrite (1);
+  free (StatsFilename);
+  free (StatsTemporary);
+  StatsFilename = StatsTemporary = NULL;
+  pthread_mutex_unlock (&StatsMutex);
+}
+
+//---------------------------------------------------------------------------
+// Pieces of the file, for the writers.
+
+// Writes a count, and its rate per second since the last time (for which
+// the count is kept in *Previous), unless Seconds is 0.
+void
+StatsRate (FILE *fp, const char *Name, uint64_t Count, uint64_t *Previous,
+	   double Seconds)
+{
+  fprintf (fp, "%s " FORMAT_64U "\n", Name, Count);
+  if (Seconds > 0)
+    fprintf (fp, "%s_per_s %.1f\n", Name, (Count - *Previous) / Seconds);
+  *Previous = Count;
+}
+
+static void
+StatsHistogram (FILE *fp, const char *Name, const unsigned *Histogram)
+{
+  int i;
+  for (i = 0; i < PACER_BUCKETS; i++)
+    if (Histogram[i])
+      fprintf (fp, "%s_hist_%luus %u\n", Name,
+	       (i == 0) ? 0UL : 1UL << (i - 1), Histogram[i]);
+}
+
+// The pacing:  how late the wakeups are, and how far the CPU falls behind.
+void
+StatsPacer (FILE *fp, const Pacer_t *Pacer)
+{
+  fprintf (fp, "pacer_quantum_us %lu\n",
+	   (unsigned long) (Pacer->Quantum / 1000));
+  fprintf (fp, "pacer_wakeups " FORMAT_64U "\n", Pacer->Wakeups);
+  fprintf (fp, "pacer_jitter_us %lu\n",
+	   (unsigned long) (Pacer->LastJitter / 1000));
+  fprintf (fp, "pacer_jitter_us_max %lu\n",
+	   (unsigned long) (Pacer->MaxJitter / 1000));
+  fprintf (fp, "pacer_backlog_cycles " FORMAT_64U "\n", Pacer->Backlog);
+  fprintf (fp, "pacer_backlog_cycles_max " FORMAT_64U "\n",
+	   Pacer->MaxBacklog);
+  StatsHistogram (fp, "pacer_jitter", Pacer->Jitter);
+  StatsHistogram (fp, "pacer_lag", Pacer->Lag);
+}
+
+// The AGC's interrupts, its queued counter increments, and its trace.
+void
+StatsAgc (FILE *fp, const agc_t *State)
+{
+  int i;
+  for (i = 1; i <= NUM_INTERRUPT_TYPES; i++)
+    fprintf (fp, "interrupts_%s " FORMAT_64U "\n", InterruptNames[i],
+	     State->InterruptCounts[i]);
+  for (i = 0; i < NUM_CDU_FIFOS; i++)
+    fprintf (fp, "cdu_fifo_depth_%c %d\n", "xyz"[i],
+	     State->CduFifos[i].Size);
+  fprintf (fp, "bulk_queue_depth %d\n", State->BulkSize);
+  if (State->Trace != NULL)
+    {
+      fprintf (fp, "trace_records " FORMAT_64U "\n", State->Trace->Records);
+      fprintf (fp, "trace_stalls " FORMAT_64U "\n", State->Trace->Stalls);
+    }
+  if (State->RuptTiming == NULL)
+    return;
+  for (i = 1; i <= NUM_INTERRUPT_TYPES; i++)
+    if (State->RuptTiming->Taken[i])
+      fprintf (fp, "interrupt_latency_cycles_max_%s " FORMAT_64U "\n",
+	       InterruptNames[i], State->RuptTiming->MaxLatency[i]);
+  fprintf (fp, "interrupts_inhibited_cycles " FORMAT_64U "\n",
+	   State->RuptTiming->InhibitedCycles);
+}
+
+// The traffic with each peripheral.  Port is that of Clients[0].
+void
+StatsClients (FILE *fp, const Client_t *Clients, int NumClients, int Port)
+{
+  const Client_t *Client;
+  int i;
+
+  if (Clients == NULL)
+    return;
+  for (i = 0, Client = Clients; i < NumClients; i++, Client++)
+    {
+      if (Client->Socket == -1 && Client->PacketsIn == 0
+	  && Client->PacketsOut == 0)
+	continue;
+      fprintf (fp, "client%d_port %d\n", i, Port + i);
+      fprintf (fp, "client%d_transport %s\n", i,
+	       (Client->Socket == -1) ? "none" :
+	       (Client->Socket == SHM_SOCKET) ? "shm" : "socket");
+      fprintf (fp, "client%d_packets_in " FORMAT_64U "\n", i,
+	       Client->PacketsIn);
+      fprintf (fp, "client%d_bytes_in " FORMAT_64U "\n", i, Client->BytesIn);
+      fprintf (fp, "client%d_packets_out " FORMAT_64U "\n", i,
+	       Client->PacketsOut);
+      fprintf (fp, "client%d_bytes_out " FORMAT_64U "\n", i,
+	       Client->BytesOut);
+      fprintf (fp, "client%d_bad_packets " FORMAT_64U "\n", i,
+	       Client->BadPackets);
+      fprintf (fp, "client%d_dropped_packets " FORMAT_64U "\n", i,
+	       Client->DroppedPackets);
+    }
+}
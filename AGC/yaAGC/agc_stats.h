@@ -0,0 +1,63 @@
+/*
+  Copyright 2026 Ronald S. Burkey <info@sandroid.org>
+
+  This file is part of yaAGC.
+
+  yaAGC is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  yaAGC is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with yaAGC; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+  Filename:	agc_stats.h
+  Purpose:	Header for agc_stats.c, the live runtime statistics
+  		(--stats) of yaAGC and yaAGS.
+  Compiler:	GNU gcc.
+  Contact:	Ron Burkey <info@sandroid.org>
+  Reference:	http://www.ibiblio.org/apollo/index.html
+  Mods:		2026-10-17	Began.
+		2026-10-17	Seconds is 0 for the final write.
+*/
+
+#ifndef AGC_STATS_H
+#define AGC_STATS_H
+
+#include <stdio.h>
+#include "agc_engine.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define STATS_DEFAULT_INTERVAL 1000	// ms.
+
+// Writes the program's own lines into the statistics file.  Seconds is the
+// real time since the previous call, or 0 for the final write (by
+// StatsStop), which should leave out any rates.
+typedef void StatsWriter_t (FILE *fp, double Seconds, void *Data);
+
+int StatsStart (const char *Filename, int Milliseconds,
+		StatsWriter_t *Writer, void *Data);
+void StatsStop (void);
+
+// For the writers.
+void StatsRate (FILE *fp, const char *Name, uint64_t Count,
+		uint64_t *Previous, double Seconds);
+void StatsPacer (FILE *fp, const Pacer_t *Pacer);
+void StatsAgc (FILE *fp, const agc_t *State);
+void StatsClients (FILE *fp, const Client_t *Clients, int NumClients,
+		   int Port);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // AGC_STATS_H
@@ -66,6 +66,20 @@
 				Virtual AGC binaries to PowerPC vs.
 				Intel CPUs.
 		08/01/09 RSB	Adjusted to use NormalizeSourceName().
+		2026-10-17	ResolveLastLabel finds a label on the line
+				itself, too.  Added ResolveErasableAGC.
+		2026-10-17	Added ErasableAddressAGC.
+		2026-10-17	Reads version 2 of the symbol table file,
+				mapping it into memory, and looks symbols
+				and lines up through its name hash and
+				line index.  Indexes the original version
+				the same way once it's read, and reads
+				it without a malloc per record.
+		2026-10-17	ResolveLastLabel searches a sorted index
+				of the labels.
+		2026-10-17	Rejects a version 2 file with a name that
+				isn't terminated, and unmaps the file
+				rather than freeing it.
 */
 
 #include <stdio.h>
@@ -75,6 +89,9 @@
 #include <sys/types.h>
 //#include <sys/uio.h>
 #include <unistd.h>
+#ifndef WIN32
+#include <sys/mman.h>
+#endif
 
 #include "agc_engine.h"
 #include "agc_symtab.h"
@@ -121,6 +138,24 @@ int SymbolTableSize = 0;
 SymbolLine_t *LineTable = NULL;
 int LineTableSize = 0;
 
+// The hash of the symbol names, and the index of the lines by address, as
+// described for SymbolFile2_t.  If NULL, the tables are searched instead.
+static int *SymbolHash = NULL;
+static int SymbolHashSize = 0;
+static int *LineIndex = NULL;
+
+// The indexes of the labels in SymbolTable, sorted by file, line number,
+// and index, for ResolveLastLabel.  It's built the first time it's needed.
+static int *LabelIndex = NULL;
+static int LabelIndexSize = 0;
+
+// A version 2 symbol table file is used in place: SymbolTable, LineTable,
+// SymbolHash, and LineIndex all point into SymbolFileData, which is the
+// file mapped into memory, or read into memory if it can't be mapped.
+static char *SymbolFileData = NULL;
+static size_t SymbolFileSize = 0;
+static int SymbolFileMapped = 0;
+
 // JMS: 07.28
 // The currently opened source file name and current line number and its
 // file pointer. This is used to maintain the state for the "list" debug
@@ -226,15 +261,35 @@ ResetSymbolTable (void)
 {
   int i;
 
-  // Clear the symbol table
-  if (SymbolTable)
-    free (SymbolTable);
+  // Clear the symbol table, the line table, and their indexes
+  if (SymbolFileData)
+    {
+#ifndef WIN32
+      if (SymbolFileMapped)
+	munmap (SymbolFileData, SymbolFileSize);
+      else
+#endif
+	free (SymbolFileData);
+      SymbolFileData = NULL;
+      SymbolFileMapped = 0;
+    }
+  else
+    {
+      free (SymbolTable);
+      free (LineTable);
+      free (SymbolHash);
+      free (LineIndex);
+    }
+  SymbolTable = NULL;
   SymbolTableSize = 0;
-
-  // Clear the line table
-  if (LineTable)
-    free (LineTable);
+  LineTable = NULL;
   LineTableSize = 0;
+  SymbolHash = NULL;
+  SymbolHashSize = 0;
+  LineIndex = NULL;
+  free (LabelIndex);
+  LabelIndex = NULL;
+  LabelIndexSize = 0;
 
   // Clear the list of source files
   for (i = 0; i < MAX_NUM_FILES; i++)
@@ -323,113 +378,321 @@ LittleEndian32 (void *Value)
 
 #endif
 
+// A version 2 symbol table file can be mapped into memory and used as-is
+// only where mmap is available and the integers in it needn't be swapped.
+#if !defined (WIN32) && BYTE_ORDER == 1234
+#define SYMBOL_FILE_MMAP
+#endif
+
 //-------------------------------------------------------------------------
-// Reads in the symbol table. The .symtab file is given as an argument. This
-// routine updates the global variables storing the symbol table. Returns
-// 0 upon success, 1 upon failure
-int
-ReadSymbolTable (char *fname)
+// The hash of a symbol name used for the name hash in version 2 of the
+// symbol table file.  It's FNV-1a, and must be the same as yaYUL's.
+unsigned
+SymbolNameHash (const char *Name)
 {
-  extern FILE *rfopen (const char *Filename, const char *mode);
-  FILE *fp;
-  int i, fd;
-  Symbol_t *symbol;
-  SymbolLine_t *Line;
-  SymbolFile_t symfile;
-  // char *ss;
+  unsigned Hash = 2166136261u;
 
-  // Open the symbol table file. If it does not exist, that is ok.
-  if (NULL == (fp = rfopen (fname, "rb")))
+  while (*Name)
+    Hash = (Hash ^ (unsigned char) *Name++) * 16777619u;
+  return (Hash);
+}
+
+//-------------------------------------------------------------------------
+// Returns where a line's address goes in the line index, or -1 if it isn't
+// in fixed memory.  The banks are numbered as in LineCompareAGC, and the
+// same way as by yaYUL when it writes the index.
+static int
+LineIndexAGC (Address_t *Address)
+{
+  int Bank;
+
+  if (!Address->Fixed)
+    return (-1);
+  if (Address->Banked && Address->FB >= 020 && Address->Super)
+    Bank = Address->FB + 010;
+  else if (Address->Banked)
+    Bank = Address->FB;
+  else
+    Bank = Address->SReg / 02000;
+  if (Bank >= SYMBOL_LINE_BANKS)
+    return (-1);
+  return (Bank * 02000 + (Address->SReg & 01777));
+}
+
+//-------------------------------------------------------------------------
+// Converts the integers in the records of the symbol and line tables, as
+// read from a file, to the CPU's representation.
+static void
+LittleEndianTables (void)
+{
+  int i;
+
+  for (i = 0; i < SymbolTableSize; i++)
     {
-      printf ("Cannot open symbol table file: %s\n", fname);
-      return 1;
+      LittleEndian32 (&SymbolTable[i]);
+      LittleEndian32 (&SymbolTable[i].Value.Value);
+      LittleEndian32 (&SymbolTable[i].Type);
+      LittleEndian32 (&SymbolTable[i].LineNumber);
     }
-  fd = fileno (fp);
+  for (i = 0; i < LineTableSize; i++)
+    {
+      LittleEndian32 (&LineTable[i]);
+      LittleEndian32 (&LineTable[i].CodeAddress.Value);
+      LittleEndian32 (&LineTable[i].LineNumber);
+    }
+}
+
+//-------------------------------------------------------------------------
+// Builds the name hash and the line index for a symbol table file of the
+// original version, which doesn't contain them.  If there's no memory for
+// them, lookups just fall back to searching the tables.
+static void
+CreateIndexes (void)
+{
+  int i, j;
+
+  for (SymbolHashSize = 16; SymbolHashSize < 2 * SymbolTableSize;
+       SymbolHashSize *= 2);
+  SymbolHash = (int *) calloc (SymbolHashSize, sizeof (int));
+  if (SymbolHash != NULL)
+    for (i = 0; i < SymbolTableSize; i++)
+      {
+	j = SymbolNameHash (SymbolTable[i].Name) & (SymbolHashSize - 1);
+	while (SymbolHash[j])
+	  j = (j + 1) & (SymbolHashSize - 1);
+	SymbolHash[j] = i + 1;
+      }
+
+  // The lines are sorted, so keep the first of any at the same address.
+  LineIndex = (int *) calloc (SYMBOL_LINE_INDEX_SIZE, sizeof (int));
+  if (LineIndex != NULL)
+    for (i = 0; i < LineTableSize; i++)
+      {
+	j = LineIndexAGC (&LineTable[i].CodeAddress);
+	if (j >= 0 && !LineIndex[j])
+	  LineIndex[j] = i + 1;
+      }
+}
+
+//-------------------------------------------------------------------------
+// Reads a symbol table file of the original version, whose SymbolFile_t
+// header fp is positioned at.  Returns 0 upon success, 1 upon failure.
+static int
+ReadSymbolTable1 (FILE *fp)
+{
+  SymbolFile_t symfile;
 
   // Read in the SymbolFile_t structure as the header
-  //printf ("__BYTE_ORDER=%0x04X\n", BYTE_ORDER);
-  read (fd, &symfile, sizeof(SymbolFile_t));
-  //printf ("NumberSymbols=0x%08X\n", symfile.NumberSymbols);
-  //printf ("NumberLines=0x%08X\n", symfile.NumberLines);
+  if (1 != fread (&symfile, sizeof (SymbolFile_t), 1, fp))
+    {
+      printf ("Symbol table file is truncated\n");
+      return 1;
+    }
   LittleEndian32 (&symfile.NumberSymbols);
   LittleEndian32 (&symfile.NumberLines);
-  //printf ("NumberSymbols=0x%08X\n", symfile.NumberSymbols);
-  //printf ("NumberLines=0x%08X\n", symfile.NumberLines);
 
   /* Set the source path if it is not overridden by command-line option */
   if (SourcePathName == (char*)0) SourcePathName = strdup (symfile.SourcePath);
 
-  // Allocate the symbol table
+  // Read the symbol table and the line table, each in one piece.
   SymbolTableSize = symfile.NumberSymbols;
-  SymbolTable = (Symbol_t *) calloc (SymbolTableSize, sizeof (Symbol_t));
+  LineTableSize = symfile.NumberLines;
+  SymbolTable = (Symbol_t *) calloc (SymbolTableSize + 1, sizeof (Symbol_t));
+  LineTable = (SymbolLine_t *) calloc (LineTableSize + 1, sizeof (SymbolLine_t));
+  if (SymbolTable == NULL || LineTable == NULL)
+    {
+      printf ("Out of memory in symbol table\n");
+      return 1;
+    }
+  if ((size_t) SymbolTableSize != fread (SymbolTable, sizeof (Symbol_t),
+					 SymbolTableSize, fp)
+      || (size_t) LineTableSize != fread (LineTable, sizeof (SymbolLine_t),
+					  LineTableSize, fp))
+    {
+      printf ("Symbol table file is truncated\n");
+      return 1;
+    }
+  LittleEndianTables ();
 
-  // Loop through the number of symbols and read them each in. Since it is
-  // a file, we kind of assume the read will succeed.
-  for (i = 0; i < SymbolTableSize; i++)
+  CreateIndexes ();
+  CreateFileList ();
+  return 0;
+}
+
+//-------------------------------------------------------------------------
+// Uses a version 2 symbol table file, mapping it into memory if possible
+// and otherwise reading it in whole.  Returns 0 upon success, 1 upon
+// failure.
+static int
+ReadSymbolTable2 (FILE *fp)
+{
+  SymbolFile2_t *Header;
+  char *Name;
+  long Size;
+  int i;
+
+  if (fseek (fp, 0, SEEK_END) || (Size = ftell (fp)) < (long) sizeof (SymbolFile2_t))
     {
-      // Allocate a new symbol
-      if ((symbol = (Symbol_t *) malloc (sizeof(Symbol_t))) == NULL)
+      printf ("Symbol table file is truncated\n");
+      return 1;
+    }
+  SymbolFileSize = Size;
+#ifdef SYMBOL_FILE_MMAP
+  SymbolFileData = mmap (NULL, SymbolFileSize, PROT_READ | PROT_WRITE,
+			 MAP_PRIVATE, fileno (fp), 0);
+  if (SymbolFileData == MAP_FAILED)
+    SymbolFileData = NULL;
+  else
+    SymbolFileMapped = 1;
+#endif
+  if (SymbolFileData == NULL)
+    {
+      SymbolFileData = (char *) malloc (SymbolFileSize);
+      if (SymbolFileData == NULL)
 	{
 	  printf ("Out of memory in symbol table\n");
-	  fclose (fp);
 	  return 1;
 	}
+      rewind (fp);
+      if (1 != fread (SymbolFileData, SymbolFileSize, 1, fp))
+	{
+	  printf ("Symbol table file is truncated\n");
+	  return 1;
+	}
+    }
 
-      // Read it in from the symbol table file
-      read (fd, symbol, sizeof(Symbol_t));
-      LittleEndian32 (symbol);
-      LittleEndian32 (&symbol->Value.Value);
-      LittleEndian32 (&symbol->Type);
-      LittleEndian32 (&symbol->LineNumber);
-      SymbolTable[i] = *symbol;
+  // Check that all of the sections are where they're supposed to be.
+  Header = (SymbolFile2_t *) SymbolFileData;
+  if (!SymbolFileMapped)
+    {
+      LittleEndian32 (&Header->Version);
+      LittleEndian32 (&Header->NumberSymbols);
+      LittleEndian32 (&Header->NumberLines);
+      LittleEndian32 (&Header->HashSize);
+      LittleEndian32 (&Header->NumberFiles);
+      LittleEndian32 (&Header->FilesSize);
+      LittleEndian32 (&Header->SymbolsOffset);
+      LittleEndian32 (&Header->LinesOffset);
+      LittleEndian32 (&Header->HashOffset);
+      LittleEndian32 (&Header->LineIndexOffset);
+      LittleEndian32 (&Header->FilesOffset);
+    }
+  if (Header->Version != SYMBOL_FILE_VERSION)
+    {
+      printf ("Symbol table file is version %d, not %d\n", Header->Version,
+	      SYMBOL_FILE_VERSION);
+      return 1;
+    }
+#define SYMBOL_SECTION_OK(Offset, Count, Size) \
+  ((Offset) >= (int) sizeof (SymbolFile2_t) && (Offset) % 4 == 0 \
+   && (size_t) (Offset) <= SymbolFileSize && (Count) >= 0 \
+   && (size_t) (Count) <= (SymbolFileSize - (Offset)) / (Size))
+  if (!SYMBOL_SECTION_OK (Header->SymbolsOffset, Header->NumberSymbols,
+			  sizeof (Symbol_t))
+      || !SYMBOL_SECTION_OK (Header->LinesOffset, Header->NumberLines,
+			     sizeof (SymbolLine_t))
+      || !SYMBOL_SECTION_OK (Header->HashOffset, Header->HashSize,
+			     sizeof (int))
+      || !SYMBOL_SECTION_OK (Header->LineIndexOffset, SYMBOL_LINE_INDEX_SIZE,
+			     sizeof (int))
+      || !SYMBOL_SECTION_OK (Header->FilesOffset, Header->FilesSize, 1)
+      || Header->HashSize < 1 || (Header->HashSize & (Header->HashSize - 1)))
+    {
+      printf ("Symbol table file is corrupt\n");
+      return 1;
     }
+#undef SYMBOL_SECTION_OK
 
-  // Allocate the line table
-  LineTableSize = symfile.NumberLines;
-  LineTable = (SymbolLine_t *) calloc (LineTableSize, sizeof (SymbolLine_t));
+  /* Set the source path if it is not overridden by command-line option */
+  Header->SourcePath[MAX_PATH_LENGTH - 1] = 0;
+  if (SourcePathName == (char*)0) SourcePathName = strdup (Header->SourcePath);
+
+  SymbolTable = (Symbol_t *) (SymbolFileData + Header->SymbolsOffset);
+  SymbolTableSize = Header->NumberSymbols;
+  LineTable = (SymbolLine_t *) (SymbolFileData + Header->LinesOffset);
+  LineTableSize = Header->NumberLines;
+  SymbolHash = (int *) (SymbolFileData + Header->HashOffset);
+  SymbolHashSize = Header->HashSize;
+  LineIndex = (int *) (SymbolFileData + Header->LineIndexOffset);
+  if (!SymbolFileMapped)
+    {
+      LittleEndianTables ();
+      for (i = 0; i < SymbolHashSize; i++)
+	LittleEndian32 (&SymbolHash[i]);
+      for (i = 0; i < SYMBOL_LINE_INDEX_SIZE; i++)
+	LittleEndian32 (&LineIndex[i]);
+    }
 
-  // Loop through the number of symbols and read them each in. Since it is
-  // a file, we kind of assume the read will succeed.
+  // The names are used in place, so each must end within its field.
+  for (i = 0; i < SymbolTableSize; i++)
+    if (memchr (SymbolTable[i].Name, 0, sizeof (SymbolTable[i].Name)) == NULL
+	|| memchr (SymbolTable[i].FileName, 0,
+		   sizeof (SymbolTable[i].FileName)) == NULL)
+      {
+	printf ("Symbol table file is corrupt (symbol %d)\n", i);
+	return 1;
+      }
   for (i = 0; i < LineTableSize; i++)
+    if (memchr (LineTable[i].FileName, 0, sizeof (LineTable[i].FileName))
+	== NULL)
+      {
+	printf ("Symbol table file is corrupt (line %d)\n", i);
+	return 1;
+      }
+
+  // The list of source files is already made, and sorted.
+  Name = SymbolFileData + Header->FilesOffset;
+  for (i = 0; i < Header->NumberFiles && Name[0] != 0; i++)
     {
-      // Allocate a new symbol
-      if ((Line = (SymbolLine_t *) malloc (sizeof(SymbolLine_t))) == NULL)
+      if (NumberFiles >= MAX_NUM_FILES)
 	{
-	  printf ("Out of memory in line table\n");
-	  fclose (fp);
-	  return 1;
+	  printf ("Out of memory in source file list\n");
+	  break;
 	}
-
-      // Read it in from the symbol table file
-      read (fd, Line, sizeof(SymbolLine_t));
-      LittleEndian32 (Line);
-      LittleEndian32 (&Line->CodeAddress.Value);
-      LittleEndian32 (&Line->LineNumber);
-      LineTable[i] = *Line;
+      if (memchr (Name, 0, SymbolFileData + Header->FilesOffset
+		  + Header->FilesSize - Name) == NULL)
+	break;
+      strncpy (SourceFiles[NumberFiles], Name, MAX_FILE_LENGTH - 1);
+      nbadd_source_file (SourceFiles[NumberFiles]);
+      NumberFiles++;
+      Name += strlen (Name) + 1;
     }
+  return 0;
+}
 
-  // Create the list of files from the LineTable
-  CreateFileList ();
+//-------------------------------------------------------------------------
+// Reads in the symbol table. The .symtab file is given as an argument. This
+// routine updates the global variables storing the symbol table. Returns
+// 0 upon success, 1 upon failure
+int
+ReadSymbolTable (char *fname)
+{
+  extern FILE *rfopen (const char *Filename, const char *mode);
+  FILE *fp;
+  char Magic[sizeof (SYMBOL_FILE_MAGIC)];
+  int Result;
 
-#if 0
-  // Print out
-  {
-    FILE *tmp;
-    int i;
-    char AddressStr[64];
-
-    tmp = fopen("linetest.out", "w");
-    for (i = 0; i < LineTableSize; i++) {
-      AddressPrintAGS(&LineTable[i].CodeAddress, AddressStr);
-      fprintf(tmp, "%s\t%s\t%d\n", AddressStr, LineTable[i].FileName,
-	      LineTable[i].LineNumber);
+  // Open the symbol table file. If it does not exist, that is ok.
+  if (NULL == (fp = rfopen (fname, "rb")))
+    {
+      printf ("Cannot open symbol table file: %s\n", fname);
+      return 1;
     }
-    fclose(tmp);
-  }
-#endif
 
+  // The original version of the file has no magic number, but begins
+  // with a path instead, so can't be mistaken for version 2.
+  if (1 == fread (Magic, sizeof (Magic), 1, fp)
+      && !memcmp (Magic, SYMBOL_FILE_MAGIC, sizeof (Magic)))
+    Result = ReadSymbolTable2 (fp);
+  else
+    {
+      rewind (fp);
+      Result = ReadSymbolTable1 (fp);
+    }
   fclose (fp);
-  return 0;
+  if (Result)
+    ResetSymbolTable ();
+  return Result;
 }
 
 //-------------------------------------------------------------------------
@@ -514,15 +777,42 @@ int CompareSymbolName (const void *Raw1, const void *Raw2)
 //-------------------------------------------------------------------------
 // Resolves the symbol given its desired type mask.  Returns the Symbol_t
 // entry if found or NULL if not found.
-Symbol_t *
-ResolveSymbol (char *Name, int TypeMask)
+static Symbol_t *
+FindSymbol (const char *Name)
 {
-  Symbol_t Symbol, *Found = NULL;
+  Symbol_t Symbol;
+  int i, j, n;
+
+  // Look the symbol up in the hash, if there is one.
+  if (SymbolHash != NULL)
+    {
+      // The entries come straight from the file, so check them as
+      // for LineIndex.
+      i = SymbolNameHash (Name) & (SymbolHashSize - 1);
+      for (n = 0; n < SymbolHashSize && (j = SymbolHash[i]) != 0; n++)
+	{
+	  if (j > 0 && j <= SymbolTableSize
+	      && !strcmp (SymbolTable[j - 1].Name, Name))
+	    return (&SymbolTable[j - 1]);
+	  i = (i + 1) & (SymbolHashSize - 1);
+	}
+      return (NULL);
+    }
 
   // Search for the symbol in the table
+  if (strlen (Name) > MAX_LABEL_LENGTH)
+    return (NULL);
   strcpy (Symbol.Name, Name);
-  Found = (Symbol_t *) bsearch (&Symbol, SymbolTable, SymbolTableSize,
-                                sizeof (Symbol_t), CompareSymbolName);
+  return ((Symbol_t *) bsearch (&Symbol, SymbolTable, SymbolTableSize,
+				sizeof (Symbol_t), CompareSymbolName));
+}
+
+Symbol_t *
+ResolveSymbol (char *Name, int TypeMask)
+{
+  Symbol_t *Found;
+
+  Found = FindSymbol (Name);
 
   // If we found a symbol, then make sure it is the desired type.
   if (Found && (Found->Type & TypeMask))
@@ -550,20 +840,77 @@ Symbol_t* ResolveSymbolAGC(int Address12, int FB, int SBB)
 	return (Symbol);
 }
 
+// Orders the label index by file, line number, and symbol index.
+static int
+LabelCompare (const void *Raw1, const void *Raw2)
+{
+  const Symbol_t *Symbol1 = &SymbolTable[*(const int *) Raw1];
+  const Symbol_t *Symbol2 = &SymbolTable[*(const int *) Raw2];
+  int i;
+
+  i = strcmp (Symbol1->FileName, Symbol2->FileName);
+  if (i)
+    return (i);
+  if (Symbol1->LineNumber != Symbol2->LineNumber)
+    return (Symbol1->LineNumber < Symbol2->LineNumber) ? -1 : 1;
+  return (*(const int *) Raw1 - *(const int *) Raw2);
+}
+
+// Finds the nearest label at or above a source line, in the same file.  Of
+// labels on the same line, the first in the symbol table is chosen.
 Symbol_t* ResolveLastLabel(SymbolLine_t *Line)
 {
-	int i;
+	int i, Low, High, Middle;
 	int found = -1;
 	int dist = 100000;
 	Symbol_t* Symbol = NULL;
 
-//LineNumber
+	if (LabelIndex == NULL && SymbolTableSize > 0)
+	{
+		LabelIndex = (int *) malloc (SymbolTableSize * sizeof (int));
+		if (LabelIndex != NULL)
+		{
+			for (i = 0; i < SymbolTableSize; i++)
+				if (SymbolTable[i].Type == SYMBOL_LABEL)
+					LabelIndex[LabelIndexSize++] = i;
+			qsort (LabelIndex, LabelIndexSize, sizeof (int), LabelCompare);
+		}
+	}
+
+	if (LabelIndex != NULL)
+	{
+		// Find the first label past the line, and back up from it.
+		Low = 0;
+		High = LabelIndexSize;
+		while (Low < High)
+		{
+			Middle = (Low + High) / 2;
+			Symbol = &SymbolTable[LabelIndex[Middle]];
+			i = strcmp (Symbol->FileName, Line->FileName);
+			if (i < 0 || (i == 0 && Symbol->LineNumber <= Line->LineNumber))
+				Low = Middle + 1;
+			else
+				High = Middle;
+		}
+		if (Low == 0)
+			return (NULL);
+		Symbol = &SymbolTable[LabelIndex[--Low]];
+		if (strcmp (Symbol->FileName, Line->FileName) ||
+		    (Line->LineNumber - Symbol->LineNumber) >= dist)
+			return (NULL);
+		while (Low > 0 &&
+		       SymbolTable[LabelIndex[Low - 1]].LineNumber == Symbol->LineNumber &&
+		       !strcmp (SymbolTable[LabelIndex[Low - 1]].FileName, Line->FileName))
+			Low--;
+		return (&SymbolTable[LabelIndex[Low]]);
+	}
 
+	// Out of memory for the index, so search the whole table.
 	for (i=0;i<SymbolTableSize;i++)
 	{
 		Symbol = &SymbolTable[i];
 		if (Symbol->Type == SYMBOL_LABEL &&
-		    Symbol->LineNumber < Line->LineNumber &&
+		    Symbol->LineNumber <= Line->LineNumber &&
 		    (strcmp(Line->FileName,Symbol->FileName) == 0) &&
 		    ((Line->LineNumber - Symbol->LineNumber) < dist))
 		{
@@ -577,13 +924,48 @@ Symbol_t* ResolveLastLabel(SymbolLine_t *Line)
 
 	return (Symbol);
 }
+//-------------------------------------------------------------------------
+// Returns the erasable-memory word an address refers to, as bank * 0400 
+// plus the offset within the bank, or -1 if it isn't in erasable memory.
+int
+ErasableAddressAGC (Address_t *Address)
+{
+  if (!Address->Erasable)
+    return (-1);
+  if (Address->Banked && Address->SReg >= 01400)
+    return (Address->EB * 0400 + (Address->SReg & 0377));
+  if (Address->SReg < 01400)
+    return (Address->SReg);
+  return (-1);
+}
+
+//-------------------------------------------------------------------------
+// Resolves a word of erasable memory, given as its bank and its offset 
+// within the bank, into the variable or register there.  Returns NULL if 
+// there isn't one.
+Symbol_t *
+ResolveErasableAGC (int Bank, int Offset)
+{
+  Symbol_t *Symbol;
+  int i;
+
+  for (i = 0; i < SymbolTableSize; i++)
+    {
+      Symbol = &SymbolTable[i];
+      if ((Symbol->Type & (SYMBOL_VARIABLE | SYMBOL_REGISTER))
+	  && ErasableAddressAGC (&Symbol->Value) == Bank * 0400 + Offset)
+	return (Symbol);
+    }
+  return (NULL);
+}
+
 //-------------------------------------------------------------------------
 // Returns information about a given symbol if found
 void
 WhatIsSymbol (char *SymbolName, int Arch)
 {
   char AddressStr[64];
-  Symbol_t Symbol, *Found = NULL;
+  Symbol_t *Found = NULL;
   int (*AddressPrint)(Address_t *, char *);
 
   // Check to make sure the architecture flag passed in is valid
@@ -597,11 +979,7 @@ WhatIsSymbol (char *SymbolName, int Arch)
       return;
     }
 
-  // Search for the symbol in the table
-  strcpy (Symbol.Name, SymbolName);
-  Found = (Symbol_t *) bsearch (&Symbol, SymbolTable, SymbolTableSize,
-                                sizeof (Symbol_t), CompareSymbolName);
-
+  Found = FindSymbol (SymbolName);
   if (Found)
     {
       AddressPrint(&Found->Value, AddressStr);
@@ -692,6 +1070,7 @@ SymbolLine_t *
 ResolveLineAGC (int Address12, int FB, int SBB)
 {
   SymbolLine_t Line;
+  int i;
 
   // Convert the <Address12, FB, SBB> into an Address_t structure. We only
   // want to find fixed memory addresses. We can get instances where the
@@ -712,6 +1091,15 @@ ResolveLineAGC (int Address12, int FB, int SBB)
   Line.CodeAddress.FB = FB;
   Line.CodeAddress.Super = SBB;
 
+  // Look the line up in the index, if there is one.
+  if (LineIndex != NULL)
+    {
+      i = LineIndexAGC (&Line.CodeAddress);
+      if (i < 0 || LineIndex[i] <= 0 || LineIndex[i] > LineTableSize)
+	return NULL;
+      return &LineTable[LineIndex[i] - 1];
+    }
+
   // Search for the line in the table
   return (SymbolLine_t *) bsearch (&Line, LineTable, LineTableSize,
 				   sizeof (SymbolLine_t), LineCompareAGC);
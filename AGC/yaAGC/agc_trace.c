@@ -0,0 +1,442 @@
+/*
+  Copyright 2026 Ronald S. Burkey <info@sandroid.org>
+
+  This file is part of yaAGC.
+
+  yaAGC is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  yaAGC is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with yaAGC; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+  Filename:	agc_trace.c
+  Purpose:	A binary trace of the instructions executed (--trace),
+  		and its decoder (--decode-trace).
+  Compiler:	GNU gcc.
+  Contact:	Ron Burkey <info@sandroid.org>
+  Reference:	http://www.ibiblio.org/apollo/index.html
+  Mods:		2026-10-17	Began.
+		2026-10-17	The file and writer thread are kept with each
+				agc_t's ring, so several CPUs can be traced.
+
+  While State->Trace is set, agc_engine.c puts a 24-byte TraceRecord_t
+  into a ring for each instruction executed (its machine cycle, Z, BB and
+  the superbank bit, the instruction as indexed, and A, L, and Q before
+  it), and another for each interrupt taken, naming it.  The thread
+  started by TraceStart takes them out of the ring a run at a time and
+  writes them to the file, so the CPU's thread only fills in the record.
+  Nothing is lost if the writer falls behind; the CPU waits for it
+  instead, which is counted in Trace->Stalls.  Unthrottled, a trace takes
+  the simulation from about 45 to 35 million machine cycles per second,
+  and about 0.9 MB per second of AGC time.  If the name of the file ends
+  in .gz, it's written through gzip -1, which is a sixth of the size but
+  slower:  about 7 million machine cycles per second, which is still well
+  ahead of real time.
+
+  To keep a trace short, it can be limited to the instructions in ranges
+  of addresses (TraceRange), started when an address is reached or at a
+  given machine cycle, and stopped after a number of records
+  (TraceTrigger).  An interrupt is recorded if the instruction it
+  displaces would have been.  Idle loops aren't skipped (--idle-skip)
+  while tracing.
+
+  TraceDecode prints a trace as text, disassembling the instructions with
+  agc_disassembler.c, and giving the label and source line of each from
+  the symbol table, if one has been read.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "yaAGC.h"
+#include "agc_engine.h"
+#include "agc_symtab.h"
+#include "agc_disassembler.h"
+#include "agc_trace.h"
+
+// How often the writer looks for records, when it's caught up.
+#define TRACE_POLL 1000000	// ns.
+
+// How many records the decoder reads at a time.
+#define TRACE_CHUNK 4096
+
+static const char *InterruptNames[1 + NUM_INTERRUPT_TYPES] = {
+  "", "T6RUPT", "T5RUPT", "T3RUPT", "T4RUPT", "KEYRUPT1", "KEYRUPT2",
+  "UPRUPT", "DOWNRUPT", "RADARUPT", "HANDRUPT"
+};
+
+// What TraceStart allocates for each agc_t traced:  the ring that the CPU
+// fills (State->Trace points to it), and the file and thread writing it out.
+typedef struct
+{
+  Trace_t Trace;
+  FILE *File;
+  int Piped, Error;
+  int Stopping;
+  pthread_t Thread;
+} TraceWriter_t;
+
+// Opens Filename for Mode ("r" or "w"), through gzip if it ends in .gz.
+static FILE *
+TraceOpen (const char *Filename, const char *Mode, int *Piped)
+{
+  char *Command;
+  FILE *fp;
+  size_t n = strlen (Filename);
+
+  *Piped = (n > 3 && !strcmp (&Filename[n - 3], ".gz"));
+  if (!*Piped)
+    return (fopen (Filename, (*Mode == 'r') ? "rb" : "wb"));
+  if (strchr (Filename, '\'') != NULL)
+    return (NULL);
+  Command = (char *) malloc (n + 32);
+  if (Command == NULL)
+    return (NULL);
+  if (*Mode == 'r')
+    sprintf (Command, "gzip -dc '%s'", Filename);
+  else
+#ifdef WIN32
+    sprintf (Command, "gzip -1 -c > '%s'", Filename);
+#else
+    // A ^C goes to gzip as well, but mustn't stop it before the last of the
+    // trace has been written.
+    sprintf (Command, "trap '' INT; exec gzip -1 -c > '%s'", Filename);
+#endif
+  fp = popen (Command, Mode);
+  free (Command);
+  return (fp);
+}
+
+// Returns 0 if the file is closed without any error.
+static int
+TraceClose (FILE *fp, int Piped)
+{
+  if (Piped)
+    return (pclose (fp) != 0);
+  return (fclose (fp) != 0);
+}
+
+// Converts the address of a symbol to a trace address (see agc_engine.h),
+// or returns -1 if it isn't the address of a word of memory.
+int
+TraceSymbolAddress (const Address_t *Value)
+{
+  int Bank;
+
+  if (Value->Erasable)
+    return (ErasableAddressAGC ((Address_t *) Value));
+  if (!Value->Fixed || Value->SReg < 02000)
+    return (-1);
+  if (Value->SReg >= 04000)
+    return (04000 + Value->SReg);
+  Bank = Value->FB;
+  if (Value->Super && Bank >= 030)
+    Bank += 010;
+  return (04000 + Bank * 02000 + (Value->SReg & 01777));
+}
+
+// Converts an address to a trace address, or returns -1.  It can be
+// E bank,offset or bank,offset in octal (superbanks being 040-047), an
+// unswitched octal address, or the name of a label or variable.
+int
+TraceAddress (const char *Spec)
+{
+  unsigned Bank, Offset;
+  char Extra;
+  Symbol_t *Symbol;
+
+  if (2 == sscanf (Spec, "E%o,%o%c", &Bank, &Offset, &Extra))
+    {
+      if (Bank < 8 && Offset >= 01400 && Offset < 02000)
+	return (Bank * 0400 + (Offset & 0377));
+      return (-1);
+    }
+  if (2 == sscanf (Spec, "%o,%o%c", &Bank, &Offset, &Extra))
+    {
+      if (Bank < NUM_FIXED_BANKS && Offset >= 02000 && Offset < 04000)
+	return (04000 + Bank * 02000 + (Offset & 01777));
+      return (-1);
+    }
+  if (*Spec && strspn (Spec, "01234567") == strlen (Spec))
+    {
+      Offset = strtoul (Spec, NULL, 8);
+      if (Offset < 01400)
+	return (Offset);
+      if (Offset >= 04000 && Offset < 010000)
+	return (04000 + Offset);
+      return (-1);
+    }
+  Symbol = ResolveSymbol ((char *) Spec, SYMBOL_LABEL | SYMBOL_VARIABLE);
+  if (Symbol == NULL)
+    return (-1);
+  return (TraceSymbolAddress (&Symbol->Value));
+}
+
+static void *
+TraceLoop (void *Arg)
+{
+  TraceWriter_t *Writer = (TraceWriter_t *) Arg;
+  Trace_t *Trace = &Writer->Trace;
+  Pacer_t Pacer;
+  uint64_t Head, Tail, Start, Count;
+  int Stopping;
+
+  PacerInit (&Pacer, TRACE_POLL);
+  for (;;)
+    {
+      // Once stopping, whatever is in the ring is the last of it.
+      Stopping = __atomic_load_n (&Writer->Stopping, __ATOMIC_ACQUIRE);
+      Head = __atomic_load_n (&Trace->Head, __ATOMIC_ACQUIRE);
+      Tail = Trace->Tail;
+      if (Head == Tail)
+	{
+	  if (Stopping)
+	    break;
+	  PacerWait (&Pacer);
+	  continue;
+	}
+      Start = Tail & (TRACE_RING_SIZE - 1);
+      Count = Head - Tail;
+      if (Count > TRACE_RING_SIZE - Start)
+	Count = TRACE_RING_SIZE - Start;
+      if (fwrite (&Trace->Ring[Start], sizeof (TraceRecord_t), Count,
+		  Writer->File) != Count)
+	Writer->Error = 1;
+      __atomic_store_n (&Trace->Tail, Tail + Count, __ATOMIC_RELEASE);
+    }
+  return (NULL);
+}
+
+// Starts tracing State to Filename, from its next instruction.  Each agc_t
+// has its own trace and writer thread, so several CPUs can be traced at
+// once, to different files.  Returns 0 on success, or 1 if the file can't
+// be written or there's no memory for the ring.
+int
+TraceStart (agc_t *State, const char *Filename)
+{
+  TraceHeader_t Header;
+  TraceWriter_t *Writer;
+
+  if (State->Trace != NULL)
+    return (1);
+  Writer = (TraceWriter_t *) calloc (1, sizeof (TraceWriter_t));
+  if (Writer == NULL)
+    return (1);
+  Writer->Trace.StartAddress = -1;
+  Writer->File = TraceOpen (Filename, "w", &Writer->Piped);
+  if (Writer->File == NULL)
+    {
+      free (Writer);
+      return (1);
+    }
+  memset (&Header, 0, sizeof (Header));
+  strcpy (Header.Magic, TRACE_MAGIC);
+  Header.Version = TRACE_VERSION;
+  Header.ByteOrder = TRACE_BYTE_ORDER;
+  Header.RecordSize = sizeof (TraceRecord_t);
+  Writer->Error = (1 != fwrite (&Header, sizeof (Header), 1, Writer->File));
+  if (Writer->Error
+      || pthread_create (&Writer->Thread, NULL, TraceLoop, Writer))
+    {
+      TraceClose (Writer->File, Writer->Piped);
+      free (Writer);
+      return (1);
+    }
+  State->Trace = &Writer->Trace;
+  return (0);
+}
+
+// Adds the addresses in Spec, which is either one address or two
+// separated by a dash, to those traced.  Returns 0 on success, or 1 if
+// there's no trace or the addresses aren't understood.
+int
+TraceRange (agc_t *State, const char *Spec)
+{
+  Trace_t *Trace = State->Trace;
+  char *From, *To;
+  int First, Last;
+
+  if (Trace == NULL)
+    return (1);
+  From = strdup (Spec);
+  if (From == NULL)
+    return (1);
+  // A label with a dash in it is an address by itself.
+  First = Last = TraceAddress (From);
+  To = strchr (From, '-');
+  if (First == -1 && To != NULL)
+    {
+      *To++ = 0;
+      First = TraceAddress (From);
+      Last = TraceAddress (To);
+    }
+  free (From);
+  if (First == -1 || Last == -1 || Last < First)
+    return (1);
+  memset (&Trace->InRange[First], 1, Last - First + 1);
+  Trace->Ranged = 1;
+  return (0);
+}
+
+// Starts the trace when the instruction at From (if not NULL) is reached
+// at or after machine cycle Cycle, and stops it after Limit records (if
+// not 0).  Returns 0 on success, or 1 if there's no trace or From isn't
+// understood.
+int
+TraceTrigger (agc_t *State, const char *From, uint64_t Cycle,
+	      uint64_t Limit)
+{
+  Trace_t *Trace = State->Trace;
+
+  if (Trace == NULL)
+    return (1);
+  Trace->StartAddress = -1;
+  if (From != NULL)
+    {
+      Trace->StartAddress = TraceAddress (From);
+      if (Trace->StartAddress == -1)
+	return (1);
+    }
+  Trace->StartCycle = Cycle;
+  Trace->Limit = Limit;
+  Trace->Triggered = 0;
+  return (0);
+}
+
+// Writes the last of the trace, and stops it.  Returns 0 on success, or 1
+// if the file couldn't all be written.
+int
+TraceStop (agc_t *State)
+{
+  TraceWriter_t *Writer;
+  int Error;
+
+  if (State->Trace == NULL)
+    return (1);
+  Writer = (TraceWriter_t *) State->Trace;	// Trace is its first member.
+  __atomic_store_n (&Writer->Stopping, 1, __ATOMIC_RELEASE);
+  pthread_join (Writer->Thread, NULL);
+  Error = Writer->Error;
+  if (TraceClose (Writer->File, Writer->Piped))
+    Error = 1;
+  free (Writer);
+  State->Trace = NULL;
+  return (Error);
+}
+
+//---------------------------------------------------------------------------
+// The decoder.
+
+static void
+TracePrint (const TraceRecord_t *Record)
+{
+  char Where[16], Source[MAX_FILE_LENGTH + 16];
+  SymbolLine_t *Line = NULL;
+  Symbol_t *Label = NULL;
+  int Z = Record->Z, Bank, Super;
+
+  if (Z < 01400)
+    sprintf (Where, "%04o", Z);
+  else if (Z < 02000)
+    sprintf (Where, "E%o,%04o", Record->BB & 07, Z);
+  else if (Z < 04000)
+    {
+      Bank = (Record->BB >> 10) & 037;
+      Super = (Bank >= 030 && (Record->Flags & TRACE_SUPERBANK));
+      sprintf (Where, "%02o,%04o", Super ? Bank + 010 : Bank, Z);
+      Line = ResolveLineAGC (Z, Bank, Super);
+    }
+  else
+    {
+      sprintf (Where, "%04o", Z);
+      Line = ResolveLineAGC (Z, Z / 02000, 0);
+    }
+  Source[0] = 0;
+  if (Line != NULL)
+    {
+      Label = ResolveLastLabel (Line);
+      snprintf (Source, sizeof (Source), "%s:%d", Line->FileName,
+		Line->LineNumber);
+    }
+
+  printf ("%12llu %-8s %c%c %06o %06o %06o  %-10s %-30s ",
+	  (unsigned long long) Record->Cycle, Where,
+	  (Record->Flags & TRACE_ISR) ? 'R' : ' ',
+	  (Record->Flags & TRACE_INHINT) ? 'I' : ' ',
+	  Record->A, Record->L, Record->Q,
+	  (Label != NULL) ? Label->Name : "", Source);
+  if (Record->Cause)
+    {
+      printf ("interrupt %s\n", (Record->Cause <= NUM_INTERRUPT_TYPES) ?
+	      InterruptNames[Record->Cause] : "?");
+      return;
+    }
+  if (Record->Flags & TRACE_SUBSTITUTE)
+    printf ("sub\t");
+  else if (Record->Index)
+    printf ("w/i:\t");
+  DasPrintTracedInstruction (Z, Record->Flags & TRACE_EXTRACODE,
+			     Record->Instruction & 077777);
+}
+
+// Prints the trace in Filename.  Returns 0 on success, or 1 if it can't be
+// read.
+int
+TraceDecode (const char *Filename)
+{
+  TraceHeader_t Header;
+  TraceRecord_t *Records;
+  FILE *fp;
+  size_t Count, i;
+  int Piped, Error = 0;
+
+  fp = TraceOpen (Filename, "r", &Piped);
+  if (fp == NULL)
+    {
+      printf ("Cannot read the trace \"%s\".\n", Filename);
+      return (1);
+    }
+  if (1 != fread (&Header, sizeof (Header), 1, fp)
+      || memcmp (Header.Magic, TRACE_MAGIC, sizeof (Header.Magic))
+      || Header.Version != TRACE_VERSION
+      || Header.ByteOrder != TRACE_BYTE_ORDER
+      || Header.RecordSize != sizeof (TraceRecord_t))
+    {
+      printf ("\"%s\" isn't a trace, or is from a different kind of "
+	      "computer.\n", Filename);
+      TraceClose (fp, Piped);
+      return (1);
+    }
+  Records = (TraceRecord_t *) malloc (TRACE_CHUNK * sizeof (TraceRecord_t));
+  if (Records == NULL)
+    {
+      TraceClose (fp, Piped);
+      return (1);
+    }
+
+  printf ("# R = in an interrupt, I = interrupts inhibited.  A, L, and Q "
+	  "are before the\n# instruction.\n");
+  printf ("#%11s %-8s %2s %6s %6s %6s  %-10s %-30s %s\n", "Cycle", "Address",
+	  "", "A", "L", "Q", "Label", "Source", "Instruction");
+  while ((Count = fread (Records, sizeof (TraceRecord_t), TRACE_CHUNK, fp))
+	 > 0)
+    for (i = 0; i < Count; i++)
+      TracePrint (&Records[i]);
+  if (ferror (fp))
+    Error = 1;
+  if (TraceClose (fp, Piped))
+    Error = 1;
+  free (Records);
+  if (Error)
+    printf ("Error reading the trace \"%s\".\n", Filename);
+  return (Error);
+}
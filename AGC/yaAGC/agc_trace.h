@@ -0,0 +1,57 @@
+/*
+  Copyright 2026 Ronald S. Burkey <info@sandroid.org>
+
+  This file is part of yaAGC.
+
+  yaAGC is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  yaAGC is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with yaAGC; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+  Filename:	agc_trace.h
+  Purpose:	Header for agc_trace.c, the binary instruction trace.
+  Compiler:	GNU gcc.
+  Contact:	Ron Burkey <info@sandroid.org>
+  Reference:	http://www.ibiblio.org/apollo/index.html
+  Mods:		2026-10-17	Began.
+*/
+
+#ifndef AGC_TRACE_H
+#define AGC_TRACE_H
+
+#include "agc_engine.h"
+#include "agc_symtab.h"
+
+// A trace file begins with this, followed by the TraceRecord_t's, in the
+// byte order of the computer that wrote it.
+#define TRACE_MAGIC "yaTRCv1"
+#define TRACE_VERSION 1
+#define TRACE_BYTE_ORDER 0x01020304
+typedef struct
+{
+  char Magic[8];			// TRACE_MAGIC
+  uint32_t Version;			// TRACE_VERSION
+  uint32_t ByteOrder;			// TRACE_BYTE_ORDER
+  uint32_t RecordSize;			// sizeof (TraceRecord_t)
+  uint32_t Unused;
+} TraceHeader_t;
+
+int TraceSymbolAddress (const Address_t *Value);
+int TraceAddress (const char *Spec);
+int TraceStart (agc_t *State, const char *Filename);
+int TraceRange (agc_t *State, const char *Spec);
+int TraceTrigger (agc_t *State, const char *From, uint64_t Cycle,
+		  uint64_t Limit);
+int TraceStop (agc_t *State);
+int TraceDecode (const char *Filename);
+
+#endif // AGC_TRACE_H
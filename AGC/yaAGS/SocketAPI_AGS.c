@@ -40,6 +40,10 @@
   		03/18/09 RSB	Added some robustness filtering to 
 				the tcp interface.
 		03/19/09 RSB	Added stuff related to --debug-deda.
+		2026-10-17	Clients can be connected through shared
+				memory (see ../yaAGC/agc_shm.c).
+		2026-10-17	Count each client's packets and bytes, for
+				../yaAGC/agc_stats.c.
 */
 
 #include <errno.h>
@@ -51,6 +55,7 @@ typedef unsigned short uint16_t;
 #define SOCKET_API_AGS_C
 #include "yaAGC.h"
 #include "aea_engine.h"
+#include "agc_shm.h"
 
 // When we detect the pressing of the READ OUT or ENTR key, we don't immediately
 // pass it along to the CPU.  Instead, we interact with yaDEDA to buffer the
@@ -73,10 +78,30 @@ int DedaBuffer[9], DedaBufferCount = 0, DedaBufferWanted = 0,
 static
 void OneRawChannelOutputAGS (Client_t *Client, const unsigned char *Packet, int Type, int Data)
 {
-  if (Client->Socket != -1)
+  if (Client->Socket == SHM_SOCKET)
     {
-      if (send (Client->Socket, Packet, 4, MSG_NOSIGNAL) == SOCKET_ERROR 
-          && SOCKET_BROKEN)
+      if (ShmSend (Client->Shm, Packet, 4) < 0)
+	{
+	  if (!DebugMode)
+	    printf ("Removing shared memory on port %d\n", Client->Shm->Port);
+	  ShmRelease (Client->Shm);
+	  Client->Socket = -1;
+	}
+      else
+	{
+	  Client->PacketsOut++;
+	  Client->BytesOut += 4;
+	}
+    }
+  else if (Client->Socket != -1)
+    {
+      int n = send (Client->Socket, Packet, 4, MSG_NOSIGNAL);
+      if (n > 0)
+	{
+	  Client->PacketsOut++;
+	  Client->BytesOut += n;
+	}
+      else if (n == SOCKET_ERROR && SOCKET_BROKEN)
 	{
 	  if (!DebugMode)
 	    printf ("Removing socket %d\n", Client->Socket);
@@ -144,13 +169,19 @@ ChannelInputAGS (ags_t * State)
 	    // packet per client per instruction cycle.
 	    for (j = Client->Size; j < 4; j++)
 	      {
-		k = recv (Client->Socket, &c, 1, 0);
+		if (Client->Socket == SHM_SOCKET)
+		  k = ShmRecv (Client->Shm, &c, 1);
+		else
+		  k = recv (Client->Socket, &c, 1, 0);
 		if (k == 0 || k == -1)
 		  break;
+		Client->BytesIn++;
 		// 20090318 RSB.  Added this filter for a little 
 		// robustness, but it shouldn't be needed.
 		if (Signatures[j] != (c & 0xC0))
 		  {
+		    if (Client->Size != 0 || 0 != (c & 0xC0))
+		      Client->BadPackets++;
 		    Client->Size = 0;
 		    if (0 != (c & 0xC0))
 		      {
@@ -168,7 +199,10 @@ ChannelInputAGS (ags_t * State)
 		//printf ("Received from %d: %02X %02X %02X %02X\n",
 		//	i, Client->Packet[0], Client->Packet[1],
 		//	Client->Packet[2], Client->Packet[3]);
-		if (!ParseIoPacketAGS (Client->Packet, &Type, &Data))
+		Client->PacketsIn++;
+		if (ParseIoPacketAGS (Client->Packet, &Type, &Data))
+		  Client->BadPackets++;
+		else
 		  switch (Type)
 		    {
 		    case 000:		// PGNS theta integrator.
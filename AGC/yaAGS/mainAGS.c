@@ -111,13 +111,21 @@
 		03/18/09 RSB	Added some necessary goofiness to allow proper usage
 				when linking statically to the Win32 pthreads library.
 				Added --debug-deda.
+		2026-10-17	Real time is now paced by the monotonic
+				clock in ../yaAGC/Pacer.c, at an adjustable
+				--quantum, rather than by times().
+		2026-10-17	Added --shm.
+		2026-10-17	Added --stats and --stats-interval.
+		2026-10-17	The --shm regions are removed on exit.
 */
 
 //#define VERSION(x) #x
 
 #include <stdio.h>
+#include <stdlib.h>
 #include "aea_engine.h"
 #include "agc_symtab.h"
+#include "agc_stats.h"
 #include "yaAEA.h"
 #include <string.h>
 #include <unistd.h>
@@ -161,12 +169,36 @@ clock_t times (struct tms *p)
 
 //-----------------------------------------------------------------------------------
 
+static Pacer_t Pacer;
+
+static void
+PrintPacing (void)
+{
+  PacerReport (&Pacer);
+}
+
+// Writes yaAGS's part of the --stats file (see ../yaAGC/agc_stats.c).
+static void
+WriteStats (FILE *fp, double Seconds, void *Data)
+{
+  static uint64_t LastCycles = 0;
+  StatsRate (fp, "aea_cycles", State.CycleCounter, &LastCycles, Seconds);
+  StatsPacer (fp, &Pacer);
+  StatsClients (fp, Clients, MAX_CLIENTS, Portnum);
+}
+
+//-----------------------------------------------------------------------------------
+
 int
 main (int argc, char *argv[])
 {
   char *RomImage = NULL, *CoreDump = NULL;
-  int i;
+  int i, Quantum = 1000, PacingReport = 0;
+  int StatsInterval = STATS_DEFAULT_INTERVAL;
+  char *StatsFile = NULL;
   struct tms DummyTime;
+  uint64_t StartTime, StartCycles, Now, Paused, AeaTime;
+  clock_t StartOffset;
 
   //int k, n;
   //int16_t *WordPtr;
@@ -196,6 +228,17 @@ main (int argc, char *argv[])
         DebugModeAGS = 2;
       else if (!strcmp (argv[i], "--debug-deda"))
         DebugDeda = 1;
+      else if (1 == sscanf (argv[i], "--quantum=%d", &Quantum) && Quantum > 0)
+        ;
+      else if (!strcmp (argv[i], "--pacing-report"))
+        PacingReport = 1;
+      else if (!strcmp (argv[i], "--shm"))
+        SharedMemory = 1;
+      else if (!strncmp (argv[i], "--stats=", 8))
+        StatsFile = &argv[i][8];
+      else if (1 == sscanf (argv[i], "--stats-interval=%d", &StatsInterval)
+               && StatsInterval > 0)
+        ;
       else if (!strncmp (argv[i], "--symtab=", 9))
 	{
 	  strcpy(SymbolFileAGS, &argv[i][9]);
@@ -221,7 +264,18 @@ main (int argc, char *argv[])
 	      "--debug               Enter debug mode.\n"
 	      "--debug-deda          Print messages showing how input\n"
 	      "                      data from the DEDA is parsed.\n"
-	      "--symtab=filename     Load symbol table from file.\n");
+	      "--symtab=filename     Load symbol table from file.\n"
+	      "--quantum=N           Catch the CPU up with real time every\n"
+	      "                      N microseconds (default 1000).\n"
+	      "--pacing-report       Print timing histograms on exit.\n"
+	      "--shm                 Let peripherals on the same computer\n"
+	      "                      connect through shared memory, if\n"
+	      "                      they're run with --shm too.\n"
+	      "--stats=filename      While running, rewrite the file every\n"
+	      "                      second with live statistics:  AEA cycles\n"
+	      "                      per second, pacing, and the traffic with\n"
+	      "                      each peripheral.\n"
+	      "--stats-interval=N    Rewrite it every N milliseconds instead.\n");
       return (1);
     }
   DebugMode = DebugModeAGS;
@@ -270,44 +324,48 @@ main (int argc, char *argv[])
   // user's standpoint.)  So I do a trick:  I just execute the simulation
   // often enough to keep up with real-time on the average.  AGS time is
   // measured as the number of machine cycles divided by AEA_PER_SECOND, 
-  // while real-time is measured using the times() function.  What this means
-  // is that AEA_PER_SECOND AGC cycles are executed every CLK_TCK clock ticks.  
-  // The timing is thus rather rough-and-ready (i.e., I'm sure it can be improved 
-  // a lot).  It's good enough for me, for NOW, but I'd be happy to take suggestions 
-  // for how to improve it in a reasonably portable way.
-  RealTimeOffsetAGS = times (&DummyTime);	// The starting time of the program.
-  CycleCount = State.CycleCounter * sysconf (_SC_CLK_TCK);	// Number of AEA cycles so far.
-  RealTimeOffsetAGS -= (CycleCount + AEA_PER_SECOND / 2) / AEA_PER_SECOND;
-  LastRealTimeAGS = ~0UL;
+  // while real-time is measured by the monotonic clock in Pacer.c, which
+  // wakes us up every Quantum microseconds.  RealTimeAGS and 
+  // RealTimeOffsetAGS are still kept in times() ticks for the debugger,
+  // which adds the time it's paused to RealTimeOffsetAGS; that time
+  // doesn't count.
+  PacerInit (&Pacer, Quantum * (uint64_t) 1000);
+  StartTime = PacerNow ();	// The starting time of the program.
+  RealTimeOffsetAGS = StartOffset = times (&DummyTime);
+  CycleCount = StartCycles = State.CycleCounter;	// Number of AEA cycles so far.
+  DesiredCycles = CycleCount;
+  if (PacingReport)
+    atexit (PrintPacing);
+  if (SharedMemory)
+    atexit (ChannelCloseGeneric);
+  if (StatsFile != NULL)
+    {
+      if (StatsStart (StatsFile, StatsInterval, WriteStats, NULL))
+        printf ("Could not create the statistics file \"%s\".\n", StatsFile);
+      else
+        atexit (StatsStop);
+    }
   while (1)
     {
       RealTimeAGS = times (&DummyTime);
-      if (RealTimeAGS != LastRealTimeAGS)
-	{
-	  // Need to recalculate the number of AEA cycles we're supposed to
-	  // have executed.  Notice the trick of multiplying both CycleCount
-	  // and DesiredCycles by CLK_TCK, to avoid a long long division by CLK_TCK.
-	  // This not only reduces overhead, but actually makes the calculation
-	  // more exact.  A bit tricky to understand at first glance, though.
-	  LastRealTimeAGS = RealTimeAGS;
-	  DesiredCycles = (RealTimeAGS - RealTimeOffsetAGS) * AEA_PER_SECOND;
-	}
-      else
-        {
-#ifdef WIN32
-	  Sleep (10);	    
-#else // WIN32
-	  struct timespec req, rem;
-	  req.tv_sec = 0;
-	  req.tv_nsec = 10000000;
-	  nanosleep (&req, &rem);
-#endif // WIN32
-	}
+      Now = PacerWait (&Pacer);
+      Paused = (uint64_t) (RealTimeOffsetAGS - StartOffset) * 1000000000ULL 
+               / sysconf (_SC_CLK_TCK);
+      if (Now - StartTime > Paused)
+        DesiredCycles = StartCycles + (uint64_t) 
+	  ((Now - StartTime - Paused) * (AEA_PER_SECOND / 1e9));
+      PacerBacklog (&Pacer, (DesiredCycles > CycleCount) ?
+		    DesiredCycles - CycleCount : 0);
       // Execute as many AEA CPU instructions as needed to catch up with real time.
       while (CycleCount < DesiredCycles)
 	{
-	  CycleCount += aea_engine (&State) * sysconf (_SC_CLK_TCK);
+	  CycleCount += aea_engine (&State);
 	}
+      // Note how far behind real time we still are.
+      AeaTime = StartTime + Paused + (uint64_t)
+	((CycleCount - StartCycles) * (1e9 / AEA_PER_SECOND));
+      Now = PacerNow ();
+      PacerLag (&Pacer, (Now > AeaTime) ? Now - AeaTime : 0);
     }
 
 #ifdef PTW32_STATIC_LIB
@@ -36,6 +36,9 @@
 				attempt to work around the weird behavior
 				I've been seeing with the DEDA essentially
 				freezing up.
+		2026-10-17	Added --shm, for connecting to yaAGS
+				through shared memory rather than a
+				socket.
   
   The yaDSKY2 program is intended to be a completely identical drop-in
   replacement for the yaDEDA program as it exists at 2009-03-12.  
@@ -62,6 +65,7 @@ using namespace std;
 
 #include "../yaAGC/yaAGC.h"
 #include "../yaAGC/agc_engine.h"
+#include "../yaAGC/agc_shm.h"
 
 #ifdef WIN32
 clock_t 
@@ -85,6 +89,9 @@ static int StartupDelay = 0;
 #endif
 extern int Portnum;
 static int ServerSocket = -1;
+// With --shm, ServerShm is used in place of ServerSocket.
+static int UseShm = 0;
+static ShmLink_t *ServerShm = NULL;
 
 // Names of various graphics files.
 
@@ -532,6 +539,8 @@ bool yaDedaAppClass::OnInit()
 	  strcpy (NonDefaultHostname, ArgEnd.char_str ());
 	  Hostname = NonDefaultHostname;
 	}
+      else if (Arg.IsSameAs (wxT ("--shm")))
+        UseShm = 1;
       else if (ArgStart.IsSameAs (wxT ("--port")))
         {
 	  long lPortnum;
@@ -578,6 +587,10 @@ bool yaDedaAppClass::OnInit()
 	  printf ("\tdifferent port settings for yaDEDA2 are needed.  Note that by default,\n");
 	  printf ("\tyaAGS listens for new connections on ports %d-%d.\n",
 	          Portnum, Portnum + 10 - 1);
+	  printf ("--shm\n");
+	  printf ("\tConnects to yaAGS through shared memory rather than a socket, on the\n");
+	  printf ("\tsame port number.  yaAGS must be on the same computer, and must have\n");
+	  printf ("\tbeen started with its own --shm switch.  --ip is then ignored.\n");
 	  printf ("--half-size\n");
 	  printf ("\tUses a half-size version of yaDEDA2, suitable for smaller graphical\n");
 	  printf ("\tdisplays. \n");
@@ -651,17 +664,38 @@ TimerClass::Notify ()
       return;
     }
   // Try to connect to the server (yaAGC) if not already connected.
-  if (ServerSocket == -1)
+  if (UseShm)
+    {
+      if (ServerShm == NULL)
+        {
+	  ServerShm = ShmConnect (Portnum);
+	  if (ServerShm != NULL)
+	    printf ("yaDEDA2 is connected through shared memory.\n");
+	}
+    }
+  else if (ServerSocket == -1)
     {
       ServerSocket = CallSocket (Hostname, Portnum);
       if (ServerSocket != -1)
         printf ("yaDEDA2 is connected, socket=%d.\n", ServerSocket);
     }
-  if (ServerSocket != -1)
+  if (ServerSocket != -1 || ServerShm != NULL)
     {
       for (;;)
         {
-	  i = recv (ServerSocket, (char *) &c, 1, MSG_NOSIGNAL);
+	  if (ServerShm != NULL)
+	    {
+	      i = ShmRecv (ServerShm, &c, 1);
+	      if (i == -1)
+	        {
+		  printf ("yaDEDA2 reports that yaAGS has gone\n");
+		  ShmDisconnect (ServerShm);
+		  ServerShm = NULL;
+		  break;
+		}
+	    }
+	  else
+	    i = recv (ServerSocket, (char *) &c, 1, MSG_NOSIGNAL);
 	  if (i == -1)
 	    {
 	      // The conditions i==-1,errno==0 or 9 occur only on Win32,
@@ -797,7 +831,16 @@ MainFrame::OutputData (int Type, int Data)
   unsigned char Packet[4];
   extern int ServerSocket;
   int j;
-  if (ServerSocket != -1)
+  if (ServerShm != NULL)
+    {
+      FormIoPacketAGS (Type, Data, Packet);
+      if (ShmSend (ServerShm, Packet, 4) < 0)
+        {
+	  ShmDisconnect (ServerShm);
+	  ServerShm = NULL;
+	}
+    }
+  else if (ServerSocket != -1)
     {
       FormIoPacketAGS (Type, Data, Packet);
       j = send (ServerSocket, (const char *) Packet, 4, MSG_NOSIGNAL);
@@ -49,6 +49,9 @@
 				transmissions.  Increased the flashing
 				frequency as well, by about 20%.  It's
 				still not accurate.
+		2026-10-17	Added --shm, for connecting to yaAGC
+				through shared memory rather than a
+				socket.
   
   The yaDSKY2 program is intended to be a completely identical drop-in
   replacement for the yaDSKY program as it exists at 2009-03-06.  
@@ -78,6 +81,7 @@ using namespace std;
 
 #include "../yaAGC/yaAGC.h"
 #include "../yaAGC/agc_engine.h"
+#include "../yaAGC/agc_shm.h"
 
 static MainFrame* MainWindow;
 int HalfSize = 0;
@@ -97,6 +101,40 @@ static int DebugCounterReg = 032, DebugCounterInc = 1, DebugCounterWhich = 1;
 static int TestUplink = 0;
 static int VerbNounFlashing = 0;
 static int ServerSocket = -1;
+// With --shm, ServerShm is used in place of ServerSocket.
+static int UseShm = 0;
+static ShmLink_t *ServerShm = NULL;
+
+// Sends a packet (or packets) to yaAGC, through whichever of ServerShm and
+// ServerSocket is connected, and drops the connection if it has broken.
+static void
+SendToServer (const unsigned char *Packet, int Size)
+{
+  int j;
+  if (ServerShm != NULL)
+    {
+      if (ShmSend (ServerShm, Packet, Size) < 0)
+        {
+	  ShmDisconnect (ServerShm);
+	  ServerShm = NULL;
+	}
+    }
+  else if (ServerSocket != -1)
+    {
+      j = send (ServerSocket, (const char *) Packet, Size, MSG_NOSIGNAL);
+      if (j == SOCKET_ERROR && SOCKET_BROKEN)
+        {
+	  if (!DebugMode)
+	    printf ("Removing socket %d\n", ServerSocket);
+#ifdef unix
+	  close (ServerSocket);
+#else
+	  closesocket (ServerSocket);
+#endif
+	  ServerSocket = -1;
+	}
+    }
+}
 
 static const char SevenSeg0[] = "7Seg-0.jpg";
 
@@ -623,7 +661,6 @@ void MainFrame::on_ProButton_pressed(wxCommandEvent &event)
 {
   if (DebugCounterMode)
     {
-      int j;
       unsigned char Packet[4];
       if (DebugCounterReg < 032 || DebugCounterReg > 060)
 	return;
@@ -636,21 +673,7 @@ void MainFrame::on_ProButton_pressed(wxCommandEvent &event)
       //printf ("Reg=%02o Inc=%o Packet=%02x %02x %02x %02x\n",
       //	      DebugCounterReg, DebugCounterInc,
       //	      Packet[0], Packet[1], Packet[2], Packet[3]);
-      if (ServerSocket != -1)
-	{
-	  j = send (ServerSocket, (const char *) Packet, 4, MSG_NOSIGNAL);
-	  if (j == SOCKET_ERROR && SOCKET_BROKEN)
-	    {
-	      if (!DebugMode)
-	        printf ("Removing socket %d\n", ServerSocket);
-#ifdef unix
-	      close (ServerSocket);
-#else
-	      closesocket (ServerSocket);
-#endif
-	      ServerSocket = -1;
-	    }
-	}
+      SendToServer (Packet, 4);
     }
   else
     {
@@ -981,6 +1004,8 @@ bool yaDskyApp::OnInit()
 	  strcpy (NonDefaultHostname, ArgEnd.char_str ());
 	  Hostname = NonDefaultHostname;
 	}
+      else if (Arg.IsSameAs (wxT ("--shm")))
+        UseShm = 1;
       else if (ArgStart.IsSameAs (wxT ("--port")))
         {
 	  long lPortnum;
@@ -1039,6 +1064,10 @@ bool yaDskyApp::OnInit()
 	  printf ("\tdifferent port settings for yaDSKY2 are needed.  Note that by default,\n");
 	  printf ("\tyaAGC listens for new connections on ports %d-%d.\n",
 	          Portnum, Portnum + 10 - 1);
+	  printf ("--shm\n");
+	  printf ("\tConnects to yaAGC through shared memory rather than a socket, on the\n");
+	  printf ("\tsame port number.  yaAGC must be on the same computer, and must have\n");
+	  printf ("\tbeen started with its own --shm switch.  --ip is then ignored.\n");
 	  printf ("--cfg=ConfigFilename\n");
 	  printf ("\tSelects a configuration file to be used, to allow different yaDSKY\n");
 	  printf ("\tsettings for LM vs. CM, or for different Apollo missions.  The \n");
@@ -1209,17 +1238,38 @@ TimerClass::Notify ()
       FlashStatus = !FlashStatus;
     }
   // Try to connect to the server (yaAGC) if not already connected.
-  if (ServerSocket == -1)
+  if (UseShm)
+    {
+      if (ServerShm == NULL)
+        {
+	  ServerShm = ShmConnect (Portnum);
+	  if (ServerShm != NULL)
+	    printf ("yaDSKY is connected through shared memory.\n");
+	}
+    }
+  else if (ServerSocket == -1)
     {
       ServerSocket = CallSocket (Hostname, Portnum);
       if (ServerSocket != -1)
         printf ("yaDSKY is connected.\n");
     }
-  if (ServerSocket != -1)
+  if (ServerSocket != -1 || ServerShm != NULL)
     {
       for (;;)
         {
-	  i = recv (ServerSocket, (char *) &c, 1, MSG_NOSIGNAL);
+	  if (ServerShm != NULL)
+	    {
+	      i = ShmRecv (ServerShm, &c, 1);
+	      if (i == -1)
+	        {
+		  printf ("yaDSKY reports that yaAGC has gone\n");
+		  ShmDisconnect (ServerShm);
+		  ServerShm = NULL;
+		  break;
+		}
+	    }
+	  else
+	    i = recv (ServerSocket, (char *) &c, 1, MSG_NOSIGNAL);
 	  if (i == -1)
 	    {
 	      // The conditions i==-1,errno==0 or 9 occur only on Win32,
@@ -1551,8 +1601,7 @@ void
 MainFrame::OutputKeycode (int Keycode)
 {
   unsigned char Packet[4];
-  int j;
-  if (ServerSocket != -1)
+  if (ServerSocket != -1 || ServerShm != NULL)
     {
       if (TestUplink)
         {
@@ -1564,12 +1613,7 @@ MainFrame::OutputKeycode (int Keycode)
 	}
       else	
         FormIoPacket (015, Keycode, Packet);
-      j = send (ServerSocket, (const char *) Packet, 4, MSG_NOSIGNAL);
-      if (j == SOCKET_ERROR && SOCKET_BROKEN)
-        {
-	  close (ServerSocket);
-	  ServerSocket = -1;
-	}
+      SendToServer (Packet, 4);
     }
 }
 
@@ -1580,8 +1624,7 @@ void
 MainFrame::OutputPro (int OffOn)
 {
   unsigned char Packet[8];
-  int j;
-  if (ServerSocket != -1)
+  if (ServerSocket != -1 || ServerShm != NULL)
     {
       // First, create the mask which will tell the CPU to only pay attention to
       // bit 14 of the channel (032).
@@ -1591,12 +1634,7 @@ MainFrame::OutputPro (int OffOn)
         OffOn = 020000;
       FormIoPacket (032, OffOn, &Packet[4]);
       // And, send it all.
-      j = send (ServerSocket, (const char *) Packet, 8, MSG_NOSIGNAL);
-      if (j == SOCKET_ERROR && SOCKET_BROKEN)
-        {
-	  close (ServerSocket);
-	  ServerSocket = -1;
-	}
+      SendToServer (Packet, 8);
     }
 }
 
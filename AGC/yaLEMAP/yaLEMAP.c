@@ -55,6 +55,8 @@
 				to upper case.  This doesn't matter a lot,
 				but does mess up URLs, so it has been
 				repaired.
+		2026-10-17	Asks for the original version of the
+				symbol table file.
 				
   Note that we use yaYUL's symbol-table machinery for handling the
   symbol table.
@@ -1340,8 +1342,9 @@ main (int argc, char *argv[])
   // up later.
   SortLines (SORT_LEMAP);
 
-  // Print the symbol table to a binary file
-  WriteSymbolsToFile ("yaLEMAP.symtab");
+  // Print the symbol table to a binary file.  yaAGS reads only the
+  // original version of the file.
+  WriteSymbolsToFile ("yaLEMAP.symtab", 1);
 
   // Print symbol table.
   fprintf (Lst, "\n");
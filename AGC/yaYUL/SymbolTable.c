@@ -61,6 +61,9 @@
                                 only if UnpoundPage is non-zero --- i.e.,
                                 only if --unpound-page command-line
                                 switch was used. 
+                2026-10-17      WriteSymbolsToFile can write version 2
+                                of the symbol table file, with a name
+                                hash and a line index.
 
 
   Concerning the concept of a symbol's namespace.  I had originally 
@@ -879,12 +882,115 @@ int EditSymbolNew(const char *Name,
 #define O_BINARY 0
 #endif
 
-void WriteSymbolsToFile(char *fname)
+//------------------------------------------------------------------------
+// The hash of a symbol name used for the name hash in version 2 of the
+// symbol table file.  It's FNV-1a, and yaAGC must use the same one.
+unsigned SymbolNameHash(const char *Name)
+{
+  unsigned Hash = 2166136261u;
+
+  while (*Name)
+    Hash = (Hash ^ (unsigned char) *Name++) * 16777619u;
+  return (Hash);
+}
+
+// Returns where a line's address goes in the line index of version 2 of
+// the symbol table file, or -1 if it isn't in fixed memory.  The banks are
+// numbered as in CompareLineAGC.
+static int LineIndexAGC(Address_t *Address)
+{
+  int Bank;
+
+  if (!Address->Fixed)
+    return (-1);
+  if (Address->Banked && Address->FB >= 020 && Address->Super)
+    Bank = Address->FB + 010;
+  else if (Address->Banked)
+    Bank = Address->FB;
+  else
+    Bank = Address->SReg / 02000;
+  if (Bank >= SYMBOL_LINE_BANKS)
+    return (-1);
+  return (Bank * 02000 + (Address->SReg & 01777));
+}
+
+static int CompareFileNames(const void *Raw1, const void *Raw2)
+{
+  return (strcmp(*(char **) Raw1, *(char **) Raw2));
+}
+
+// Converts the integers in a SymbolFile2_t between the CPU's representation
+// and little-endian format, in either direction.
+static void LittleEndianHeader2(SymbolFile2_t *Header)
+{
+  LittleEndian32(&Header->Version);
+  LittleEndian32(&Header->NumberSymbols);
+  LittleEndian32(&Header->NumberLines);
+  LittleEndian32(&Header->HashSize);
+  LittleEndian32(&Header->NumberFiles);
+  LittleEndian32(&Header->FilesSize);
+  LittleEndian32(&Header->SymbolsOffset);
+  LittleEndian32(&Header->LinesOffset);
+  LittleEndian32(&Header->HashOffset);
+  LittleEndian32(&Header->LineIndexOffset);
+  LittleEndian32(&Header->FilesOffset);
+}
+
+// Writes the sections of version 2 of the symbol table file which follow
+// the symbols and lines: the name hash, the line index, and the names of
+// the source files, which are given sorted.  Returns 0 on success, 1 if out
+// of memory.
+static int WriteSymbolIndexes(int fd, SymbolFile2_t *Header, char **Files)
+{
+  int i, j, *Hash, *Index;
+
+  Hash = (int *) calloc(Header->HashSize, sizeof(int));
+  Index = (int *) calloc(SYMBOL_LINE_INDEX_SIZE, sizeof(int));
+  if (Hash == NULL || Index == NULL)
+    {
+      free(Hash);
+      free(Index);
+      return (1);
+    }
+
+  for (i = 0; i < SymbolTableSize; i++)
+    {
+      j = SymbolNameHash(SymbolTable[i].Name) & (Header->HashSize - 1);
+      while (Hash[j])
+        j = (j + 1) & (Header->HashSize - 1);
+      Hash[j] = i + 1;
+    }
+  for (i = 0; i < Header->HashSize; i++)
+    LittleEndian32(&Hash[i]);
+  write(fd, (void *) Hash, Header->HashSize * sizeof(int));
+
+  // The lines are sorted, so keep the first of any at the same address.
+  for (i = 0; i < LineTableSize; i++)
+    {
+      j = LineIndexAGC(&LineTable[i].CodeAddress);
+      if (j >= 0 && !Index[j])
+        Index[j] = i + 1;
+    }
+  for (i = 0; i < SYMBOL_LINE_INDEX_SIZE; i++)
+    LittleEndian32(&Index[i]);
+  write(fd, (void *) Index, SYMBOL_LINE_INDEX_SIZE * sizeof(int));
+
+  for (i = 0; i < Header->NumberFiles; i++)
+    write(fd, (void *) Files[i], strlen(Files[i]) + 1);
+
+  free(Hash);
+  free(Index);
+  return (0);
+}
+
+void WriteSymbolsToFile(char *fname, int Version)
 {
   int i, fd;
   SymbolFile_t symfile = { { 0 } };
+  SymbolFile2_t Header = { { 0 } };
   Symbol_t symbol;
   SymbolLine_t Line;
+  char **Files = NULL;
 
   // Open the symbol table file
   if ((fd = open (fname, O_BINARY | O_WRONLY | O_CREAT | O_TRUNC, 0666)) < 0) {
@@ -892,14 +998,58 @@ void WriteSymbolsToFile(char *fname)
     return;
   }
 
-  // Write the SymbolFile_t header to the symbol file, filling its
-  // members first.
-  getcwd(symfile.SourcePath, MAX_PATH_LENGTH);
-  symfile.NumberSymbols = SymbolTableSize;
-  symfile.NumberLines = LineTableSize; // JMS: 07.28
-  LittleEndian32(&symfile.NumberSymbols);
-  LittleEndian32(&symfile.NumberLines);
-  write(fd, (void *)&symfile, sizeof(SymbolFile_t));
+  if (Version == SYMBOL_FILE_VERSION)
+    {
+      // The header of version 2 says where everything is, so the sizes
+      // of the sections, and hence the distinct source files, are needed
+      // up front.  The hash is kept at most half full.
+      Files = (char **) calloc(LineTableSize + 1, sizeof(char *));
+      if (Files == NULL)
+        {
+          printf("\nOut of memory writing symbol table file: %s\n", fname);
+          close(fd);
+          return;
+        }
+      for (i = 0; i < LineTableSize; i++)
+        Files[i] = LineTable[i].FileName;
+      qsort(Files, LineTableSize, sizeof(char *), CompareFileNames);
+      for (i = 0; i < LineTableSize; i++)
+        if (i == 0 || strcmp(Files[Header.NumberFiles - 1], Files[i]))
+          {
+            Files[Header.NumberFiles++] = Files[i];
+            Header.FilesSize += strlen(Files[i]) + 1;
+          }
+      strcpy(Header.Magic, SYMBOL_FILE_MAGIC);
+      Header.Version = SYMBOL_FILE_VERSION;
+      Header.NumberSymbols = SymbolTableSize;
+      Header.NumberLines = LineTableSize;
+      for (Header.HashSize = 16; Header.HashSize < 2 * SymbolTableSize;
+           Header.HashSize *= 2);
+      Header.SymbolsOffset = sizeof(SymbolFile2_t);
+      Header.LinesOffset = Header.SymbolsOffset
+                           + SymbolTableSize * sizeof(Symbol_t);
+      Header.HashOffset = Header.LinesOffset
+                          + LineTableSize * sizeof(SymbolLine_t);
+      Header.LineIndexOffset = Header.HashOffset
+                               + Header.HashSize * sizeof(int);
+      Header.FilesOffset = Header.LineIndexOffset
+                           + SYMBOL_LINE_INDEX_SIZE * sizeof(int);
+      getcwd(Header.SourcePath, MAX_PATH_LENGTH);
+      LittleEndianHeader2(&Header);
+      write(fd, (void *)&Header, sizeof(SymbolFile2_t));
+      LittleEndianHeader2(&Header);
+    }
+  else
+    {
+      // Write the SymbolFile_t header to the symbol file, filling its
+      // members first.
+      getcwd(symfile.SourcePath, MAX_PATH_LENGTH);
+      symfile.NumberSymbols = SymbolTableSize;
+      symfile.NumberLines = LineTableSize; // JMS: 07.28
+      LittleEndian32(&symfile.NumberSymbols);
+      LittleEndian32(&symfile.NumberLines);
+      write(fd, (void *)&symfile, sizeof(SymbolFile_t));
+    }
 
   // Loop and write the symbols to a file
   for (i = 0; i < SymbolTableSize; i++)
@@ -922,6 +1072,13 @@ void WriteSymbolsToFile(char *fname)
       LittleEndian32(&Line.LineNumber);
       write(fd, (void *) &Line, sizeof(SymbolLine_t));
     }
+
+  if (Version == SYMBOL_FILE_VERSION)
+    {
+      if (WriteSymbolIndexes(fd, &Header, Files))
+        printf("\nOut of memory writing symbol table file: %s\n", fname);
+      free(Files);
+    }
   close (fd);
 }
 
@@ -57,6 +57,7 @@
 				the memory size differently.  I'm sure I'll
 				have to add additional tweaks as I go along.
 		02/20/10 RSB	Added --unpound-page.
+		2026-10-17	Writes version 2 of the symbol table file.
 */
 
 #include "yaYUL.h"
@@ -348,7 +349,7 @@ main (int argc, char *argv[])
 	  goto Done;
 	}
       sprintf (SymbolFile, "%s.symtab", InputFilename);
-      WriteSymbolsToFile (SymbolFile);
+      WriteSymbolsToFile (SymbolFile, SYMBOL_FILE_VERSION);
     }
 
   // Output the executable object code.
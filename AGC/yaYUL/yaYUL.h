@@ -52,6 +52,7 @@
                 09/03/09 JL    Added CHECK= and =ECADR directives.
                 01/31/10 RSB   Added Syllable field to Address_t for 
                                Gemini OBC and Apollo LVDC.
+                2026-10-17     Added version 2 of the symbol table file.
 */
 
 #ifndef INCLUDED_YAYUL_H
@@ -204,6 +205,45 @@ typedef struct {
   int  NumberLines;                     // # of SymbolLine_t structs
 } SymbolFile_t;
 
+// Version 2 of the symbol table file is meant to be used in place, by
+// mapping it into memory, rather than read in a record at a time.  It
+// begins with a SymbolFile2_t header, which is distinguished from the
+// SymbolFile_t header of the original version by its Magic field, and
+// contains these sections, at the byte offsets given in the header:
+//
+// Symbol_t (NumberSymbols of these, sorted by name)
+// SymbolLine_t (NumberLines of these, sorted by address)
+// int (HashSize of these) A hash table of the symbol names, using open
+//	addressing with linear probing.  Each entry is 1 + the index of a
+//	symbol, or 0 if unused.  See SymbolNameHash.
+// int (SYMBOL_LINE_INDEX_SIZE of these) The line at each fixed-memory
+//	address, by bank * 02000 + offset within the bank, with the bank
+//	numbered as in the SymbolLine_t sort order.  Each entry is 1 + the
+//	index of a line, or 0 if there's no code there.
+// char (FilesSize of these) The names of the source files, sorted,
+//	each terminated by a 0.
+//
+// All integers are little-endian, as in the original version.
+#define SYMBOL_FILE_MAGIC	"yaSYMv2"
+#define SYMBOL_FILE_VERSION	(2)
+#define SYMBOL_LINE_BANKS	(050)
+#define SYMBOL_LINE_INDEX_SIZE	(SYMBOL_LINE_BANKS * 02000)
+typedef struct {
+  char Magic[8];                        // SYMBOL_FILE_MAGIC
+  int  Version;                         // SYMBOL_FILE_VERSION
+  int  NumberSymbols;                   // # of Symbol_t structs
+  int  NumberLines;                     // # of SymbolLine_t structs
+  int  HashSize;                        // # of hash entries, a power of 2
+  int  NumberFiles;                     // # of source file names
+  int  FilesSize;                       // Total size of the file names
+  int  SymbolsOffset;                   // Where the sections begin
+  int  LinesOffset;
+  int  HashOffset;
+  int  LineIndexOffset;
+  int  FilesOffset;
+  char SourcePath[MAX_PATH_LENGTH];     // Base path for all source
+} SymbolFile2_t;
+
 // The Symbol_t structure represents a symbol within the symbol table
 // This structure has been added to for the purposes of debugging. Recent
 // modifications include adding a "type" to distinguish between symbols
@@ -255,8 +295,14 @@ int EditSymbolNew(const char *Name, Address_t *Value, int Type, char *FileName,
                   unsigned int LineNumber);
 
 // Writes the symbol table to a file in binary format. See yaYUL.h for
-// more information about the format. Takes the name of the symbol file.
-void WriteSymbolsToFile(char *fname);
+// more information about the format. Takes the name of the symbol file,
+// and the version of the format: 1 for the original, or
+// SYMBOL_FILE_VERSION.  Version 2 is only for AGC addresses.
+void WriteSymbolsToFile(char *fname, int Version);
+
+// The hash of a symbol name used for the name hash in version 2 of the
+// symbol table file.
+unsigned SymbolNameHash(const char *Name);
 
 // JMS: 07.28
 //-------------------------------------------------------------------------